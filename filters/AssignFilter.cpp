@@ -36,6 +36,9 @@
 
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/private/ThreadBudget.hpp>
+
+#include <algorithm>
 
 #include "private/DimRange.hpp"
 #include "private/expr/AssignStatement.hpp"
@@ -178,13 +181,132 @@ bool AssignFilter::processOne(PointRef& point)
 }
 
 
+void AssignFilter::processChunk(StreamPointTable& table, point_count_t count)
+{
+    const DimRange& condition = m_args->m_condition;
+
+    // Points that were skipped or don't pass the 'where' expression or the
+    // condition are left alone.
+    std::vector<char> selected(count);
+    PointRef point(table, 0);
+    for (PointId idx = 0; idx < count; ++idx)
+    {
+        point.setPointId(idx);
+        selected[idx] = !table.skip(idx) && eval(point) &&
+            (condition.m_id == Dimension::Id::Unknown ||
+                condition.valuePasses(
+                    point.getFieldAs<double>(condition.m_id)));
+    }
+
+    // A chunk is all the work there is at the moment, so it's split
+    // among threads sooner than a view is.
+    const point_count_t MinPerThread = 4096;
+
+    ThreadGroup group(count / MinPerThread);
+    group.ranges(count, MinPerThread,
+        [this, &table, &selected](size_t, PointId begin, PointId end)
+    {
+        PointRef point(table, 0);
+        for (AssignRange& r : m_args->m_assignments)
+            for (PointId idx = begin; idx < end; ++idx)
+            {
+                if (!selected[idx])
+                    continue;
+                point.setPointId(idx);
+                if (r.valuePasses(point.getFieldAs<double>(r.m_id)))
+                    point.setField(r.m_id, r.m_value);
+            }
+
+        // As in filter(), each statement is evaluated for the whole range
+        // before the next is started.
+        std::vector<double> passes;
+        std::vector<double> values;
+        for (expr::AssignStatement& expr : m_args->m_statements)
+        {
+            Dimension::Id id = expr.identExpr().eval();
+            expr.conditionalExpr().eval(table, begin, end - begin, passes);
+            expr.valueExpr().eval(table, begin, end - begin, values);
+            for (PointId idx = begin; idx < end; ++idx)
+                if (selected[idx] && passes[idx - begin])
+                {
+                    point.setPointId(idx);
+                    point.setField(id, values[idx - begin]);
+                }
+        }
+    });
+}
+
+
 void AssignFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId id = 0; id < view.size(); ++id)
+    // Threads don't pay for themselves on small views.
+    const point_count_t MinPerThread = 1 << 16;
+
+    // Large views are split among threads.  Points are independent of
+    // each other, so this doesn't change the result.
+    ThreadGroup group(view.size() / MinPerThread);
+    group.ranges(view.size(), MinPerThread,
+        [this, &view](size_t, PointId begin, PointId end)
+    {
+        assign(view, begin, end);
+    });
+}
+
+
+// Assign values to the points in [begin, end) of a view a batch of points
+// at a time.
+void AssignFilter::assign(PointView& view, PointId begin, PointId end)
+{
+    // Spans fetched with the same starting point and batch size all have
+    // the same size.
+    const point_count_t batchSize = 4096;
+    const DimRange& condition = m_args->m_condition;
+    std::vector<char> selected;
+    std::vector<double> passes;
+    std::vector<double> values;
+    for (PointId idx = begin; idx < end;)
     {
-        point.setPointId(id);
-        processOne(point);
+        point_count_t count = (std::min)(batchSize, end - idx);
+        selected.assign(count, 1);
+        if (condition.m_id != Dimension::Id::Unknown)
+        {
+            FieldSpan<double> vals =
+                view.getFieldSpan<double>(condition.m_id, idx, count);
+            count = vals.size();
+            for (point_count_t i = 0; i < count; ++i)
+                selected[i] = condition.valuePasses(vals[i]);
+        }
+
+        // Assignments are made in order, so fetch the values again for
+        // each one in case an earlier assignment changed them.
+        for (AssignRange& r : m_args->m_assignments)
+        {
+            FieldSpan<double> vals =
+                view.getFieldSpan<double>(r.m_id, idx, count);
+            count = vals.size();
+            for (point_count_t i = 0; i < count; ++i)
+                if (selected[i] && r.valuePasses(vals[i]))
+                {
+                    if (vals.direct())
+                        vals[i] = r.m_value;
+                    else
+                        view.setField(r.m_id, idx + i, r.m_value);
+                }
+        }
+
+        // Each statement is evaluated for the whole batch before the next
+        // is started.  A point's results depend only on the point itself,
+        // so this is the same as running the statements point by point.
+        for (expr::AssignStatement& expr : m_args->m_statements)
+        {
+            Dimension::Id id = expr.identExpr().eval();
+            expr.conditionalExpr().eval(view, idx, count, passes);
+            expr.valueExpr().eval(view, idx, count, values);
+            for (point_count_t i = 0; i < count; ++i)
+                if (selected[i] && passes[i])
+                    view.setField(id, idx + i, values[i]);
+        }
+        idx += count;
     }
 }
 
@@ -54,7 +54,12 @@ private:
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
     virtual bool processOne(PointRef& point);
+    virtual void processChunk(StreamPointTable& table, point_count_t count);
     virtual void filter(PointView& view);
+    virtual bool viewParallelSafe() const
+        { return true; }
+
+    void assign(PointView& view, PointId begin, PointId end);
 
     AssignFilter& operator=(const AssignFilter&) = delete;
     AssignFilter(const AssignFilter&) = delete;
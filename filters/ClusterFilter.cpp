@@ -34,8 +34,6 @@
 
 #include "ClusterFilter.hpp"
 
-#include <pdal/KDIndex.hpp>
-
 #include "private/Segmentation.hpp"
 
 #include <string>
@@ -74,13 +72,13 @@ void ClusterFilter::addDimensions(PointLayoutPtr layout)
 
 void ClusterFilter::filter(PointView& view)
 {
-    std::deque<PointIdList> clusters;
+    using namespace Dimension;
+
+    Dimension::IdList dims { Id::X, Id::Y };
     if (m_is3d)
-        clusters = Segmentation::extractClusters<KD3Index>(view, m_minPoints,
-            m_maxPoints, m_tolerance);
-    else
-        clusters = Segmentation::extractClusters<KD2Index>(view, m_minPoints,
-            m_maxPoints, m_tolerance);
+        dims.push_back(Id::Z);
+    std::deque<PointIdList> clusters = Segmentation::extractClusters(view,
+        dims, m_minPoints, m_maxPoints, m_tolerance);
 
     uint64_t id = 1;
     for (auto const& c : clusters)
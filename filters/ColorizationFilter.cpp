@@ -37,7 +37,10 @@
 #include <pdal/PointView.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 #include <pdal/private/gdal/Raster.hpp>
+#include <pdal/private/gdal/RasterSampler.hpp>
+#include <pdal/private/ThreadBudget.hpp>
 
+#include <algorithm>
 #include <array>
 
 namespace pdal
@@ -124,7 +127,7 @@ ColorizationFilter::BandInfo parseDim(const std::string& dim,
 
 } // unnamed namespace
 
-ColorizationFilter::ColorizationFilter()
+ColorizationFilter::ColorizationFilter() : m_cacheSize(0)
 {}
 
 
@@ -136,20 +139,32 @@ void ColorizationFilter::addArgs(ProgramArgs& args)
 {
     args.add("raster", "Raster filename", m_rasterFilename);
     args.add("dimensions", "Dimensions to use for colorization", m_dimSpec);
+    args.add("interpolation", "Method for computing a value from the "
+        "raster cells near a point ('nearest' or 'bilinear')",
+        m_interpolation, "nearest");
+    args.add("cache_size", "Size of the raster block cache of each thread, "
+        "in megabytes", m_cacheSize, (size_t)64);
 }
 
 
 void ColorizationFilter::initialize()
 {
-    m_raster.reset(new gdal::Raster(m_rasterFilename));
-    auto bandTypes = m_raster->getPDALDimensionTypes();
-    m_raster->close();
+    m_interpolation = Utils::tolower(m_interpolation);
+    if (m_interpolation != "nearest" && m_interpolation != "bilinear")
+        throwError("Invalid 'interpolation' option '" + m_interpolation +
+            "'.  Must be 'nearest' or 'bilinear'.");
+    if (m_cacheSize == 0)
+        throwError("Option 'cache_size' must be greater than 0.");
+
+    gdal::Raster raster(m_rasterFilename);
+    auto bandTypes = raster.getPDALDimensionTypes();
 
     if (m_dimSpec.empty())
         m_dimSpec = { "Red", "Green", "Blue" };
 
     uint32_t defaultBand = 1;
     m_bands.clear();
+    m_bandNums.clear();
     for (std::string& dim : m_dimSpec)
     {
         try
@@ -160,6 +175,7 @@ void ColorizationFilter::initialize()
             if (bi.m_band <= bandTypes.size())
                 bi.m_type = bandTypes[bi.m_band - 1];
             m_bands.push_back(bi);
+            m_bandNums.push_back((int)bi.m_band);
         }
         catch(const std::string& what)
         {
@@ -176,58 +192,160 @@ void ColorizationFilter::addDimensions(PointLayoutPtr layout)
 }
 
 
-void ColorizationFilter::ready(PointTableRef table)
+gdal::RasterSampler *ColorizationFilter::newSampler()
 {
     using namespace gdal;
 
-    m_raster.reset(new gdal::Raster(m_rasterFilename));
+    RasterSampler::Method method = (m_interpolation == "bilinear") ?
+        RasterSampler::Method::Bilinear : RasterSampler::Method::Nearest;
+    std::unique_ptr<RasterSampler> sampler(new RasterSampler(
+        m_rasterFilename, method, m_cacheSize * 1024 * 1024));
 
-    GDALError error = m_raster->open();
+    GDALError error = sampler->open();
     if (error != GDALError::None)
     {
         if (error == GDALError::NoTransform ||
             error == GDALError::NotInvertible)
         {
-            log()->get(LogLevel::Warning) << getName() << ": " <<
-                m_raster->errorMsg() << std::endl;
+            // Only warn once, for the first sampler.
+            if (!m_sampler)
+                log()->get(LogLevel::Warning) << getName() << ": " <<
+                    sampler->errorMsg() << std::endl;
         }
         else
         {
-            throwError(m_raster->errorMsg());
+            throwError(sampler->errorMsg());
         }
     }
+    return sampler.release();
 }
 
 
-bool ColorizationFilter::processOne(PointRef& point)
+void ColorizationFilter::ready(PointTableRef table)
+{
+    m_sampler.reset(newSampler());
+    m_threadSamplers.clear();
+}
+
+
+// Sample the raster at a set of positions.
+void ColorizationFilter::sample(gdal::RasterSampler& sampler,
+    point_count_t count, const double *x, const double *y,
+    std::vector<double>& values, std::vector<char>& found)
 {
-    static std::vector<double> data;
+    values.resize(count * m_bands.size());
+    found.resize(count);
+    if (sampler.sample(count, x, y, m_bandNums, values.data(),
+        found.data()) != gdal::GDALError::None)
+        throwError(sampler.errorMsg());
+}
+
 
+bool ColorizationFilter::processOne(PointRef& point)
+{
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
 
-    if (m_raster->read(x, y, data) == gdal::GDALError::None)
+    sample(*m_sampler, 1, &x, &y, m_values, m_found);
+    if (!m_found[0])
+        return false;
+    for (size_t b = 0; b < m_bands.size(); ++b)
+        point.setField(m_bands[b].m_dim, m_values[b] * m_bands[b].m_scale);
+    return true;
+}
+
+
+void ColorizationFilter::processChunk(StreamPointTable& table,
+    point_count_t count)
+{
+    using namespace Dimension;
+
+    // Gather the points to colorize.
+    m_ids.clear();
+    m_x.clear();
+    m_y.clear();
+    PointRef point(table, 0);
+    for (PointId idx = 0; idx < count; idx++)
     {
-        int i(0);
-        for (auto bi = m_bands.begin(); bi != m_bands.end(); ++bi)
+        point.setPointId(idx);
+        if (table.skip(idx) || !eval(point))
+            continue;
+        m_ids.push_back(idx);
+        m_x.push_back(point.getFieldAs<double>(Id::X));
+        m_y.push_back(point.getFieldAs<double>(Id::Y));
+    }
+
+    sample(*m_sampler, m_ids.size(), m_x.data(), m_y.data(),
+        m_values, m_found);
+
+    // As with processOne(), points outside of the raster are dropped.
+    const size_t numBands = m_bands.size();
+    for (size_t i = 0; i < m_ids.size(); ++i)
+    {
+        if (!m_found[i])
         {
-            BandInfo& b = *bi;
-            point.setField(b.m_dim, data[i] * b.m_scale);
-            ++i;
+            table.setSkip(m_ids[i]);
+            continue;
         }
-        return true;
+        point.setPointId(m_ids[i]);
+        for (size_t b = 0; b < numBands; ++b)
+            point.setField(m_bands[b].m_dim,
+                m_values[i * numBands + b] * m_bands[b].m_scale);
     }
-    return false;
 }
 
 
 void ColorizationFilter::filter(PointView& view)
 {
-    PointRef point = view.point(0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    const point_count_t MinPerThread = 65536;
+
+    // Large views are split among threads.  GDAL datasets can't be shared
+    // between threads, so each thread samples with its own.
+    const point_count_t count = view.size();
+    ThreadGroup group((std::max)(count / MinPerThread, (point_count_t)1));
+    const point_count_t threads = group.size();
+    while (m_threadSamplers.size() + 1 < threads)
+        m_threadSamplers.emplace_back(newSampler());
+
+    const point_count_t chunk = (count + threads - 1) / threads;
+    group.run(threads, [&](size_t t)
     {
-        point.setPointId(idx);
-        processOne(point);
+        gdal::RasterSampler& sampler =
+            t ? *m_threadSamplers[t - 1] : *m_sampler;
+        PointId begin = (std::min)(count, t * chunk);
+        colorize(view, begin, (std::min)(count, begin + chunk), sampler);
+    });
+}
+
+
+// Colorize the points in [begin, end) of a view a batch at a time.  Points
+// outside of the raster are left alone.
+void ColorizationFilter::colorize(PointView& view, PointId begin,
+    PointId end, gdal::RasterSampler& sampler)
+{
+    using namespace Dimension;
+
+    const point_count_t batchSize = 65536;
+    const size_t numBands = m_bands.size();
+    std::vector<double> values;
+    std::vector<char> found;
+    for (PointId idx = begin; idx < end;)
+    {
+        const point_count_t n = (std::min)(batchSize, end - idx);
+        FieldSpan<double> xs = view.getFieldSpan<double>(Id::X, idx, n);
+        FieldSpan<double> ys = view.getFieldSpan<double>(Id::Y, idx, n);
+        const point_count_t count = xs.size();
+
+        sample(sampler, count, xs.data(), ys.data(), values, found);
+        for (size_t b = 0; b < numBands; ++b)
+        {
+            const BandInfo& band = m_bands[b];
+            for (point_count_t i = 0; i < count; ++i)
+                if (found[i])
+                    view.setField(band.m_dim, idx + i,
+                        values[i * numBands + b] * band.m_scale);
+        }
+        idx += count;
     }
 }
 
@@ -38,11 +38,13 @@
 #include <pdal/Streamable.hpp>
 
 #include <map>
+#include <memory>
+#include <vector>
 
 namespace pdal
 {
 
-namespace gdal { class Raster; }
+namespace gdal { class RasterSampler; }
 
 // Provides GDAL-based raster overlay that places output data in
 // specified dimensions. It also supports scaling the data by a multiplier
@@ -81,13 +83,33 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
     virtual bool processOne(PointRef& point);
+    virtual void processChunk(StreamPointTable& table, point_count_t count);
     virtual void filter(PointView& view);
 
+    gdal::RasterSampler *newSampler();
+    void colorize(PointView& view, PointId begin, PointId end,
+        gdal::RasterSampler& sampler);
+    void sample(gdal::RasterSampler& sampler, point_count_t count,
+        const double *x, const double *y, std::vector<double>& values,
+        std::vector<char>& found);
+
     StringList m_dimSpec;
     std::string m_rasterFilename;
+    std::string m_interpolation;
+    size_t m_cacheSize;
     std::vector<BandInfo> m_bands;
+    std::vector<int> m_bandNums;
 
-    std::unique_ptr<gdal::Raster> m_raster;
+    std::unique_ptr<gdal::RasterSampler> m_sampler;
+    // Samplers for threads other than the first.  Each has its own
+    // dataset handle.
+    std::vector<std::unique_ptr<gdal::RasterSampler>> m_threadSamplers;
+    // Stream chunk buffers.
+    std::vector<PointId> m_ids;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_values;
+    std::vector<char> m_found;
 };
 
 } // namespace pdal
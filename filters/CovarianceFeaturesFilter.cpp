@@ -175,45 +175,70 @@ void CovarianceFeaturesFilter::filter(PointView& view)
 {
     KD3Index& kdi = view.build3dIndex();
 
-    point_count_t nloops = view.size();
-    std::vector<std::thread> threadList(m_threads);
-    for(int t = 0;t<m_threads;t++)
+    // Neighbors are found a batch of points at a time.  Optimal
+    // neighborhoods have a different size for each point, so they're
+    // found as each point is processed.
+    const point_count_t batchSize = 65536;
+    for (PointId begin = 0; begin < view.size(); begin += batchSize)
     {
-        threadList[t] = std::thread(std::bind(
-                [&](const PointId start, const PointId end)
-                {
-                    for(PointId i = start;i<end;i++)
-                        setDimensionality(view, i, kdi);
-                },
-                t*nloops/m_threads,(t+1)==m_threads?nloops:(t+1)*nloops/m_threads));
+        const point_count_t nloops = (std::min)(batchSize, view.size() - begin);
+        KDNeighbors neighbors;
+        if (!m_optimal)
+        {
+            neighbors = m_radiusArg->set() ?
+                kdi.radiusAll(m_radius, begin, batchSize, m_threads) :
+                kdi.knnSearchAll((m_knn + 1) * m_stride, begin, batchSize,
+                    m_threads);
+        }
+
+        std::vector<std::thread> threadList(m_threads);
+        for(int t = 0;t<m_threads;t++)
+        {
+            threadList[t] = std::thread(std::bind(
+                    [&](const PointId start, const PointId end)
+                    {
+                        for(PointId i = start;i<end;i++)
+                        {
+                            PointRef p = view.point(begin + i);
+                            PointIdList ids =
+                                this->neighbors(p, neighbors, i, kdi);
+                            if (m_radiusArg->set() &&
+                                    ids.size() < (size_t)m_minK)
+                                continue;
+                            setDimensionality(view, begin + i, ids);
+                        }
+                    },
+                    t*nloops/m_threads,(t+1)==m_threads?nloops:(t+1)*nloops/m_threads));
+        }
+        for (auto &t: threadList)
+            t.join();
     }
-    for (auto &t: threadList)
-        t.join();
 }
 
-void CovarianceFeaturesFilter::setDimensionality(PointView &view, const PointId &id, const KD3Index &kdi)
+// Find the neighbors of a point, either by radius or k nearest neighbors.
+PointIdList CovarianceFeaturesFilter::neighbors(PointRef& p,
+    const KDNeighbors& neighbors, PointId batchIdx, const KD3Index& kdi) const
+{
+    if (m_optimal)
+        return kdi.neighbors(p, p.getFieldAs<uint64_t>(Id::OptimalKNN), 1);
+    if (m_radiusArg->set() || m_stride == 1)
+        return neighbors.neighbors(batchIdx);
+
+    // Select every nth neighbor at the given stride.
+    PointIdList ids;
+    const PointId *all = neighbors.ids(batchIdx);
+    for (point_count_t j = 0; j < neighbors.count(batchIdx); j += m_stride)
+        ids.push_back(all[j]);
+    return ids;
+}
+
+void CovarianceFeaturesFilter::setDimensionality(PointView &view,
+    const PointId &id, const PointIdList& ids)
 {
     using namespace Eigen;
     
     PointRef p = view.point(id);
 
-    // find neighbors, either by radius or k nearest neighbors
-    PointIdList ids;
-    if (m_optimal)
-    {
-        ids = kdi.neighbors(p, p.getFieldAs<uint64_t>(Id::OptimalKNN), 1);
-    }
-    else if (m_radiusArg->set())
-    {
-        ids = kdi.radius(p, m_radius);
-        if (ids.size() < (size_t)m_minK)
-            return;
-    }
-    else
-    {
-        ids = kdi.neighbors(p, m_knn + 1, m_stride);
-    }
-
     // compute covariance of the neighborhood
     auto B = math::computeCovariance(view, ids);
 
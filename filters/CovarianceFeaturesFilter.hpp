@@ -40,6 +40,8 @@
 
 namespace pdal {
 
+class KDNeighbors;
+
 class PDAL_DLL CovarianceFeaturesFilter: public Filter
 {
 public:
@@ -73,7 +75,10 @@ private:
     virtual void filter(PointView &view);
     virtual void prepared(PointTableRef table);
 
-    void setDimensionality(PointView &view, const PointId &id, const KD3Index &kid);
+    PointIdList neighbors(PointRef& p, const KDNeighbors& neighbors,
+        PointId batchIdx, const KD3Index& kdi) const;
+    void setDimensionality(PointView &view, const PointId &id,
+        const PointIdList& ids);
 
     friend std::istream& operator>>(std::istream& in,
         CovarianceFeaturesFilter::Mode& mode);
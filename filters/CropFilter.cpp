@@ -39,6 +39,7 @@
 #include <pdal/Polygon.hpp>
 #include <pdal/util/Bounds.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/private/BoxTree.hpp>
 #include <pdal/private/gdal/GDALUtils.hpp>
 
 #include "private/Point.hpp"
@@ -69,6 +70,80 @@ struct CropArgs
     std::vector<Polygon> m_polys;
 };
 
+namespace
+{
+
+// Conservative test of whether a point lies within any of the crop
+// regions, pushed to the reader so that it can skip points outside of
+// them.  Distance crops are treated as the box around the center.
+class CropPredicate : public ReadPredicate
+{
+public:
+    void addBox(const Bounds& box)
+    {
+        if (box.is3d())
+            m_boxes3d.push_back(box.to3d());
+        else
+            m_boxes2d.push_back(box.to2d());
+    }
+
+    void addPolygon(const Polygon& poly)
+    {
+        for (const Polygon& p : poly.polygons())
+        {
+            m_polyBounds.push_back(p.bounds().to2d());
+            m_gridPnps.emplace_back(new GridPnp(p.exteriorRing(),
+                p.interiorRings()));
+        }
+        m_polyIndex.build(m_polyBounds);
+    }
+
+    void addCenter(const filter::Point& center, double distance)
+    {
+        if (center.is3d())
+            m_boxes3d.emplace_back(center.x() - distance,
+                center.y() - distance, center.z() - distance,
+                center.x() + distance, center.y() + distance,
+                center.z() + distance);
+        else
+            m_boxes2d.emplace_back(center.x() - distance,
+                center.y() - distance, center.x() + distance,
+                center.y() + distance);
+    }
+
+    bool boxPasses(const BOX3D& box) const override
+    {
+        for (const BOX2D& b : m_boxes2d)
+            if (b.overlaps(box.to2d()))
+                return true;
+        for (const BOX3D& b : m_boxes3d)
+            if (b.overlaps(box))
+                return true;
+        return m_polyIndex.overlaps(box.to2d());
+    }
+
+    bool positionPasses(double x, double y, double z) const override
+    {
+        for (const BOX2D& b : m_boxes2d)
+            if (b.contains(x, y))
+                return true;
+        for (const BOX3D& b : m_boxes3d)
+            if (b.contains(x, y, z))
+                return true;
+        return m_polyIndex.find(x, y, [this, x, y](size_t id)
+            { return m_gridPnps[id]->inside(x, y); });
+    }
+
+private:
+    std::vector<BOX2D> m_boxes2d;
+    std::vector<BOX3D> m_boxes3d;
+    std::vector<BOX2D> m_polyBounds;
+    std::vector<std::unique_ptr<GridPnp>> m_gridPnps;
+    BoxTree m_polyIndex;
+};
+
+} // unnamed namespace
+
 CropFilter::ViewGeom::ViewGeom(const Polygon& poly) : m_poly(poly)
 {}
 
@@ -78,7 +153,7 @@ CropFilter::ViewGeom::ViewGeom(ViewGeom&& vg) :
 
 std::string CropFilter::getName() const { return s_info.name; }
 
-CropFilter::CropFilter() : m_args(new CropArgs)
+CropFilter::CropFilter() : m_args(new CropArgs), m_polyIndex(new BoxTree)
 {}
 
 
@@ -127,6 +202,33 @@ void CropFilter::initialize()
 }
 
 
+// The crop regions can only be pushed to the inputs when they don't need
+// to be reprojected to the coordinate system of the points.
+ReadPredicatePtr CropFilter::predicate() const
+{
+    if (m_args->m_cropOutside)
+        return ReadPredicatePtr();
+
+    for (const Stage *s : getInputs())
+    {
+        const SpatialReference& srs = m_args->m_assignedSrs.empty() ?
+            getInputs().front()->getSpatialReference() :
+            m_args->m_assignedSrs;
+        if (s->getSpatialReference() != srs)
+            return ReadPredicatePtr();
+    }
+
+    std::shared_ptr<CropPredicate> pred(new CropPredicate);
+    for (const Bounds& box : m_boxes)
+        pred->addBox(box);
+    for (const ViewGeom& geom : m_geoms)
+        pred->addPolygon(geom.m_poly);
+    for (const filter::Point& center : m_args->m_centers)
+        pred->addCenter(center, m_args->m_distance);
+    return pred;
+}
+
+
 void CropFilter::ready(PointTableRef table)
 {
     // If the user didn't provide an SRS, take one from the table.
@@ -145,10 +247,13 @@ void CropFilter::ready(PointTableRef table)
 
 bool CropFilter::processOne(PointRef& point)
 {
-    for (auto& g : m_geoms)
-        for (auto& gridPnp : g.m_gridPnps)
-            if (crop(point, *gridPnp))
-                return true;
+    if (m_gridPnps.size())
+    {
+        double x = point.getFieldAs<double>(Dimension::Id::X);
+        double y = point.getFieldAs<double>(Dimension::Id::Y);
+        if (crop(x, y))
+            return true;
+    }
 
     for (auto& box : m_boxes)
         if (box.is3d())
@@ -179,6 +284,8 @@ void CropFilter::spatialReferenceChanged(const SpatialReference& srs)
 
 void CropFilter::transform(const SpatialReference& srs)
 {
+    std::vector<BOX2D> polyBounds;
+    m_gridPnps.clear();
     for (auto& geom : m_geoms)
     {
         auto ok = geom.m_poly.transform(srs);
@@ -190,9 +297,12 @@ void CropFilter::transform(const SpatialReference& srs)
         {
             std::unique_ptr<GridPnp> gridPnp(new GridPnp(
                 p.exteriorRing(), p.interiorRings()));
+            m_gridPnps.push_back(gridPnp.get());
+            polyBounds.push_back(p.bounds().to2d());
             geom.m_gridPnps.push_back(std::move(gridPnp));
         }
     }
+    m_polyIndex->build(polyBounds);
 
     // If we don't have any SRS, do nothing.
     if (srs.empty() && m_args->m_assignedSrs.empty())
@@ -229,11 +339,21 @@ PointViewSet CropFilter::run(PointViewPtr view)
     PointViewSet viewSet;
 
     transform(view->spatialReference());
-    for (auto& geom : m_geoms)
+    if (m_geoms.size())
     {
-        PointViewPtr outView = view->makeNew();
-        crop(geom, *view, *outView);
-        viewSet.insert(outView);
+        // Each geometry's output has the points kept by each of its
+        // polygons in turn.
+        std::vector<PointIdList> kept(m_gridPnps.size());
+        crop(*view, kept);
+        auto ki = kept.begin();
+        for (auto& geom : m_geoms)
+        {
+            PointViewPtr outView = view->makeNew();
+            for (size_t i = 0; i < geom.m_gridPnps.size(); ++i, ++ki)
+                for (PointId idx : *ki)
+                    outView->appendPoint(*view, idx);
+            viewSet.insert(outView);
+        }
     }
 
     for (auto& box : m_boxes)
@@ -305,25 +425,79 @@ void CropFilter::crop(const BOX2D& box, PointView& input, PointView& output)
 }
 
 
-bool CropFilter::crop(const PointRef& point, GridPnp& g)
+// Determine if any polygon keeps a point.  Only the polygons whose bounds
+// contain the point can contain it.
+bool CropFilter::crop(double x, double y)
 {
-    double x = point.getFieldAs<double>(Dimension::Id::X);
-    double y = point.getFieldAs<double>(Dimension::Id::Y);
-    return (m_args->m_cropOutside != g.inside(x, y));
+    m_polyIndex->candidates(x, y, m_candidates);
+    if (m_args->m_cropOutside)
+    {
+        if (m_candidates.size() < m_gridPnps.size())
+            return true;
+        for (size_t id : m_candidates)
+            if (!m_gridPnps[id]->inside(x, y))
+                return true;
+        return false;
+    }
+
+    for (size_t id : m_candidates)
+        if (m_gridPnps[id]->inside(x, y))
+            return true;
+    return false;
 }
 
 
-void CropFilter::crop(const ViewGeom& g, PointView& input, PointView& output)
+// Find the points of a view kept by each polygon.  Points are handled a
+// block at a time.  Polygons whose bounds don't overlap a block, or that
+// cover a block entirely, are resolved without testing each point.
+void CropFilter::crop(PointView& input, std::vector<PointIdList>& kept)
 {
-    PointRef point = input.point(0);
-    for (auto& gridPnp : g.m_gridPnps)
+    const point_count_t blockSize = 4096;
+    const bool outside = m_args->m_cropOutside;
+    std::vector<size_t> candidates;
+    for (PointId idx = 0; idx < input.size();)
     {
-        for (PointId idx = 0; idx < input.size(); ++idx)
+        FieldSpan<double> xs =
+            input.getFieldSpan<double>(Dimension::Id::X, idx, blockSize);
+        FieldSpan<double> ys =
+            input.getFieldSpan<double>(Dimension::Id::Y, idx, xs.size());
+        const point_count_t count = (std::min)(xs.size(), ys.size());
+
+        BOX2D bounds;
+        for (point_count_t i = 0; i < count; ++i)
+            bounds.grow(xs[i], ys[i]);
+        m_polyIndex->candidates(bounds, candidates);
+
+        auto keepAll = [&kept, idx, count](size_t id)
+        {
+            for (point_count_t i = 0; i < count; ++i)
+                kept[id].push_back(idx + i);
+        };
+
+        auto ci = candidates.begin();
+        for (size_t id = 0; id < m_gridPnps.size(); ++id)
         {
-            point.setPointId(idx);
-            if (crop(point, const_cast<GridPnp&>(*gridPnp)))
-                output.appendPoint(input, idx);
+            if (ci == candidates.end() || *ci != id)
+            {
+                if (outside)
+                    keepAll(id);
+                continue;
+            }
+            ci++;
+
+            GridPnp& g = *m_gridPnps[id];
+            GridPnp::Coverage c = g.coverage(bounds.minx, bounds.miny,
+                bounds.maxx, bounds.maxy);
+            if (c == GridPnp::Coverage::Partial)
+            {
+                for (point_count_t i = 0; i < count; ++i)
+                    if (outside != g.inside(xs[i], ys[i]))
+                        kept[id].push_back(idx + i);
+            }
+            else if (outside != (c == GridPnp::Coverage::Inside))
+                keepAll(id);
         }
+        idx += count;
     }
 }
 
@@ -44,6 +44,7 @@
 namespace pdal
 {
 
+class BoxTree;
 class ProgramArgs;
 class GridPnp;
 struct CropArgs;
@@ -77,10 +78,16 @@ private:
     double m_distance2;
     std::vector<ViewGeom> m_geoms;
     std::vector<Bounds> m_boxes;
+    // Point-in-polygon testers of all geometries and an index of their
+    // bounds.
+    std::vector<GridPnp *> m_gridPnps;
+    std::unique_ptr<BoxTree> m_polyIndex;
+    std::vector<size_t> m_candidates;
 
     void addArgs(ProgramArgs& args);
     virtual void initialize();
 
+    virtual ReadPredicatePtr predicate() const;
     virtual void ready(PointTableRef table);
     virtual void spatialReferenceChanged(const SpatialReference& srs);
     virtual bool processOne(PointRef& point);
@@ -90,8 +97,8 @@ private:
     void crop(const BOX3D& box, PointView& input, PointView& output);
     void crop(const BOX2D& box, PointView& input, PointView& output);
     void crop(const Bounds& box, PointView& input, PointView& output);
-    bool crop(const PointRef& point, GridPnp& g);
-    void crop(const ViewGeom& g, PointView& input, PointView& output);
+    bool crop(double x, double y);
+    void crop(PointView& input, std::vector<PointIdList>& kept);
     bool crop(const PointRef& point, const filter::Point& center);
     void crop(const filter::Point& center, PointView& input,
         PointView& output);
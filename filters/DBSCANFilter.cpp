@@ -32,15 +32,12 @@
  * OF SUCH DAMAGE.
  ****************************************************************************/
 
-// Adapted from MIT-licensed implemenation provided by
-// https://github.com/intel-isl/Open3D/pull/1038.
-
 #include "DBSCANFilter.hpp"
 
-#include <pdal/KDIndex.hpp>
+#include <pdal/private/DisjointSets.hpp>
+#include <pdal/private/NeighborGrid.hpp>
 
 #include <string>
-#include <unordered_set>
 
 namespace pdal
 {
@@ -80,6 +77,9 @@ void DBSCANFilter::prepared(PointTableRef table)
 {
     const PointLayoutPtr layout(table.layout());
 
+    if (m_eps <= 0)
+        throwError("Option 'eps' must be greater than 0.");
+
     if (m_dimStringList.size())
     {
         for (std::string& s : m_dimStringList)
@@ -94,81 +94,90 @@ void DBSCANFilter::prepared(PointTableRef table)
     }
 }
 
+// Clusters are found without storing the neighbors of each point:
+//
+// 1. Points with at least min_points neighbors within eps (counting
+//    themselves) are core points.
+// 2. Core points that are neighbors are joined into clusters.
+// 3. Clusters are numbered in the order of their first core point.
+// 4. Each other point joins the lowest numbered cluster that has a core
+//    point among its neighbors, or is noise if there is none.
+//
+// This gives the same labels as expanding one cluster at a time, starting
+// from each unlabeled core point in turn.  Neighbors are found with a grid
+// of cells that are eps on a side, and the first, second and fourth steps
+// are spread across threads.
 void DBSCANFilter::filter(PointView& view)
 {
-    // Construct KDFlexIndex for radius search.
-    KDFlexIndex kdfi(view, m_dimIdList);
-    kdfi.build();
-
-    // First pass through point cloud precomputes neighbor indices and
-    // initializes ClusterID to -2.
-    std::vector<PointIdList> neighbors(view.size());
-    for (PointId idx = 0; idx < view.size(); ++idx)
-    {
-        neighbors[idx] = kdfi.radius(idx, m_eps);
-        view.setField(Id::ClusterID, idx, -2);
-    }
+    NeighborGrid grid(view, m_dimIdList, m_eps);
+    grid.build();
 
-    // Second pass through point cloud performs DBSCAN clustering.
-    int64_t cluster_label = 0;
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    const point_count_t count = view.size();
+    std::vector<char> core(count);
+    grid.forEachCell([&](size_t cell, const std::vector<uint32_t>& adjacent)
     {
-        // Point has already been labeled, so move on to next.
-        if (view.getFieldAs<int64_t>(Id::ClusterID, idx) != -2)
-            continue;
-
-        // Density of the neighborhood does not meet minimum number of points
-        // constraint, label as noise.
-        if (neighbors[idx].size() < m_minPoints)
+        for (size_t s = grid.begin(cell); s < grid.end(cell); ++s)
         {
-            view.setField(Id::ClusterID, idx, -1);
-            continue;
+            uint64_t neighbors = 0;
+            core[grid.id(s)] = m_minPoints == 0 ||
+                grid.findNeighbors(s, adjacent,
+                    [&neighbors, this](size_t)
+                    { return ++neighbors >= m_minPoints; });
         }
+    });
 
-        // Initialize some bookkeeping to track which neighbors have been
-        // considered for addition to the current cluster.
-        std::unordered_set<PointId> neighbors_next(neighbors[idx].begin(),
-                                                   neighbors[idx].end());
-        std::unordered_set<PointId> neighbors_visited;
-        neighbors_visited.insert(idx);
-
-        // Unlabeled point encountered; assign cluster label.
-        view.setField(Id::ClusterID, idx, cluster_label);
-
-        // Consider all neighbors.
-        while (!neighbors_next.empty())
+    DisjointSets clusters(count);
+    grid.forEachCell([&](size_t cell, const std::vector<uint32_t>& adjacent)
+    {
+        for (size_t s = grid.begin(cell); s < grid.end(cell); ++s)
         {
-            // Select first neighbor and move it to the visited set.
-            PointId p = *neighbors_next.begin();
-            neighbors_next.erase(neighbors_next.begin());
-            neighbors_visited.insert(p);
-
-            // Reassign cluster label to neighbor previously marked as noise.
-            if (view.getFieldAs<int64_t>(Id::ClusterID, p) == -1)
-                view.setField(Id::ClusterID, p, cluster_label);
-
-            // Neighbor has already been labeled, so move on to next.
-            if (view.getFieldAs<int64_t>(Id::ClusterID, p) != -2)
+            const PointId id = grid.id(s);
+            if (!core[id])
                 continue;
+            grid.findNeighbors(s, adjacent,
+                [&grid, &core, &clusters, id](size_t n)
+                {
+                    // Each pair of neighbors is found from both ends.
+                    const PointId nid = grid.id(n);
+                    if (nid < id && core[nid])
+                        clusters.unite(id, nid);
+                    return false;
+                });
+        }
+    });
 
-            // Assign cluster label to neighbor.
-            view.setField(Id::ClusterID, p, cluster_label);
+    // The root of each cluster is its first core point.
+    std::vector<int64_t> labels(count, -1);
+    int64_t nextLabel = 0;
+    for (PointId id = 0; id < count; ++id)
+    {
+        if (!core[id])
+            continue;
+        const PointId root = clusters.find(id);
+        labels[id] = (root == id) ? nextLabel++ : labels[root];
+    }
 
-            // If density of neighbor's neighborhood is sufficient, add it's
-            // neighbors to the set of neighbors to consider if they are not
-            // already.
-            if (neighbors[p].size() >= m_minPoints)
-            {
-                for (PointId q : neighbors[p])
+    grid.forEachCell([&](size_t cell, const std::vector<uint32_t>& adjacent)
+    {
+        for (size_t s = grid.begin(cell); s < grid.end(cell); ++s)
+        {
+            const PointId id = grid.id(s);
+            if (core[id])
+                continue;
+            int64_t& label = labels[id];
+            grid.findNeighbors(s, adjacent,
+                [&grid, &core, &labels, &label](size_t n)
                 {
-                    if (neighbors_visited.count(q) == 0)
-                        neighbors_next.insert(q);
-                }
-            }
+                    const PointId nid = grid.id(n);
+                    if (core[nid] && (label < 0 || labels[nid] < label))
+                        label = labels[nid];
+                    return false;
+                });
         }
+    });
 
-        cluster_label++;
-    }
+    for (PointId id = 0; id < count; ++id)
+        view.setField(Id::ClusterID, id, labels[id]);
 }
 
 } // namespace pdal
@@ -34,10 +34,11 @@
 
 #include "DEMFilter.hpp"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
-#include <pdal/private/gdal/Raster.hpp>
+#include <pdal/private/gdal/RasterSampler.hpp>
 #include "private/DimRange.hpp"
 
 namespace pdal
@@ -88,8 +89,13 @@ void DEMFilter::addArgs(ProgramArgs& args)
 
 void DEMFilter::ready(PointTableRef table)
 {
-    m_raster.reset(new gdal::Raster(m_args->m_raster));
-    m_raster->open();
+    using namespace gdal;
+
+    m_sampler.reset(new RasterSampler(m_args->m_raster));
+    GDALError error = m_sampler->open();
+    if (error != GDALError::None && error != GDALError::NoTransform &&
+        error != GDALError::NotInvertible)
+        throwError(m_sampler->errorMsg());
 }
 
 
@@ -108,40 +114,94 @@ void DEMFilter::prepared(PointTableRef table)
 
 bool DEMFilter::processOne(PointRef& point)
 {
-    static std::vector<double> data;
-
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
     double z = point.getFieldAs<double>(m_args->m_dim);
+    double v;
+    char found;
 
-    bool passes(false);
+    if (m_sampler->sample(1, &x, &y, { m_args->m_band }, &v, &found) !=
+            gdal::GDALError::None)
+        throwError(m_sampler->errorMsg());
+    return found && passes(z, v);
+}
 
-    if (m_raster->read(x, y, data) == gdal::GDALError::None)
+void DEMFilter::processChunk(StreamPointTable& table, point_count_t count)
+{
+    using namespace Dimension;
+
+    // Gather the points to test.
+    m_ids.clear();
+    m_x.clear();
+    m_y.clear();
+    PointRef point(table, 0);
+    for (PointId idx = 0; idx < count; idx++)
     {
-        double v = data[m_args->m_band-1];
-        double lb = v - m_args->m_range.m_lower_bound;
-        double ub = v + m_args->m_range.m_upper_bound;
+        point.setPointId(idx);
+        if (table.skip(idx) || !eval(point))
+            continue;
+        m_ids.push_back(idx);
+        m_x.push_back(point.getFieldAs<double>(Id::X));
+        m_y.push_back(point.getFieldAs<double>(Id::Y));
+    }
 
+    m_values.resize(m_ids.size());
+    m_found.resize(m_ids.size());
+    if (m_sampler->sample(m_ids.size(), m_x.data(), m_y.data(),
+        { m_args->m_band }, m_values.data(), m_found.data()) !=
+            gdal::GDALError::None)
+        throwError(m_sampler->errorMsg());
 
-        if ( z >= lb && z <= ub)
-            passes = true;
+    // As with processOne(), points outside of the raster are dropped.
+    for (size_t i = 0; i < m_ids.size(); ++i)
+    {
+        point.setPointId(m_ids[i]);
+        if (!m_found[i] ||
+                !passes(point.getFieldAs<double>(m_args->m_dim), m_values[i]))
+            table.setSkip(m_ids[i]);
     }
-    return passes;
+}
+
+bool DEMFilter::passes(double z, double v) const
+{
+    double lb = v - m_args->m_range.m_lower_bound;
+    double ub = v + m_args->m_range.m_upper_bound;
+    return (z >= lb && z <= ub);
 }
 
 PointViewSet DEMFilter::run(PointViewPtr inView)
 {
+    using namespace Dimension;
+
     PointViewSet viewSet;
     if (!inView->size())
         return viewSet;
 
     PointViewPtr outView = inView->makeNew();
 
-    for (PointId i = 0; i < inView->size(); ++i)
+    // Sample the raster a batch of points at a time.
+    const point_count_t batchSize = 65536;
+    const std::vector<int> bands { m_args->m_band };
+    std::vector<double> values;
+    std::vector<char> found;
+    for (PointId idx = 0; idx < inView->size();)
     {
-        PointRef point = inView->point(i);
-        if (processOne(point))
-            outView->appendPoint(*inView, i);
+        const point_count_t n = (std::min)(batchSize, inView->size() - idx);
+        FieldSpan<double> xs = inView->getFieldSpan<double>(Id::X, idx, n);
+        FieldSpan<double> ys = inView->getFieldSpan<double>(Id::Y, idx, n);
+        const point_count_t count = xs.size();
+
+        values.resize(count);
+        found.resize(count);
+        if (m_sampler->sample(count, xs.data(), ys.data(), bands,
+            values.data(), found.data()) != gdal::GDALError::None)
+            throwError(m_sampler->errorMsg());
+
+        for (point_count_t i = 0; i < count; ++i)
+            if (found[i] && passes(inView->getFieldAs<double>(m_args->m_dim,
+                    idx + i), values[i]))
+                outView->appendPoint(*inView, idx + i);
+        idx += count;
     }
 
     viewSet.insert(outView);
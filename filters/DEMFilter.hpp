@@ -40,13 +40,14 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace pdal
 {
 
 struct DEMArgs;
 
-namespace gdal { class Raster; }
+namespace gdal { class RasterSampler; }
 class Options;
 class PointLayout;
 class PointView;
@@ -62,7 +63,13 @@ public:
 private:
 
     std::unique_ptr<DEMArgs> m_args;
-    std::unique_ptr<gdal::Raster> m_raster;
+    std::unique_ptr<gdal::RasterSampler> m_sampler;
+    // Stream chunk buffers.
+    std::vector<PointId> m_ids;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_values;
+    std::vector<char> m_found;
 
     virtual void ready(PointTableRef table);
     virtual void addArgs(ProgramArgs& args);
@@ -70,6 +77,9 @@ private:
     virtual void prepared(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
     virtual bool processOne(PointRef& point);
+    virtual void processChunk(StreamPointTable& table, point_count_t count);
+
+    bool passes(double z, double v) const;
 
     DEMFilter& operator=(const DEMFilter&); // not implemented
     DEMFilter(const DEMFilter&); // not implemented
@@ -71,6 +71,8 @@ private:
     virtual void prepared(PointTableRef table);
     virtual bool processOne(PointRef& point);
     virtual void filter(PointView& view);
+    virtual bool viewParallelSafe() const
+        { return true; }
 
     FerryFilter& operator=(const FerryFilter&) = delete;
     FerryFilter(const FerryFilter&) = delete;
@@ -34,7 +34,9 @@
 
 #include "HagDemFilter.hpp"
 
-#include <pdal/private/gdal/Raster.hpp>
+#include <pdal/private/gdal/RasterSampler.hpp>
+
+#include <algorithm>
 
 namespace pdal
 {
@@ -77,8 +79,13 @@ void HagDemFilter::addDimensions(PointLayoutPtr layout)
 
 void HagDemFilter::ready(PointTableRef table)
 {
-    m_raster.reset(new gdal::Raster(m_rasterName));
-    m_raster->open();
+    using namespace gdal;
+
+    m_sampler.reset(new RasterSampler(m_rasterName));
+    GDALError error = m_sampler->open();
+    if (error != GDALError::None && error != GDALError::NoTransform &&
+        error != GDALError::NotInvertible)
+        throwError(m_sampler->errorMsg());
 }
 
 void HagDemFilter::prepared(PointTableRef table)
@@ -89,18 +96,46 @@ void HagDemFilter::prepared(PointTableRef table)
 
 void HagDemFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId i = 0; i < view.size(); ++i)
+    using namespace pdal::Dimension;
+
+    // Sample the raster a batch of points at a time.
+    const point_count_t batchSize = 65536;
+    const std::vector<int> bands { m_band };
+    std::vector<double> values;
+    std::vector<char> found;
+    for (PointId idx = 0; idx < view.size();)
     {
-        point.setPointId(i);
-        processOne(point);
+        const point_count_t n = (std::min)(batchSize, view.size() - idx);
+        FieldSpan<double> xs = view.getFieldSpan<double>(Id::X, idx, n);
+        FieldSpan<double> ys = view.getFieldSpan<double>(Id::Y, idx, n);
+        const point_count_t count = xs.size();
+
+        values.resize(count);
+        found.resize(count);
+        if (m_sampler->sample(count, xs.data(), ys.data(), bands,
+            values.data(), found.data()) != gdal::GDALError::None)
+            throwError(m_sampler->errorMsg());
+
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            const PointId id = idx + i;
+            // If "zero_ground" option is set, all ground points get HAG
+            // of 0.  Otherwise, if the raster has a cell at X, Y of the
+            // point, use it.
+            if (m_zeroGround && view.getFieldAs<uint8_t>(Id::Classification,
+                    id) == ClassLabel::Ground)
+                view.setField(Id::HeightAboveGround, id, 0);
+            else if (found[i])
+                view.setField(Id::HeightAboveGround, id,
+                    view.getFieldAs<double>(Id::Z, id) - values[i]);
+        }
+        idx += count;
     }
 }
 
 bool HagDemFilter::processOne(PointRef& point)
 {
     using namespace pdal::Dimension;
-    std::vector<double> data;
 
     // If "zero_ground" option is set, all ground points get HAG of 0
     if (m_zeroGround &&
@@ -112,17 +147,66 @@ bool HagDemFilter::processOne(PointRef& point)
     {
         double x = point.getFieldAs<double>(Id::X);
         double y = point.getFieldAs<double>(Id::Y);
+        double value;
+        char found;
 
         // If raster has a point at X, Y of pointcloud point, use it.
         // Otherwise the HAG value is not set.
-        if (m_raster->read(x, y, data) == gdal::GDALError::None)
+        if (m_sampler->sample(1, &x, &y, { m_band }, &value, &found) !=
+                gdal::GDALError::None)
+            throwError(m_sampler->errorMsg());
+        if (found)
         {
             double z = point.getFieldAs<double>(Id::Z);
-            double hag = z - data[m_band - 1];
+            double hag = z - value;
             point.setField(Dimension::Id::HeightAboveGround, hag);
         }
     }
     return true;
 }
 
+void HagDemFilter::processChunk(StreamPointTable& table, point_count_t count)
+{
+    using namespace pdal::Dimension;
+
+    // Ground points get a HAG of 0 right away.  The rest are gathered
+    // to be sampled together.
+    m_ids.clear();
+    m_x.clear();
+    m_y.clear();
+    PointRef point(table, 0);
+    for (PointId idx = 0; idx < count; idx++)
+    {
+        point.setPointId(idx);
+        if (table.skip(idx) || !eval(point))
+            continue;
+        if (m_zeroGround && point.getFieldAs<uint8_t>(Id::Classification) ==
+                ClassLabel::Ground)
+        {
+            point.setField(Id::HeightAboveGround, 0);
+            continue;
+        }
+        m_ids.push_back(idx);
+        m_x.push_back(point.getFieldAs<double>(Id::X));
+        m_y.push_back(point.getFieldAs<double>(Id::Y));
+    }
+
+    m_values.resize(m_ids.size());
+    m_found.resize(m_ids.size());
+    if (m_sampler->sample(m_ids.size(), m_x.data(), m_y.data(), { m_band },
+        m_values.data(), m_found.data()) != gdal::GDALError::None)
+        throwError(m_sampler->errorMsg());
+
+    // As with processOne(), the HAG of points outside of the raster
+    // isn't set.
+    for (size_t i = 0; i < m_ids.size(); ++i)
+    {
+        if (!m_found[i])
+            continue;
+        point.setPointId(m_ids[i]);
+        point.setField(Id::HeightAboveGround,
+            point.getFieldAs<double>(Id::Z) - m_values[i]);
+    }
+}
+
 } // namespace pdal
@@ -40,11 +40,12 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace pdal
 {
 
-namespace gdal { class Raster; }
+namespace gdal { class RasterSampler; }
 class Options;
 class PointLayout;
 class PointView;
@@ -65,11 +66,18 @@ private:
     virtual void ready(PointTableRef table);
     virtual void filter(PointView& view);
     virtual bool processOne(PointRef& point);
+    virtual void processChunk(StreamPointTable& table, point_count_t count);
 
-    std::unique_ptr<gdal::Raster> m_raster;
+    std::unique_ptr<gdal::RasterSampler> m_sampler;
     std::string m_rasterName;
     bool m_zeroGround;
     int32_t m_band;
+    // Stream chunk buffers.
+    std::vector<PointId> m_ids;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_values;
+    std::vector<char> m_found;
 };
 
 } // namespace pdal
@@ -155,9 +155,18 @@ void HagNnFilter::filter(PointView& view)
     double maxDistance2 = std::pow(m_maxDistance, 2.0);
     // Find Z difference between non-ground points and the nearest
     // neighbor (2D) in the ground view or between non-ground points and the
-    // locally-computed surface.
+    // locally-computed surface.  Neighbors are found a batch of points
+    // at a time.
+    const point_count_t batchSize = 65536;
+    KDNeighbors neighbors;
     for (PointId i = 0; i < ngView->size(); ++i)
     {
+        const PointId batchIdx = i % batchSize;
+        if (batchIdx == 0)
+            neighbors = kdi.knnSearchAll(*ngView, m_count, i, batchSize);
+        if (neighbors.count(batchIdx) == 0)
+            continue;
+
         PointRef point = ngView->point(i);
 
         // Non-ground view point for which we're trying to calc HAG
@@ -165,9 +174,9 @@ void HagNnFilter::filter(PointView& view)
         double y0 = point.getFieldAs<double>(Id::Y);
         double z0 = point.getFieldAs<double>(Id::Z);
 
-        PointIdList ids(m_count);
-        std::vector<double> sqr_dists(m_count);
-        kdi.knnSearch(x0, y0, m_count, &ids, &sqr_dists);
+        PointIdList ids(neighbors.neighbors(batchIdx));
+        std::vector<double> sqr_dists(neighbors.sqrDists(batchIdx),
+            neighbors.sqrDists(batchIdx) + ids.size());
 
         // Closest ground point.
         double x = gView->getFieldAs<double>(Id::X, ids[0]);
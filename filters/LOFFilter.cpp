@@ -83,21 +83,12 @@ void LOFFilter::filter(PointView& view)
     // The k-distance is the Euclidean distance to k-th nearest neighbor.
     log()->get(LogLevel::Debug) << "Computing k-distances...\n";
 
-    typedef std::pair<PointId, size_t> PointIdKPair;
-    typedef std::pair<PointId, double> PointIdDistPair;
-    typedef std::map<PointIdKPair, PointIdDistPair> AdjacencyMap;
-    AdjacencyMap mat;
-
+    KDNeighbors neighbors = index.knnSearchAll(m_minpts);
     for (PointId i = 0; i < view.size(); ++i)
     {
-        PointIdList indices(m_minpts);
-        std::vector<double> sqr_dists(m_minpts);
-        index.knnSearch(i, m_minpts, &indices, &sqr_dists);
-
-        for (size_t j = 0; j < m_minpts; ++j)
-            mat[std::make_pair(i, j)] = std::make_pair(indices[j], std::sqrt(sqr_dists[j]));
-
-        view.setField(m_kdist, i, std::sqrt(sqr_dists[m_minpts - 1]));
+        const double *sqr_dists = neighbors.sqrDists(i);
+        view.setField(m_kdist, i,
+            std::sqrt(sqr_dists[neighbors.count(i) - 1]));
     }
 
     // Second pass: Compute the local reachability distance for each point.
@@ -108,13 +99,14 @@ void LOFFilter::filter(PointView& view)
     log()->get(LogLevel::Debug) << "Computing lrd...\n";
     for (PointId i = 0; i < view.size(); ++i)
     {
+        const PointId *ids = neighbors.ids(i);
+        const double *sqr_dists = neighbors.sqrDists(i);
         double M1 = 0.0;
         point_count_t n = 0;
-        for (size_t j = 0; j < m_minpts; ++j)
+        for (size_t j = 0; j < neighbors.count(i); ++j)
         {
-            auto val = mat[std::make_pair(i, j)];
-            double k = view.getFieldAs<double>(m_kdist, val.first);
-            double reachdist = (std::max)(k, val.second);
+            double k = view.getFieldAs<double>(m_kdist, ids[j]);
+            double reachdist = (std::max)(k, std::sqrt(sqr_dists[j]));
             M1 += (reachdist - M1) / ++n;
         }
         view.setField(m_lrd, i, 1.0 / M1);
@@ -125,14 +117,12 @@ void LOFFilter::filter(PointView& view)
     log()->get(LogLevel::Debug) << "Computing LOF...\n";
     for (PointId i = 0; i < view.size(); ++i)
     {
+        const PointId *ids = neighbors.ids(i);
         double lrdp = view.getFieldAs<double>(m_lrd, i);
         double M1 = 0.0;
         point_count_t n = 0;
-        for (size_t j = 0; j < m_minpts; ++j)
-        {
-            auto val = mat[std::make_pair(i, j)];
-            M1 += (view.getFieldAs<double>(m_lrd, val.first) / lrdp - M1) / ++n;
-        }
+        for (size_t j = 0; j < neighbors.count(i); ++j)
+            M1 += (view.getFieldAs<double>(m_lrd, ids[j]) / lrdp - M1) / ++n;
         view.setField(m_lof, i, M1);
     }
 }
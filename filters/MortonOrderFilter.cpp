@@ -33,10 +33,7 @@
 
 #include "MortonOrderFilter.hpp"
 
-#include <climits>
-#include <iostream>
-#include <limits>
-#include <map>
+#include <pdal/private/PointSort.hpp>
 
 namespace pdal
 {
@@ -56,40 +53,24 @@ std::string MortonOrderFilter::getName() const { return s_info.name; }
 void MortonOrderFilter::addArgs(ProgramArgs& args)
 {
     args.add("reverse", "Reverse Morton", m_reverse, false);
+    args.add("curve", "Space-filling curve to follow: 'morton' or 'hilbert'",
+        m_curveName, "morton");
+    args.add("3d", "Include Z when ordering points", m_3d, false);
 }
 
-//This used to be a lambda, but the VS compiler exploded, I guess.
-typedef std::pair<double, double> Coord;
-namespace
+void MortonOrderFilter::initialize()
 {
-bool less_msb(const int& x, const int& y)
-{
-    return x < y && x < (x ^ y);
-}
-
-class CmpZOrder
-{
-public:
-    bool operator()(const Coord& c1, const Coord& c2) const
-    {
-        int a[2] = {(int)(c1.first * INT_MAX), (int)(c1.second * INT_MAX)};
-        int b[2] = {(int)(c2.first * INT_MAX), (int)(c2.second * INT_MAX)};
-
-        int j = 0;
-        int x = 0;
-
-        for (int k = 0; k < 2; k++)
-        {
-            int y = a[k] ^ b[k];
-            if (less_msb(x, y))
-            {
-                j = k;
-                x = y;
-            }
-        }
-        return (a[j] - b[j]) < 0;
-    };
-};
+    m_curveName = Utils::tolower(m_curveName);
+    if (m_curveName == "hilbert")
+        m_curve = sorting::Curve::Hilbert;
+    else if (m_curveName == "morton")
+        m_curve = sorting::Curve::Morton;
+    else
+        throwError("Invalid curve '" + m_curveName + "'.  Must be 'morton' "
+            "or 'hilbert'.");
+    if (m_reverse && (m_curve != sorting::Curve::Morton || m_3d))
+        throwError("Option 'reverse' is only supported with the 2D "
+            "Morton curve.");
 }
 
 class ReverseZOrder
@@ -146,7 +127,7 @@ PointViewSet MortonOrderFilter::reverseMorton(PointViewPtr inView)
     const double cell_height = yrange / cell;
 
     // compute reverse morton code for each point
-    std::multimap<uint32_t, PointId> codes;
+    std::vector<uint64_t> codes(inView->size());
     for (PointId idx = 0; idx < inView->size(); idx++)
     {
         const double x = inView->getFieldAs<double>(Dimension::Id::X, idx);
@@ -160,22 +141,16 @@ PointViewSet MortonOrderFilter::reverseMorton(PointViewPtr inView)
                 cell_height));
 
         const uint32_t code = ReverseZOrder::encode_morton(xpos, ypos);
-        const uint32_t reverse = ReverseZOrder::reverse_morton( code );
-
-        codes.insert( std::pair<uint32_t, PointId>(reverse, idx) );
+        codes[idx] = ReverseZOrder::reverse_morton( code );
     }
 
-    // a map is yet order by key so its naturally ordered by lod
-    std::multimap<uint32_t, PointId>::iterator it;
-    PointViewPtr outView = inView->makeNew();
-    for (it = codes.begin(); it != codes.end(); ++it)
-    {
-        outView->appendPoint(*inView, it->second);
-    }
+    // points with equal codes keep their order, so the result is
+    // naturally ordered by lod
+    inView->reorder(sorting::keyOrder(codes));
 
     // build output view
     PointViewSet viewSet;
-    viewSet.insert(outView);
+    viewSet.insert(inView);
 
     return viewSet;
 }
@@ -185,31 +160,9 @@ PointViewSet MortonOrderFilter::morton(PointViewPtr inView)
     PointViewSet viewSet;
     if (!inView->size())
         return viewSet;
-    CmpZOrder compare;
-    std::multimap<Coord, PointId, CmpZOrder> sorted(compare);
-
-    BOX2D buffer_bounds;
-    inView->calculateBounds(buffer_bounds);
-    double xrange = buffer_bounds.maxx - buffer_bounds.minx;
-    double yrange = buffer_bounds.maxy - buffer_bounds.miny;
-
-    for (PointId idx = 0; idx < inView->size(); idx++)
-    {
-        double xpos = (inView->getFieldAs<double>(Dimension::Id::X, idx) -
-            buffer_bounds.minx) / xrange;
-        double ypos = (inView->getFieldAs<double>(Dimension::Id::Y, idx) -
-            buffer_bounds.miny) / yrange;
-        Coord loc(xpos, ypos);
-        sorted.insert(std::make_pair(loc, idx));
-    }
 
-    PointViewPtr outView = inView->makeNew();
-    std::multimap<Coord, PointId, CmpZOrder>::iterator pos;
-    for (pos = sorted.begin(); pos != sorted.end(); ++pos)
-    {
-        outView->appendPoint(*inView, pos->second);
-    }
-    viewSet.insert(outView);
+    inView->reorder(sorting::curveOrder(*inView, m_curve, m_3d));
+    viewSet.insert(inView);
 
     return viewSet;
 }
@@ -39,6 +39,11 @@
 namespace pdal
 {
 
+namespace sorting
+{
+    enum class Curve;
+}
+
 class PDAL_DLL MortonOrderFilter : public pdal::Filter
 {
 public:
@@ -51,12 +56,16 @@ public:
 
 private:
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual PointViewSet run(PointViewPtr view);
 
     PointViewSet reverseMorton(PointViewPtr view);
     PointViewSet morton(PointViewPtr view);
 
     bool m_reverse = false;
+    std::string m_curveName;
+    sorting::Curve m_curve;
+    bool m_3d = false;
 };
 
 } // namespace pdal
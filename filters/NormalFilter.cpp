@@ -127,12 +127,21 @@ void NormalFilter::prepared(PointTableRef table)
 void NormalFilter::compute(PointView& view, KD3Index& kdi)
 {
     log()->get(LogLevel::Debug) << "Computing normal vectors\n";
+
+    // Neighbors are found a batch of points at a time.
+    const point_count_t batchSize = 65536;
+    KDNeighbors neighbors;
     for (auto&& p : view)
     {
+        const PointId batchIdx = p.pointId() % batchSize;
+        if (batchIdx == 0)
+            neighbors = kdi.knnSearchAll(m_args->m_knn, p.pointId(),
+                batchSize);
+
         // Perform eigen decomposition of covariance matrix computed from
         // neighborhood composed of k-nearest neighbors.
-        PointIdList neighbors = kdi.neighbors(p.pointId(), m_args->m_knn);
-        auto B = math::computeCovariance(view, neighbors);
+        auto B = math::computeCovariance(view,
+            neighbors.neighbors(batchIdx));
         SelfAdjointEigenSolver<Matrix3d> solver(B);
         if (solver.info() != Success)
             throwError("Cannot perform eigen decomposition.");
@@ -83,13 +83,18 @@ Indices OutlierFilter::processRadius(PointViewPtr inView)
 
     PointIdList inliers, outliers;
 
-    for (PointId i = 0; i < np; ++i)
+    // Neighbors are found a batch of points at a time.
+    const point_count_t batchSize = 65536;
+    for (PointId begin = 0; begin < np; begin += batchSize)
     {
-        auto ids = index.radius(i, m_radius);
-        if (ids.size() > size_t(m_minK))
-            inliers.push_back(i);
-        else
-            outliers.push_back(i);
+        KDNeighbors neighbors = index.radiusAll(m_radius, begin, batchSize);
+        for (PointId i = 0; i < neighbors.size(); ++i)
+        {
+            if (neighbors.count(i) > size_t(m_minK))
+                inliers.push_back(begin + i);
+            else
+                outliers.push_back(begin + i);
+        }
     }
 
     return Indices{inliers, outliers};
@@ -108,21 +113,22 @@ Indices OutlierFilter::processStatistical(PointViewPtr inView)
 
     // we increase the count by one because the query point itself will
     // be included with a distance of 0
+    // Neighbors are found a batch of points at a time.
     point_count_t count = m_meanK + 1;
-    PointIdList indices(count);
-    std::vector<double> sqr_dists(count);
-    for (PointId i = 0; i < np; ++i)
+    const point_count_t batchSize = 65536;
+    for (PointId begin = 0; begin < np; begin += batchSize)
     {
-
-        index.knnSearch(i, count, &indices, &sqr_dists);
-
-        for (size_t j = 1; j < count; ++j)
+        KDNeighbors neighbors = index.knnSearchAll(count, begin, batchSize);
+        for (PointId i = 0; i < neighbors.size(); ++i)
         {
-            double delta = std::sqrt(sqr_dists[j]) - distances[i];
-            distances[i] += (delta / j);
+            const double *sqr_dists = neighbors.sqrDists(i);
+            double& distance = distances[begin + i];
+            for (size_t j = 1; j < neighbors.count(i); ++j)
+            {
+                double delta = std::sqrt(sqr_dists[j]) - distance;
+                distance += (delta / j);
+            }
         }
-        indices.clear(); indices.resize(count);
-        sqr_dists.clear(); sqr_dists.resize(count);
     }
 
     size_t n(0);
@@ -39,6 +39,7 @@
 #include <ogr_api.h>
 
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/private/BoxTree.hpp>
 #include <pdal/private/gdal/GDALUtils.hpp>
 
 namespace pdal
@@ -55,6 +56,14 @@ static StaticPluginInfo const s_info
 CREATE_STATIC_STAGE(OverlayFilter, s_info)
 
 
+OverlayFilter::OverlayFilter() : m_ds(0), m_lyr(0), m_index(new BoxTree)
+{}
+
+
+OverlayFilter::~OverlayFilter()
+{}
+
+
 void OverlayFilter::addArgs(ProgramArgs& args)
 {
     args.add("dimension", "Dimension on which to filter", m_dimName).
@@ -127,6 +136,16 @@ void OverlayFilter::ready(PointTableRef table)
         feature = OGRFeaturePtr(OGR_L_GetNextFeature(m_lyr), featureDeleter);
     }
     while (feature);
+    indexPolygons();
+}
+
+
+void OverlayFilter::indexPolygons()
+{
+    std::vector<BOX2D> bounds;
+    for (auto& poly : m_polygons)
+        bounds.push_back(poly.geom.bounds().to2d());
+    m_index->build(bounds);
 }
 
 
@@ -140,15 +159,20 @@ void OverlayFilter::spatialReferenceChanged(const SpatialReference& srs)
         if (!ok)
             throwError(ok.what());
     }
+    indexPolygons();
 }
 
 
+// The first polygon (in datasource order) that contains a point sets its
+// value.  Only polygons whose bounds contain the point need to be tested.
 bool OverlayFilter::processOne(PointRef& point)
 {
-    for (const auto& poly : m_polygons)
+    double x = point.getFieldAs<double>(Dimension::Id::X);
+    double y = point.getFieldAs<double>(Dimension::Id::Y);
+    m_index->candidates(x, y, m_candidates);
+    for (size_t id : m_candidates)
     {
-        double x = point.getFieldAs<double>(Dimension::Id::X);
-        double y = point.getFieldAs<double>(Dimension::Id::Y);
+        const PolyVal& poly = m_polygons[id];
         if (poly.geom.contains(x, y))
         {
             point.setField(m_dim, poly.val);
@@ -159,13 +183,29 @@ bool OverlayFilter::processOne(PointRef& point)
 }
 
 
+// Blocks of points that don't overlap any polygon are skipped.
 void OverlayFilter::filter(PointView& view)
 {
+    const point_count_t blockSize = 4096;
     PointRef point(view, 0);
-    for (PointId id = 0; id < view.size(); ++id)
+    for (PointId idx = 0; idx < view.size();)
     {
-        point.setPointId(id);
-        processOne(point);
+        FieldSpan<double> xs =
+            view.getFieldSpan<double>(Dimension::Id::X, idx, blockSize);
+        FieldSpan<double> ys =
+            view.getFieldSpan<double>(Dimension::Id::Y, idx, xs.size());
+        const point_count_t count = (std::min)(xs.size(), ys.size());
+
+        BOX2D bounds;
+        for (point_count_t i = 0; i < count; ++i)
+            bounds.grow(xs[i], ys[i]);
+        if (m_index->overlaps(bounds))
+            for (PointId id = idx; id < idx + count; ++id)
+            {
+                point.setPointId(id);
+                processOne(point);
+            }
+        idx += count;
     }
 }
 
@@ -57,6 +57,96 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(RangeFilter, s_info)
 
+namespace
+{
+
+// Range test pushed to the reader.  Ranges on X, Y and Z are applied to
+// point positions and boxes before points are decoded.  The full test is
+// applied to decoded points.
+class RangePredicate : public ReadPredicate
+{
+public:
+    RangePredicate(const std::vector<DimRange>& ranges) : m_ranges(ranges)
+    {
+        for (const DimRange& r : m_ranges)
+            if (r.m_id == Dimension::Id::X || r.m_id == Dimension::Id::Y ||
+                    r.m_id == Dimension::Id::Z)
+                m_posRanges.push_back(r);
+    }
+
+    bool boxPasses(const BOX3D& box) const override
+    {
+        return test([&box](const DimRange& r)
+        {
+            if (r.m_id == Dimension::Id::X)
+                return rangePasses(r, box.minx, box.maxx);
+            else if (r.m_id == Dimension::Id::Y)
+                return rangePasses(r, box.miny, box.maxy);
+            return rangePasses(r, box.minz, box.maxz);
+        });
+    }
+
+    bool positionPasses(double x, double y, double z) const override
+    {
+        return test([x, y, z](const DimRange& r)
+        {
+            if (r.m_id == Dimension::Id::X)
+                return r.valuePasses(x);
+            else if (r.m_id == Dimension::Id::Y)
+                return r.valuePasses(y);
+            return r.valuePasses(z);
+        });
+    }
+
+    bool pointPasses(PointRef& point) const override
+        { return DimRange::pointPasses(m_ranges, point); }
+
+private:
+    // Determine if any value between 'lo' and 'hi' might pass a range.
+    static bool rangePasses(const DimRange& r, double lo, double hi)
+    {
+        if (!r.m_negate)
+            return hi >= r.m_lower_bound && lo <= r.m_upper_bound;
+        // A negated range only fails if every value in the box is inside
+        // the range.
+        bool inside =
+            (r.m_inclusive_lower_bound ? lo >= r.m_lower_bound :
+                lo > r.m_lower_bound) &&
+            (r.m_inclusive_upper_bound ? hi <= r.m_upper_bound :
+                hi < r.m_upper_bound);
+        return !inside;
+    }
+
+    // Apply the same OR within a dimension/AND between dimensions logic
+    // as DimRange::pointPasses() to the position ranges.
+    template<typename Func>
+    bool test(Func f) const
+    {
+        if (m_posRanges.empty())
+            return true;
+        Dimension::Id lastId = m_posRanges.front().m_id;
+        bool passes = false;
+        for (const DimRange& r : m_posRanges)
+        {
+            if (r.m_id != lastId)
+            {
+                if (!passes)
+                    return false;
+                lastId = r.m_id;
+            }
+            else if (passes)
+                continue;
+            passes = f(r);
+        }
+        return passes;
+    }
+
+    std::vector<DimRange> m_ranges;
+    std::vector<DimRange> m_posRanges;
+};
+
+} // unnamed namespace
+
 std::string RangeFilter::getName() const
 {
     return s_info.name;
@@ -92,6 +182,14 @@ void RangeFilter::prepared(PointTableRef table)
 }
 
 
+ReadPredicatePtr RangeFilter::predicate() const
+{
+    if (m_ranges.empty())
+        return ReadPredicatePtr();
+    return ReadPredicatePtr(new RangePredicate(m_ranges));
+}
+
+
 // The range list is sorted by dimension, so the logic here should work
 // as ORs between ranges of the same dimension and ANDs between ranges
 // of different dimensions.  This is simple logic, but is probably the most
@@ -110,11 +208,39 @@ PointViewSet RangeFilter::run(PointViewPtr inView)
 
     PointViewPtr outView = inView->makeNew();
 
-    for (PointId i = 0; i < inView->size(); ++i)
+    // Evaluate the ranges a batch of points at a time.  'passes' holds
+    // the result for the dimensions checked so far (AND) and 'dimPasses'
+    // holds the result for the ranges of the current dimension (OR).
+    const point_count_t batchSize = 4096;
+    std::vector<char> passes;
+    std::vector<char> dimPasses;
+    for (PointId idx = 0; idx < inView->size();)
     {
-        PointRef point = inView->point(i);
-        if (processOne(point))
-            outView->appendPoint(*inView, i);
+        point_count_t count = (std::min)(batchSize, inView->size() - idx);
+        passes.assign(count, 1);
+        for (auto ri = m_ranges.begin(); ri != m_ranges.end();)
+        {
+            const Dimension::Id id = ri->m_id;
+            FieldSpan<double> vals =
+                inView->getFieldSpan<double>(id, idx, batchSize);
+            if (ri == m_ranges.begin())
+            {
+                count = vals.size();
+                passes.resize(count);
+            }
+
+            dimPasses.assign(count, 0);
+            for (; ri != m_ranges.end() && ri->m_id == id; ++ri)
+                for (point_count_t i = 0; i < count; ++i)
+                    dimPasses[i] |= ri->valuePasses(vals[i]);
+            for (point_count_t i = 0; i < count; ++i)
+                passes[i] &= dimPasses[i];
+        }
+
+        for (point_count_t i = 0; i < count; ++i)
+            if (passes[i])
+                outView->appendPoint(*inView, idx + i);
+        idx += count;
     }
 
     viewSet.insert(outView);
@@ -59,8 +59,11 @@ private:
 
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
+    virtual ReadPredicatePtr predicate() const;
     virtual bool processOne(PointRef& point);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool viewParallelSafe() const
+        { return true; }
 
     RangeFilter& operator=(const RangeFilter&) = delete;
     RangeFilter(const RangeFilter&) = delete;
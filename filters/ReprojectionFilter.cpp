@@ -36,9 +36,10 @@
 
 #include <pdal/PointView.hpp>
 #include <pdal/private/SrsTransform.hpp>
+#include <pdal/private/ThreadBudget.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
-//#include <memory>
+#include <algorithm>
 
 namespace pdal
 {
@@ -146,40 +147,136 @@ void ReprojectionFilter::createTransform(const SpatialReference& srsSRS)
     }
 
 
+    m_transform.reset(newTransform());
+    m_threadTransforms.clear();
+}
+
+
+SrsTransform *ReprojectionFilter::newTransform() const
+{
     // If either vector is empty, GDAL's default ordering is used.
     if (m_inAxisOrdering.size() || m_outAxisOrdering.size())
     {
 
-        m_transform.reset(new SrsTransform(m_inSRS,
-                                           m_inAxisOrdering,
-                                           m_outSRS,
-                                           m_outAxisOrdering));
+        return new SrsTransform(m_inSRS,
+                                m_inAxisOrdering,
+                                m_outSRS,
+                                m_outAxisOrdering);
     } else {
-        m_transform.reset(new SrsTransform(m_inSRS, m_outSRS));
+        return new SrsTransform(m_inSRS, m_outSRS);
     }
 }
 
 
+// Transform points in place, splitting large sets among threads.
+// Coordinate transformations aren't thread-safe, so each thread gets its
+// own.
+void ReprojectionFilter::transform(point_count_t count, double *x,
+    double *y, double *z, int *success)
+{
+    const point_count_t MinPerThread = 4096;
+
+    ThreadGroup group((std::max)(count / MinPerThread, (point_count_t)1));
+    const point_count_t threads = group.size();
+    while (m_threadTransforms.size() + 1 < threads)
+        m_threadTransforms.emplace_back(newTransform());
+
+    const point_count_t chunk = (count + threads - 1) / threads;
+    group.run(threads, [&](size_t t)
+    {
+        const SrsTransform& xform =
+            t ? *m_threadTransforms[t - 1] : *m_transform;
+        point_count_t begin = t * chunk;
+        point_count_t n = (std::min)(chunk, count - begin);
+        xform.transform(n, x + begin, y + begin, z + begin,
+            success + begin);
+    });
+}
+
+
 PointViewSet ReprojectionFilter::run(PointViewPtr view)
 {
     PointViewSet viewSet;
     PointViewPtr outView = view->makeNew();
 
+    using namespace Dimension;
+
+    // Transforming many points at once is much cheaper than transforming
+    // them one at a time.
+    const point_count_t Batch = 65536;
+
     createTransform(view->spatialReference());
 
-    PointRef point(*view, 0);
-    for (PointId id = 0; id < view->size(); ++id)
+    // Spans for the same range all have the same size, which may be less
+    // than asked for.
+    std::vector<int> success(view->size());
+    for (PointId begin = 0; begin < view->size();)
     {
-        point.setPointId(id);
-        if (processOne(point))
-            outView->appendPoint(*view, id);
+        FieldSpan<double> x = view->getFieldSpan<double>(Id::X, begin, Batch);
+        FieldSpan<double> y = view->getFieldSpan<double>(Id::Y, begin, Batch);
+        FieldSpan<double> z = view->getFieldSpan<double>(Id::Z, begin, Batch);
+        transform(x.size(), x.data(), y.data(), z.data(),
+            success.data() + begin);
+        view->setFieldSpan(Id::X, begin, x);
+        view->setFieldSpan(Id::Y, begin, y);
+        view->setFieldSpan(Id::Z, begin, z);
+        begin += x.size();
     }
 
+    if (std::find(success.begin(), success.end(), 0) == success.end())
+        outView->append(*view);
+    else
+        for (PointId id = 0; id < view->size(); ++id)
+            if (success[id])
+                outView->appendPoint(*view, id);
+
     viewSet.insert(outView);
     return viewSet;
 }
 
 
+void ReprojectionFilter::processChunk(StreamPointTable& table,
+    point_count_t count)
+{
+    using namespace Dimension;
+
+    // Gather the points to transform.
+    m_ids.clear();
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    PointRef point(table, 0);
+    for (PointId idx = 0; idx < count; idx++)
+    {
+        point.setPointId(idx);
+        if (table.skip(idx) || !eval(point))
+            continue;
+        m_ids.push_back(idx);
+        m_x.push_back(point.getFieldAs<double>(Id::X));
+        m_y.push_back(point.getFieldAs<double>(Id::Y));
+        m_z.push_back(point.getFieldAs<double>(Id::Z));
+    }
+
+    m_success.resize(m_ids.size());
+    transform(m_ids.size(), m_x.data(), m_y.data(), m_z.data(),
+        m_success.data());
+
+    // Scatter the results back, skipping points that failed.
+    for (size_t i = 0; i < m_ids.size(); ++i)
+    {
+        if (!m_success[i])
+        {
+            table.setSkip(m_ids[i]);
+            continue;
+        }
+        point.setPointId(m_ids[i]);
+        point.setField(Id::X, m_x[i]);
+        point.setField(Id::Y, m_y[i]);
+        point.setField(Id::Z, m_z[i]);
+    }
+}
+
+
 bool ReprojectionFilter::processOne(PointRef& point)
 {
     double x(point.getFieldAs<double>(Dimension::Id::X));
@@ -60,15 +60,27 @@ private:
     virtual void initialize();
     virtual PointViewSet run(PointViewPtr view);
     virtual bool processOne(PointRef& point);
+    virtual void processChunk(StreamPointTable& table, point_count_t count);
     virtual void spatialReferenceChanged(const SpatialReference& srs);
     virtual void prepared(PointTableRef table);
 
     void createTransform(const SpatialReference& srs);
+    SrsTransform *newTransform() const;
+    void transform(point_count_t count, double *x, double *y, double *z,
+        int *success);
 
     SpatialReference m_inSRS;
     SpatialReference m_outSRS;
     bool m_inferInputSRS;
     std::unique_ptr<SrsTransform> m_transform;
+    // Transforms for threads other than the first.
+    std::vector<std::unique_ptr<SrsTransform>> m_threadTransforms;
+    // Stream chunk buffers.
+    std::vector<PointId> m_ids;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+    std::vector<int> m_success;
     std::vector<std::string> m_inAxisOrderingArg;
     std::vector<std::string> m_outAxisOrderingArg;
     std::vector<int> m_inAxisOrdering;
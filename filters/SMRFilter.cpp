@@ -668,12 +668,13 @@ std::vector<int> SMRFilter::progressiveFilter(std::vector<double> const& ZImin,
     // from a starting value of one pixel to the pixel equivalent of the maximum
     // value."
     std::vector<int> Obj(m_rows * m_cols, 0);
+    std::vector<double> curOpening;
     for (int radius = 1; radius <= max_radius; ++radius)
     {
         // "On the first iteration, the minimum surface (ZImin) is opened using
         // a disk-shaped structuring element with a radius of one pixel."
         math::erodeDiamond(erosion, m_rows, m_cols, 1);
-        std::vector<double> curOpening = erosion;
+        curOpening.assign(erosion.begin(), erosion.end());
         math::dilateDiamond(curOpening, m_rows, m_cols, radius);
 
         // "An elevation threshold is then calculated, where the value is equal
@@ -682,31 +683,22 @@ std::vector<int> SMRFilter::progressiveFilter(std::vector<double> const& ZImin,
         double threshold = slope * m_args->m_cell * radius;
 
         // "This elevation threshold is applied to the difference of the minimum
-        // and the opened surfaces."
-
-        // Need to provide means of diffing two vectors.
-        std::vector<double> diff;
-        std::transform(prevSurface.begin(), prevSurface.end(),
-                       curOpening.begin(), std::back_inserter(diff),
-                       [&](double l, double r) { return std::fabs(l - r); });
-
-        // "Any grid cell with a difference value exceeding the calculated
-        // elevation threshold for the iteration is then flagged as an OBJ
-        // cell."
-        std::vector<int> foo;
-        std::transform(diff.begin(), diff.end(), std::back_inserter(foo),
-                       [threshold](double x) {
-                           return (x > threshold) ? int(1) : int(0);
-                       });
-        std::transform(Obj.begin(), Obj.end(), foo.begin(), Obj.begin(),
-                       [](int a, int b) { return (std::max)(a, b); });
+        // and the opened surfaces. Any grid cell with a difference value
+        // exceeding the calculated elevation threshold for the iteration is
+        // then flagged as an OBJ cell."
+        size_t ng(0);
+        for (size_t i = 0; i < Obj.size(); ++i)
+        {
+            if (std::fabs(prevSurface[i] - curOpening[i]) > threshold)
+                Obj[i] = 1;
+            ng += Obj[i];
+        }
 
         // "The algorithm then proceeds to the next window radius (up to the
         // maximum), and proceeds as above with the last opened surface acting
         // as the minimum surface for the next difference calculation."
-        prevSurface = curOpening;
+        prevSurface.swap(curOpening);
 
-        size_t ng = std::count(Obj.begin(), Obj.end(), 1);
         size_t g(Obj.size() - ng);
         double p(100.0 * double(ng) / double(Obj.size()));
         log()->floatPrecision(2);
@@ -34,6 +34,8 @@
 
 #include "SortFilter.hpp"
 
+#include <pdal/private/PointSort.hpp>
+
 namespace pdal
 {
 
@@ -50,28 +52,31 @@ std::string SortFilter::getName() const { return s_info.name; }
 
 void SortFilter::addArgs(ProgramArgs& args)
 {
-    args.add("dimension", "Dimension on which to sort", m_dimName).
-        setPositional();
+    args.add("dimension", "Dimension(s) on which to sort, separated by "
+        "commas", m_dimName).setPositional();
     args.add("order", "Sort order ASC(ending) or DESC(ending)", m_order,
         SortOrder::ASC);
 }
 
 void SortFilter::prepared(PointTableRef table)
 {
-    m_dim = table.layout()->findDim(m_dimName);
-    if (m_dim == Dimension::Id::Unknown)
-        throwError("Dimension '" + m_dimName + "' not found.");
+    m_dims.clear();
+    for (std::string name : Utils::split2(m_dimName, ','))
+    {
+        Utils::trim(name);
+        Dimension::Id dim = table.layout()->findDim(name);
+        if (dim == Dimension::Id::Unknown)
+            throwError("Dimension '" + name + "' not found.");
+        m_dims.push_back(dim);
+    }
+    if (m_dims.empty())
+        throwError("No dimension specified.");
 }
 
 void SortFilter::filter(PointView& view)
 {
-    auto cmp = [this](const PointRef& p1, const PointRef& p2)
-    {
-        bool result = p1.compare(m_dim, p2);
-        return (m_order == SortOrder::ASC) ? result : !result;
-    };
-
-    std::stable_sort(view.begin(), view.end(), cmp);
+    view.reorder(sorting::dimensionOrder(view, m_dims,
+        m_order == SortOrder::DESC));
 }
 
 std::istream& operator >> (std::istream& in, SortOrder& order)
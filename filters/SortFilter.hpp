@@ -59,9 +59,9 @@ public:
     std::string getName() const;
 
 private:
-    // Dimension on which to sort.
-    Dimension::Id m_dim;
-    // Dimension name.
+    // Dimensions on which to sort.
+    Dimension::IdList m_dims;
+    // Dimension names.
     std::string m_dimName;
 
     // Sort order.
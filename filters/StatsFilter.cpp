@@ -35,12 +35,15 @@
 #include "StatsFilter.hpp"
 
 #include <cmath>
+#include <cstring>
+#include <set>
 #include <unordered_map>
 
 #include <pdal/Options.hpp>
 #include <pdal/Polygon.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/private/ThreadBudget.hpp>
 
 namespace pdal
 {
@@ -59,6 +62,324 @@ std::string StatsFilter::getName() const { return s_info.name; }
 namespace stats
 {
 
+namespace
+{
+
+const double Pi = 3.14159265358979323846;
+
+} // unnamed namespace
+
+
+QuantileSketch::QuantileSketch(double compression) :
+    m_compression(compression)
+{
+    clear();
+}
+
+
+void QuantileSketch::clear()
+{
+    m_min = (std::numeric_limits<double>::max)();
+    m_max = (std::numeric_limits<double>::lowest)();
+    m_count = 0;
+    m_centroids.clear();
+    m_buffer.clear();
+}
+
+
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+    if (!other.m_count)
+        return;
+    m_buffer.insert(m_buffer.end(), other.m_centroids.begin(),
+        other.m_centroids.end());
+    m_buffer.insert(m_buffer.end(), other.m_buffer.begin(),
+        other.m_buffer.end());
+    m_count += other.m_count;
+    m_min = (std::min)(m_min, other.m_min);
+    m_max = (std::max)(m_max, other.m_max);
+    compress();
+}
+
+
+size_t QuantileSketch::size() const
+{
+    compress();
+    return m_centroids.size();
+}
+
+
+// Merge the buffered values and the existing centroids into a new set of
+// centroids.  Neighboring centroids are combined as long as the result
+// spans no more than one unit of the scale function
+// k(q) = compression / (2 * pi) * asin(2q - 1).
+void QuantileSketch::compress() const
+{
+    if (m_buffer.empty())
+        return;
+
+    m_buffer.insert(m_buffer.end(), m_centroids.begin(), m_centroids.end());
+    std::sort(m_buffer.begin(), m_buffer.end(),
+        [](const Centroid& a, const Centroid& b)
+        { return a.m_mean < b.m_mean; });
+
+    double total = 0;
+    for (const Centroid& c : m_buffer)
+        total += c.m_weight;
+
+    const double scale = m_compression / (2 * Pi);
+    const double kmax = m_compression / 4;
+    auto limit = [total, scale, kmax](double weight)
+    {
+        double k = scale * std::asin(2 * weight / total - 1) + 1;
+        if (k >= kmax)
+            return total;
+        return total * (std::sin(k / scale) + 1) / 2;
+    };
+
+    m_centroids.clear();
+    Centroid cur = m_buffer.front();
+    double weight = 0;
+    double wLimit = limit(0);
+    for (size_t i = 1; i < m_buffer.size(); ++i)
+    {
+        const Centroid& c = m_buffer[i];
+        if (weight + cur.m_weight + c.m_weight <= wLimit)
+        {
+            cur.m_weight += c.m_weight;
+            cur.m_mean += (c.m_mean - cur.m_mean) * c.m_weight / cur.m_weight;
+        }
+        else
+        {
+            weight += cur.m_weight;
+            m_centroids.push_back(cur);
+            wLimit = limit(weight);
+            cur = c;
+        }
+    }
+    m_centroids.push_back(cur);
+    m_buffer.clear();
+}
+
+
+// Each centroid is taken to sit at the middle of the range of ranks it
+// represents.  Values between centroids (and between the extreme
+// centroids and the minimum and maximum) are interpolated.
+double QuantileSketch::quantile(double q) const
+{
+    compress();
+    if (m_centroids.empty())
+        return 0;
+    if (m_centroids.size() == 1)
+        return m_centroids.front().m_mean;
+
+    const double target = q * m_count;
+    double prevPos = 0;
+    double prevVal = m_min;
+    double weight = 0;
+    for (const Centroid& c : m_centroids)
+    {
+        double pos = weight + c.m_weight / 2;
+        if (target < pos)
+        {
+            if (c.m_weight == 1 && target >= weight)
+                return c.m_mean;
+            return prevVal +
+                (c.m_mean - prevVal) * (target - prevPos) / (pos - prevPos);
+        }
+        weight += c.m_weight;
+        prevPos = pos;
+        prevVal = c.m_mean;
+    }
+    if (prevPos >= m_count)
+        return m_max;
+    return prevVal + (m_max - prevVal) * (target - prevPos) /
+        (m_count - prevPos);
+}
+
+
+// Fraction of the values less than or equal to 'x', interpolated in the
+// same way as quantile().
+double QuantileSketch::cdf(double x) const
+{
+    compress();
+    if (m_centroids.empty() || x < m_min)
+        return 0;
+    if (x >= m_max)
+        return 1;
+
+    double prevPos = 0;
+    double prevVal = m_min;
+    double weight = 0;
+    for (const Centroid& c : m_centroids)
+    {
+        double pos = weight + c.m_weight / 2;
+        if (x < c.m_mean)
+            return (prevPos + (pos - prevPos) * (x - prevVal) /
+                (c.m_mean - prevVal)) / m_count;
+        weight += c.m_weight;
+        prevPos = pos;
+        prevVal = c.m_mean;
+    }
+    return (prevPos + (m_count - prevPos) * (x - prevVal) /
+        (m_max - prevVal)) / m_count;
+}
+
+
+// Median of the absolute deviations of the values from 'median': the
+// distance 'd' such that half the values lie within 'd' of 'median'.
+double QuantileSketch::medianDeviation(double median) const
+{
+    compress();
+    if (m_centroids.empty())
+        return 0;
+
+    double lo = 0;
+    double hi = (std::max)(m_max - median, median - m_min);
+    for (int i = 0; i < 64; ++i)
+    {
+        double d = (lo + hi) / 2;
+        if (cdf(median + d) - cdf(median - d) < .5)
+            lo = d;
+        else
+            hi = d;
+    }
+    return hi;
+}
+
+
+namespace
+{
+
+const int DistinctBits = 14;
+
+uint64_t hashValue(double value)
+{
+    // Make -0 and 0 the same value.
+    if (value == 0)
+        value = 0;
+    uint64_t h;
+    std::memcpy(&h, &value, sizeof(h));
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} // unnamed namespace
+
+
+// The top bits of the hash select a register and the register holds the
+// longest run of leading zeros seen in the remaining bits.
+void DistinctSketch::insert(double value)
+{
+    if (m_registers.empty())
+        m_registers.resize(1 << DistinctBits);
+
+    uint64_t h = hashValue(value);
+    size_t reg = (size_t)(h >> (64 - DistinctBits));
+    uint64_t bits = h << DistinctBits;
+
+    const uint8_t maxRank = 64 - DistinctBits + 1;
+    uint8_t rank = 1;
+    while (rank < maxRank && !(bits & (1ULL << 63)))
+    {
+        bits <<= 1;
+        rank++;
+    }
+    if (rank > m_registers[reg])
+        m_registers[reg] = rank;
+}
+
+
+void DistinctSketch::merge(const DistinctSketch& other)
+{
+    if (other.m_registers.empty())
+        return;
+    if (m_registers.empty())
+    {
+        m_registers = other.m_registers;
+        return;
+    }
+    for (size_t i = 0; i < m_registers.size(); ++i)
+        m_registers[i] = (std::max)(m_registers[i], other.m_registers[i]);
+}
+
+
+double DistinctSketch::estimate() const
+{
+    if (m_registers.empty())
+        return 0;
+
+    const double m = (double)m_registers.size();
+    double sum = 0;
+    size_t zeros = 0;
+    for (uint8_t r : m_registers)
+    {
+        sum += std::ldexp(1.0, -r);
+        if (r == 0)
+            zeros++;
+    }
+    double est = (0.7213 / (1 + 1.079 / m)) * m * m / sum;
+
+    // Linear counting is more accurate for small sets.
+    if (est <= 2.5 * m && zeros)
+        est = m * std::log(m / zeros);
+    return est;
+}
+
+
+// Combine the statistics of another summary of the same dimension.  The
+// moments are combined as described by Pebay, "Formulas for Robust,
+// One-Pass Parallel Computation of Covariances and Arbitrary-Order
+// Statistical Moments", 2008.
+void Summary::merge(const Summary& s)
+{
+    if (s.m_cnt == 0)
+        return;
+
+    if (m_cnt == 0)
+    {
+        M1 = s.M1;
+        M2 = s.M2;
+        M3 = s.M3;
+        M4 = s.M4;
+    }
+    else
+    {
+        double na = (double)m_cnt;
+        double nb = (double)s.m_cnt;
+        double n = na + nb;
+        double delta = s.M1 - M1;
+        double delta_n = delta / n;
+        double delta_n2 = delta_n * delta_n;
+        double term1 = delta * delta_n * na * nb;
+
+        M1 += delta_n * nb;
+        if (m_advanced)
+        {
+            M4 += s.M4 + term1 * delta_n2 * (na * na - na * nb + nb * nb) +
+                6 * delta_n2 * (na * na * s.M2 + nb * nb * M2) +
+                4 * delta_n * (na * s.M3 - nb * M3);
+            M3 += s.M3 + term1 * delta_n * (na - nb) +
+                3 * delta_n * (na * s.M2 - nb * M2);
+        }
+        M2 += s.M2 + term1;
+    }
+
+    m_cnt += s.m_cnt;
+    m_min = (std::min)(m_min, s.m_min);
+    m_max = (std::max)(m_max, s.m_max);
+    for (auto& v : s.m_values)
+        m_values[v.first] += v.second;
+    m_data.insert(m_data.end(), s.m_data.begin(), s.m_data.end());
+    m_sketch.merge(s.m_sketch);
+    m_distinctSketch.merge(s.m_distinctSketch);
+}
+
 
 void Summary::extractMetadata(MetadataNode &m)
 {
@@ -76,6 +397,9 @@ void Summary::extractMetadata(MetadataNode &m)
     if (!std::isinf(v) && !std::isnan(v))
         m.add("variance", v, "variance");
     m.add("name", m_name, "name");
+    if (m_distinct)
+        m.add("distinct", (uint64_t)std::llround(distinct()),
+            "estimated number of distinct values");
 
     if (m_advanced)
     {
@@ -119,6 +443,15 @@ void Summary::computeGlobalStats()
         return *(vals.begin()+vals.size()/2);
     };
 
+    if (m_approximate)
+    {
+        m_median = m_sketch.quantile(.5);
+        m_mad = m_sketch.medianDeviation(m_median);
+        return;
+    }
+    if (m_data.empty())
+        return;
+
     // TODO add quantiles
     m_median = compute_median(m_data);
     std::transform(m_data.begin(), m_data.end(), m_data.begin(),
@@ -145,16 +478,112 @@ bool StatsFilter::processOne(PointRef& point)
 }
 
 
-void StatsFilter::filter(PointView& view)
+// Each dimension is summarized separately, so the dimensions of a chunk
+// are split among threads.  Values reach each summary in the same order
+// as with processOne(), so the results are the same.
+void StatsFilter::processChunk(StreamPointTable& table, point_count_t count)
 {
-    PointRef point(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    const point_count_t MinPoints = 4096;
+
+    m_ids.clear();
+    PointRef point(table, 0);
+    for (PointId idx = 0; idx < count; idx++)
     {
         point.setPointId(idx);
-        processOne(point);
+        if (table.skip(idx) || !eval(point))
+            continue;
+        m_ids.push_back(idx);
+    }
+
+    std::vector<std::pair<Dimension::Id, Summary *>> summaries;
+    for (auto& p : m_stats)
+        summaries.emplace_back(p.first, &p.second);
+
+    ThreadGroup group(m_ids.size() < MinPoints ? 1 : summaries.size());
+    group.run(summaries.size(), [this, &table, &summaries](size_t i)
+    {
+        const Dimension::Id d = summaries[i].first;
+        Summary& c = *summaries[i].second;
+        PointRef point(table, 0);
+        for (PointId idx : m_ids)
+        {
+            point.setPointId(idx);
+            c.insert(point.getFieldAs<double>(d));
+        }
+    });
+}
+
+
+namespace
+{
+
+using SummaryMap = std::map<Dimension::Id, Summary>;
+
+void summarize(PointView& view, PointId begin, PointId end,
+    SummaryMap& stats)
+{
+    const point_count_t batchSize = 4096;
+    for (auto p = stats.begin(); p != stats.end(); ++p)
+    {
+        Dimension::Id d = p->first;
+        Summary& c = p->second;
+        for (PointId idx = begin; idx < end;)
+        {
+            FieldSpan<double> vals =
+                view.getFieldSpan<double>(d, idx, (std::min)(batchSize,
+                    end - idx));
+            for (double v : vals)
+                c.insert(v);
+            idx += vals.size();
+        }
     }
 }
 
+} // unnamed namespace
+
+
+// Large views are split among threads.  Each thread summarizes its part
+// of the view and the partial summaries are combined pairwise.
+void StatsFilter::filter(PointView& view)
+{
+    const point_count_t minChunk = 65536;
+    ThreadGroup group(view.size() / minChunk);
+    const size_t threads = group.size();
+    if (threads <= 1)
+    {
+        summarize(view, 0, view.size(), m_stats);
+        return;
+    }
+
+    SummaryMap empty(m_stats);
+    for (auto& p : empty)
+        p.second.reset();
+    std::vector<SummaryMap> parts(threads, empty);
+
+    const point_count_t chunk = (view.size() + threads - 1) / threads;
+    group.run(threads, [&view, &parts, chunk](size_t t)
+    {
+        PointId begin = t * chunk;
+        PointId end = (std::min)(begin + chunk, view.size());
+        summarize(view, begin, end, parts[t]);
+    });
+
+    for (size_t step = 1; step < threads; step *= 2)
+    {
+        size_t merges = (threads - step + 2 * step - 1) / (2 * step);
+        group.run(merges, [&parts, step](size_t m)
+        {
+            SummaryMap& dst = parts[2 * step * m];
+            SummaryMap& src = parts[2 * step * m + step];
+            for (auto& p : dst)
+                p.second.merge(src.at(p.first));
+        });
+    }
+
+    for (auto& p : m_stats)
+        p.second.merge(parts[0].at(p.first));
+}
+
 
 void StatsFilter::done(PointTableRef table)
 {
@@ -171,7 +600,11 @@ void StatsFilter::addArgs(ProgramArgs& args)
     args.add("global", "Dimensions to compute global stats (median, mad, mode)",
         m_global);
     args.add("count", "Dimensions whose values should be counted", m_counts);
+    args.add("distinct", "Dimensions whose number of distinct values "
+        "should be estimated", m_distinct);
     args.add("advanced", "Calculate skewness and kurtosis", m_advanced);
+    args.add("approximate", "Estimate global statistics (median, mad) "
+        "using bounded memory", m_approximate);
 }
 
 
@@ -232,10 +665,21 @@ void StatsFilter::prepared(PointTableRef table)
         else
             dims[s] = Summary::Global;
     }
+    std::set<std::string> distinct;
+    for (auto& s : m_distinct)
+    {
+        if (dims.find(s) == dims.end())
+            getWarn() << "Dimension '" << s << "' listed in --distinct "
+                "option does not exist.  Ignoring." << std::endl;
+        else
+            distinct.insert(s);
+    }
+
     // Create the summary objects.
     for (auto& dv : dims)
         m_stats.insert(std::make_pair(layout->findDim(dv.first),
-            Summary(dv.first, dv.second, m_advanced)));
+            Summary(dv.first, dv.second, m_advanced, m_approximate,
+                distinct.count(dv.first))));
 }
 
 
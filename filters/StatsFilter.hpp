@@ -42,6 +42,70 @@ namespace pdal
 namespace stats
 {
 
+/**
+  Bounded-memory estimate of the distribution of a set of values
+  (a merging t-digest).  Values are grouped into weighted centroids that
+  are small near the tails of the distribution and larger near the
+  middle.  Sketches built from separate parts of the data can be merged.
+*/
+class PDAL_DLL QuantileSketch
+{
+public:
+    QuantileSketch(double compression = 200);
+
+    void insert(double value)
+    {
+        m_buffer.push_back({value, 1});
+        m_count++;
+        m_min = (std::min)(m_min, value);
+        m_max = (std::max)(m_max, value);
+        if (m_buffer.size() >= 5 * m_compression)
+            compress();
+    }
+
+    void merge(const QuantileSketch& other);
+    void clear();
+    double quantile(double q) const;
+    double cdf(double x) const;
+    double medianDeviation(double median) const;
+    point_count_t count() const
+        { return m_count; }
+    size_t size() const;
+
+private:
+    struct Centroid
+    {
+        double m_mean;
+        double m_weight;
+    };
+
+    void compress() const;
+
+    double m_compression;
+    double m_min;
+    double m_max;
+    point_count_t m_count;
+    mutable std::vector<Centroid> m_centroids;
+    mutable std::vector<Centroid> m_buffer;
+};
+
+/**
+  Estimate of the number of distinct values in a set (HyperLogLog).
+  Memory use is fixed (16K) and sketches can be merged.
+*/
+class PDAL_DLL DistinctSketch
+{
+public:
+    void insert(double value);
+    void merge(const DistinctSketch& other);
+    void clear()
+        { m_registers.clear(); }
+    double estimate() const;
+
+private:
+    std::vector<uint8_t> m_registers;
+};
+
 class PDAL_DLL Summary
 {
 public:
@@ -57,8 +121,10 @@ typedef std::map<double, point_count_t> EnumMap;
 typedef std::vector<double> DataVector;
 
 public:
-    Summary(std::string name, EnumType enumerate, bool advanced = true) :
-        m_name(name), m_enumerate(enumerate), m_advanced(advanced)
+    Summary(std::string name, EnumType enumerate, bool advanced = true,
+            bool approximate = false, bool distinct = false) :
+        m_name(name), m_enumerate(enumerate), m_advanced(advanced),
+        m_approximate(approximate), m_distinct(distinct)
     { reset(); }
 
     double minimum() const
@@ -132,6 +198,8 @@ public:
         { return m_mad; }
     point_count_t count() const
         { return m_cnt; }
+    double distinct() const
+        { return m_distinctSketch.estimate(); }
     std::string name() const
         { return m_name; }
     const EnumMap& values() const
@@ -139,6 +207,7 @@ public:
 
     void extractMetadata(MetadataNode &m);
     void computeGlobalStats();
+    void merge(const Summary& s);
 
     void reset()
     {
@@ -148,6 +217,10 @@ public:
         m_median = 0.0;
         m_mad = 0.0;
         M1 = M2 = M3 = M4 = 0.0;
+        m_values.clear();
+        m_data.clear();
+        m_sketch.clear();
+        m_distinctSketch.clear();
     }
 
     void insert(double value)
@@ -160,10 +233,17 @@ public:
             m_values[value]++;
         if (m_enumerate == Global)
         {
-            if (m_data.capacity() - m_data.size() < 10000)
-                m_data.reserve(m_data.capacity() + m_cnt);
-            m_data.push_back(value);
+            if (m_approximate)
+                m_sketch.insert(value);
+            else
+            {
+                if (m_data.capacity() - m_data.size() < 10000)
+                    m_data.reserve(m_data.capacity() + m_cnt);
+                m_data.push_back(value);
+            }
         }
+        if (m_distinct)
+            m_distinctSketch.insert(value);
 
         // stolen from http://www.johndcook.com/blog/skewness_kurtosis/
 
@@ -196,12 +276,16 @@ private:
     std::string m_name;
     EnumType m_enumerate;
     bool m_advanced;
+    bool m_approximate;
+    bool m_distinct;
     double m_max;
     double m_min;
     double m_mad;
     double m_median;
     EnumMap m_values;
     DataVector m_data;
+    QuantileSketch m_sketch;
+    DistinctSketch m_distinctSketch;
     point_count_t m_cnt;
     double M1, M2, M3, M4;
 };
@@ -226,6 +310,7 @@ private:
     StatsFilter(const StatsFilter&); // not implemented
     virtual void addArgs(ProgramArgs& args);
     virtual bool processOne(PointRef& point);
+    virtual void processChunk(StreamPointTable& table, point_count_t count);
     virtual void prepared(PointTableRef table);
     virtual void done(PointTableRef table);
     virtual void filter(PointView& view);
@@ -235,8 +320,12 @@ private:
     StringList m_enums;
     StringList m_counts;
     StringList m_global;
+    StringList m_distinct;
     bool m_advanced;
+    bool m_approximate;
     std::map<Dimension::Id, stats::Summary> m_stats;
+    // Points of the current stream chunk.
+    std::vector<PointId> m_ids;
 };
 
 } // namespace pdal
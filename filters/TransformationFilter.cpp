@@ -34,9 +34,11 @@
 
 #include "TransformationFilter.hpp"
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/private/ThreadBudget.hpp>
 
 #include <Eigen/Dense>
 
+#include <algorithm>
 #include <sstream>
 
 namespace pdal
@@ -202,6 +204,83 @@ bool TransformationFilter::processOne(PointRef& point)
     return true;
 }
 
+
+void TransformationFilter::processChunk(StreamPointTable& table,
+    point_count_t count)
+{
+    using namespace Dimension;
+
+    // Gather the points to transform.
+    m_ids.clear();
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    PointRef point(table, 0);
+    for (PointId idx = 0; idx < count; idx++)
+    {
+        point.setPointId(idx);
+        if (table.skip(idx) || !eval(point))
+            continue;
+        m_ids.push_back(idx);
+        m_x.push_back(point.getFieldAs<double>(Id::X));
+        m_y.push_back(point.getFieldAs<double>(Id::Y));
+        m_z.push_back(point.getFieldAs<double>(Id::Z));
+    }
+
+    // A chunk is all the work there is at the moment, so it's split
+    // among threads sooner than a view is.
+    const point_count_t MinPerThread = 4096;
+
+    ThreadGroup group(m_ids.size() / MinPerThread);
+    group.ranges(m_ids.size(), MinPerThread,
+        [this](size_t, size_t begin, size_t end)
+    {
+        transform(end - begin, m_x.data() + begin, m_y.data() + begin,
+            m_z.data() + begin);
+    });
+
+    for (size_t i = 0; i < m_ids.size(); ++i)
+    {
+        point.setPointId(m_ids[i]);
+        point.setField(Id::X, m_x[i]);
+        point.setField(Id::Y, m_y[i]);
+        point.setField(Id::Z, m_z[i]);
+    }
+}
+
+
+// Transform arrays of coordinates in place.  The matrix is copied to
+// locals and there's no dependency between points, so the compiler can
+// vectorize the loop.  The arithmetic is the same as in processOne().
+void TransformationFilter::transform(point_count_t count, double *x,
+    double *y, double *z) const
+{
+    const Transform& matrix = *m_matrix;
+    const double m0 = matrix[0];
+    const double m1 = matrix[1];
+    const double m2 = matrix[2];
+    const double m3 = matrix[3];
+    const double m4 = matrix[4];
+    const double m5 = matrix[5];
+    const double m6 = matrix[6];
+    const double m7 = matrix[7];
+    const double m8 = matrix[8];
+    const double m9 = matrix[9];
+    const double m10 = matrix[10];
+    const double m11 = matrix[11];
+
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        const double xi = x[i];
+        const double yi = y[i];
+        const double zi = z[i];
+
+        x[i] = xi * m0 + yi * m1 + zi * m2 + m3;
+        y[i] = xi * m4 + yi * m5 + zi * m6 + m7;
+        z[i] = xi * m8 + yi * m9 + zi * m10 + m11;
+    }
+}
+
 void TransformationFilter::spatialReferenceChanged(const SpatialReference& srs)
 {
     if (!srs.empty() && !m_overrideSrs.empty())
@@ -216,12 +295,32 @@ void TransformationFilter::filter(PointView& view)
         log()->get(LogLevel::Warning) << getName() <<
             ": overriding input spatial reference." << std::endl;
 
-    PointRef point(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    // Threads don't pay for themselves on small views.
+    const point_count_t MinPerThread = 1 << 16;
+
+    // Large views are split among threads.  Each works through its
+    // range a batch of points at a time.
+    ThreadGroup group(view.size() / MinPerThread);
+    group.ranges(view.size(), MinPerThread,
+        [this, &view](size_t, PointId begin, PointId end)
     {
-        point.setPointId(idx);
-        processOne(point);
-    }
+        using namespace Dimension;
+
+        const point_count_t batchSize = 4096;
+        for (PointId idx = begin; idx < end;)
+        {
+            const point_count_t n = (std::min)(batchSize, end - idx);
+            FieldSpan<double> xs = view.getFieldSpan<double>(Id::X, idx, n);
+            FieldSpan<double> ys = view.getFieldSpan<double>(Id::Y, idx, n);
+            FieldSpan<double> zs = view.getFieldSpan<double>(Id::Z, idx, n);
+
+            transform(xs.size(), xs.data(), ys.data(), zs.data());
+            view.setFieldSpan(Id::X, idx, xs);
+            view.setFieldSpan(Id::Y, idx, ys);
+            view.setFieldSpan(Id::Z, idx, zs);
+            idx += xs.size();
+        }
+    });
     view.invalidateProducts();
 }
 
@@ -36,6 +36,7 @@
 
 #include <array>
 #include <string>
+#include <vector>
 
 #include <pdal/Filter.hpp>
 #include <pdal/Streamable.hpp>
@@ -61,12 +62,24 @@ private:
     virtual void addArgs(ProgramArgs& args) override;
     virtual void initialize() override;
     virtual bool processOne(PointRef& point) override;
+    virtual void processChunk(StreamPointTable& table,
+        point_count_t count) override;
     virtual void filter(PointView& view) override;
+    virtual bool viewParallelSafe() const override
+        { return true; }
     virtual void spatialReferenceChanged(const SpatialReference& srs) override;
 
+    void transform(point_count_t count, double *x, double *y,
+        double *z) const;
+
     std::unique_ptr<Transform> m_matrix;
     SpatialReference m_overrideSrs;
     bool m_invert;
+    // Stream chunk buffers.
+    std::vector<PointId> m_ids;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
 };
 
 class TransformationFilter::Transform
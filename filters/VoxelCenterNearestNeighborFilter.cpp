@@ -34,9 +34,9 @@
 
 #include "VoxelCenterNearestNeighborFilter.hpp"
 
-#include <pdal/KDIndex.hpp>
+#include <pdal/private/VoxelGrid.hpp>
 
-#include <set>
+#include <algorithm>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -68,45 +68,28 @@ PointViewSet VoxelCenterNearestNeighborFilter::run(PointViewPtr view)
     BOX3D bounds;
     view->calculateBounds(bounds);
 
-    // Find distance from voxel center to point.  If the distance is less
-    // than previous (or is the first one for the voxel), store the
-    // point ID and distance.
-    std::map<std::tuple<size_t, size_t, size_t>,
-        std::tuple<PointId, double>> populated_voxels;
-    for (PointId id = 0; id < view->size(); ++id)
-    {
-        double x = view->getFieldAs<double>(Dimension::Id::X, id);
-        double y = view->getFieldAs<double>(Dimension::Id::Y, id);
-        double z = view->getFieldAs<double>(Dimension::Id::Z, id);
-        size_t c = static_cast<size_t>((x - bounds.minx) / m_cell);
-        size_t r = static_cast<size_t>((y - bounds.miny) / m_cell);
-        size_t d = static_cast<size_t>((z - bounds.minz) / m_cell);
-        double xv = bounds.minx + (c + 0.5) * m_cell;
-        double yv = bounds.miny + (r + 0.5) * m_cell;
-        double zv = bounds.minz + (d + 0.5) * m_cell;
-        double dist = pow(xv - x, 2) + pow(yv - y, 2) + pow(zv - z, 2);
+    // Find the point nearest the center of each voxel.
+    VoxelGrid grid(m_cell, bounds.minx, bounds.miny, bounds.minz,
+        VoxelGrid::Center);
+    grid.build(*view);
 
-        auto t = std::make_tuple(r, c, d);
-        auto pi = populated_voxels.find(t);
-        if (pi == populated_voxels.end())
-            populated_voxels.insert(
-                std::make_pair(t, std::make_tuple(id, dist)));
-        else
-        {
-            auto& t2 = pi->second;  // Get point/distance tuple.
-            double curDist = std::get<1>(t2);
-            if (dist < curDist)
-                t2 = std::make_tuple(id, dist);
-        }
-    }
+    // Append the ID of the point nearest the voxel center to the output
+    // view, ordered by voxel row, column and depth.
+    std::vector<size_t> voxels(grid.size());
+    for (size_t v = 0; v < voxels.size(); ++v)
+        voxels[v] = v;
+    auto rcd = [&grid](size_t v)
+    {
+        int32_t c, r, d;
+        grid.index(v, c, r, d);
+        return std::make_tuple(r, c, d);
+    };
+    std::sort(voxels.begin(), voxels.end(),
+        [&rcd](size_t a, size_t b){ return rcd(a) < rcd(b); });
 
-    // Append the ID of the point nearest the voxel center to the output view.
     PointViewPtr output = view->makeNew();
-    for (auto const& t : populated_voxels)
-    {
-        auto& t2 = t.second; // Get point/distance tuple.
-        output->appendPoint(*view, std::get<0>(t2));
-    }
+    for (size_t v : voxels)
+        output->appendPoint(*view, grid.nearestCenter(v));
 
     PointViewSet viewSet;
     viewSet.insert(output);
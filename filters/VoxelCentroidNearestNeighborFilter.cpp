@@ -34,15 +34,13 @@
 
 #include "VoxelCentroidNearestNeighborFilter.hpp"
 
-#include <map>
+#include <pdal/private/VoxelGrid.hpp>
+
+#include <algorithm>
 #include <string>
 #include <tuple>
 #include <vector>
 
-#include <Eigen/Dense>
-
-#include <pdal/private/MathUtils.hpp>
-
 namespace pdal
 {
 
@@ -67,95 +65,48 @@ void VoxelCentroidNearestNeighborFilter::addArgs(ProgramArgs& args)
 
 PointViewSet VoxelCentroidNearestNeighborFilter::run(PointViewPtr view)
 {
+    PointViewPtr output = view->makeNew();
+    PointViewSet viewSet;
+    viewSet.insert(output);
+    if (view->empty())
+        return viewSet;
+
     double x0 = view->getFieldAs<double>(Dimension::Id::X, 0);
     double y0 = view->getFieldAs<double>(Dimension::Id::Y, 0);
     double z0 = view->getFieldAs<double>(Dimension::Id::Z, 0);
 
-    // Make an initial pass through the input PointView to index PointIds by
-    // row, column, and depth.
-    std::map<std::tuple<size_t, size_t, size_t>, PointIdList>
-        populated_voxel_ids;
-    for (PointId id = 0; id < view->size(); ++id)
-    {
-        double y = view->getFieldAs<double>(Dimension::Id::Y, id);
-        double x = view->getFieldAs<double>(Dimension::Id::X, id);
-        double z = view->getFieldAs<double>(Dimension::Id::Z, id);
-        size_t r = static_cast<size_t>((y - y0) / m_cell);
-        size_t c = static_cast<size_t>((x - x0) / m_cell);
-        size_t d = static_cast<size_t>((z - z0) / m_cell);
-        populated_voxel_ids[std::make_tuple(r, c, d)].push_back(id);
-    }
+    // Make a pass through the input PointView to assign points to voxels
+    // and compute the voxel centroids and the points nearest them.
+    VoxelGrid grid(m_cell, x0, y0, z0,
+        VoxelGrid::Center | VoxelGrid::Centroid);
+    grid.build(*view);
 
-    // Make a second pass through the populated voxels to compute the voxel
-    // centroid and to find its nearest neighbor.
-    PointViewPtr output = view->makeNew();
-    for (auto const& t : populated_voxel_ids)
+    std::vector<size_t> voxels(grid.size());
+    for (size_t v = 0; v < voxels.size(); ++v)
+        voxels[v] = v;
+    auto rcd = [&grid](size_t v)
     {
-        if (t.second.size() == 1)
-        {
-            // If there is only one point in the voxel, simply append it.
-            output->appendPoint(*view, t.second[0]);
-        }
-        else if (t.second.size() == 2)
-        {
-            // Else if there are only two, they are equidistant to the
-            // centroid, so append the one closest to voxel center.
-
-            // Compute voxel center.
-            double y_center = y0 + (std::get<0>(t.first) + 0.5) * m_cell;
-            double x_center = x0 + (std::get<1>(t.first) + 0.5) * m_cell;
-            double z_center = z0 + (std::get<2>(t.first) + 0.5) * m_cell;
-
-            // Compute distance from first point to voxel center.
-            double x1 = view->getFieldAs<double>(Dimension::Id::X, t.second[0]);
-            double y1 = view->getFieldAs<double>(Dimension::Id::Y, t.second[0]);
-            double z1 = view->getFieldAs<double>(Dimension::Id::Z, t.second[0]);
-            double d1 = pow(x_center - x1, 2) + pow(y_center - y1, 2) + pow(z_center - z1, 2);
-
-            // Compute distance from second point to voxel center.
-            double x2 = view->getFieldAs<double>(Dimension::Id::X, t.second[1]);
-            double y2 = view->getFieldAs<double>(Dimension::Id::Y, t.second[1]);
-            double z2 = view->getFieldAs<double>(Dimension::Id::Z, t.second[1]);
-            double d2 = pow(x_center - x2, 2) + pow(y_center - y2, 2) + pow(z_center - z2, 2);
-
-            // Append the closer of the two.
-            if (d1 < d2)
-                output->appendPoint(*view, t.second[0]);
-            else
-                output->appendPoint(*view, t.second[1]);
-        }
+        int32_t c, r, d;
+        grid.index(v, c, r, d);
+        return std::make_tuple(r, c, d);
+    };
+    std::sort(voxels.begin(), voxels.end(),
+        [&rcd](size_t a, size_t b){ return rcd(a) < rcd(b); });
+
+    for (size_t v : voxels)
+    {
+        // If there is only one point in the voxel, simply append it.
+        // If there are only two, they are equidistant to the centroid, so
+        // append the one closest to voxel center.  Otherwise choose the
+        // one closest to the centroid.
+        if (grid.count(v) == 1)
+            output->appendPoint(*view, grid.first(v));
+        else if (grid.count(v) == 2)
+            output->appendPoint(*view, grid.nearestCenter(v));
         else
-        {
-            // Else there are more than two neighbors, so choose the one
-            // closest to the centroid.
-
-            // Compute the centroid.
-            Eigen::Vector3d centroid = math::computeCentroid(*view, t.second);
-
-            // Compute distance from each point in the voxel to the centroid,
-            // retaining only the closest.
-            PointId pmin;
-            double dmin((std::numeric_limits<double>::max)());
-            for (auto const& p : t.second)
-            {
-                double x = view->getFieldAs<double>(Dimension::Id::X, p);
-                double y = view->getFieldAs<double>(Dimension::Id::Y, p);
-                double z = view->getFieldAs<double>(Dimension::Id::Z, p);
-                double sqr_dist = pow(centroid.x() - x, 2) +
-                                  pow(centroid.y() - y, 2) +
-                                  pow(centroid.z() - z, 2);
-                if (sqr_dist < dmin)
-                {
-                    dmin = sqr_dist;
-                    pmin = p;
-                }
-            }
-            output->appendPoint(*view, pmin);
-        }
+            output->appendPoint(*view, grid.nearestCentroid(v));
     }
 
-    PointViewSet viewSet;
-    viewSet.insert(output);
     return viewSet;
 }
 
@@ -36,6 +36,8 @@
 
 #include "VoxelDownsizeFilter.hpp"
 
+#include <pdal/private/VoxelGrid.hpp>
+
 namespace pdal
 {
 
@@ -81,7 +83,12 @@ std::ostream& operator<<(std::ostream& out,
 }
 
 
-VoxelDownsizeFilter::VoxelDownsizeFilter()
+VoxelDownsizeFilter::VoxelDownsizeFilter() :
+    m_populatedVoxels(new VoxelHash)
+{}
+
+
+VoxelDownsizeFilter::~VoxelDownsizeFilter()
 {}
 
 
@@ -99,18 +106,44 @@ void VoxelDownsizeFilter::addArgs(ProgramArgs& args)
 
 
 void VoxelDownsizeFilter::ready(PointTableRef)
-{ m_populatedVoxels.clear(); }
+{ m_populatedVoxels->clear(); }
 
 
 PointViewSet VoxelDownsizeFilter::run(PointViewPtr view)
 {
+    using namespace Dimension;
+
     PointViewPtr output = view->makeNew();
-    PointRef point(*view);
-    for (PointId id = 0; id < view->size(); ++id)
+    if (view->empty())
     {
-        point.setPointId(id);
-        if (voxelize(point))
-            output->appendPoint(*view, id);
+        PointViewSet viewSet;
+        viewSet.insert(output);
+        return viewSet;
+    }
+    if (m_populatedVoxels->empty())
+        setOrigin(view->point(0));
+
+    // Find the first point in each voxel of the view, in parallel.  Voxels
+    // populated by earlier views are skipped, as when streaming.
+    VoxelGrid grid(m_cell, m_originX, m_originY, m_originZ);
+    grid.build(*view);
+    for (size_t v = 0; v < grid.size(); ++v)
+    {
+        int32_t i, j, k;
+        grid.index(v, i, j, k);
+        if (!m_populatedVoxels->insert(i, j, k).second)
+            continue;
+
+        PointId id = output->size();
+        output->appendPoint(*view, grid.first(v));
+        if (m_mode == Mode::Center)
+        {
+            double x, y, z;
+            grid.center(v, x, y, z);
+            output->setField(Id::X, id, x);
+            output->setField(Id::Y, id, y);
+            output->setField(Id::Z, id, z);
+        }
     }
 
     PointViewSet viewSet;
@@ -119,43 +152,53 @@ PointViewSet VoxelDownsizeFilter::run(PointViewPtr view)
 }
 
 
+void VoxelDownsizeFilter::setOrigin(const PointRef& point)
+{
+    // Center the voxel grid on the first point.
+    m_originX = point.getFieldAs<double>(Dimension::Id::X) - (m_cell / 2);
+    m_originY = point.getFieldAs<double>(Dimension::Id::Y) - (m_cell / 2);
+    m_originZ = point.getFieldAs<double>(Dimension::Id::Z) - (m_cell / 2);
+}
+
+
 bool VoxelDownsizeFilter::voxelize(PointRef& point)
 {
     /*
      * Calculate the voxel coordinates for the incoming point.
      * gx, gy, gz will be the global coordinates from (0, 0, 0).
      */
-    double x = point.getFieldAs<double>(Dimension::Id::X);
-    double y = point.getFieldAs<double>(Dimension::Id::Y);
-    double z = point.getFieldAs<double>(Dimension::Id::Z);
-    if (m_populatedVoxels.empty())
-    {
-        m_originX = x - (m_cell / 2);
-        m_originY = y - (m_cell / 2);
-        m_originZ = z - (m_cell / 2);
-    }
+    if (m_populatedVoxels->empty())
+        setOrigin(point);
 
     // Offset by origin.
-    x -= m_originX;
-    y -= m_originY;
-    z -= m_originZ;
+    double x = point.getFieldAs<double>(Dimension::Id::X) - m_originX;
+    double y = point.getFieldAs<double>(Dimension::Id::Y) - m_originY;
+    double z = point.getFieldAs<double>(Dimension::Id::Z) - m_originZ;
 
-    Voxel v = std::make_tuple((int)(std::floor(x / m_cell)),
-        (int)(std::floor(y / m_cell)), (int)(std::floor(z / m_cell)));
+    int32_t gx = voxelIndex(x);
+    int32_t gy = voxelIndex(y);
+    int32_t gz = voxelIndex(z);
 
-    auto inserted = m_populatedVoxels.insert(v).second;
+    auto inserted = m_populatedVoxels->insert(gx, gy, gz).second;
     if ((m_mode == Mode::Center) && inserted)
     {
-        point.setField(Dimension::Id::X,
-            (std::get<0>(v) + 0.5) * m_cell + m_originX);
-        point.setField(Dimension::Id::Y,
-            (std::get<1>(v) + 0.5) * m_cell + m_originY);
-        point.setField(Dimension::Id::Z,
-            (std::get<2>(v) + 0.5) * m_cell + m_originZ);
+        point.setField(Dimension::Id::X, (gx + 0.5) * m_cell + m_originX);
+        point.setField(Dimension::Id::Y, (gy + 0.5) * m_cell + m_originY);
+        point.setField(Dimension::Id::Z, (gz + 0.5) * m_cell + m_originZ);
     }
     return inserted;
 }
 
+
+int32_t VoxelDownsizeFilter::voxelIndex(double offset) const
+{
+    double c = std::floor(offset / m_cell);
+    if (!(c >= (std::numeric_limits<int32_t>::lowest)() &&
+        c <= (std::numeric_limits<int32_t>::max)()))
+        throwError("Voxel index out of range.  Increase the cell size.");
+    return (int32_t)c;
+}
+
 bool VoxelDownsizeFilter::processOne(PointRef& point)
 {
     return voxelize(point);
@@ -44,10 +44,10 @@ namespace pdal
 
 class PointLayout;
 class PointView;
+class VoxelHash;
 
 class PDAL_DLL VoxelDownsizeFilter : public Filter, public Streamable
 {
-    using Voxel = std::tuple<int, int, int>;
     enum class Mode
     {
         First,
@@ -55,6 +55,7 @@ class PDAL_DLL VoxelDownsizeFilter : public Filter, public Streamable
     };
 public:
     VoxelDownsizeFilter();
+    ~VoxelDownsizeFilter();
     VoxelDownsizeFilter& operator=(const VoxelDownsizeFilter&) = delete;
     VoxelDownsizeFilter(const VoxelDownsizeFilter&) = delete;
 
@@ -67,12 +68,14 @@ private:
     virtual bool processOne(PointRef& point) override;
 
     bool voxelize(PointRef& point);
+    void setOrigin(const PointRef& point);
+    int32_t voxelIndex(double offset) const;
 
     double m_cell;
     double m_originX;
     double m_originY;
     double m_originZ;
-    std::set<Voxel> m_populatedVoxels;
+    std::unique_ptr<VoxelHash> m_populatedVoxels;
     Mode m_mode;
 
     friend std::istream& operator>>(std::istream& in,
@@ -38,10 +38,13 @@
 #include <pdal/PointView.hpp>
 #include <pdal/Stage.hpp>
 #include <pdal/pdal_types.hpp>
+#include <pdal/private/DisjointSets.hpp>
+#include <pdal/private/NeighborGrid.hpp>
 
 #include "DimRange.hpp"
 #include "Segmentation.hpp"
 
+#include <limits>
 #include <vector>
 
 namespace pdal
@@ -88,6 +91,71 @@ std::ostream& operator<<(std::ostream& out, const PointClasses& classes)
     return out;
 }
 
+std::deque<PointIdList> extractClusters(PointView& view,
+    const Dimension::IdList& dims, uint64_t min_points, uint64_t max_points,
+    double tolerance)
+{
+    const point_count_t count = view.size();
+
+    // Join each point to the neighbors before it.  With no tolerance, no
+    // point has any neighbors.
+    DisjointSets sets(count);
+    if (tolerance > 0)
+    {
+        NeighborGrid grid(view, dims, tolerance);
+        grid.build();
+        grid.forEachCell([&grid, &sets](size_t cell,
+            const std::vector<uint32_t>& adjacent)
+        {
+            for (size_t s = grid.begin(cell); s < grid.end(cell); ++s)
+            {
+                const PointId id = grid.id(s);
+                grid.findNeighbors(s, adjacent, [&grid, &sets, id](size_t n)
+                {
+                    if (grid.id(n) < id)
+                        sets.unite(id, grid.id(n));
+                    return false;
+                });
+            }
+        });
+    }
+
+    // The root of each cluster is its first point, so clusters are listed
+    // in the same order as when they're grown from each unclustered point
+    // in turn.
+    std::vector<PointId> roots(count);
+    std::vector<point_count_t> sizes(count);
+    for (PointId id = 0; id < count; ++id)
+    {
+        roots[id] = sets.find(id);
+        sizes[roots[id]]++;
+    }
+
+    // Once a root is reached, its size is replaced by the position of its
+    // cluster in the list.
+    const point_count_t Rejected = (std::numeric_limits<point_count_t>::max)();
+    std::deque<PointIdList> clusters;
+    for (PointId id = 0; id < count; ++id)
+    {
+        const PointId root = roots[id];
+        if (root == id)
+        {
+            const point_count_t size = sizes[id];
+            if (size >= min_points && size <= max_points)
+            {
+                sizes[id] = clusters.size();
+                clusters.emplace_back();
+                clusters.back().reserve(size);
+            }
+            else
+                sizes[id] = Rejected;
+        }
+        if (sizes[root] != Rejected)
+            clusters[sizes[root]].push_back(id);
+    }
+    return clusters;
+}
+
 void ignoreDimRange(DimRange dr, PointViewPtr input, PointViewPtr keep,
                     PointViewPtr ignore)
 {
@@ -36,6 +36,7 @@
 
 #include <pdal/pdal_export.hpp>
 #include <pdal/pdal_types.hpp>
+#include <pdal/Dimension.hpp>
 
 #include "DimRange.hpp"
 
@@ -154,6 +155,26 @@ PDAL_DLL std::deque<PointIdList> extractClusters(PointView& view, uint64_t min_p
     return clusters;
 }
 
+/**
+  Extract clusters of points from input PointView.
+
+  Finds the same clusters as the KD index version of extractClusters(),
+  in the same order, but joins neighboring points with a union-find
+  rather than growing one cluster at a time.  Neighbors are found with a
+  grid of cells and the work is spread across threads.  The points of
+  each cluster are in ascending order.
+
+  \param[in] view the input PointView.
+  \param[in] dims the dimensions used to compute distances.
+  \param[in] min_points the minimum number of points in a cluster.
+  \param[in] max_points the maximum number of points in a cluster.
+  \param[in] tolerance the tolerance for adding points to a cluster.
+  \returns a deque of clusters (themselves vectors of PointIds).
+*/
+PDAL_DLL std::deque<PointIdList> extractClusters(PointView& view,
+    const Dimension::IdList& dims, uint64_t min_points, uint64_t max_points,
+    double tolerance);
+
 PDAL_DLL void ignoreDimRange(DimRange dr, PointViewPtr input, PointViewPtr keep,
                              PointViewPtr ignore);
 PDAL_DLL void ignoreDimRanges(std::vector<DimRange>& ranges,
@@ -7,6 +7,7 @@ namespace expr
 
 Utils::StatusWithReason ConditionalExpression::prepare(PointLayoutPtr layout)
 {
+    m_program.clear();
     Node *top = topNode();
     if (top)
     {
@@ -28,6 +29,8 @@ Utils::StatusWithReason ConditionalExpression::prepare(PointLayoutPtr layout)
                 }
             }
         }
+        if (status)
+            m_program.compile(*top);
         return status;
     }
     return true;
@@ -35,10 +38,45 @@ Utils::StatusWithReason ConditionalExpression::prepare(PointLayoutPtr layout)
 
 bool ConditionalExpression::eval(PointRef& p) const
 {
+    if (m_program.compiled())
+        return m_program.eval(p) != 0;
     const Node *n = topNode();
     return n ? n->eval(p).m_bval : true;
 }
 
+// Evaluate the expression for a run of points.  A point passes if its
+// result is non-zero.
+void ConditionalExpression::eval(PointView& v, PointId begin,
+    point_count_t count, std::vector<double>& results) const
+{
+    if (m_program.compiled())
+    {
+        results.resize(count);
+        m_program.eval(v, begin, count, results.data());
+    }
+    else
+        eval((PointContainer&)v, begin, count, results);
+}
+
+// Evaluate the expression for a run of points that are read one at a
+// time, as from a streaming point table.
+void ConditionalExpression::eval(PointContainer& c, PointId begin,
+    point_count_t count, std::vector<double>& results) const
+{
+    results.resize(count);
+    if (m_program.compiled())
+        m_program.eval(c, begin, count, results.data());
+    else
+    {
+        PointRef p(c, begin);
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            p.setPointId(begin + i);
+            results[i] = eval(p) ? 1 : 0;
+        }
+    }
+}
+
 } // namespace expr
 } // namespace pdal
 
@@ -2,6 +2,7 @@
 
 #include "Expression.hpp"
 #include "Lexer.hpp"
+#include "Program.hpp"
 #include "ConditionalParser.hpp"
 
 namespace pdal
@@ -14,6 +15,13 @@ class ConditionalExpression : public Expression
 public:
     Utils::StatusWithReason prepare(PointLayoutPtr layout);
     bool eval(PointRef& p) const;
+    void eval(PointView& v, PointId begin, point_count_t count,
+        std::vector<double>& results) const;
+    void eval(PointContainer& c, PointId begin, point_count_t count,
+        std::vector<double>& results) const;
+
+private:
+    Program m_program;
 };
 
 } // namespace expr
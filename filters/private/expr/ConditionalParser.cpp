@@ -285,7 +285,7 @@ bool ConditionalParser::uminus(Expression& expr)
     }
     else
     {
-        if (node->isBool())
+        if (sub->isBool())
         {
             setError("Can't apply '-' to logical expression '" +
                 sub->print() + "'.");
@@ -1,4 +1,5 @@
 #include "Expression.hpp"
+#include "Program.hpp"
 
 namespace pdal
 {
@@ -37,6 +38,11 @@ Result NotNode::eval(PointRef& p) const
     return !(m_sub->eval(p).m_bval);
 }
 
+Operand NotNode::compile(Program& prog) const
+{
+    return prog.unary(type(), m_sub->compile(prog));
+}
+
 
 //
 // UnMathNode
@@ -60,6 +66,11 @@ Result UnMathNode::eval(PointRef& p) const
     return -(m_sub->eval(p).m_dval);
 }
 
+Operand UnMathNode::compile(Program& prog) const
+{
+    return prog.unary(type(), m_sub->compile(prog));
+}
+
 
 //
 // BinMathNode
@@ -125,6 +136,13 @@ Result BinMathNode::eval(PointRef& p) const
     return 0.0;
 }
 
+Operand BinMathNode::compile(Program& prog) const
+{
+    Operand l = m_left->compile(prog);
+    Operand r = m_right->compile(prog);
+    return prog.binary(type(), l, r);
+}
+
 //
 // Bool node
 //
@@ -176,6 +194,13 @@ Result BoolNode::eval(PointRef& p) const
 
 }
 
+Operand BoolNode::compile(Program& prog) const
+{
+    Operand l = m_left->compile(prog);
+    Operand r = m_right->compile(prog);
+    return prog.binary(type(), l, r);
+}
+
 //
 // CompareNode
 //
@@ -245,6 +270,13 @@ Result CompareNode::eval(PointRef& p) const
     return false;
 }
 
+Operand CompareNode::compile(Program& prog) const
+{
+    Operand l = m_left->compile(prog);
+    Operand r = m_right->compile(prog);
+    return prog.binary(type(), l, r);
+}
+
 //
 // ConstValueNode
 //
@@ -267,6 +299,11 @@ Result ConstValueNode::eval(PointRef&) const
     return m_val;
 }
 
+Operand ConstValueNode::compile(Program&) const
+{
+    return Operand::constant(m_val);
+}
+
 double ConstValueNode::value() const
 {
     return m_val;
@@ -295,6 +332,11 @@ Result ConstLogicalNode::eval(PointRef&) const
     return m_val;
 }
 
+Operand ConstLogicalNode::compile(Program&) const
+{
+    return Operand::constant(m_val ? 1.0 : 0.0);
+}
+
 bool ConstLogicalNode::value() const
 {
     return m_val;
@@ -322,6 +364,11 @@ Dimension::Id VarNode::eval() const
     return m_id;
 }
 
+Operand VarNode::compile(Program& prog) const
+{
+    return prog.load(m_id);
+}
+
 Utils::StatusWithReason VarNode::prepare(PointLayoutPtr l)
 {
     m_id = l->findDim(m_name);
@@ -54,6 +54,45 @@ struct Result
     Type m_type;
 };
 
+class Program;
+
+/**
+  An operand of a compiled expression.  An operand is either a register
+  holding the result of an earlier instruction or a constant.  Logical
+  values are represented as 1 (true) and 0 (false).
+*/
+struct Operand
+{
+    Operand() : m_reg(-1), m_val(0)
+    {}
+
+    static Operand reg(int r)
+    {
+        Operand op;
+        op.m_reg = r;
+        return op;
+    }
+
+    static Operand constant(double d)
+    {
+        Operand op;
+        op.m_val = d;
+        return op;
+    }
+
+    bool isConst() const
+    { return m_reg < 0; }
+
+    bool operator==(const Operand& other) const
+    {
+        return m_reg == other.m_reg &&
+            (m_reg >= 0 || m_val == other.m_val);
+    }
+
+    int m_reg;
+    double m_val;
+};
+
 class Node
 {
 protected:
@@ -66,6 +105,7 @@ public:
     virtual std::string print() const = 0;
     virtual Utils::StatusWithReason prepare(PointLayoutPtr l) = 0;
     virtual Result eval(PointRef& p) const = 0;
+    virtual Operand compile(Program& prog) const = 0;
     virtual bool isBool() const = 0;
     virtual bool isValue() const
     { return !isBool(); }
@@ -107,6 +147,7 @@ public:
     virtual std::string print() const;
     virtual Utils::StatusWithReason prepare(PointLayoutPtr l);
     virtual Result eval(PointRef& p) const;
+    virtual Operand compile(Program& prog) const;
 
 private:
     NodePtr m_left;
@@ -121,6 +162,7 @@ public:
     virtual std::string print() const;
     virtual Utils::StatusWithReason prepare(PointLayoutPtr l);
     virtual Result eval(PointRef& p) const;
+    virtual Operand compile(Program& prog) const;
 
 private:
     NodePtr m_sub;
@@ -134,6 +176,7 @@ public:
     virtual std::string print() const;
     virtual Utils::StatusWithReason prepare(PointLayoutPtr l);
     virtual Result eval(PointRef& p) const;
+    virtual Operand compile(Program& prog) const;
 
 private:
     NodePtr m_sub;
@@ -147,6 +190,7 @@ public:
     virtual std::string print() const;
     virtual Utils::StatusWithReason prepare(PointLayoutPtr l);
     virtual Result eval(PointRef& p) const;
+    virtual Operand compile(Program& prog) const;
 
 private:
     NodePtr m_left;
@@ -161,6 +205,7 @@ public:
     virtual std::string print() const;
     virtual Utils::StatusWithReason prepare(PointLayoutPtr l);
     virtual Result eval(PointRef& p) const;
+    virtual Operand compile(Program& prog) const;
 
 private:
     NodePtr m_left;
@@ -175,6 +220,7 @@ public:
     virtual std::string print() const;
     virtual Utils::StatusWithReason prepare(PointLayoutPtr l);
     virtual Result eval(PointRef&) const;
+    virtual Operand compile(Program& prog) const;
 
     double value() const;
 
@@ -190,6 +236,7 @@ public:
     virtual std::string print() const;
     virtual Utils::StatusWithReason prepare(PointLayoutPtr l);
     virtual Result eval(PointRef&) const;
+    virtual Operand compile(Program& prog) const;
 
     bool value() const;
 
@@ -205,6 +252,7 @@ public:
     virtual std::string print() const;
     virtual Utils::StatusWithReason prepare(PointLayoutPtr l);
     virtual Result eval(PointRef& p) const;
+    virtual Operand compile(Program& prog) const;
     Dimension::Id eval() const;
 
 private:
@@ -7,6 +7,7 @@ namespace expr
 
 Utils::StatusWithReason MathExpression::prepare(PointLayoutPtr layout)
 {
+    m_program.clear();
     Node *top = topNode();
     if (top)
     {
@@ -16,6 +17,8 @@ Utils::StatusWithReason MathExpression::prepare(PointLayoutPtr layout)
             if (!top->isValue())
                 status = { -1, "Expression doesn't evaluate to a value." };
         }
+        if (status)
+            m_program.compile(*top);
         return status;
     }
     return true;
@@ -23,10 +26,43 @@ Utils::StatusWithReason MathExpression::prepare(PointLayoutPtr layout)
 
 double MathExpression::eval(PointRef& p) const
 {
+    if (m_program.compiled())
+        return m_program.eval(p);
     const Node *n = topNode();
     return n ? n->eval(p).m_dval : 0;
 }
 
+void MathExpression::eval(PointView& v, PointId begin, point_count_t count,
+    std::vector<double>& results) const
+{
+    if (m_program.compiled())
+    {
+        results.resize(count);
+        m_program.eval(v, begin, count, results.data());
+    }
+    else
+        eval((PointContainer&)v, begin, count, results);
+}
+
+// Evaluate the expression for a run of points that are read one at a
+// time, as from a streaming point table.
+void MathExpression::eval(PointContainer& c, PointId begin,
+    point_count_t count, std::vector<double>& results) const
+{
+    results.resize(count);
+    if (m_program.compiled())
+        m_program.eval(c, begin, count, results.data());
+    else
+    {
+        PointRef p(c, begin);
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            p.setPointId(begin + i);
+            results[i] = eval(p);
+        }
+    }
+}
+
 } // namespace expr
 } // namespace pdal
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Expression.hpp"
+#include "Program.hpp"
 
 namespace pdal
 {
@@ -12,6 +13,13 @@ class MathExpression : public Expression
 public:
     Utils::StatusWithReason prepare(PointLayoutPtr layout);
     double eval(PointRef& p) const;
+    void eval(PointView& v, PointId begin, point_count_t count,
+        std::vector<double>& results) const;
+    void eval(PointContainer& c, PointId begin, point_count_t count,
+        std::vector<double>& results) const;
+
+private:
+    Program m_program;
 };
 
 } // namespace expr
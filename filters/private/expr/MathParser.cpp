@@ -137,7 +137,7 @@ bool MathParser::uminus(Expression& expr)
     }
     else
     {
-        if (node->isBool())
+        if (sub->isBool())
         {
             setError("Can't apply '-' to logical expression '" +
                 sub->print() + "'.");
@@ -0,0 +1,543 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#include "Program.hpp"
+
+namespace pdal
+{
+namespace expr
+{
+
+namespace
+{
+
+// Each operation is a functor so that the block loops below can be
+// instantiated (and vectorized) for each operation.
+
+struct AddOp
+{
+    double operator()(double l, double r) const
+        { return l + r; }
+};
+
+struct SubtractOp
+{
+    double operator()(double l, double r) const
+        { return l - r; }
+};
+
+struct MultiplyOp
+{
+    double operator()(double l, double r) const
+        { return l * r; }
+};
+
+struct DivideOp
+{
+    double operator()(double l, double r) const
+    {
+        return r == 0 ? std::numeric_limits<double>::quiet_NaN() : l / r;
+    }
+};
+
+struct AndOp
+{
+    double operator()(double l, double r) const
+        { return (double)((l != 0) & (r != 0)); }
+};
+
+struct OrOp
+{
+    double operator()(double l, double r) const
+        { return (double)((l != 0) | (r != 0)); }
+};
+
+struct EqualOp
+{
+    double operator()(double l, double r) const
+        { return (double)(l == r); }
+};
+
+struct NotEqualOp
+{
+    double operator()(double l, double r) const
+        { return (double)(l != r); }
+};
+
+struct GreaterOp
+{
+    double operator()(double l, double r) const
+        { return (double)(l > r); }
+};
+
+struct GreaterEqualOp
+{
+    double operator()(double l, double r) const
+        { return (double)(l >= r); }
+};
+
+struct LessOp
+{
+    double operator()(double l, double r) const
+        { return (double)(l < r); }
+};
+
+struct LessEqualOp
+{
+    double operator()(double l, double r) const
+        { return (double)(l <= r); }
+};
+
+double applyUnary(NodeType op, double v)
+{
+    if (op == NodeType::Not)
+        return (double)(v == 0);
+    return -v;
+}
+
+double apply(NodeType op, double l, double r)
+{
+    switch (op)
+    {
+    case NodeType::Add:
+        return AddOp()(l, r);
+    case NodeType::Subtract:
+        return SubtractOp()(l, r);
+    case NodeType::Multiply:
+        return MultiplyOp()(l, r);
+    case NodeType::Divide:
+        return DivideOp()(l, r);
+    case NodeType::And:
+        return AndOp()(l, r);
+    case NodeType::Or:
+        return OrOp()(l, r);
+    case NodeType::Equal:
+        return EqualOp()(l, r);
+    case NodeType::NotEqual:
+        return NotEqualOp()(l, r);
+    case NodeType::Greater:
+        return GreaterOp()(l, r);
+    case NodeType::GreaterEqual:
+        return GreaterEqualOp()(l, r);
+    case NodeType::Less:
+        return LessOp()(l, r);
+    case NodeType::LessEqual:
+        return LessEqualOp()(l, r);
+    default:
+        break;
+    }
+    assert(false);
+    return 0.0;
+}
+
+template<typename OP>
+void blockBinary(const double *l, double lval, const double *r, double rval,
+    point_count_t count, double *out)
+{
+    OP op;
+    if (!l)
+        for (point_count_t i = 0; i < count; ++i)
+            out[i] = op(lval, r[i]);
+    else if (!r)
+        for (point_count_t i = 0; i < count; ++i)
+            out[i] = op(l[i], rval);
+    else
+        for (point_count_t i = 0; i < count; ++i)
+            out[i] = op(l[i], r[i]);
+}
+
+void blockApply(NodeType op, const double *l, double lval,
+    const double *r, double rval, point_count_t count, double *out)
+{
+    switch (op)
+    {
+    case NodeType::Add:
+        blockBinary<AddOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::Subtract:
+        blockBinary<SubtractOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::Multiply:
+        blockBinary<MultiplyOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::Divide:
+        blockBinary<DivideOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::And:
+        blockBinary<AndOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::Or:
+        blockBinary<OrOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::Equal:
+        blockBinary<EqualOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::NotEqual:
+        blockBinary<NotEqualOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::Greater:
+        blockBinary<GreaterOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::GreaterEqual:
+        blockBinary<GreaterEqualOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::Less:
+        blockBinary<LessOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::LessEqual:
+        blockBinary<LessEqualOp>(l, lval, r, rval, count, out);
+        break;
+    case NodeType::Not:
+        for (point_count_t i = 0; i < count; ++i)
+            out[i] = (double)(l[i] == 0);
+        break;
+    case NodeType::Negative:
+        for (point_count_t i = 0; i < count; ++i)
+            out[i] = -l[i];
+        break;
+    default:
+        assert(false);
+        break;
+    }
+}
+
+bool commutes(NodeType op)
+{
+    return op == NodeType::Add || op == NodeType::Multiply ||
+        op == NodeType::And || op == NodeType::Or ||
+        op == NodeType::Equal || op == NodeType::NotEqual;
+}
+
+// Comparison that gives the same result with its operands swapped.
+NodeType mirror(NodeType op)
+{
+    switch (op)
+    {
+    case NodeType::Greater:
+        return NodeType::Less;
+    case NodeType::GreaterEqual:
+        return NodeType::LessEqual;
+    case NodeType::Less:
+        return NodeType::Greater;
+    case NodeType::LessEqual:
+        return NodeType::GreaterEqual;
+    default:
+        break;
+    }
+    return op;
+}
+
+} // unnamed namespace
+
+const point_count_t Program::BlockSize;
+
+Program::Program() : m_compiled(false), m_loads(0)
+{}
+
+void Program::clear()
+{
+    m_code.clear();
+    m_result = Operand();
+    m_compiled = false;
+    m_loads = 0;
+}
+
+void Program::compile(const Node& root)
+{
+    clear();
+    m_result = root.compile(*this);
+    prune();
+
+    m_loads = 0;
+    for (const Instruction& inst : m_code)
+        if (inst.m_op == NodeType::Identifier)
+            m_loads++;
+    m_compiled = true;
+}
+
+// Remove instructions whose results aren't used.  Simplifications made
+// as the program is built can leave them behind.
+void Program::prune()
+{
+    std::vector<int> regs(m_code.size(), -1);
+    if (!m_result.isConst())
+        regs[m_result.m_reg] = 0;
+    for (size_t i = m_code.size(); i-- > 0;)
+    {
+        if (regs[i] < 0)
+            continue;
+        const Instruction& inst = m_code[i];
+        if (!inst.m_left.isConst())
+            regs[inst.m_left.m_reg] = 0;
+        if (!inst.m_right.isConst())
+            regs[inst.m_right.m_reg] = 0;
+    }
+
+    // Operands always refer to earlier instructions, so they're renumbered
+    // before they're used.
+    size_t count = 0;
+    for (size_t i = 0; i < m_code.size(); ++i)
+    {
+        if (regs[i] < 0)
+            continue;
+        Instruction inst = m_code[i];
+        if (!inst.m_left.isConst())
+            inst.m_left.m_reg = regs[inst.m_left.m_reg];
+        if (!inst.m_right.isConst())
+            inst.m_right.m_reg = regs[inst.m_right.m_reg];
+        regs[i] = (int)count;
+        m_code[count++] = inst;
+    }
+    m_code.resize(count);
+    if (!m_result.isConst())
+        m_result.m_reg = regs[m_result.m_reg];
+}
+
+Operand Program::emit(const Instruction& inst)
+{
+    // Reuse the register of an identical instruction, if there is one.
+    for (size_t i = 0; i < m_code.size(); ++i)
+    {
+        const Instruction& c = m_code[i];
+        if (c.m_op == inst.m_op && c.m_dim == inst.m_dim &&
+                c.m_left == inst.m_left && c.m_right == inst.m_right)
+            return Operand::reg((int)i);
+    }
+    m_code.push_back(inst);
+    return Operand::reg((int)m_code.size() - 1);
+}
+
+Operand Program::load(Dimension::Id dim)
+{
+    Instruction inst { NodeType::Identifier, dim, Operand(), Operand() };
+    return emit(inst);
+}
+
+Operand Program::unary(NodeType op, Operand sub)
+{
+    if (sub.isConst())
+        return Operand::constant(applyUnary(op, sub.m_val));
+
+    // Negation and logical not undo themselves.
+    const Instruction& prev = m_code[sub.m_reg];
+    if (prev.m_op == op)
+        return prev.m_left;
+
+    Instruction inst { op, Dimension::Id::Unknown, sub, Operand() };
+    return emit(inst);
+}
+
+Operand Program::binary(NodeType op, Operand left, Operand right)
+{
+    if (left.isConst() && right.isConst())
+        return Operand::constant(apply(op, left.m_val, right.m_val));
+
+    // Put operands in a canonical order so that equivalent
+    // subexpressions are found: constants on the right, lower registers
+    // on the left.
+    if (left.isConst() || (!right.isConst() && right.m_reg < left.m_reg))
+    {
+        if (commutes(op))
+            std::swap(left, right);
+        else if (mirror(op) != op)
+        {
+            std::swap(left, right);
+            op = mirror(op);
+        }
+    }
+
+    // Identities.  Logical operands are always 0 or 1, so the register
+    // of a logical operand can stand in for the result.
+    if (right.isConst())
+    {
+        double v = right.m_val;
+        switch (op)
+        {
+        case NodeType::And:
+            return v ? left : Operand::constant(0);
+        case NodeType::Or:
+            return v ? Operand::constant(1) : left;
+        case NodeType::Add:
+        case NodeType::Subtract:
+            if (v == 0)
+                return left;
+            break;
+        case NodeType::Multiply:
+        case NodeType::Divide:
+            if (v == 1)
+                return left;
+            break;
+        default:
+            break;
+        }
+    }
+
+    Instruction inst { op, Dimension::Id::Unknown, left, right };
+    return emit(inst);
+}
+
+double Program::eval(PointRef& p) const
+{
+    if (m_result.isConst())
+        return m_result.m_val;
+
+    // Each register gets a value.  The scratch space is local so that
+    // the program can be evaluated by several threads at once.  Most
+    // programs are short enough that it fits on the stack.
+    const size_t StackRegs = 64;
+    double stackValues[StackRegs];
+    std::vector<double> heapValues;
+    double *values = stackValues;
+    if (m_code.size() > StackRegs)
+    {
+        heapValues.resize(m_code.size());
+        values = heapValues.data();
+    }
+
+    for (size_t i = 0; i < m_code.size(); ++i)
+    {
+        const Instruction& inst = m_code[i];
+        const Operand& l = inst.m_left;
+        const Operand& r = inst.m_right;
+        double lval = l.isConst() ? l.m_val : values[l.m_reg];
+        double rval = r.isConst() ? r.m_val : values[r.m_reg];
+
+        switch (inst.m_op)
+        {
+        case NodeType::Identifier:
+            values[i] = p.getFieldAs<double>(inst.m_dim);
+            break;
+        case NodeType::Not:
+        case NodeType::Negative:
+            values[i] = applyUnary(inst.m_op, lval);
+            break;
+        default:
+            values[i] = apply(inst.m_op, lval, rval);
+            break;
+        }
+    }
+    return values[m_result.m_reg];
+}
+
+void Program::eval(PointView& view, PointId begin, point_count_t count,
+    double *out) const
+{
+    if (m_result.isConst())
+    {
+        std::fill(out, out + count, m_result.m_val);
+        return;
+    }
+
+    Block block;
+    initBlock(block);
+    while (count)
+    {
+        point_count_t n = evalBlock(view, begin,
+            (std::min)(count, BlockSize), block, out);
+        begin += n;
+        out += n;
+        count -= n;
+    }
+}
+
+void Program::eval(PointContainer& container, PointId begin,
+    point_count_t count, double *out) const
+{
+    if (m_result.isConst())
+    {
+        std::fill(out, out + count, m_result.m_val);
+        return;
+    }
+
+    Block block;
+    initBlock(block);
+    while (count)
+    {
+        point_count_t n = (std::min)(count, BlockSize);
+        evalBlock(container, begin, n, block, out);
+        begin += n;
+        out += n;
+        count -= n;
+    }
+}
+
+// Each instruction, including loads, gets a block of values.
+void Program::initBlock(Block& block) const
+{
+    block.m_values.resize(m_code.size() * BlockSize);
+    block.m_regs.resize(m_code.size());
+}
+
+// Evaluate the program for at most 'count' points.  Returns the number
+// of points evaluated, which is less than 'count' when a run of points
+// read in place from the point table ends early.
+point_count_t Program::evalBlock(PointView& view, PointId begin,
+    point_count_t count, Block& block, double *out) const
+{
+    // Dimensions are read in place where the point table allows it.
+    // Every dimension of a point is stored the same way, so the spans
+    // for the block all have the same size.
+    std::vector<FieldSpan<double>> spans;
+    spans.reserve(m_loads);
+    for (size_t i = 0; i < m_code.size(); ++i)
+    {
+        const Instruction& inst = m_code[i];
+        if (inst.m_op == NodeType::Identifier)
+        {
+            spans.push_back(
+                view.getFieldSpan<double>(inst.m_dim, begin, count));
+            count = spans.back().size();
+            block.m_regs[i] = spans.back().data();
+        }
+    }
+    runBlock(count, block, out);
+    return count;
+}
+
+void Program::evalBlock(PointContainer& container, PointId begin,
+    point_count_t count, Block& block, double *out) const
+{
+    PointRef p(container, begin);
+    for (size_t i = 0; i < m_code.size(); ++i)
+    {
+        const Instruction& inst = m_code[i];
+        if (inst.m_op == NodeType::Identifier)
+        {
+            double *vals = block.m_values.data() + i * BlockSize;
+            for (point_count_t j = 0; j < count; ++j)
+            {
+                p.setPointId(begin + j);
+                vals[j] = p.getFieldAs<double>(inst.m_dim);
+            }
+            block.m_regs[i] = vals;
+        }
+    }
+    runBlock(count, block, out);
+}
+
+// Run the instructions other than loads, whose registers must already
+// be set.
+void Program::runBlock(point_count_t count, Block& block, double *out) const
+{
+    for (size_t i = 0; i < m_code.size(); ++i)
+    {
+        const Instruction& inst = m_code[i];
+        if (inst.m_op == NodeType::Identifier)
+            continue;
+
+        const Operand& l = inst.m_left;
+        const Operand& r = inst.m_right;
+        double *vals = block.m_values.data() + i * BlockSize;
+        blockApply(inst.m_op,
+            l.isConst() ? nullptr : block.m_regs[l.m_reg], l.m_val,
+            r.isConst() ? nullptr : block.m_regs[r.m_reg], r.m_val,
+            count, vals);
+        block.m_regs[i] = vals;
+    }
+    std::memcpy(out, block.m_regs[m_result.m_reg], count * sizeof(double));
+}
+
+} // namespace expr
+} // namespace pdal
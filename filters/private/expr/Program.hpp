@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vector>
+
+#include <pdal/PointView.hpp>
+
+#include "Expression.hpp"
+
+namespace pdal
+{
+namespace expr
+{
+
+/**
+  An expression tree compiled to a flat list of instructions.  Each
+  instruction writes its own register, so a program can be evaluated for
+  a block of points at a time, one tight loop per instruction, rather
+  than walking the tree once per point.  Constant subexpressions are
+  folded and repeated subexpressions are computed once as the program
+  is built.
+
+  Evaluating a single point uses scratch space held by the program, so
+  it may not be done by more than one thread at a time.  Runs of points
+  may be evaluated by several threads at once.
+*/
+class Program
+{
+public:
+    static const point_count_t BlockSize = 1024;
+
+    Program();
+
+    void clear();
+    void compile(const Node& root);
+    bool compiled() const
+        { return m_compiled; }
+    size_t size() const
+        { return m_code.size(); }
+
+    /**
+      Evaluate the program for a single point.
+
+      The program may be evaluated by several threads at once.
+
+      \param p  Point for which the program should be evaluated.
+      \return  Result of the program.
+    */
+    double eval(PointRef& p) const;
+
+    /**
+      Evaluate the program for a run of points.
+
+      \param view  View containing the points.
+      \param begin  ID of the first point to evaluate.
+      \param count  Number of points to evaluate.
+      \param out  Array of at least \a count values to receive the results.
+    */
+    void eval(PointView& view, PointId begin, point_count_t count,
+        double *out) const;
+
+    /**
+      Evaluate the program for a run of points in a container that can't
+      provide spans of fields, such as a streaming point table.
+
+      \param container  Container holding the points.
+      \param begin  ID of the first point to evaluate.
+      \param count  Number of points to evaluate.
+      \param out  Array of at least \a count values to receive the results.
+    */
+    void eval(PointContainer& container, PointId begin, point_count_t count,
+        double *out) const;
+
+    // Called by the nodes of an expression tree as they are compiled.
+    Operand load(Dimension::Id dim);
+    Operand unary(NodeType op, Operand sub);
+    Operand binary(NodeType op, Operand left, Operand right);
+
+private:
+    struct Instruction
+    {
+        NodeType m_op;
+        Dimension::Id m_dim;
+        Operand m_left;
+        Operand m_right;
+    };
+
+    // Scratch space for evaluating a block of points.
+    struct Block
+    {
+        std::vector<double> m_values;
+        std::vector<const double *> m_regs;
+    };
+
+    Operand emit(const Instruction& inst);
+    void prune();
+    void initBlock(Block& block) const;
+    point_count_t evalBlock(PointView& view, PointId begin,
+        point_count_t count, Block& block, double *out) const;
+    void evalBlock(PointContainer& container, PointId begin,
+        point_count_t count, Block& block, double *out) const;
+    void runBlock(point_count_t count, Block& block, double *out) const;
+
+    std::vector<Instruction> m_code;
+    Operand m_result;
+    bool m_compiled;
+    size_t m_loads;
+};
+
+} // namespace expr
+} // namespace pdal
@@ -78,6 +78,51 @@ public:
         return testCell(cell, x, y);
     }
 
+    enum class Coverage
+    {
+        Inside,
+        Outside,
+        Partial
+    };
+
+    // Determine whether a box lies entirely inside or entirely outside the
+    // polygon.  A box is reported as partially covered if any grid cell it
+    // touches has an edge, or if it touches too many cells to check
+    // quickly.
+    Coverage coverage(double xmin, double ymin, double xmax, double ymax) const
+    {
+        if (xmax < m_xMin || xmin > m_xMax || ymax < m_yMin || ymin > m_yMax)
+            return Coverage::Outside;
+
+        XYIndex lo;
+        XYIndex hi;
+        if (!m_grid->cellPos(xmin, ymin, lo) ||
+                !m_grid->cellPos(xmax, ymax, hi))
+            return Coverage::Partial;
+        if ((hi.first - lo.first + 1) * (hi.second - lo.second + 1) > 1024)
+            return Coverage::Partial;
+
+        bool in = false;
+        bool out = false;
+        for (XYIndex idx(lo.first, 0); idx.first <= hi.first; idx.first++)
+            for (idx.second = lo.second; idx.second <= hi.second;
+                    idx.second++)
+            {
+                Cell& cell = m_grid->cell(idx);
+                if (!cell.computed())
+                    computeCell(cell, idx);
+                if (!cell.empty())
+                    return Coverage::Partial;
+                if (cell.inside())
+                    in = true;
+                else
+                    out = true;
+                if (in && out)
+                    return Coverage::Partial;
+            }
+        return in ? Coverage::Inside : Coverage::Outside;
+    }
+
 private:
     using XYIndex = std::pair<size_t, size_t>;
     using Edge = std::pair<Point, Point>;
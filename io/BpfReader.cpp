@@ -35,9 +35,11 @@
 #include "BpfReader.hpp"
 
 #include <climits>
+#include <cstring>
 
 #include <pdal/Options.hpp>
 #include <pdal/pdal_features.hpp>
+#include <pdal/util/portable_endian.hpp>
 
 #ifdef PDAL_HAVE_ZLIB
 #include <zlib.h>
@@ -58,6 +60,40 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(BpfReader, s_info)
 
+namespace
+{
+
+// Store values for the points [start, start + vals.size()) of a view.  If
+// 'rows' isn't empty it holds the address of each point.
+template<typename T>
+void storeValues(PointView& view, Dimension::Id dim, PointId start,
+    const std::vector<double>& vals, const std::vector<char *>& rows)
+{
+    if (rows.size())
+    {
+        const size_t offset = view.layout()->dimOffset(dim);
+        for (size_t i = 0; i < vals.size(); ++i)
+        {
+            T v = static_cast<T>(vals[i]);
+            std::memcpy(rows[i] + offset, &v, sizeof(T));
+        }
+        return;
+    }
+
+    size_t pos = 0;
+    while (pos < vals.size())
+    {
+        FieldSpan<T> span =
+            view.getFieldSpan<T>(dim, start + pos, vals.size() - pos);
+        for (size_t i = 0; i < span.size(); ++i)
+            span[i] = static_cast<T>(vals[pos + i]);
+        view.setFieldSpan(dim, start + pos, span);
+        pos += span.size();
+    }
+}
+
+} // unnamed namespace
+
 struct BpfReader::Args
 {
     bool m_fixNames;
@@ -229,6 +265,7 @@ void BpfReader::initialize()
         throwError("BPF Header length exceeded that reported by file.");
     m_stream.close();
     Utils::closeFile(m_istreamPtr);
+    m_istreamPtr = nullptr;
 }
 
 
@@ -293,8 +330,18 @@ bool BpfReader::readPolarData()
 
 void BpfReader::ready(PointTableRef)
 {
-    m_istreamPtr = Utils::openFile(m_filename);
-    m_stream = ILeStream(m_istreamPtr);
+    // Point data of local files is read directly from the mapped file when
+    // possible.  Remote files are read through a stream as in initialize().
+    m_stream = ILeStream();
+    if (Utils::isRemote(m_filename))
+    {
+        m_istreamPtr = Utils::openFile(m_filename);
+        if (!m_istreamPtr)
+            throwError("Can't open file '" + m_filename + "'.");
+        m_stream = ILeStream(m_istreamPtr);
+    }
+    else if (m_stream.openMapped(m_filename) != 0)
+        throwError("Can't open file '" + m_filename + "'.");
     m_stream.seek(m_header.m_len);
     m_index = 0;
     m_start = m_stream.position();
@@ -322,6 +369,7 @@ void BpfReader::done(PointTableRef)
         delete s;
     m_stream.close();
     Utils::closeFile(m_istreamPtr);
+    m_istreamPtr = nullptr;
 }
 
 
@@ -348,6 +396,9 @@ bool BpfReader::processOne(PointRef& point)
 
 point_count_t BpfReader::read(PointViewPtr data, point_count_t count)
 {
+    if (const char *buf = pointData())
+        return readBuffer(data, count, buf);
+
     switch (m_header.m_pointFormat)
     {
     case BpfFormat::PointMajor:
@@ -361,6 +412,136 @@ point_count_t BpfReader::read(PointViewPtr data, point_count_t count)
 }
 
 
+// Get the point data if it's held in memory, either because the file is
+// mapped or because it was compressed and has been inflated.
+const char *BpfReader::pointData() const
+{
+    const size_t len = numPoints() * m_dims.size() * sizeof(float);
+    if (m_header.m_compression)
+        return m_deflateBuf.size() >= len ? m_deflateBuf.data() : nullptr;
+
+    const char *data = m_stream.data();
+    const size_t start = static_cast<size_t>(m_start);
+    if (!data || m_stream.size() < start + len)
+        return nullptr;
+    return data + start;
+}
+
+
+// Get the value of a dimension of a point from in-memory point data.
+double BpfReader::bufferValue(const char *buf, size_t dim, PointId idx) const
+{
+    const size_t numDims = m_dims.size();
+    uint32_t u;
+    switch (m_header.m_pointFormat)
+    {
+    case BpfFormat::PointMajor:
+        std::memcpy(&u, buf + (idx * numDims + dim) * sizeof(float),
+            sizeof(u));
+        u = le32toh(u);
+        break;
+    case BpfFormat::DimMajor:
+        std::memcpy(&u, buf + (dim * numPoints() + idx) * sizeof(float),
+            sizeof(u));
+        u = le32toh(u);
+        break;
+    case BpfFormat::ByteMajor:
+    {
+        // The offset is added as a float, as with the stream path.
+        const char *pos = buf + dim * numPoints() * sizeof(float) + idx;
+        u = 0;
+        for (size_t b = 0; b < sizeof(float); ++b)
+            u |= ((uint32_t)(uint8_t)pos[b * numPoints()] << (b * CHAR_BIT));
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        return f + static_cast<float>(m_dims[dim].m_offset);
+    }
+    }
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f + m_dims[dim].m_offset;
+}
+
+
+// Read points from in-memory point data a dimension at a time.  Values
+// are stored directly into the point table rather than being extracted
+// from a stream.
+point_count_t BpfReader::readBuffer(PointViewPtr view, point_count_t count,
+    const char *buf)
+{
+    using namespace Dimension;
+
+    count = (std::min)(count, numPoints() - m_index);
+    const PointId start = view->size();
+
+    // Add the points.  Tables that store points as rows give us the
+    // address of each point.
+    std::vector<char *> rows(count);
+    for (point_count_t i = 0; i < count; ++i)
+        rows[i] = view->getOrAddPoint(start + i);
+    if (count && !rows[0])
+        rows.clear();
+
+    auto store = [&](Id id, const std::vector<double>& vals)
+    {
+        switch (view->dimType(id))
+        {
+        case Type::Float:
+            storeValues<float>(*view, id, start, vals, rows);
+            break;
+        case Type::Double:
+            storeValues<double>(*view, id, start, vals, rows);
+            break;
+        default:
+            for (point_count_t i = 0; i < count; ++i)
+                view->setField(id, start + i, vals[i]);
+            break;
+        }
+    };
+
+    // X, Y and Z are held until the transformation has been applied.
+    // They're rounded to their stored type first, as they would be if
+    // they were read back from the view.
+    std::vector<double> xyz[3];
+    std::vector<double> vals(count);
+    for (size_t d = 0; d < m_dims.size(); ++d)
+    {
+        const Id id = m_dims[d].m_id;
+        const bool isFloat = (view->dimType(id) == Type::Float);
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            vals[i] = bufferValue(buf, d, m_index + i);
+            if (isFloat)
+                vals[i] = static_cast<float>(vals[i]);
+        }
+
+        if (id == Id::X)
+            xyz[0] = vals;
+        else if (id == Id::Y)
+            xyz[1] = vals;
+        else if (id == Id::Z)
+            xyz[2] = vals;
+        else
+            store(id, vals);
+    }
+
+    for (std::vector<double>& v : xyz)
+        v.resize(count);
+    for (point_count_t i = 0; i < count; ++i)
+        m_header.m_xform.apply(xyz[0][i], xyz[1][i], xyz[2][i]);
+    store(Id::X, xyz[0]);
+    store(Id::Y, xyz[1]);
+    store(Id::Z, xyz[2]);
+
+    if (m_cb)
+        for (PointId idx = start; idx < view->size(); ++idx)
+            m_cb(*view, idx);
+
+    m_index += count;
+    return count;
+}
+
+
 bool BpfReader::eof()
 {
     return m_index >= numPoints();
@@ -441,7 +622,8 @@ void BpfReader::readDimMajor(PointRef& point)
             std::streamoff offset = sizeof(float) * dim * numPoints();
 
             m_streams.emplace_back(new ILeStream());
-            m_streams.back()->open(m_filename);
+            if (m_streams.back()->openMapped(m_filename) != 0)
+                throwError("Can't open file '" + m_filename + "'.");
 
 #ifdef PDAL_HAVE_ZLIB
             if (m_header.m_compression)
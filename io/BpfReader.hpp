@@ -107,6 +107,10 @@ private:
     point_count_t readDimMajor(PointViewPtr data, point_count_t count);
     void readByteMajor(PointRef& point);
     point_count_t readByteMajor(PointViewPtr data, point_count_t count);
+    const char *pointData() const;
+    double bufferValue(const char *buf, size_t dim, PointId idx) const;
+    point_count_t readBuffer(PointViewPtr view, point_count_t count,
+        const char *buf);
     size_t readBlock(std::vector<char>& outBuf, size_t index);
     bool eof();
     int inflate(char *inbuf, uint32_t insize, char *outbuf, uint32_t outsize);
@@ -34,7 +34,9 @@
 
 #include "EptReader.hpp"
 
+#include <algorithm>
 #include <limits>
+#include <numeric>
 
 #include <nlohmann/json.hpp>
 
@@ -43,11 +45,14 @@
 #include <pdal/SrsBounds.hpp>
 #include <pdal/pdal_features.hpp>
 #include <pdal/util/ThreadPool.hpp>
+#include <pdal/private/BoxTree.hpp>
 #include <pdal/private/gdal/GDALUtils.hpp>
+#include <filters/private/pnp/GridPnp.hpp>
 
 #include "private/ept/Connector.hpp"
 #include "private/ept/EptArtifact.hpp"
 #include "private/ept/EptSupport.hpp"
+#include "private/ept/TileCache.hpp"
 #include "private/ept/TileContents.hpp"
 
 namespace pdal
@@ -108,6 +113,9 @@ public:
     std::string m_origin;
     std::size_t m_threads = 0;
     double m_resolution = 0;
+    std::string m_cacheDir;
+    uint64_t m_cacheSize = 1024;
+    uint64_t m_readAhead = 512;
     std::vector<Polygon> m_polys;
     NL::json m_addons;
 
@@ -125,10 +133,20 @@ public:
     std::unique_ptr<TileContents> currentTile;
     std::unique_ptr<Hierarchy> hierarchy;
     std::queue<TileContents> contents;
-    Hierarchy::const_iterator hierarchyIter;
+    // Tiles in the order they're read, and the next one to read.
+    std::vector<const Overlap *> order;
+    size_t next = 0;
+    // Estimated size of the tiles that have been requested but not handled.
+    uint64_t inflight = 0;
     AddonList addons;
     std::mutex mutex;
     std::condition_variable contentsCv;
+    PointLayoutPtr layout;
+    std::vector<std::unique_ptr<GridPnp>> gridPnps;
+    BoxTree polyIndex;
+    // Points of the current tile that pass the query, in streaming mode.
+    PointIdList selected;
+    PointId selectedPos = 0;
 };
 
 EptReader::EptReader() : m_args(new EptReader::Args), m_p(new EptReader::Private),
@@ -146,6 +164,12 @@ void EptReader::addArgs(ProgramArgs& args)
     args.add("origin", "Origin of source file to fetch", m_args->m_origin);
     args.add("threads", "Number of worker threads", m_args->m_threads);
     args.add("resolution", "Resolution limit", m_args->m_resolution);
+    args.add("cache_dir", "Directory in which to cache EPT data",
+        m_args->m_cacheDir);
+    args.add("cache_size", "Size limit of the cache for the EPT dataset "
+        "in megabytes", m_args->m_cacheSize, (uint64_t)1024);
+    args.add("read_ahead", "Memory limit for tiles read ahead of "
+        "processing in megabytes", m_args->m_readAhead, (uint64_t)512);
     args.add("addons", "Mapping of addon dimensions to their output directory",
         m_args->m_addons);
     args.add("polygon", "Bounding polygon(s) to crop requests",
@@ -211,6 +235,23 @@ void EptReader::initialize()
         throwError(err.what());
     }
 
+    // Tiles and hierarchy files of the dataset are cached and checked
+    // against the dataset's ept.json.
+    if (m_args->m_cacheDir.size())
+    {
+        try
+        {
+            m_p->connector->setCache(std::unique_ptr<TileCache>(
+                new TileCache(m_args->m_cacheDir, m_p->info->rootDir(),
+                    m_p->info->json().dump(),
+                    m_args->m_cacheSize * 1024 * 1024)));
+        }
+        catch (const pdal_error& err)
+        {
+            throwError(err.what());
+        }
+    }
+
     if (!m_args->m_ogr.is_null())
     {
         auto& plist = m_args->m_polys;
@@ -446,7 +487,8 @@ void EptReader::load(const Overlap& overlap)
     m_p->pool->add([this, overlap]()
         {
             // Read the tile.
-            TileContents tile(overlap, *m_p->info, *m_p->connector, m_p->addons);
+            TileContents tile(overlap, *m_p->info, *m_p->connector,
+                m_p->addons, *m_p->layout);
             tile.read();
 
             // Put the tile on the output queue.
@@ -465,6 +507,19 @@ void EptReader::ready(PointTableRef table)
     // origins and ordering for an EPT writer.
     m_nodeIdDim = table.layout()->findDim("EptNodeId");
     m_pointIdDim = table.layout()->findDim("EptPointId");
+    m_p->layout = table.layout();
+
+    // Index the query polygons so that blocks of points can be checked
+    // against them at once.
+    std::vector<BOX2D> polyBounds;
+    m_p->gridPnps.clear();
+    for (const Polygon& poly : m_args->m_polys)
+    {
+        polyBounds.push_back(poly.bounds().to2d());
+        m_p->gridPnps.emplace_back(new GridPnp(poly.exteriorRing(),
+            poly.interiorRings()));
+    }
+    m_p->polyIndex.build(polyBounds);
 
     m_p->hierarchy.reset(new Hierarchy);
 
@@ -490,28 +545,73 @@ void EptReader::ready(PointTableRef table)
 
     // Ten million is a silly-large number for the number of tiles.
     m_p->pool.reset(new ThreadPool(m_p->pool->numThreads()));
-    m_pointId = 0;
     m_tileCount = m_p->hierarchy->size();
-
-    // If we're running in standard mode, queue up all the requests for data.
-    // In streaming mode, queue up at most 4 to avoid having a ton of data
-    // show up at once. Others requests will be queued as the results
-    // are handled.
     if (table.supportsView())
-    {
         m_artifactMgr = &table.artifactManager();
-        for (const Overlap& overlap : *m_p->hierarchy)
-            load(overlap);
-    }
-    else
-    {
-        int count = 4;
-        m_p->hierarchyIter = m_p->hierarchy->cbegin();
-        while (m_p->hierarchyIter != m_p->hierarchy->cend() && count)
+
+    // Read the tiles nearest the center of the query area first.  Ties
+    // go to the shallower tile.
+    BOX3D area(m_p->info->bounds());
+    area.clip(m_queryBounds);
+    BOX2D query(area.to2d());
+    if (m_args->m_polys.size())
+    {
+        BOX2D polyBounds;
+        for (const Polygon& poly : m_args->m_polys)
+            polyBounds.grow(poly.bounds().to2d());
+        query.clip(polyBounds);
+    }
+    const double cx = (query.minx + query.maxx) / 2;
+    const double cy = (query.miny + query.maxy) / 2;
+    auto distance = [cx, cy](const Overlap *o)
+    {
+        const BOX3D& b = o->m_key.b;
+        const double dx = (b.minx + b.maxx) / 2 - cx;
+        const double dy = (b.miny + b.maxy) / 2 - cy;
+        return dx * dx + dy * dy;
+    };
+
+    m_p->order.clear();
+    for (const Overlap& overlap : *m_p->hierarchy)
+        m_p->order.push_back(&overlap);
+    std::sort(m_p->order.begin(), m_p->order.end(),
+        [&distance](const Overlap *a, const Overlap *b)
         {
-            load(*m_p->hierarchyIter++);
-            count--;
-        }
+            const double da = distance(a);
+            const double db = distance(b);
+            if (da != db)
+                return da < db;
+            if (a->m_key.d != b->m_key.d)
+                return a->m_key.d < b->m_key.d;
+            return a->m_nodeId < b->m_nodeId;
+        });
+    m_p->next = 0;
+    m_p->inflight = 0;
+    schedule();
+}
+
+
+uint64_t EptReader::tileBytes(point_count_t count) const
+{
+    return count * m_p->info->remoteLayout().pointSize();
+}
+
+
+// Request tiles in order until the estimated size of the tiles that are
+// waiting to be handled reaches the read-ahead limit.  A tile is always
+// requested if none are waiting so that reading makes progress.
+void EptReader::schedule()
+{
+    const uint64_t limit = m_args->m_readAhead * 1024 * 1024;
+    while (m_p->next < m_p->order.size())
+    {
+        const Overlap& overlap = *m_p->order[m_p->next];
+        const uint64_t bytes = tileBytes(overlap.m_count);
+        if (m_p->inflight && m_p->inflight + bytes > limit)
+            break;
+        m_p->inflight += bytes;
+        m_p->next++;
+        load(overlap);
     }
 }
 
@@ -637,55 +737,106 @@ void EptReader::checkTile(const TileContents& tile)
 }
 
 
-bool EptReader::processPoint(PointRef& dst, const TileContents& tile)
+// Select the points of a tile that pass the query.  Tiles that lie
+// entirely inside the query bounds and a query polygon are taken whole.
+// Otherwise points are checked a block at a time so that polygons that
+// cover or miss a block are resolved without testing each point.
+void EptReader::selectPoints(const TileContents& tile, PointIdList& ids)
 {
-    using namespace Dimension;
+    const point_count_t numPoints = tile.numPoints();
+    std::vector<size_t> candidates;
 
-    BasePointTable& t = tile.table();
-
-    // Save current point ID and increment so that we can return without
-    // worrying about m_pointId being correct on exit.
-    PointId pointId = m_pointId++;
-
-    PointRef p(t, pointId);
-    int64_t originId = p.getFieldAs<int64_t>(Id::OriginId);
-    if (m_queryOriginId != -1 && originId != m_queryOriginId)
-        return false;
-
-    auto passesPolyFilter = [this](double x, double y)
+    auto polysCover = [this, &candidates](const BOX2D& b)
     {
-        if (m_args->m_polys.empty())
+        if (m_p->gridPnps.empty())
             return true;
-
-        for (Polygon& poly : m_args->m_polys)
-            if (poly.contains(x, y))
+        m_p->polyIndex.candidates(b, candidates);
+        for (size_t id : candidates)
+            if (m_p->gridPnps[id]->coverage(b.minx, b.miny, b.maxx, b.maxy) ==
+                    GridPnp::Coverage::Inside)
                 return true;
         return false;
     };
 
-    double x = p.getFieldAs<double>(Id::X);
-    double y = p.getFieldAs<double>(Id::Y);
-    double z = p.getFieldAs<double>(Id::Z);
-
-    if (!m_queryBounds.contains(x, y, z) || !passesPolyFilter(x, y))
-        return false;
-
-    for (auto& el : m_p->info->dims())
+    ids.clear();
+    const BOX3D& tileBounds = tile.key().b;
+    if (m_queryOriginId == -1 && m_queryBounds.contains(tileBounds) &&
+            polysCover(tileBounds.to2d()))
     {
-        DimType& dt = el.second;
-        if (dt.m_id != Dimension::Id::X &&
-                dt.m_id != Dimension::Id::Y &&
-                dt.m_id != Dimension::Id::Z)
+        ids.resize(numPoints);
+        std::iota(ids.begin(), ids.end(), 0);
+        return;
+    }
+
+    const point_count_t blockSize = 4096;
+    std::vector<double> xs(blockSize);
+    std::vector<double> ys(blockSize);
+    std::vector<double> zs(blockSize);
+    std::vector<const GridPnp *> partial;
+    for (PointId begin = 0; begin < numPoints; begin += blockSize)
+    {
+        const point_count_t count = (std::min)(blockSize, numPoints - begin);
+        tile.xyz(begin, count, xs.data(), ys.data(), zs.data());
+
+        BOX3D bounds;
+        for (point_count_t i = 0; i < count; ++i)
+            bounds.grow(xs[i], ys[i], zs[i]);
+        if (!m_queryBounds.overlaps(bounds))
+            continue;
+        const bool boundsPass = m_queryBounds.contains(bounds);
+
+        // Find the polygons that contain some, but not all, of the block.
+        // If a polygon contains the entire block, no points need testing.
+        const BOX2D b = bounds.to2d();
+        bool polysPass = m_p->gridPnps.empty();
+        partial.clear();
+        if (!polysPass)
         {
-            const double val = p.getFieldAs<double>(dt.m_id) *
-                dt.m_xform.m_scale.m_val + dt.m_xform.m_offset.m_val;
+            m_p->polyIndex.candidates(b, candidates);
+            for (size_t id : candidates)
+            {
+                const GridPnp& g = *m_p->gridPnps[id];
+                GridPnp::Coverage c = g.coverage(b.minx, b.miny,
+                    b.maxx, b.maxy);
+                if (c == GridPnp::Coverage::Inside)
+                {
+                    polysPass = true;
+                    break;
+                }
+                if (c == GridPnp::Coverage::Partial)
+                    partial.push_back(&g);
+            }
+            if (!polysPass && partial.empty())
+                continue;
+        }
 
-            dst.setField(dt.m_id, val);
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            const PointId id = begin + i;
+            if (m_queryOriginId != -1 &&
+                    tile.originId(id) != m_queryOriginId)
+                continue;
+            if (!boundsPass && !m_queryBounds.contains(xs[i], ys[i], zs[i]))
+                continue;
+            if (!polysPass)
+            {
+                const double x = xs[i];
+                const double y = ys[i];
+                auto inside = [x, y](const GridPnp *g)
+                    { return g->inside(x, y); };
+                if (std::none_of(partial.begin(), partial.end(), inside))
+                    continue;
+            }
+            ids.push_back(id);
         }
     }
-    dst.setField(Id::X, x);
-    dst.setField(Id::Y, y);
-    dst.setField(Id::Z, z);
+}
+
+
+void EptReader::processPoint(PointRef& dst, const TileContents& tile,
+    PointId pointId)
+{
+    tile.copy(pointId, dst);
     dst.setField(m_nodeIdDim, tile.nodeId());
     dst.setField(m_pointIdDim, pointId);
     for (Addon& addon : m_p->addons)
@@ -699,7 +850,6 @@ bool EptReader::processPoint(PointRef& dst, const TileContents& tile)
             dst.setField(addon.externalId(), val);
         }
     }
-    return true;
 }
 
 
@@ -725,9 +875,10 @@ point_count_t EptReader::read(PointViewPtr view, point_count_t count)
                 TileContents tile = std::move(m_p->contents.front());
                 m_p->contents.pop();
                 l.unlock();
+                m_p->inflight -= tileBytes(tile.size());
+                schedule();
                 checkTile(tile);
-                process(view, tile, count - numRead);
-                numRead += tile.size();
+                numRead += process(view, tile, count - numRead);
                 m_tileCount--;
             }
             else
@@ -754,18 +905,21 @@ point_count_t EptReader::read(PointViewPtr view, point_count_t count)
 
 
 // Put the contents of a tile into the destination point view.
-void EptReader::process(PointViewPtr dstView, const TileContents& tile,
-    point_count_t count)
+point_count_t EptReader::process(PointViewPtr dstView,
+    const TileContents& tile, point_count_t count)
 {
-    m_pointId = 0;
+    PointIdList ids;
+    selectPoints(tile, ids);
+    if (ids.size() > count)
+        ids.resize(count);
+
     PointRef dstPoint(*dstView);
-    for (PointId idx = 0; idx < tile.size(); ++idx)
+    for (PointId id : ids)
     {
-        if (count-- == 0)
-            return;
         dstPoint.setPointId(dstView->size());
-        processPoint(dstPoint, tile);
+        processPoint(dstPoint, tile, id);
     }
+    return ids.size();
 }
 
 
@@ -787,32 +941,30 @@ top:
                 m_p->currentTile.reset(new TileContents(std::move(m_p->contents.front())));
                 m_p->contents.pop();
                 l.unlock();
-                if (m_p->hierarchyIter != m_p->hierarchy->cend())
-                    load(*m_p->hierarchyIter++);
+                m_p->inflight -= tileBytes(m_p->currentTile->size());
+                schedule();
                 break;
             }
             else
                 m_p->contentsCv.wait(l);
         } while (true);
         checkTile(*m_p->currentTile);
+        selectPoints(*m_p->currentTile, m_p->selected);
+        m_p->selectedPos = 0;
     }
 
-    bool ok = processPoint(point, *m_p->currentTile);
-
-    // If we've processed all the points in the current tile, pop it.
-    // If we've processed all the tiles, return false to indicate that
-    // we're done.
-    if (m_pointId == m_p->currentTile->size())
+    // If we've processed all the selected points in the current tile,
+    // pop it and try the next one.  If we've processed all the tiles,
+    // return false to indicate that we're done.
+    if (m_p->selectedPos == m_p->selected.size())
     {
-        m_pointId = 0;
         m_p->currentTile.reset();
         --m_tileCount;
-    }
-
-    // If we didn't pass a point, try again.
-    if (!ok)
         goto top;
+    }
 
+    processPoint(point, *m_p->currentTile,
+        m_p->selected[m_p->selectedPos++]);
     return true;
 }
 
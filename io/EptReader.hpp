@@ -85,9 +85,14 @@ private:
     // downloaded during the 'read' section.
     void overlaps();
     void overlaps(Hierarchy& target, const NL::json& current, const Key& key);
-    void process(PointViewPtr dstView, const TileContents& tile, point_count_t count);
-    bool processPoint(PointRef& dst, const TileContents& tile);
+    point_count_t process(PointViewPtr dstView, const TileContents& tile,
+        point_count_t count);
+    void selectPoints(const TileContents& tile, PointIdList& ids);
+    void processPoint(PointRef& dst, const TileContents& tile,
+        PointId pointId);
     void load(const Overlap& overlap);
+    void schedule();
+    uint64_t tileBytes(point_count_t count) const;
     void checkTile(const TileContents& tile);
 
     struct Args;
@@ -106,7 +111,6 @@ private:
     Dimension::Id m_pointIdDim = Dimension::Id::Unknown;
 
     ArtifactManager *m_artifactMgr;
-    PointId m_pointId = 0;
     uint64_t m_nodeId;
 };
 
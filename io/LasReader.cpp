@@ -36,6 +36,8 @@
 
 #include "LasReader.hpp"
 
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <string.h>
 
@@ -51,6 +53,7 @@
 #include "GeotiffSupport.hpp"
 #include "LasHeader.hpp"
 #include "LasVLR.hpp"
+#include "private/LasPointDecoder.hpp"
 
 namespace pdal
 {
@@ -64,9 +67,80 @@ struct invalid_stream : public std::runtime_error
         {}
 };
 
+// Bounds of the chunks of LAZ files, computed the first time a file is
+// read completely with a pushed-down predicate so that later reads of the
+// file can skip chunks that contain no points that can pass.  Entries are
+// only used if the size and modification time of the file and the point
+// count and bounds in its header haven't changed.  Files written by PDAL
+// as version 1.4 store their chunk bounds in a VLR instead.
+class ChunkBoundsCache
+{
+public:
+    bool find(const std::string& filename, const LasHeader& header,
+        std::vector<BOX3D>& bounds)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(filename);
+        if (it == m_entries.end() ||
+                it->second.m_stamp != stamp(filename, header))
+            return false;
+        bounds = it->second.m_bounds;
+        return true;
+    }
+
+    void insert(const std::string& filename, const LasHeader& header,
+        const std::vector<BOX3D>& bounds)
+    {
+        std::string s = stamp(filename, header);
+        if (s.empty())
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_entries.size() >= MaxEntries)
+            m_entries.clear();
+        m_entries[filename] = { s, bounds };
+    }
+
+private:
+    struct Entry
+    {
+        std::string m_stamp;
+        std::vector<BOX3D> m_bounds;
+    };
+
+    static const size_t MaxEntries = 1000;
+
+    // Modification times only have a resolution of a second, so the header
+    // summary is added to tell apart files rewritten within that second.
+    static std::string stamp(const std::string& filename,
+        const LasHeader& header)
+    {
+        if (!FileUtils::fileExists(filename))
+            return std::string();
+
+        struct tm modTime;
+        FileUtils::fileTimes(filename, nullptr, &modTime);
+        const BOX3D& b = header.getBounds();
+        std::ostringstream oss;
+        oss.precision(17);
+        oss << FileUtils::fileSize(filename) << "/" << modTime.tm_year <<
+            "/" << modTime.tm_yday << "/" << modTime.tm_hour << ":" <<
+            modTime.tm_min << ":" << modTime.tm_sec << "/" <<
+            header.pointCount() << "/" << b.minx << "/" << b.miny << "/" <<
+            b.minz << "/" << b.maxx << "/" << b.maxy << "/" << b.maxz;
+        return oss.str();
+    }
+
+    std::mutex m_mutex;
+    std::map<std::string, Entry> m_entries;
+};
+
+ChunkBoundsCache s_chunkBounds;
+
 } // unnamed namespace
 
-LasReader::LasReader() : m_decompressor(nullptr), m_index(0)
+LasReader::LasReader() : m_decompressor(nullptr), m_index(0),
+    m_mapped(nullptr), m_threads(1), m_chunkSize(0)
 {}
 
 
@@ -86,6 +160,8 @@ void LasReader::addArgs(ProgramArgs& args)
     args.add("use_eb_vlr", "Use extra bytes VLR for 1.0 - 1.3 files",
         m_useEbVlr);
     args.add("ignore_vlr", "VLR userid/recordid to ignore", m_ignoreVLROption);
+    args.add("threads", "Number of threads used to decompress LAZ data "
+        "with LAZperf", m_threads, 1);
 }
 
 
@@ -130,8 +206,9 @@ void LasReader::handleCompressionOption()
 {
     std::string compression = Utils::toupper(m_compression);
 #if defined(PDAL_HAVE_LAZPERF) && defined(PDAL_HAVE_LASZIP)
+    // Only LAZperf decompression can be run on multiple threads.
     if (compression == "EITHER")
-        compression = "LASZIP";
+        compression = (m_threads > 1) ? "LAZPERF" : "LASZIP";
 #endif
 #if !defined(PDAL_HAVE_LAZPERF) && defined(PDAL_HAVE_LASZIP)
     if (compression == "EITHER")
@@ -281,8 +358,13 @@ void LasReader::ready(PointTableRef table)
             if (!vlr)
                 throwError("LAZ file missing required laszip VLR.");
             m_decompressor = new LazPerfVlrDecompressor(*stream,
-                vlr->data(), m_header.pointOffset());
+                vlr->data(), m_header.pointOffset(), getNumPoints(),
+                m_threads);
             m_decompressorBuf.resize(m_decompressor->pointSize());
+            if (m_threads > 1 && !m_decompressor->parallel())
+                log()->get(LogLevel::Warning) << getName() << ": Unable "
+                    "to read LAZ chunk table.  Decompressing with a single "
+                    "thread." << std::endl;
         }
 #endif
 
@@ -292,7 +374,92 @@ void LasReader::ready(PointTableRef table)
 #endif
     }
     else
+    {
         stream->seekg(m_header.pointOffset());
+        m_pointDecoder = LasPointDecoder::create(m_header, *table.layout());
+
+        // When the points can be decoded in bulk, decode them straight
+        // from the mapped file rather than copying through the stream.
+        m_mapped = nullptr;
+        if (m_pointDecoder)
+            m_mapped = m_streamIf->map();
+    }
+    setupPredicate(table);
+}
+
+
+// Set up the use of a predicate pushed down from the stage consuming our
+// points.  If no point in the file can pass, the whole file is skipped.
+// For compressed files, chunks can be skipped once their bounds are known.
+void LasReader::setupPredicate(PointTableRef table)
+{
+    m_predicate = pushedPredicate(table);
+    m_chunkSize = 0;
+    m_skipChunks.clear();
+    m_chunkBounds.clear();
+    if (!m_predicate)
+        return;
+
+    // Pad the header bounds to allow for rounding of the scaled values.
+    const LasHeader& h = m_header;
+    BOX3D bounds(h.getBounds());
+    bounds.grow(bounds.minx - h.scaleX(), bounds.miny - h.scaleY(),
+        bounds.minz - h.scaleZ());
+    bounds.grow(bounds.maxx + h.scaleX(), bounds.maxy + h.scaleY(),
+        bounds.maxz + h.scaleZ());
+    if (!m_predicate->boxPasses(bounds))
+    {
+        log()->get(LogLevel::Debug) << getName() << ": No points in '" <<
+            m_filename << "' can pass downstream filters." << std::endl;
+        m_index = getNumPoints();
+        return;
+    }
+
+    if (!h.compressed() || !getNumPoints())
+        return;
+
+    // The LASzip VLR holds the number of points in each chunk at offset
+    // 12.  Files with variable-sized chunks can't be skipped by chunk.
+    const LasVLR *vlr = h.findVlr(LASZIP_USER_ID, LASZIP_RECORD_ID);
+    if (!vlr || vlr->dataLen() < 16)
+        return;
+    uint32_t chunkSize;
+    LeExtractor in(vlr->data() + 12, sizeof(chunkSize));
+    in >> chunkSize;
+    if (chunkSize == 0 ||
+            chunkSize == (std::numeric_limits<uint32_t>::max)())
+        return;
+    m_chunkSize = chunkSize;
+
+    size_t numChunks = (size_t)
+        ((getNumPoints() + m_chunkSize - 1) / m_chunkSize);
+    std::vector<BOX3D> chunkBounds;
+    if (!readChunkBoundsVlr(chunkBounds) &&
+        (!s_chunkBounds.find(m_filename, h, chunkBounds) ||
+            chunkBounds.size() != numChunks))
+    {
+        m_chunkBounds.resize(numChunks);
+        return;
+    }
+
+    std::vector<bool> skip(numChunks);
+    size_t skipped = 0;
+    for (size_t i = 0; i < numChunks; ++i)
+        if (!m_predicate->boxPasses(chunkBounds[i]))
+        {
+            skip[i] = true;
+            skipped++;
+        }
+    if (!skipped)
+        return;
+
+#ifdef PDAL_HAVE_LAZPERF
+    if (m_compression == "LAZPERF" && !m_decompressor->skipChunks(skip))
+        return;
+#endif
+    m_skipChunks.swap(skip);
+    log()->get(LogLevel::Debug) << getName() << ": Skipping " << skipped <<
+        " of " << numChunks << " chunks." << std::endl;
 }
 
 
@@ -537,6 +704,9 @@ void LasReader::extractVlrMetadata(MetadataNode& forward, MetadataNode& m)
         if (vlr.userId() == SPEC_USER_ID &&
             vlr.recordId() != 0 && vlr.recordId() != 3)
             continue;
+        if (vlr.userId() == PDAL_USER_ID &&
+            vlr.recordId() == PDAL_CHUNK_BOUNDS_RECORD_ID)
+            continue;
         forward.add(vlrNode);
     }
 }
@@ -589,62 +759,186 @@ void LasReader::addDimensions(PointLayoutPtr layout)
 
 bool LasReader::processOne(PointRef& point)
 {
-    if (m_index >= getNumPoints())
-        return false;
+    while (m_index < getNumPoints())
+        if (nextPoint(point) &&
+                (!m_predicate || m_predicate->pointPasses(point)))
+            return true;
+    return false;
+}
 
+
+// Read the next point record.  Returns false, without loading the point,
+// if the record can't pass the pushed-down predicate or there are no
+// more points.
+bool LasReader::nextPoint(PointRef& point)
+{
     size_t pointLen = m_header.pointLen();
 
     if (m_header.compressed())
     {
+        skipChunks();
+        if (m_index >= getNumPoints())
+            return false;
+        PointId idx = m_index++;
+        bool passes = true;
+
 #ifdef PDAL_HAVE_LASZIP
         if (m_compression == "LASZIP")
         {
             handleLaszip(laszip_read_point(m_laszip));
-            loadPoint(point, *m_laszipPoint);
+            passes = !m_predicate || positionPasses(idx, m_laszipPoint->X,
+                m_laszipPoint->Y, m_laszipPoint->Z);
+            if (passes)
+                loadPoint(point, *m_laszipPoint);
         }
 #endif
 
 #ifdef PDAL_HAVE_LAZPERF
         if (m_compression == "LAZPERF")
         {
-            m_decompressor->decompress(m_decompressorBuf.data());
-            loadPoint(point, m_decompressorBuf.data(), pointLen);
+            char *buf = m_decompressorBuf.data();
+            m_decompressor->decompress(buf);
+            if (m_predicate)
+            {
+                LeExtractor in(buf, 3 * sizeof(int32_t));
+                int32_t xi, yi, zi;
+                in >> xi >> yi >> zi;
+                passes = positionPasses(idx, xi, yi, zi);
+            }
+            if (passes)
+                loadPoint(point, buf, pointLen);
         }
 #endif
 #if !defined(PDAL_HAVE_LAZPERF) && !defined(PDAL_HAVE_LASZIP)
         throwError("Can't read compressed file without LASzip or "
             "LAZperf decompression library.");
 #endif
+
+        // Once the bounds of every chunk are known, save them for the
+        // next time the file is read.
+        if (m_chunkBounds.size() && m_index == getNumPoints())
+        {
+            s_chunkBounds.insert(m_filename, m_header, m_chunkBounds);
+            m_chunkBounds.clear();
+        }
+        return passes;
     } // compression
-    else
-    {
-        std::vector<char> buf(m_header.pointLen());
 
-        m_streamIf->m_istream->read(buf.data(), pointLen);
-        loadPoint(point, buf.data(), pointLen);
-    }
+    if (m_index >= getNumPoints())
+        return false;
+    std::vector<char> buf(m_header.pointLen());
+
+    m_streamIf->m_istream->read(buf.data(), pointLen);
     m_index++;
+    if (m_predicate && !positionPasses(buf.data()))
+        return false;
+    loadPoint(point, buf.data(), pointLen);
+    return true;
+}
+
+
+// Read the chunk bounds written by PDAL as an extended VLR.  The VLR holds
+// the chunk size followed by the minimum and maximum X, Y and Z of each
+// chunk as stored in the file.
+bool LasReader::readChunkBoundsVlr(std::vector<BOX3D>& bounds)
+{
+    const LasHeader& h = m_header;
+    const LasVLR *vlr = h.findVlr(PDAL_USER_ID, PDAL_CHUNK_BOUNDS_RECORD_ID);
+    if (!vlr || vlr->dataLen() < sizeof(uint32_t))
+        return false;
+
+    size_t numChunks = (size_t)
+        ((getNumPoints() + m_chunkSize - 1) / m_chunkSize);
+    if (vlr->dataLen() != sizeof(uint32_t) + numChunks * 6 * sizeof(int32_t))
+        return false;
+
+    LeExtractor in(vlr->data(), vlr->dataLen());
+    uint32_t chunkSize;
+    in >> chunkSize;
+    if (chunkSize != m_chunkSize)
+        return false;
+
+    bounds.resize(numChunks);
+    for (BOX3D& b : bounds)
+    {
+        int32_t v[6];
+        for (int32_t& i : v)
+            in >> i;
+        b = BOX3D(v[0] * h.scaleX() + h.offsetX(),
+            v[1] * h.scaleY() + h.offsetY(), v[2] * h.scaleZ() + h.offsetZ(),
+            v[3] * h.scaleX() + h.offsetX(),
+            v[4] * h.scaleY() + h.offsetY(), v[5] * h.scaleZ() + h.offsetZ());
+    }
     return true;
 }
 
 
+// Move past any chunks that have no points that can pass the pushed-down
+// predicate.  The LAZperf decompressor skips the same chunks itself.
+void LasReader::skipChunks()
+{
+    if (m_skipChunks.empty() || m_index % m_chunkSize)
+        return;
+
+    size_t chunk = (size_t)(m_index / m_chunkSize);
+    if (chunk >= m_skipChunks.size() || !m_skipChunks[chunk])
+        return;
+    while (chunk < m_skipChunks.size() && m_skipChunks[chunk])
+        chunk++;
+    m_index = (std::min)(chunk * m_chunkSize, getNumPoints());
+
+#ifdef PDAL_HAVE_LASZIP
+    if (m_compression == "LASZIP" && m_index < getNumPoints())
+        handleLaszip(laszip_seek_point(m_laszip, m_index));
+#endif
+}
+
+
+// Test the position of a point against the pushed-down predicate.  The
+// bounds of the chunks of a compressed file are collected as points
+// are tested.
+bool LasReader::positionPasses(PointId idx, int32_t xi, int32_t yi,
+    int32_t zi)
+{
+    const LasHeader& h = m_header;
+
+    double x = xi * h.scaleX() + h.offsetX();
+    double y = yi * h.scaleY() + h.offsetY();
+    double z = zi * h.scaleZ() + h.offsetZ();
+
+    if (m_chunkBounds.size())
+        m_chunkBounds[(size_t)(idx / m_chunkSize)].grow(x, y, z);
+    return m_predicate->positionPasses(x, y, z);
+}
+
+
+// Test the position of an uncompressed point record.
+bool LasReader::positionPasses(const char *buf)
+{
+    LeExtractor in(buf, 3 * sizeof(int32_t));
+    int32_t xi, yi, zi;
+    in >> xi >> yi >> zi;
+    return positionPasses(0, xi, yi, zi);
+}
+
+
 point_count_t LasReader::read(PointViewPtr view, point_count_t count)
 {
     size_t pointLen = m_header.pointLen();
     count = (std::min)(count, getNumPoints() - m_index);
+    point_count_t start = view->size();
 
-    PointId i = 0;
     if (m_header.compressed())
     {
 #if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
         if (m_compression == "LASZIP" || m_compression == "LAZPERF")
         {
-            for (i = 0; i < count; i++)
+            point_count_t end = m_index + count;
+            while (m_index < end)
             {
-                PointRef point = view->point(i);
                 PointId id = view->size();
-                processOne(point);
-                if (m_cb)
+                PointRef point(*view, id);
+                if (nextPoint(point) && m_cb)
                     m_cb(*view, id);
             }
         }
@@ -653,9 +947,12 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
             "LAZperf decompression library.");
 #endif
     }
+    else if (m_mapped)
+        readMapped(*view, count);
     else
     {
         point_count_t remaining = count;
+        point_count_t i = 0;
 
         // Make a buffer at most a meg.
         size_t bufsize = (std::min)((point_count_t)1000000, count * pointLen);
@@ -667,15 +964,24 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
                 point_count_t blockPoints = readFileBlock(buf, remaining);
                 remaining -= blockPoints;
                 char *pos = buf.data();
+                if (m_pointDecoder)
+                {
+                    loadPoints(*view, pos, blockPoints);
+                    i += blockPoints;
+                    continue;
+                }
                 while (blockPoints--)
                 {
-                    PointId id = view->size();
-                    PointRef point = view->point(id);
-                    loadPoint(point, pos, pointLen);
-                    if (m_cb)
-                        m_cb(*view, id);
-                    pos += pointLen;
                     i++;
+                    if (!m_predicate || positionPasses(pos))
+                    {
+                        PointId id = view->size();
+                        PointRef point = view->point(id);
+                        loadPoint(point, pos, pointLen);
+                        if (m_cb)
+                            m_cb(*view, id);
+                    }
+                    pos += pointLen;
                 }
             } while (remaining);
         }
@@ -683,9 +989,9 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
         {}
         catch (invalid_stream&)
         {}
+        m_index += i;
     }
-    m_index += i;
-    return (point_count_t)i;
+    return view->size() - start;
 }
 
 
@@ -724,6 +1030,97 @@ void LasReader::loadPoint(PointRef& point, laszip_point& p)
 #endif // PDAL_HAVE_LASZIP
 
 
+// Decode uncompressed points directly from the mapped file.  The stream
+// is kept positioned after the last point read so that it stays in step
+// with the mapped reads.
+point_count_t LasReader::readMapped(PointView& view, point_count_t count)
+{
+    size_t pointLen = m_header.pointLen();
+    size_t offset = m_header.pointOffset() + m_index * pointLen;
+    size_t mapSize = m_streamIf->mapSize();
+
+    // A truncated file has fewer points than the header claims.
+    point_count_t avail = 0;
+    if (mapSize > offset)
+        avail = (mapSize - offset) / pointLen;
+    count = (std::min)(count, avail);
+
+    // Decode about a meg at a time so that the source pages are still
+    // in cache when extra dimensions are extracted.
+    const point_count_t blockSize =
+        (std::max)((point_count_t)1, (point_count_t)(1000000 / pointLen));
+    const char *pos = m_mapped + offset;
+    point_count_t remaining = count;
+    while (remaining)
+    {
+        point_count_t blockPoints = (std::min)(remaining, blockSize);
+        loadPoints(view, pos, blockPoints);
+        pos += blockPoints * pointLen;
+        remaining -= blockPoints;
+    }
+    m_index += count;
+
+    std::istream *stream(m_streamIf->m_istream);
+    stream->clear();
+    stream->seekg(offset + count * pointLen);
+    return count;
+}
+
+
+// Decode a block of uncompressed points with the bulk decoder, skipping
+// runs of points that can't pass the pushed-down predicate.
+void LasReader::loadPoints(PointView& view, const char *buf,
+    point_count_t count)
+{
+    if (!m_predicate)
+    {
+        decodePoints(view, buf, count);
+        return;
+    }
+
+    size_t pointLen = m_header.pointLen();
+    point_count_t runStart = 0;
+    for (point_count_t i = 0; i < count; ++i)
+        if (!positionPasses(buf + i * pointLen))
+        {
+            if (i > runStart)
+                decodePoints(view, buf + runStart * pointLen, i - runStart);
+            runStart = i + 1;
+        }
+    if (count > runStart)
+        decodePoints(view, buf + runStart * pointLen, count - runStart);
+}
+
+
+// Decode a block of uncompressed points with the bulk decoder.  Extra
+// dimensions and the per-point callback are handled once the standard
+// fields of all the points have been set.
+void LasReader::decodePoints(PointView& view, const char *buf,
+    point_count_t count)
+{
+    size_t pointLen = m_header.pointLen();
+    PointId start = view.size();
+
+    m_pointDecoder->decode(buf, count, view);
+
+    if (m_extraDims.size())
+    {
+        size_t baseLen = m_pointDecoder->baseLen();
+        const char *pos = buf + baseLen;
+        for (PointId idx = start; idx < start + count; ++idx)
+        {
+            LeExtractor extractor(pos, pointLen - baseLen);
+            PointRef point(view, idx);
+            loadExtraDims(extractor, point);
+            pos += pointLen;
+        }
+    }
+    if (m_cb)
+        for (PointId idx = start; idx < start + count; ++idx)
+            m_cb(view, idx);
+}
+
+
 void LasReader::loadPoint(PointRef& point, char *buf, size_t bufsize)
 {
     if (m_header.has14Format())
@@ -988,6 +1385,7 @@ void LasReader::done(PointTableRef)
         handleLaszip(laszip_destroy(m_laszip));
     }
 #endif
+    m_mapped = nullptr;
     m_streamIf.reset();
 }
 
@@ -39,6 +39,7 @@
 #include <pdal/PDALUtils.hpp>
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 #ifdef PDAL_HAVE_LASZIP
 #include <laszip/laszip_api.h>
@@ -60,6 +61,7 @@ class LasHeader;
 class LeExtractor;
 class PointDimensions;
 class LazPerfVlrDecompressor;
+class LasPointDecoder;
 
 class PDAL_DLL LasReader : public Reader, public Streamable
 {
@@ -71,16 +73,46 @@ protected:
         {}
 
     public:
-        LasStreamIf(const std::string& filename)
+        LasStreamIf(const std::string& filename) : m_filename(filename)
             { m_istream = Utils::openFile(filename); }
 
         virtual ~LasStreamIf()
         {
+            if (m_map.addr())
+                FileUtils::unmapFile(m_map);
             if (m_istream)
                 Utils::closeFile(m_istream);
         }
 
+        // Map the file into memory for sequential reading.  Returns a
+        // pointer to the start of the file, or nullptr if the stream
+        // doesn't refer to a file that can be mapped.
+        const char *map()
+        {
+            if (!m_map.addr() && m_filename.size() &&
+                FileUtils::fileExists(m_filename))
+            {
+                uintmax_t size = FileUtils::fileSize(m_filename);
+                if (size)
+                    m_map = FileUtils::mapFile(m_filename, true, 0,
+                        (size_t)size);
+                if (m_map.addr())
+                    FileUtils::adviseSequential(m_map);
+                else if (m_map.m_fd != -1)
+                    m_map = FileUtils::unmapFile(m_map);
+            }
+            return static_cast<const char *>(m_map.addr());
+        }
+
+        // Size of the mapped region, or 0 if the file isn't mapped.
+        size_t mapSize() const
+            { return m_map.addr() ? m_map.m_size : 0; }
+
         std::istream *m_istream;
+
+    private:
+        std::string m_filename;
+        FileUtils::MapContext m_map;
     };
 
     friend class NitfReader;
@@ -109,13 +141,20 @@ private:
 
     LazPerfVlrDecompressor *m_decompressor;
     std::vector<char> m_decompressorBuf;
+    std::unique_ptr<LasPointDecoder> m_pointDecoder;
     point_count_t m_index;
+    const char *m_mapped;
     StringList m_extraDimSpec;
     std::vector<ExtraDim> m_extraDims;
     IgnoreVLRList m_ignoreVLRs;
     std::string m_compression;
     StringList m_ignoreVLROption;
     bool m_useEbVlr;
+    int m_threads;
+    ReadPredicatePtr m_predicate;
+    point_count_t m_chunkSize;
+    std::vector<bool> m_skipChunks;
+    std::vector<BOX3D> m_chunkBounds;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize(PointTableRef table)
@@ -139,6 +178,15 @@ private:
     void loadPointV10(PointRef& point, laszip_point& p);
     void loadPointV14(PointRef& point, laszip_point& p);
     void loadPoint(PointRef& point, char *buf, size_t bufsize);
+    bool nextPoint(PointRef& point);
+    void setupPredicate(PointTableRef table);
+    bool readChunkBoundsVlr(std::vector<BOX3D>& bounds);
+    void skipChunks();
+    bool positionPasses(PointId idx, int32_t xi, int32_t yi, int32_t zi);
+    bool positionPasses(const char *buf);
+    void loadPoints(PointView& view, const char *buf, point_count_t count);
+    void decodePoints(PointView& view, const char *buf, point_count_t count);
+    point_count_t readMapped(PointView& view, point_count_t count);
     void loadPointV10(PointRef& point, char *buf, size_t bufsize);
     void loadPointV14(PointRef& point, char *buf, size_t bufsize);
     void loadExtraDims(LeExtractor& istream, PointRef& data);
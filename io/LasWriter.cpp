@@ -54,6 +54,7 @@
 
 #include <climits>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include <pdal/pdal_features.hpp>
@@ -61,6 +62,7 @@
 #include <pdal/PDALUtils.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/Extractor.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/util/Inserter.hpp>
 #include <pdal/util/OStream.hpp>
@@ -87,7 +89,8 @@ CREATE_STATIC_STAGE(LasWriter, s_info)
 std::string LasWriter::getName() const { return s_info.name; }
 
 LasWriter::LasWriter() : m_compressor(nullptr), m_ostream(NULL),
-    m_compression(LasCompression::None), m_srsCnt(0)
+    m_compression(LasCompression::None), m_srsCnt(0), m_chunkSize(0),
+    m_threads(1)
 {}
 
 
@@ -146,6 +149,8 @@ void LasWriter::addArgs(ProgramArgs& args)
     args.add("offset_y", "Y offset", m_offsetY);
     args.add("offset_z", "Z offset", m_offsetZ);
     args.add("vlrs", "List of VLRs to set", m_userVLRs);
+    args.add("threads", "Number of threads used to compress LAZ output "
+        "with LAZperf", m_threads, 1);
 }
 
 void LasWriter::initialize()
@@ -154,12 +159,19 @@ void LasWriter::initialize()
     ext = Utils::tolower(ext);
     if ((ext == ".laz") && (m_compression == LasCompression::None))
     {
-#if defined(PDAL_HAVE_LASZIP)
+#if defined(PDAL_HAVE_LASZIP) && defined(PDAL_HAVE_LAZPERF)
+        // Only LAZperf compression can be run on multiple threads.
+        m_compression = (m_threads > 1) ? LasCompression::LazPerf :
+            LasCompression::LasZip;
+#elif defined(PDAL_HAVE_LASZIP)
         m_compression = LasCompression::LasZip;
 #elif defined(PDAL_HAVE_LAZPERF)
         m_compression = LasCompression::LazPerf;
 #endif
     }
+    if (m_threads > 1 && m_compression == LasCompression::LasZip)
+        log()->get(LogLevel::Warning) << getName() << ": Option 'threads' "
+            "is ignored when compressing with LASzip." << std::endl;
 
     if (!m_aSrs.empty())
         setSpatialReference(m_aSrs);
@@ -331,6 +343,8 @@ void LasWriter::prepOutput(std::ostream *outStream, const SpatialReference& srs)
     addSpatialRefVlrs();
 
     m_summaryData.reset(new LasSummaryData());
+    m_chunkSize = 0;
+    m_chunkBounds.clear();
     m_ostream = outStream;
     if (m_lasHeader.compressed())
         readyCompression();
@@ -703,6 +717,17 @@ void LasWriter::readyLasZipCompression()
     std::vector<laszip_U8> vlrData(data + 54, data + size);
 
     addVlr(LASZIP_USER_ID, LASZIP_RECORD_ID, "http://laszip.org", vlrData);
+
+    // Version 1.4 files get an extended VLR with the bounds of each chunk
+    // so that readers can skip chunks.  The chunk size is at offset 12 of
+    // the LASzip VLR.
+    if (m_lasHeader.versionAtLeast(1, 4) && vlrData.size() >= 16)
+    {
+        LeExtractor in((const char *)vlrData.data() + 12, sizeof(uint32_t));
+        in >> m_chunkSize;
+        if (m_chunkSize == (std::numeric_limits<uint32_t>::max)())
+            m_chunkSize = 0;
+    }
 #endif
 }
 
@@ -726,7 +751,7 @@ void LasWriter::readyLazPerfCompression()
 
     delete m_compressor;
     m_compressor = new LazPerfVlrCompressor(*m_ostream, schema,
-        zipvlr.chunk_size);
+        zipvlr.chunk_size, m_threads);
 #endif
 }
 
@@ -986,6 +1011,8 @@ bool LasWriter::writeLasZipBuf(PointRef& point)
     p.extra_bytes = (laszip_U8 *)m_pointBuf.data();
     p.num_extra_bytes = m_extraByteLen;
 
+    if (m_chunkSize)
+        addChunkBounds(p.X, p.Y, p.Z);
     m_summaryData->addPoint(xOrig, yOrig, zOrig, returnNumber);
 
     handleLaszip(laszip_set_point(m_laszip, &p));
@@ -995,6 +1022,27 @@ bool LasWriter::writeLasZipBuf(PointRef& point)
 }
 
 
+// Grow the bounds of the chunk holding the point about to be written.
+// Bounds are kept as the scaled integer values stored in the file.
+void LasWriter::addChunkBounds(int32_t x, int32_t y, int32_t z)
+{
+    size_t pos = (size_t)(m_summaryData->getTotalNumPoints() / m_chunkSize);
+    pos *= 6;
+    if (pos == m_chunkBounds.size())
+    {
+        m_chunkBounds.insert(m_chunkBounds.end(), { x, y, z, x, y, z });
+        return;
+    }
+    int32_t *b = m_chunkBounds.data() + pos;
+    b[0] = (std::min)(b[0], x);
+    b[1] = (std::min)(b[1], y);
+    b[2] = (std::min)(b[2], z);
+    b[3] = (std::max)(b[3], x);
+    b[4] = (std::max)(b[4], y);
+    b[5] = (std::max)(b[5], z);
+}
+
+
 void LasWriter::writeLazPerfBuf(char *pos, size_t pointLen,
     point_count_t numPts)
 {
@@ -1176,6 +1224,22 @@ void LasWriter::finishOutput()
         out << evlr;
     }
 
+    // The chunk bounds VLR holds the chunk size followed by the minimum and
+    // maximum X, Y and Z of each chunk.
+    if (m_chunkBounds.size())
+    {
+        std::vector<uint8_t> data(sizeof(uint32_t) +
+            m_chunkBounds.size() * sizeof(int32_t));
+        LeInserter ins((char *)data.data(), data.size());
+        ins << m_chunkSize;
+        for (int32_t i : m_chunkBounds)
+            ins << i;
+        out << ExtLasVLR(PDAL_USER_ID, PDAL_CHUNK_BOUNDS_RECORD_ID,
+            "PDAL chunk bounds", data);
+        m_lasHeader.setEVlrCount(m_eVlrs.size() + 1);
+        m_chunkBounds.clear();
+    }
+
     // Reset the offset/scale since it may have been auto-computed
     try
     {
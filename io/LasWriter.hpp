@@ -104,6 +104,8 @@ private:
     std::vector<char> m_pointBuf;
     SpatialReference m_aSrs;
     int m_srsCnt;
+    uint32_t m_chunkSize;
+    std::vector<int32_t> m_chunkBounds;
 
     NumHeaderVal<uint8_t, 1, 1> m_majorVersion;
     NumHeaderVal<uint8_t, 1, 4> m_minorVersion;
@@ -129,6 +131,7 @@ private:
     bool m_writePDALMetadata;
     std::vector<ExtLasVLR> m_userVLRs;
     bool m_firstPoint;
+    int m_threads;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
@@ -156,6 +159,7 @@ private:
     point_count_t fillWriteBuf(const PointView& view, PointId startId,
         std::vector<char>& buf);
     bool writeLasZipBuf(PointRef& point);
+    void addChunkBounds(int32_t x, int32_t y, int32_t z);
     void writeLazPerfBuf(char *data, size_t pointLen, point_count_t numPts);
     void addForwardVlrs();
     void addMetadataVlr(MetadataNode& forward);
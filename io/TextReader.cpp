@@ -34,10 +34,14 @@
 
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/private/ThreadBudget.hpp>
 
 #include "TextReader.hpp"
+#include "private/text/TextNumber.hpp"
 #include "../filters/StatsFilter.hpp"
 
+#include <cstring>
+
 namespace pdal
 {
 
@@ -53,6 +57,27 @@ CREATE_STATIC_STAGE(TextReader, s_info)
 
 std::string TextReader::getName() const { return s_info.name; }
 
+namespace
+{
+
+// Amount of input parsed by each thread at a time.
+const size_t BlockSize = 4 * 1024 * 1024;
+
+// Blocks smaller than this aren't split among threads.
+const size_t MinChunkSize = 256 * 1024;
+
+} // unnamed namespace
+
+
+TextReader::TextReader() : m_istream(NULL), m_pos(0), m_end(0), m_eof(false),
+    m_numChunks(0), m_curChunk(0), m_chunkPos(0)
+{}
+
+
+TextReader::~TextReader()
+{}
+
+
 // NOTE: - Forces reading of the entire file.
 QuickInfo TextReader::inspect()
 {
@@ -226,6 +251,8 @@ void TextReader::addArgs(ProgramArgs& args)
     args.add("header", "Use this string as the header line.", m_header);
     args.add("skip", "Skip this number of lines before attempting to "
         "read the header.", m_skip);
+    args.add("threads", "Number of threads used to parse the input.  "
+        "0 takes threads from the thread budget", m_threads, (size_t)4);
 }
 
 
@@ -251,86 +278,313 @@ void TextReader::ready(PointTableRef table)
     if (!m_istream)
         throwError("Unable to open text file '" + m_filename + "'.");
 
-    std::string dummy;
+    m_group.reset(m_threads ? new ThreadGroup(m_threads, false) :
+        new ThreadGroup);
+    m_buf.resize(m_group->size() * BlockSize);
+    m_pos = 0;
+    m_end = 0;
+    m_eof = false;
+
+    m_chunks.resize(m_group->size());
+    m_numChunks = 0;
+    m_curChunk = 0;
+    m_chunkPos = 0;
+
+    const char *pos;
+    const char *end;
     for (size_t i = 0; i < m_line; ++i)
-	std::getline(*m_istream, dummy);
+        if (!nextLine(pos, end))
+            break;
 }
 
 
-point_count_t TextReader::read(PointViewPtr view, point_count_t numPts)
+bool TextReader::fill()
 {
-    PointId idx = view->size();
-    point_count_t cnt = 0;
-    PointRef point(*view, idx);
-    while (cnt < numPts)
+    if (m_eof)
+        return false;
+
+    size_t remain = m_end - m_pos;
+    if (m_pos)
     {
-        point.setPointId(idx);
-        if (!processOne(point))
-            break;
-        cnt++;
-        idx++;
+        std::memmove(m_buf.data(), m_buf.data() + m_pos, remain);
+        m_pos = 0;
+        m_end = remain;
     }
-    return cnt;
+    if (m_end == m_buf.size())
+        m_buf.resize(m_buf.size() * 2);
+
+    m_istream->read(m_buf.data() + m_end, m_buf.size() - m_end);
+    size_t cnt = static_cast<size_t>(m_istream->gcount());
+    m_end += cnt;
+    if (!m_istream->good())
+        m_eof = true;
+    return cnt > 0;
 }
 
 
-bool TextReader::processOne(PointRef& point)
+bool TextReader::nextLine(const char *& pos, const char *& end)
 {
-    if (!fillFields())
-        return false;
+    while (true)
+    {
+        const char *start = m_buf.data() + m_pos;
+        const char *nl = static_cast<const char *>(
+            std::memchr(start, '\n', m_end - m_pos));
+        if (nl)
+        {
+            pos = start;
+            end = nl;
+            m_pos = nl + 1 - m_buf.data();
+            return true;
+        }
+        if (!fill())
+        {
+            // Last line, without a newline.
+            if (m_pos == m_end)
+                return false;
+            pos = m_buf.data() + m_pos;
+            end = m_buf.data() + m_end;
+            m_pos = m_end;
+            return true;
+        }
+    }
+}
+
 
-    double d;
-    for (size_t i = 0; i < m_fields.size(); ++i)
+bool TextReader::nextBlock(const char *& pos, const char *& end)
+{
+    fill();
+    while (true)
     {
-        if (!Utils::fromString(m_fields[i], d))
+        const char *start = m_buf.data() + m_pos;
+        const char *last = m_buf.data() + m_end;
+        while (last > start && last[-1] != '\n')
+            last--;
+        if (last > start)
         {
-            log()->get(LogLevel::Error) << "Can't convert "
-                "field '" << m_fields[i] << "' to numeric value on line " <<
-                m_line << " in '" << m_filename << "'.  Setting to 0." <<
-                std::endl;
-            d = 0;
+            pos = start;
+            end = last;
+            m_pos = last - m_buf.data();
+            return true;
+        }
+
+        // No newline: either a line longer than the buffer or the last
+        // line of the file.
+        if (!fill())
+        {
+            if (m_pos == m_end)
+                return false;
+            pos = m_buf.data() + m_pos;
+            end = m_buf.data() + m_end;
+            m_pos = m_end;
+            return true;
         }
-        point.setField(m_dims[i], d);
     }
+}
+
+
+bool TextReader::parseBlock()
+{
+    const char *pos;
+    const char *end;
+    if (!nextBlock(pos, end))
+        return false;
+
+    // Split the block into roughly equal pieces at line boundaries.
+    size_t len = end - pos;
+    m_numChunks = (std::min)(m_chunks.size(),
+        (std::max)(len / MinChunkSize, (size_t)1));
+    std::vector<const char *> bounds { pos };
+    for (size_t i = 1; i < m_numChunks; ++i)
+    {
+        const char *split =
+            (std::max)(bounds.back(), pos + len * i / m_numChunks);
+        const char *nl = static_cast<const char *>(
+            std::memchr(split, '\n', end - split));
+        bounds.push_back(nl ? nl + 1 : end);
+    }
+    bounds.push_back(end);
+
+    m_group->run(m_numChunks, [this, &bounds](size_t i)
+    {
+        parseLines(bounds[i], bounds[i + 1], m_chunks[i]);
+    });
+
+    for (size_t i = 0; i < m_numChunks; ++i)
+    {
+        report(m_chunks[i], m_line);
+        m_line += m_chunks[i].lines;
+    }
+    m_curChunk = 0;
+    m_chunkPos = 0;
     return true;
 }
 
 
-bool TextReader::fillFields()
+void TextReader::parseLines(const char *pos, const char *end,
+    Chunk& chunk) const
 {
-    while (true)
+    chunk.values.clear();
+    chunk.problems.clear();
+    chunk.lines = 0;
+    while (pos < end)
     {
-        if (!m_istream->good())
-            return false;
+        const char *nl = static_cast<const char *>(
+            std::memchr(pos, '\n', end - pos));
+        const char *eol = nl ? nl : end;
+        parseLine(pos, eol, ++chunk.lines, chunk);
+        pos = nl ? nl + 1 : end;
+    }
+}
 
-        std::string buf;
 
-        std::getline(*m_istream, buf);
-        m_line++;
-        if (buf.empty())
-            continue;
-        if (m_separator != ' ')
+bool TextReader::parseLine(const char *pos, const char *end, size_t line,
+    Chunk& chunk) const
+{
+    if (end > pos && end[-1] == '\r')
+        end--;
+    if (pos == end)
+        return false;
+
+    // Fields point into the input, so splitting doesn't allocate once the
+    // field list has grown to the number of dimensions.
+    std::vector<Field>& fields = chunk.fields;
+    fields.clear();
+    if (m_separator != ' ')
+    {
+        // Spaces are ignored, so a line of only spaces has no fields.
+        const char *start = pos;
+        bool blank = true;
+        for (const char *c = pos; c != end; ++c)
         {
-            Utils::remove(buf, ' ');
-            m_fields = Utils::split(buf, m_separator);
+            if (*c == m_separator)
+            {
+                fields.emplace_back(start, c);
+                start = c + 1;
+            }
+            if (*c != ' ')
+                blank = false;
         }
-        else
-            m_fields = Utils::split2(buf, m_separator);
-        if (m_fields.size() != m_dims.size())
+        if (!blank)
+            fields.emplace_back(start, end);
+    }
+    else
+    {
+        const char *start = pos;
+        for (const char *c = pos; c != end; ++c)
+            if (*c == ' ')
+            {
+                if (c != start)
+                    fields.emplace_back(start, c);
+                start = c + 1;
+            }
+        if (start != end)
+            fields.emplace_back(start, end);
+    }
+
+    if (fields.size() != m_dims.size())
+    {
+        chunk.problems.push_back({ line, true, fields.size(), "" });
+        return false;
+    }
+
+    for (const Field& f : fields)
+    {
+        double d;
+        if (!textnum::parseDouble(f.first, f.second, d))
         {
-            log()->get(LogLevel::Error) << "Line " << m_line <<
-                " in '" << m_filename << "' contains " << m_fields.size() <<
+            // Not a plain number.  Use the general conversion.
+            std::string s(f.first, f.second);
+            if (m_separator != ' ')
+                Utils::remove(s, ' ');
+            if (!Utils::fromString(s, d))
+            {
+                chunk.problems.push_back({ line, false, 0, s });
+                d = 0;
+            }
+        }
+        chunk.values.push_back(d);
+    }
+    return true;
+}
+
+
+void TextReader::report(const Chunk& chunk, size_t base)
+{
+    for (const Problem& p : chunk.problems)
+    {
+        if (p.badCount)
+            log()->get(LogLevel::Error) << "Line " << (base + p.line) <<
+                " in '" << m_filename << "' contains " << p.numFields <<
                 " fields when " << m_dims.size() << " were expected.  "
                 "Ignoring." << std::endl;
+        else
+            log()->get(LogLevel::Error) << "Can't convert "
+                "field '" << p.field << "' to numeric value on line " <<
+                (base + p.line) << " in '" << m_filename <<
+                "'.  Setting to 0." << std::endl;
+    }
+}
+
+
+point_count_t TextReader::read(PointViewPtr view, point_count_t numPts)
+{
+    PointId idx = view->size();
+    point_count_t cnt = 0;
+    const size_t numDims = m_dims.size();
+    while (cnt < numPts)
+    {
+        if (m_curChunk == m_numChunks)
+        {
+            if (!parseBlock())
+                break;
+            continue;
+        }
+
+        const std::vector<double>& values = m_chunks[m_curChunk].values;
+        if (m_chunkPos == values.size())
+        {
+            m_curChunk++;
+            m_chunkPos = 0;
             continue;
         }
+
+        const double *v = values.data() + m_chunkPos;
+        for (size_t i = 0; i < numDims; ++i)
+            view->setField(m_dims[i], idx, v[i]);
+        m_chunkPos += numDims;
+        cnt++;
+        idx++;
+    }
+    return cnt;
+}
+
+
+bool TextReader::processOne(PointRef& point)
+{
+    Chunk& chunk = m_chunks[0];
+    const char *pos;
+    const char *end;
+    while (nextLine(pos, end))
+    {
+        chunk.values.clear();
+        chunk.problems.clear();
+        bool ok = parseLine(pos, end, ++m_line, chunk);
+        report(chunk, 0);
+        if (!ok)
+            continue;
+        for (size_t i = 0; i < m_dims.size(); ++i)
+            point.setField(m_dims[i], chunk.values[i]);
         return true;
     }
+    return false;
 }
 
 
 void TextReader::done(PointTableRef table)
 {
+    m_group.reset();
+    m_chunks.clear();
+    std::vector<char>().swap(m_buf);
     Utils::closeFile(m_istream);
 }
 
@@ -35,6 +35,9 @@
 #pragma once
 
 #include <istream>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
@@ -42,15 +45,38 @@
 namespace pdal
 {
 
+class ThreadGroup;
+
 class PDAL_DLL TextReader : public Reader, public Streamable
 {
 public:
     std::string getName() const;
 
-    TextReader() : m_istream(NULL)
-    {}
+    TextReader();
+    ~TextReader();
 
 private:
+    typedef std::pair<const char *, const char *> Field;
+
+    // A problem found while parsing, to be logged once the lines before
+    // it have been counted.
+    struct Problem
+    {
+        size_t line;
+        bool badCount;
+        size_t numFields;
+        std::string field;
+    };
+
+    // Values parsed from a range of lines, stored point by point.
+    struct Chunk
+    {
+        std::vector<double> values;
+        std::vector<Problem> problems;
+        std::vector<Field> fields;
+        size_t lines;
+    };
+
     /**
       Retrieve summary information for the file. NOTE - entire file must
       be read to retrieve summary for text files.
@@ -111,7 +137,70 @@ private:
     */
     virtual bool processOne(PointRef& point);
 
-    bool fillFields();
+    /**
+      Read more data from the input into the buffer, keeping any data
+      that hasn't been consumed.  The buffer is grown if it's full.
+
+      \return  False if no more data could be read.
+    */
+    bool fill();
+
+    /**
+      Get the next line from the buffer, without its newline.
+
+      \param pos  Set to the start of the line.
+      \param end  Set to the end of the line.
+      \return  False if there are no more lines.
+    */
+    bool nextLine(const char *& pos, const char *& end);
+
+    /**
+      Get the largest run of whole lines available from the buffer.
+
+      \param pos  Set to the start of the block.
+      \param end  Set to the end of the block.
+      \return  False if there are no more lines.
+    */
+    bool nextBlock(const char *& pos, const char *& end);
+
+    /**
+      Parse the next block of lines into the chunk list, splitting it
+      among threads at line boundaries.
+
+      \return  False if there are no more lines.
+    */
+    bool parseBlock();
+
+    /**
+      Parse a range of lines, appending their values to a chunk.  Safe to
+      call from multiple threads with different chunks.
+
+      \param pos  Start of the lines.
+      \param end  End of the lines.
+      \param chunk  Chunk to fill.
+    */
+    void parseLines(const char *pos, const char *end, Chunk& chunk) const;
+
+    /**
+      Split a line into fields and parse them, appending the values to
+      a chunk.  Empty lines are ignored.
+
+      \param pos  Start of the line.
+      \param end  End of the line, not including the newline.
+      \param line  Line number to use when reporting problems.
+      \param chunk  Chunk to fill.
+      \return  True if the line produced a point.
+    */
+    bool parseLine(const char *pos, const char *end, size_t line,
+        Chunk& chunk) const;
+
+    /**
+      Log the problems found while parsing a chunk.
+
+      \param chunk  Parsed chunk.
+      \param base  Number of lines before the chunk.
+    */
+    void report(const Chunk& chunk, size_t base);
 
     /**
       Parse a header line into a list of dimension names.
@@ -148,10 +237,21 @@ private:
     std::istream *m_istream;
     StringList m_dimNames;
     Dimension::IdList m_dims;
-    StringList m_fields;
     size_t m_line;
     std::string m_header;
     size_t m_skip;
+    size_t m_threads;
+
+    std::vector<char> m_buf;
+    size_t m_pos;
+    size_t m_end;
+    bool m_eof;
+
+    std::unique_ptr<ThreadGroup> m_group;
+    std::vector<Chunk> m_chunks;
+    size_t m_numChunks;
+    size_t m_curChunk;
+    size_t m_chunkPos;
 };
 
 } // namespace pdal
@@ -40,6 +40,8 @@
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
+#include "private/text/TextNumber.hpp"
+
 #include <iostream>
 
 namespace pdal
@@ -57,6 +59,14 @@ CREATE_STATIC_STAGE(TextWriter, s_info)
 
 std::string TextWriter::getName() const { return s_info.name; }
 
+namespace
+{
+
+// Formatted points are collected until there's at least this much output.
+const size_t BufSize = 64 * 1024;
+
+} // unnamed namespace
+
 std::istream& operator >> (std::istream& in, TextWriter::OutputType& type)
 {
     std::string s;
@@ -168,7 +178,8 @@ bool TextWriter::findDim(Dimension::Id id, DimSpec& ds)
 
 void TextWriter::ready(PointTableRef table)
 {
-    *m_stream << std::fixed;
+    m_buf.clear();
+    m_buf.reserve(BufSize * 2);
 
     m_xDim = { Dimension::Id::X, static_cast<size_t>(m_precision),
         table.layout()->dimName(Dimension::Id::X) };
@@ -224,8 +235,16 @@ void TextWriter::writeHeader(PointTableRef table)
 }
 
 
+void TextWriter::flush()
+{
+    m_stream->write(m_buf.data(), m_buf.size());
+    m_buf.clear();
+}
+
+
 void TextWriter::writeFooter()
 {
+    flush();
     if (m_outputType == OutputType::GEOJSON)
     {
         *m_stream << "]}";
@@ -266,42 +285,50 @@ void TextWriter::processOneCSV(PointRef& point)
     for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
     {
         if (di != m_dims.begin())
-            *m_stream << m_delimiter;
-        m_stream->precision(di->precision);
-        *m_stream << point.getFieldAs<double>(di->id);
+            m_buf += m_delimiter;
+        textnum::appendFixed(point.getFieldAs<double>(di->id),
+            di->precision, m_buf);
     }
-    *m_stream << m_newline;
+    m_buf += m_newline;
+    if (m_buf.size() >= BufSize)
+        flush();
 }
 
 void TextWriter::processOneGeoJSON(PointRef& point)
 {
     if (m_idx > 0)
-        *m_stream << ",";
-    *m_stream << "{ \"type\":\"Feature\",\"geometry\": "
+        m_buf += ",";
+    m_buf += "{ \"type\":\"Feature\",\"geometry\": "
         "{ \"type\": \"Point\", \"coordinates\": [";
 
-    m_stream->precision(m_xDim.precision);
-    *m_stream << point.getFieldAs<double>(Dimension::Id::X) << ",";
-    m_stream->precision(m_yDim.precision);
-    *m_stream << point.getFieldAs<double>(Dimension::Id::Y) << ",";
-    m_stream->precision(m_zDim.precision);
-    *m_stream << point.getFieldAs<double>(Dimension::Id::Z) << "]},";
+    textnum::appendFixed(point.getFieldAs<double>(Dimension::Id::X),
+        m_xDim.precision, m_buf);
+    m_buf += ",";
+    textnum::appendFixed(point.getFieldAs<double>(Dimension::Id::Y),
+        m_yDim.precision, m_buf);
+    m_buf += ",";
+    textnum::appendFixed(point.getFieldAs<double>(Dimension::Id::Z),
+        m_zDim.precision, m_buf);
+    m_buf += "]},";
 
-    *m_stream << "\"properties\": {";
+    m_buf += "\"properties\": {";
 
     for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
     {
         if (di != m_dims.begin())
-            *m_stream << ",";
-
-        *m_stream << "\"" << di->name << "\":";
-        *m_stream << "\"";
-        m_stream->precision(di->precision);
-        *m_stream << point.getFieldAs<double>(di->id);
-        *m_stream <<"\"";
+            m_buf += ",";
+
+        m_buf += "\"";
+        m_buf += di->name;
+        m_buf += "\":\"";
+        textnum::appendFixed(point.getFieldAs<double>(di->id),
+            di->precision, m_buf);
+        m_buf += "\"";
     }
-    *m_stream << "}"; // end properties
-    *m_stream << "}"; // end feature
+    m_buf += "}"; // end properties
+    m_buf += "}"; // end feature
+    if (m_buf.size() >= BufSize)
+        flush();
 }
 
 
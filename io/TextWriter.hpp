@@ -77,6 +77,7 @@ private:
 
     void writeHeader(PointTableRef table);
     void writeFooter();
+    void flush();
     void writeGeoJSONHeader();
     void writeCSVHeader(PointTableRef table);
     void processOneCSV(PointRef& point);
@@ -99,6 +100,7 @@ private:
     PointId m_idx;
 
     FileStreamPtr m_stream;
+    std::string m_buf;
     std::vector<DimSpec> m_dims;
     DimSpec m_xDim;
     DimSpec m_yDim;
@@ -0,0 +1,378 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <pdal/PointLayout.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/portable_endian.hpp>
+#include <io/LasHeader.hpp>
+
+#include "LasPointDecoder.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+template<typename T>
+T leValue(const char *pos);
+
+template<>
+inline uint8_t leValue<uint8_t>(const char *pos)
+    { return (uint8_t)*pos; }
+
+template<>
+inline int8_t leValue<int8_t>(const char *pos)
+    { return (int8_t)*pos; }
+
+template<>
+inline uint16_t leValue<uint16_t>(const char *pos)
+{
+    uint16_t v;
+    std::memcpy(&v, pos, sizeof(v));
+    return le16toh(v);
+}
+
+template<>
+inline int16_t leValue<int16_t>(const char *pos)
+    { return (int16_t)leValue<uint16_t>(pos); }
+
+template<>
+inline int32_t leValue<int32_t>(const char *pos)
+{
+    uint32_t v;
+    std::memcpy(&v, pos, sizeof(v));
+    return (int32_t)le32toh(v);
+}
+
+template<>
+inline double leValue<double>(const char *pos)
+{
+    uint64_t v;
+    std::memcpy(&v, pos, sizeof(v));
+    v = le64toh(v);
+
+    double d;
+    std::memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+// Field offsets of a point format.  Formats 0 - 3 have a 20 byte base
+// record and formats 6 - 8 a 30 byte base record that includes GPS time.
+template<bool V14, bool Time, bool Color, bool Nir>
+struct LasFormat
+{
+    static const bool v14 = V14;
+    static const bool hasTime = V14 || Time;
+    static const bool hasColor = Color;
+    static const bool hasNir = Nir;
+    static const size_t timeOffset = V14 ? 22 : 20;
+    static const size_t colorOffset = V14 ? 30 : (Time ? 28 : 20);
+    static const size_t nirOffset = 36;
+    static const size_t baseLen = (V14 ? 30 : (Time ? 28 : 20)) +
+        (Color ? 6 : 0) + (Nir ? 2 : 0);
+};
+
+template<typename Format>
+class LasPointDecoderT : public LasPointDecoder
+{
+public:
+    LasPointDecoderT(const LasHeader& h) : m_pointLen(h.pointLen()),
+        m_scale { h.scaleX(), h.scaleY(), h.scaleZ() },
+        m_offset { h.offsetX(), h.offsetY(), h.offsetZ() }
+    {}
+
+    virtual size_t baseLen() const
+        { return Format::baseLen; }
+
+    virtual void decode(const char *buf, point_count_t count,
+        PointView& view)
+    {
+        using namespace Dimension;
+
+        const PointId start = view.size();
+
+        // Add the points.  Tables that store points as rows give us the
+        // address of each point, so fields can be stored directly.  Column
+        // tables are written a run of points at a time.
+        m_rows.resize(count);
+        for (point_count_t i = 0; i < count; ++i)
+            m_rows[i] = view.getOrAddPoint(start + i);
+        if (count && !m_rows[0])
+            m_rows.clear();
+
+        decodeScaled(buf, count, 0, 0, Id::X, view, start);
+        decodeScaled(buf, count, 4, 1, Id::Y, view, start);
+        decodeScaled(buf, count, 8, 2, Id::Z, view, start);
+        decode<uint16_t>(buf, count, 12, Id::Intensity, view, start);
+
+        if (Format::v14)
+        {
+            extract(buf, count, 14, m_bytes);
+            storeBits(Id::ReturnNumber, 0, 0x0F, count, view, start);
+            storeBits(Id::NumberOfReturns, 4, 0x0F, count, view, start);
+            extract(buf, count, 15, m_bytes);
+            storeBits(Id::ClassFlags, 0, 0x0F, count, view, start);
+            storeBits(Id::ScanChannel, 4, 0x03, count, view, start);
+            storeBits(Id::ScanDirectionFlag, 6, 0x01, count, view, start);
+            storeBits(Id::EdgeOfFlightLine, 7, 0x01, count, view, start);
+            decode<uint8_t>(buf, count, 16, Id::Classification, view, start);
+            decode<uint8_t>(buf, count, 17, Id::UserData, view, start);
+
+            extract(buf, count, 18, m_shorts);
+            m_floats.resize(count);
+            for (point_count_t i = 0; i < count; ++i)
+                m_floats[i] = (float)(m_shorts[i] * .006);
+            store(Id::ScanAngleRank, m_floats, count, view, start);
+
+            decode<uint16_t>(buf, count, 20, Id::PointSourceId, view, start);
+        }
+        else
+        {
+            extract(buf, count, 14, m_bytes);
+            storeBits(Id::ReturnNumber, 0, 0x07, count, view, start);
+            storeBits(Id::NumberOfReturns, 3, 0x07, count, view, start);
+            storeBits(Id::ScanDirectionFlag, 6, 0x01, count, view, start);
+            storeBits(Id::EdgeOfFlightLine, 7, 0x01, count, view, start);
+            decode<uint8_t>(buf, count, 15, Id::Classification, view, start);
+
+            extract(buf, count, 16, m_chars);
+            m_floats.resize(count);
+            for (point_count_t i = 0; i < count; ++i)
+                m_floats[i] = (float)m_chars[i];
+            store(Id::ScanAngleRank, m_floats, count, view, start);
+
+            decode<uint8_t>(buf, count, 17, Id::UserData, view, start);
+            decode<uint16_t>(buf, count, 18, Id::PointSourceId, view, start);
+        }
+
+        if (Format::hasTime)
+            decode<double>(buf, count, Format::timeOffset, Id::GpsTime,
+                view, start);
+        if (Format::hasColor)
+        {
+            decode<uint16_t>(buf, count, Format::colorOffset, Id::Red,
+                view, start);
+            decode<uint16_t>(buf, count, Format::colorOffset + 2, Id::Green,
+                view, start);
+            decode<uint16_t>(buf, count, Format::colorOffset + 4, Id::Blue,
+                view, start);
+        }
+        if (Format::hasNir)
+            decode<uint16_t>(buf, count, Format::nirOffset, Id::Infrared,
+                view, start);
+    }
+
+private:
+    // Load the field at 'offset' of each record into 'out'.
+    template<typename T>
+    void extract(const char *buf, point_count_t count, size_t offset,
+        std::vector<T>& out)
+    {
+        out.resize(count);
+        const char *pos = buf + offset;
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            out[i] = leValue<T>(pos);
+            pos += m_pointLen;
+        }
+    }
+
+    template<typename T>
+    void store(Dimension::Id dim, const std::vector<T>& vals,
+        point_count_t count, PointView& view, PointId start)
+    {
+        if (m_rows.size())
+        {
+            const size_t offset = view.layout()->dimOffset(dim);
+            for (point_count_t i = 0; i < count; ++i)
+                std::memcpy(m_rows[i] + offset, &vals[i], sizeof(T));
+            return;
+        }
+
+        const T *src = vals.data();
+        PointId idx = start;
+        while (count)
+        {
+            FieldSpan<T> span = view.getFieldSpan<T>(dim, idx, count);
+            std::copy(src, src + span.size(), span.data());
+            view.setFieldSpan(dim, idx, span);
+            src += span.size();
+            idx += span.size();
+            count -= span.size();
+        }
+    }
+
+    // Decode a field that is stored in the view as it appears in the record.
+    template<typename T>
+    void decode(const char *buf, point_count_t count, size_t offset,
+        Dimension::Id dim, PointView& view, PointId start)
+    {
+        std::vector<T>& vals = column(T());
+
+        extract(buf, count, offset, vals);
+        store(dim, vals, count, view, start);
+    }
+
+    void decodeScaled(const char *buf, point_count_t count, size_t offset,
+        int axis, Dimension::Id dim, PointView& view, PointId start)
+    {
+        extract(buf, count, offset, m_ints);
+        m_doubles.resize(count);
+
+        const double scale = m_scale[axis];
+        const double off = m_offset[axis];
+        for (point_count_t i = 0; i < count; ++i)
+            m_doubles[i] = m_ints[i] * scale + off;
+        store(dim, m_doubles, count, view, start);
+    }
+
+    // Store a bit field of the flag bytes that were last extracted.
+    void storeBits(Dimension::Id dim, int shift, uint8_t mask,
+        point_count_t count, PointView& view, PointId start)
+    {
+        m_bits.resize(count);
+        for (point_count_t i = 0; i < count; ++i)
+            m_bits[i] = (m_bytes[i] >> shift) & mask;
+        store(dim, m_bits, count, view, start);
+    }
+
+    std::vector<uint8_t>& column(uint8_t)
+        { return m_bits; }
+    std::vector<uint16_t>& column(uint16_t)
+        { return m_ushorts; }
+    std::vector<double>& column(double)
+        { return m_doubles; }
+
+    size_t m_pointLen;
+    double m_scale[3];
+    double m_offset[3];
+
+    // Addresses of the points of a block in a row point table.
+    std::vector<char *> m_rows;
+
+    // Column buffers, kept to avoid reallocation between blocks.
+    std::vector<int32_t> m_ints;
+    std::vector<double> m_doubles;
+    std::vector<float> m_floats;
+    std::vector<int16_t> m_shorts;
+    std::vector<uint16_t> m_ushorts;
+    std::vector<int8_t> m_chars;
+    std::vector<uint8_t> m_bytes;
+    std::vector<uint8_t> m_bits;
+};
+
+template<typename Format>
+std::unique_ptr<LasPointDecoder> makeDecoder(const LasHeader& h)
+{
+    return std::unique_ptr<LasPointDecoder>(new LasPointDecoderT<Format>(h));
+}
+
+} // unnamed namespace
+
+
+std::unique_ptr<LasPointDecoder> LasPointDecoder::create(
+    const LasHeader& header, const PointLayout& layout)
+{
+    using namespace Dimension;
+
+    std::unique_ptr<LasPointDecoder> decoder;
+
+    // The decoder stores values without conversion, so the layout must
+    // have the types that LasReader registers.
+    auto typeIs = [&layout](Id id, Type type)
+        { return layout.dimType(id) == type; };
+
+    bool ok = typeIs(Id::X, Type::Double) && typeIs(Id::Y, Type::Double) &&
+        typeIs(Id::Z, Type::Double) &&
+        typeIs(Id::Intensity, Type::Unsigned16) &&
+        typeIs(Id::ReturnNumber, Type::Unsigned8) &&
+        typeIs(Id::NumberOfReturns, Type::Unsigned8) &&
+        typeIs(Id::ScanDirectionFlag, Type::Unsigned8) &&
+        typeIs(Id::EdgeOfFlightLine, Type::Unsigned8) &&
+        typeIs(Id::Classification, Type::Unsigned8) &&
+        typeIs(Id::ScanAngleRank, Type::Float) &&
+        typeIs(Id::UserData, Type::Unsigned8) &&
+        typeIs(Id::PointSourceId, Type::Unsigned16);
+    if (header.hasTime())
+        ok = ok && typeIs(Id::GpsTime, Type::Double);
+    if (header.hasColor())
+        ok = ok && typeIs(Id::Red, Type::Unsigned16) &&
+            typeIs(Id::Green, Type::Unsigned16) &&
+            typeIs(Id::Blue, Type::Unsigned16);
+    if (header.hasInfrared())
+        ok = ok && typeIs(Id::Infrared, Type::Unsigned16);
+    if (header.has14Format())
+        ok = ok && typeIs(Id::ClassFlags, Type::Unsigned8) &&
+            typeIs(Id::ScanChannel, Type::Unsigned8);
+    if (!ok)
+        return decoder;
+
+    switch (header.pointFormat())
+    {
+    case 0:
+        decoder = makeDecoder<LasFormat<false, false, false, false>>(header);
+        break;
+    case 1:
+        decoder = makeDecoder<LasFormat<false, true, false, false>>(header);
+        break;
+    case 2:
+        decoder = makeDecoder<LasFormat<false, false, true, false>>(header);
+        break;
+    case 3:
+        decoder = makeDecoder<LasFormat<false, true, true, false>>(header);
+        break;
+    case 6:
+        decoder = makeDecoder<LasFormat<true, true, false, false>>(header);
+        break;
+    case 7:
+        decoder = makeDecoder<LasFormat<true, true, true, false>>(header);
+        break;
+    case 8:
+        decoder = makeDecoder<LasFormat<true, true, true, true>>(header);
+        break;
+    default:
+        break;
+    }
+    if (decoder && header.pointLen() < decoder->baseLen())
+        decoder.reset();
+    return decoder;
+}
+
+} // namespace pdal
@@ -0,0 +1,78 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <memory>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+class LasHeader;
+class PointLayout;
+class PointView;
+
+// Decodes blocks of uncompressed LAS point records into a PointView.
+// Rather than extracting a record at a time, each standard field is
+// decoded for the whole block before moving on to the next field.  The
+// inner loops are then simple strided loads, bit extraction and scale/offset
+// arithmetic that the compiler can vectorize, and values are stored with
+// the layout's types so there is no per-value type dispatch.  Decoders are
+// specialized at compile time for each supported point format.
+class LasPointDecoder
+{
+public:
+    virtual ~LasPointDecoder()
+    {}
+
+    // Create a decoder for the point format in the header.  Returns an
+    // empty pointer if the format isn't supported or if the layout doesn't
+    // store the standard LAS dimensions with the types registered by
+    // LasReader.
+    static std::unique_ptr<LasPointDecoder> create(const LasHeader& header,
+        const PointLayout& layout);
+
+    // Decode 'count' records from 'buf', appending the points to 'view'.
+    virtual void decode(const char *buf, point_count_t count,
+        PointView& view) = 0;
+
+    // Length of the standard fields at the start of a record.  Any extra
+    // bytes follow.
+    virtual size_t baseLen() const = 0;
+};
+
+} // namespace pdal
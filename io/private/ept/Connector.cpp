@@ -46,8 +46,30 @@ Connector::Connector(const StringMap& headers, const StringMap& query) :
     m_arbiter(new arbiter::Arbiter), m_headers(headers), m_query(query)
 {}    
 
+void Connector::setCache(std::unique_ptr<TileCache> cache)
+{
+    m_cache = std::move(cache);
+}
+
+bool Connector::cached(const std::string& path) const
+{
+    return m_cache && m_cache->handles(path);
+}
+
+TileCache::Pin Connector::getCached(const std::string& path) const
+{
+    return m_cache->pin(path, [this, &path]() { return fetchBinary(path); });
+}
+
 std::string Connector::get(const std::string& path) const
 {
+    if (cached(path))
+    {
+        std::vector<char> data(m_cache->get(path,
+            [this, &path]() { return fetchBinary(path); }));
+        return std::string(data.begin(), data.end());
+    }
+
     if (m_arbiter->isLocal(path))
         return m_arbiter->get(path);
     else
@@ -68,6 +90,13 @@ NL::json Connector::getJson(const std::string& path) const
 }
 
 std::vector<char> Connector::getBinary(const std::string& path) const
+{
+    if (cached(path))
+        return m_cache->get(path, [this, &path]() { return fetchBinary(path); });
+    return fetchBinary(path);
+}
+
+std::vector<char> Connector::fetchBinary(const std::string& path) const
 {
     if (m_arbiter->isLocal(path))
         return m_arbiter->getBinary(path);
@@ -36,6 +36,8 @@
 
 #include <arbiter/arbiter.hpp>
 
+#include "TileCache.hpp"
+
 namespace pdal
 {
 
@@ -46,11 +48,22 @@ class Connector
     std::unique_ptr<arbiter::Arbiter> m_arbiter;
     StringMap m_headers;
     StringMap m_query;
+    std::unique_ptr<TileCache> m_cache;
+
+    std::vector<char> fetchBinary(const std::string& path) const;
 
 public:
     Connector();
     Connector(const StringMap& headers, const StringMap& query);
 
+    // Use a local cache for EPT data and hierarchy files.
+    void setCache(std::unique_ptr<TileCache> cache);
+    // Determine whether a file is read through the cache.
+    bool cached(const std::string& path) const;
+    // Get the local copy of a cached file, which is kept until the
+    // pin is destroyed.
+    TileCache::Pin getCached(const std::string& path) const;
+
     std::string get(const std::string& path) const;
     NL::json getJson(const std::string& path) const;
     std::vector<char> getBinary(const std::string& path) const;
@@ -166,14 +166,19 @@ DimType EptInfo::dimType(Dimension::Id id) const
     return DimType();
 }
 
+std::string EptInfo::rootDir() const
+{
+    return FileUtils::getDirectory(m_filename);
+}
+
 std::string EptInfo::dataDir() const
 {
-    return FileUtils::getDirectory(m_filename) + "ept-data/";
+    return rootDir() + "ept-data/";
 }
 
 std::string EptInfo::hierarchyDir() const
 {
-    return FileUtils::getDirectory(m_filename) + "ept-hierarchy/";
+    return rootDir() + "ept-hierarchy/";
 }
 
 std::string EptInfo::sourcesDir() const
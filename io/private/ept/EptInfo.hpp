@@ -66,8 +66,10 @@ public:
     const SpatialReference& srs() const { return m_srs; }
     const NL::json& json() { return m_info; }
     std::map<std::string, DimType>& dims() { return m_dims; }
+    const std::map<std::string, DimType>& dims() const { return m_dims; }
     DimType dimType(Dimension::Id id) const;
     PointLayout& remoteLayout() const { return m_remoteLayout; }
+    std::string rootDir() const;
     std::string dataDir() const;
     std::string hierarchyDir() const;
     std::string sourcesDir() const;
@@ -0,0 +1,366 @@
+/******************************************************************************
+ * Copyright (c) 2020, Hobu Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of the Martin Isenburg or Iowa Department
+ *       of Natural Resources nor the names of its contributors may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#include <algorithm>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+#include "TileCache.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+const std::string DataDir("ept-data/");
+const std::string HierarchyDir("ept-hierarchy/");
+const std::string IndexFile("index.json");
+const std::string InfoFile("ept.json");
+
+// Name the cache directory of a dataset with a hash of its location.
+std::string hashName(const std::string& s)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (char c : s)
+    {
+        h ^= (unsigned char)c;
+        h *= 1099511628211ULL;
+    }
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << h;
+    return oss.str();
+}
+
+std::string randomId()
+{
+    std::random_device rd;
+    uint64_t id = ((uint64_t)rd() << 32) ^ rd();
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << id;
+    return oss.str();
+}
+
+bool removeFile(const std::string& filename)
+{
+    try
+    {
+        FileUtils::deleteFile(filename);
+    }
+    catch (...)
+    {}
+    return !FileUtils::fileExists(filename);
+}
+
+} // unnamed namespace
+
+
+TileCache::TileCache(const std::string& dir, const std::string& root,
+        const std::string& info, uintmax_t maxSize) :
+    m_root(root), m_maxSize(maxSize), m_size(0), m_clock(0),
+    m_tempId(randomId()), m_tempCount(0)
+{
+    m_dir = dir;
+    if (m_dir.size() && m_dir.back() != '/' && m_dir.back() != '\\')
+        m_dir += '/';
+    m_dir += hashName(root) + "/";
+
+    FileUtils::createDirectories(m_dir + DataDir);
+    FileUtils::createDirectories(m_dir + HierarchyDir);
+    if (!FileUtils::isDirectory(m_dir + DataDir) ||
+            !FileUtils::isDirectory(m_dir + HierarchyDir))
+        throw pdal_error("Unable to create EPT cache directory '" +
+            m_dir + "'.");
+
+    // If the dataset has changed, nothing in the cache can be used.
+    if (FileUtils::readFileIntoString(m_dir + InfoFile) != info)
+    {
+        clear();
+        if (!write(m_dir + InfoFile, info.data(), info.size()))
+            throw pdal_error("Unable to write to EPT cache directory '" +
+                m_dir + "'.");
+    }
+    else
+        loadIndex();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    evict();
+}
+
+
+TileCache::~TileCache()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    saveIndex();
+}
+
+
+bool TileCache::handles(const std::string& path) const
+{
+    return Utils::startsWith(path, m_root + DataDir) ||
+        Utils::startsWith(path, m_root + HierarchyDir);
+}
+
+
+std::string TileCache::key(const std::string& path) const
+{
+    return path.substr(m_root.size());
+}
+
+
+std::vector<char> TileCache::get(const std::string& path, const Fetch& fetch)
+{
+    const std::string k(key(path));
+    std::vector<char> data;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(k);
+    if (it != m_entries.end())
+    {
+        // Keep the file while it's read.
+        it->second.m_used = ++m_clock;
+        it->second.m_pins++;
+        lock.unlock();
+
+        bool ok = read(k, data);
+        unpin(k);
+        if (ok)
+            return data;
+    }
+    else
+        lock.unlock();
+
+    data = fetch();
+    insert(k, data, false);
+    return data;
+}
+
+
+TileCache::Pin TileCache::pin(const std::string& path, const Fetch& fetch)
+{
+    const std::string k(key(path));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(k);
+        if (it != m_entries.end() && FileUtils::fileExists(m_dir + k))
+        {
+            it->second.m_used = ++m_clock;
+            it->second.m_pins++;
+            return Pin(this, k, m_dir + k);
+        }
+    }
+
+    if (!insert(k, fetch(), true))
+        throw pdal_error("Unable to write '" + path + "' to the EPT cache.");
+    return Pin(this, k, m_dir + k);
+}
+
+
+void TileCache::unpin(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end() && it->second.m_pins)
+        it->second.m_pins--;
+}
+
+
+bool TileCache::read(const std::string& key, std::vector<char>& data)
+{
+    std::istream *in = FileUtils::openFile(m_dir + key);
+    if (!in)
+        return false;
+
+    in->seekg(0, std::ios::end);
+    data.resize((size_t)in->tellg());
+    in->seekg(0);
+    in->read(data.data(), data.size());
+    bool ok = (bool)*in;
+    FileUtils::closeFile(in);
+    return ok;
+}
+
+
+bool TileCache::insert(const std::string& key, const std::vector<char>& data,
+    bool pinned)
+{
+    if (!write(m_dir + key, data.data(), data.size()))
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& e = m_entries[key];
+    m_size -= e.m_size;
+    e.m_size = data.size();
+    e.m_used = ++m_clock;
+    if (pinned)
+        e.m_pins++;
+    m_size += e.m_size;
+    evict();
+    return true;
+}
+
+
+// Write a file by renaming a temporary file so that a partially written
+// file is never seen, even by another process using the cache.
+bool TileCache::write(const std::string& filename, const char *data,
+    size_t size)
+{
+    const std::string temp(filename + "." + m_tempId + "-" +
+        std::to_string(m_tempCount++) + ".tmp");
+
+    std::ostream *out = FileUtils::createFile(temp);
+    if (!out)
+        return false;
+    out->write(data, size);
+    bool ok = (bool)*out;
+    FileUtils::closeFile(out);
+
+    if (ok)
+    {
+        try
+        {
+            FileUtils::renameFile(filename, temp);
+        }
+        catch (...)
+        {
+            ok = false;
+        }
+    }
+    if (!ok)
+        removeFile(temp);
+    return ok;
+}
+
+
+// Remove the least recently used files that aren't pinned until the cache
+// is comfortably below its limit, so that files aren't removed every time
+// one is added.  The mutex must be held.
+void TileCache::evict()
+{
+    if (m_size <= m_maxSize)
+        return;
+
+    const uintmax_t target = m_maxSize - m_maxSize / 10;
+    std::vector<std::pair<uint64_t, std::string>> lru;
+    for (auto& el : m_entries)
+        if (el.second.m_pins == 0)
+            lru.emplace_back(el.second.m_used, el.first);
+    std::sort(lru.begin(), lru.end());
+
+    for (auto& el : lru)
+    {
+        if (m_size <= target)
+            break;
+        if (removeFile(m_dir + el.second))
+        {
+            m_size -= m_entries[el.second].m_size;
+            m_entries.erase(el.second);
+        }
+    }
+}
+
+
+void TileCache::clear()
+{
+    for (const std::string& sub : { DataDir, HierarchyDir })
+        for (const std::string& filename :
+                FileUtils::directoryList(m_dir + sub))
+            removeFile(filename);
+    removeFile(m_dir + IndexFile);
+    m_entries.clear();
+    m_size = 0;
+}
+
+
+// The index holds the time each file was last used.  Files that aren't in
+// the index, perhaps because they were added by another process, are
+// treated as the least recently used.
+void TileCache::loadIndex()
+{
+    std::unordered_map<std::string, uint64_t> used;
+    try
+    {
+        NL::json index =
+            NL::json::parse(FileUtils::readFileIntoString(m_dir + IndexFile));
+        m_clock = index.at("clock").get<uint64_t>();
+        const NL::json& files = index.at("files");
+        for (auto it = files.begin(); it != files.end(); ++it)
+            used[it.key()] = it.value().get<uint64_t>();
+    }
+    catch (...)
+    {
+        // A missing or damaged index only loses the order of use.
+    }
+
+    for (const std::string& sub : { DataDir, HierarchyDir })
+        for (const std::string& filename :
+                FileUtils::directoryList(m_dir + sub))
+        {
+            if (Utils::endsWith(filename, ".tmp"))
+                continue;
+
+            const std::string k(sub + FileUtils::getFilename(filename));
+            auto it = used.find(k);
+
+            Entry& e = m_entries[k];
+            e.m_size = FileUtils::fileSize(filename);
+            e.m_used = (it == used.end() ? 0 : it->second);
+            e.m_pins = 0;
+            m_size += e.m_size;
+        }
+}
+
+
+// The mutex must be held.
+void TileCache::saveIndex()
+{
+    NL::json files = NL::json::object();
+    for (auto& el : m_entries)
+        files[el.first] = el.second.m_used;
+
+    NL::json index;
+    index["clock"] = m_clock;
+    index["files"] = files;
+    const std::string s(index.dump());
+    write(m_dir + IndexFile, s.data(), s.size());
+}
+
+} // namespace pdal
@@ -0,0 +1,136 @@
+/******************************************************************************
+ * Copyright (c) 2020, Hobu Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of the Martin Isenburg or Iowa Department
+ *       of Natural Resources nor the names of its contributors may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pdal
+{
+
+// A size-bounded cache of EPT tile data and hierarchy files on local disk.
+// Each EPT dataset has its own directory in the cache, which is emptied
+// if the dataset's ept.json changes.  When the cache grows too large,
+// the least recently used files are removed.
+class TileCache
+{
+public:
+    using Fetch = std::function<std::vector<char>()>;
+
+    // Keeps a cached file from being removed while the pin exists.
+    class Pin
+    {
+    public:
+        Pin(TileCache *cache, const std::string& key,
+                const std::string& localPath) :
+            m_cache(cache), m_key(key), m_localPath(localPath)
+        {}
+        Pin(Pin&& other) : m_cache(other.m_cache),
+            m_key(std::move(other.m_key)),
+            m_localPath(std::move(other.m_localPath))
+        { other.m_cache = nullptr; }
+        ~Pin()
+        {
+            if (m_cache)
+                m_cache->unpin(m_key);
+        }
+
+        const std::string& localPath() const
+            { return m_localPath; }
+
+    private:
+        TileCache *m_cache;
+        std::string m_key;
+        std::string m_localPath;
+
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+    };
+
+    // \param dir  Cache directory.
+    // \param root  Directory of the EPT dataset's ept.json.
+    // \param info  Contents of the dataset's ept.json.
+    // \param maxSize  Maximum size of the dataset's cached files in bytes.
+    TileCache(const std::string& dir, const std::string& root,
+        const std::string& info, uintmax_t maxSize);
+    ~TileCache();
+
+    // Determine whether a file is one that's cached.
+    bool handles(const std::string& path) const;
+    // Get the contents of a file, fetching it and adding it to the cache
+    // if it isn't already there.
+    std::vector<char> get(const std::string& path, const Fetch& fetch);
+    // Get the local copy of a file, fetching it and adding it to the
+    // cache if it isn't already there.
+    Pin pin(const std::string& path, const Fetch& fetch);
+
+private:
+    struct Entry
+    {
+        uintmax_t m_size;
+        uint64_t m_used;    // Clock value when the file was last used.
+        int m_pins;
+    };
+
+    std::string m_root;
+    std::string m_dir;
+    uintmax_t m_maxSize;
+    uintmax_t m_size;
+    uint64_t m_clock;
+    // Temporary files are named with a random ID so that names don't
+    // collide with those of another process sharing the cache.
+    std::string m_tempId;
+    std::atomic<uint64_t> m_tempCount;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::mutex m_mutex;
+
+    std::string key(const std::string& path) const;
+    bool read(const std::string& key, std::vector<char>& data);
+    bool insert(const std::string& key, const std::vector<char>& data,
+        bool pinned);
+    bool write(const std::string& filename, const char *data,
+        size_t size);
+    void unpin(const std::string& key);
+    void evict();
+    void clear();
+    void loadIndex();
+    void saveIndex();
+};
+
+} // namespace pdal
@@ -33,7 +33,9 @@
  ****************************************************************************/
 
 #include <io/LasReader.hpp>
+#include <pdal/PDALUtils.hpp>
 #include <pdal/compression/ZstdCompression.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 #include "Connector.hpp"
 #include "EptInfo.hpp"
@@ -76,16 +78,46 @@ void TileContents::read()
 
 void TileContents::readLaszip()
 {
+    std::string filename = m_info.dataDir() + key().toString() + ".laz";
+
+    // A cached file is read in place and can't be removed from the cache
+    // until we're done with it.  Pins only hold in this process, so another
+    // process sharing the cache may remove the file before it's opened.  In
+    // that case it's fetched again.
+    if (m_connector.cached(filename))
+    {
+        for (int tries = 1; ; ++tries)
+        {
+            TileCache::Pin pin(m_connector.getCached(filename));
+            try
+            {
+                readLaszip(pin.localPath());
+                return;
+            }
+            catch (...)
+            {
+                if (tries == 3 || FileUtils::fileExists(pin.localPath()))
+                    throw;
+            }
+        }
+    }
+
     // If the file is remote (HTTP, S3, Dropbox, etc.), getLocalHandle will
     // download the file and `localPath` will return the location of the
     // downloaded file in a temporary directory.  Otherwise it's a no-op.
-    std::string filename = m_info.dataDir() + key().toString() + ".laz";
     auto handle = m_connector.getLocalHandle(filename);
+    readLaszip(handle.localPath());
+}
 
-    m_table.reset(new ColumnPointTable);
+void TileContents::readLaszip(const std::string& localPath)
+{
+    // Stream the points so that they're decoded into a single row buffer
+    // rather than being spread across the blocks of a point view.
+    VectorStreamTable *vst = new VectorStreamTable;
+    m_table.reset(vst);
 
     Options options;
-    options.add("filename", handle.localPath());
+    options.add("filename", localPath);
     options.add("use_eb_vlr", true);
 
     LasReader reader;
@@ -93,10 +125,16 @@ void TileContents::readLaszip()
 
     static std::mutex s_mutex;
     std::unique_lock<std::mutex> lock(s_mutex);
-    reader.prepare(*m_table);  // Geotiff SRS initialization is not thread-safe.
+    reader.prepare(*vst);  // Geotiff SRS initialization is not thread-safe.
     lock.unlock();
 
-    reader.execute(*m_table);
+    vst->reserve(size());
+    reader.execute(*vst);
+
+    m_data = vst->data();
+    m_numPoints = (std::min)((point_count_t)vst->size(), size());
+    // The LAS reader has already scaled X, Y and Z.
+    plan(*vst->layout(), true);
 }
 
 void TileContents::readBinary()
@@ -108,7 +146,9 @@ void TileContents::readBinary()
     vpt->buffer() = std::move(data);
     m_table.reset(vpt);
 
-    transform();
+    m_data = vpt->buffer().data();
+    m_numPoints = (std::min)((point_count_t)vpt->numPoints(), size());
+    plan(m_info.remoteLayout(), false);
 }
 
 #ifdef PDAL_HAVE_ZSTD
@@ -128,7 +168,9 @@ void TileContents::readZstandard()
     vpt->buffer() = std::move(data);
     m_table.reset(vpt);
 
-    transform();
+    m_data = vpt->buffer().data();
+    m_numPoints = (std::min)((point_count_t)vpt->numPoints(), size());
+    plan(m_info.remoteLayout(), false);
 }
 #else
 void TileContents::readZstandard()
@@ -158,27 +200,112 @@ void TileContents::readAddon(const Addon& addon)
     m_addonTables[addon.localId()] = BasePointTablePtr(vpt);
 }
 
-void TileContents::transform()
+// Determine how each dimension of the tile data gets to the destination
+// layout.  Values that don't need to be scaled and have the destination
+// type are copied as-is.  If 'scaled' is true, X, Y and Z in the tile
+// data have already had their scale and offset applied.
+void TileContents::plan(const PointLayout& layout, bool scaled)
 {
     using D = Dimension::Id;
 
-    // Shorten long name.
-    const XForm& xf = m_info.dimType(Dimension::Id::X).m_xform;
-    const XForm& yf = m_info.dimType(Dimension::Id::Y).m_xform;
-    const XForm& zf = m_info.dimType(Dimension::Id::Z).m_xform;
+    m_pointSize = layout.pointSize();
+    m_copies.clear();
+    for (auto& el : m_info.dims())
+    {
+        const std::string& name = el.first;
+        const DimType& dt = el.second;
+
+        D srcId = layout.findDim(name);
+        D dstId = m_dstLayout.findDim(name);
+        if (srcId == D::Unknown || dstId == D::Unknown)
+            continue;
+
+        const Dimension::Detail *detail = layout.dimDetail(srcId);
+        const bool xyz = (dt.m_id == D::X || dt.m_id == D::Y ||
+            dt.m_id == D::Z);
+
+        DimCopy c;
+        c.m_dst = dstId;
+        c.m_pos = detail->offset();
+        c.m_type = detail->type();
+        c.m_scale = dt.m_xform.m_scale.m_val;
+        c.m_offset = dt.m_xform.m_offset.m_val;
+        c.m_xform = xyz ? !scaled : dt.m_xform.nonstandard();
+        c.m_raw = !c.m_xform && c.m_type == m_dstLayout.dimType(dstId);
+        m_copies.push_back(c);
+    }
+
+    const D xyzIds[] = { D::X, D::Y, D::Z };
+    for (size_t i = 0; i < 3; ++i)
+    {
+        DimType dt = m_info.dimType(xyzIds[i]);
+        D srcId = layout.findDim(Dimension::name(xyzIds[i]));
+        if (srcId == D::Unknown)
+            throw pdal_error("EPT tile is missing dimension '" +
+                Dimension::name(xyzIds[i]) + "'");
+        const Dimension::Detail *detail = layout.dimDetail(srcId);
+
+        DimCopy& c = m_xyz[i];
+        c.m_dst = xyzIds[i];
+        c.m_pos = detail->offset();
+        c.m_type = detail->type();
+        c.m_scale = dt.m_xform.m_scale.m_val;
+        c.m_offset = dt.m_xform.m_offset.m_val;
+        c.m_xform = !scaled;
+        c.m_raw = false;
+    }
+
+    D originId = layout.findDim(Dimension::name(D::OriginId));
+    if (originId != D::Unknown)
+    {
+        m_originPos = layout.dimDetail(originId)->offset();
+        m_originType = layout.dimType(originId);
+    }
+}
+
+double TileContents::DimCopy::value(const char *point) const
+{
+    Everything e;
+    std::memcpy(&e, point + m_pos, Dimension::size(m_type));
+    double d = Utils::toDouble(e, m_type);
+    if (m_xform)
+        d = d * m_scale + m_offset;
+    return d;
+}
+
+void TileContents::xyz(PointId begin, point_count_t count, double *x,
+    double *y, double *z) const
+{
+    const char *point = m_data + begin * m_pointSize;
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        x[i] = m_xyz[0].value(point);
+        y[i] = m_xyz[1].value(point);
+        z[i] = m_xyz[2].value(point);
+        point += m_pointSize;
+    }
+}
+
+int64_t TileContents::originId(PointId id) const
+{
+    if (m_originPos < 0)
+        return 0;
 
-    PointRef p(*m_table);
-    for (PointId i = 0; i < size(); ++i)
+    Everything e;
+    std::memcpy(&e, m_data + id * m_pointSize + m_originPos,
+        Dimension::size(m_originType));
+    return (int64_t)Utils::toDouble(e, m_originType);
+}
+
+void TileContents::copy(PointId id, PointRef& dst) const
+{
+    const char *point = m_data + id * m_pointSize;
+    for (const DimCopy& c : m_copies)
     {
-        p.setPointId(i);
-
-        // Scale the XYZ values.
-        p.setField(D::X, p.getFieldAs<double>(D::X) * xf.m_scale.m_val +
-            xf.m_offset.m_val);
-        p.setField(D::Y, p.getFieldAs<double>(D::Y) * yf.m_scale.m_val +
-            yf.m_offset.m_val);
-        p.setField(D::Z, p.getFieldAs<double>(D::Z) * zf.m_scale.m_val +
-            zf.m_offset.m_val);
+        if (c.m_raw)
+            dst.setRawField(c.m_dst, point + c.m_pos);
+        else
+            dst.setField(c.m_dst, c.value(point));
     }
 }
 
@@ -34,6 +34,8 @@
 
 #pragma once
 
+#include <array>
+
 #include <pdal/PointView.hpp>
 #include <pdal/pdal_types.hpp>
 
@@ -52,41 +54,77 @@ class TileContents
 {
 public:
     TileContents(const Overlap& overlap, const EptInfo& info,
-            const Connector& connector, const AddonList& addons) :
+            const Connector& connector, const AddonList& addons,
+            const PointLayout& dstLayout) :
         m_overlap(overlap), m_info(info), m_connector(connector),
-        m_addons(addons)
+        m_addons(addons), m_dstLayout(dstLayout), m_data(nullptr),
+        m_pointSize(0), m_numPoints(0), m_originPos(-1)
     {}
 
-    BasePointTable& table() const
-        { return *m_table; }
     const Key& key() const
         { return m_overlap.m_key; }
     point_count_t nodeId() const
         { return m_overlap.m_nodeId; }
     point_count_t size() const
         { return m_overlap.m_count; }
+    // Number of points actually read, which is at most size().
+    point_count_t numPoints() const
+        { return m_numPoints; }
     const std::string& error() const
         { return m_error; }
     BasePointTable *addonTable(Dimension::Id id) const
         { return const_cast<TileContents *>(this)->m_addonTables[id].get(); }
     void read();
 
+    // Get the X, Y and Z values of a run of points, scaled and offset.
+    void xyz(PointId begin, point_count_t count, double *x, double *y,
+        double *z) const;
+    // Get the origin ID of a point.  Zero if the tile has no origin IDs.
+    int64_t originId(PointId id) const;
+    // Copy the dimensions of the point cloud from a point in the tile
+    // into a point with the destination layout.
+    void copy(PointId id, PointRef& dst) const;
+
 private:
+    // How to get a dimension's value from tile data into the destination.
+    struct DimCopy
+    {
+        Dimension::Id m_dst;
+        size_t m_pos;           // Position of the value in a tile point.
+        Dimension::Type m_type; // Type of the value in a tile point.
+        double m_scale;
+        double m_offset;
+        bool m_xform;   // Whether to apply the scale and offset.
+        bool m_raw;     // Whether the value is copied without conversion.
+
+        double value(const char *point) const;
+    };
+
     Overlap m_overlap;
     const EptInfo& m_info;
     const Connector& m_connector;
     const AddonList& m_addons;
+    const PointLayout& m_dstLayout;
     std::string m_error;
     // Table for the base point data.
     BasePointTablePtr m_table;
+    // Points are stored row by row.
+    const char *m_data;
+    size_t m_pointSize;
+    point_count_t m_numPoints;
+    std::vector<DimCopy> m_copies;
+    std::array<DimCopy, 3> m_xyz;
+    int64_t m_originPos;
+    Dimension::Type m_originType;
     // Tables for the add on data.
     std::map<Dimension::Id, BasePointTablePtr> m_addonTables;
 
     void readLaszip();
+    void readLaszip(const std::string& localPath);
     void readBinary();
     void readZstandard();
     void readAddon(const Addon& addon);
-    void transform();
+    void plan(const PointLayout& layout, bool scaled);
 };
 
 } // namespace pdal
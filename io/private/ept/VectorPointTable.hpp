@@ -62,5 +62,50 @@ private:
     std::vector<char> m_buffer;
 };
 
+// Stream table that keeps all of the points streamed into it, stored
+// row by row in a single buffer.  Streaming a reader into the table
+// decodes its points directly into their final location.
+class PDAL_DLL VectorStreamTable : public StreamPointTable
+{
+public:
+    VectorStreamTable(point_count_t capacity = 4096) :
+        StreamPointTable(m_layout, capacity), m_base(0)
+    {}
+
+    virtual void finalize() override
+    {
+        if (!m_layout.finalized())
+        {
+            BasePointTable::finalize();
+            m_buffer.resize(pointsToBytes(capacity()));
+        }
+    }
+    // Make room for a number of points.
+    void reserve(point_count_t count)
+        { m_buffer.reserve(pointsToBytes(count + capacity())); }
+    // Number of points that have been streamed into the table.
+    std::size_t size() const
+        { return m_base; }
+    const char *data() const
+        { return m_buffer.data(); }
+
+protected:
+    // Keep the points that have been handled and make room for the next
+    // chunk after them.
+    virtual void reset() override
+    {
+        m_base += numPoints();
+        m_buffer.resize(pointsToBytes(m_base + capacity()));
+    }
+
+    virtual char *getPoint(PointId idx) override
+        { return m_buffer.data() + pointsToBytes(m_base + idx); }
+
+private:
+    std::vector<char> m_buffer;
+    point_count_t m_base;
+    PointLayout m_layout;
+};
+
 } // namespace pdal
 
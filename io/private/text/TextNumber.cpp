@@ -0,0 +1,323 @@
+/******************************************************************************
+ * Copyright (c) 2020, Hobu Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of the Martin Isenburg or Iowa Department
+ *       of Natural Resources nor the names of its contributors may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "TextNumber.hpp"
+
+namespace pdal
+{
+namespace textnum
+{
+
+namespace
+{
+
+// Powers of ten that are exactly representable as doubles.
+const double s_pow10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+const uint64_t s_ipow10[] =
+{
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL
+};
+
+const size_t MaxDigits = 19;
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Full 128 bit product of two 64 bit values.
+void mul64(uint64_t a, uint64_t b, uint64_t& hi, uint64_t& lo)
+{
+    const uint64_t mask = 0xFFFFFFFF;
+    uint64_t a0 = a & mask;
+    uint64_t a1 = a >> 32;
+    uint64_t b0 = b & mask;
+    uint64_t b1 = b >> 32;
+
+    uint64_t p00 = a0 * b0;
+    uint64_t p01 = a0 * b1;
+    uint64_t p10 = a1 * b0;
+    uint64_t p11 = a1 * b1;
+
+    uint64_t mid = (p00 >> 32) + (p01 & mask) + (p10 & mask);
+    lo = (mid << 32) | (p00 & mask);
+    hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
+// Split mant * 2^exp, rounded to 'precision' decimal places, into its
+// integer and fractional digits.  Rounding is to nearest with ties to
+// even, which is what printf() does with an exact binary value.  Returns
+// false if the value doesn't fit in 64 bits once scaled.
+bool fixedParts(uint64_t mant, int exp, size_t precision,
+    uint64_t& ipart, uint64_t& fpart)
+{
+    const uint64_t scale = s_ipow10[precision];
+
+    ipart = 0;
+    fpart = 0;
+    if (mant == 0)
+        return true;
+
+    if (exp >= 0)
+    {
+        // mant is less than 2^53, so the shifted value fits in 64 bits.
+        if (exp > 11)
+            return false;
+        ipart = mant << exp;
+        return true;
+    }
+
+    // The scaled value is less than 2^117, so if it's shifted right by
+    // more than that it's less than one half and rounds to zero.
+    int shift = -exp;
+    if (shift > 117)
+        return true;
+
+    uint64_t hi, lo;
+    mul64(mant, scale, hi, lo);
+
+    uint64_t qhi, qlo;  // Quotient
+    uint64_t rhi, rlo;  // Remainder
+    if (shift < 64)
+    {
+        qlo = (lo >> shift) | (hi << (64 - shift));
+        qhi = hi >> shift;
+        rlo = lo & ((1ULL << shift) - 1);
+        rhi = 0;
+    }
+    else if (shift == 64)
+    {
+        qlo = hi;
+        qhi = 0;
+        rlo = lo;
+        rhi = 0;
+    }
+    else
+    {
+        qlo = hi >> (shift - 64);
+        qhi = 0;
+        rlo = lo;
+        rhi = hi & ((1ULL << (shift - 64)) - 1);
+    }
+    if (qhi)
+        return false;
+
+    uint64_t halfHi = 0;
+    uint64_t halfLo = 0;
+    if (shift <= 64)
+        halfLo = 1ULL << (shift - 1);
+    else
+        halfHi = 1ULL << (shift - 65);
+
+    bool up = (rhi > halfHi) || (rhi == halfHi && rlo > halfLo) ||
+        (rhi == halfHi && rlo == halfLo && (qlo & 1));
+    if (up && ++qlo == 0)
+        return false;
+
+    ipart = qlo / scale;
+    fpart = qlo % scale;
+    return true;
+}
+
+} // unnamed namespace
+
+
+bool parseDouble(const char *pos, const char *end, double& d)
+{
+    while (pos < end && isSpace(*pos))
+        pos++;
+
+    bool neg = false;
+    if (pos < end && (*pos == '-' || *pos == '+'))
+        neg = (*pos++ == '-');
+
+    uint64_t mant = 0;
+    size_t digits = 0;
+    int exp10 = 0;
+    bool found = false;
+
+    // Leading zeros aren't significant and don't count toward the digit
+    // limit.
+    for (; pos < end && isDigit(*pos); pos++)
+    {
+        found = true;
+        if (mant || *pos != '0')
+        {
+            if (digits++ == MaxDigits)
+                return false;
+            mant = mant * 10 + (*pos - '0');
+        }
+    }
+    if (pos < end && *pos == '.')
+    {
+        for (pos++; pos < end && isDigit(*pos); pos++)
+        {
+            found = true;
+            if (mant || *pos != '0')
+            {
+                if (digits++ == MaxDigits)
+                    return false;
+                mant = mant * 10 + (*pos - '0');
+            }
+            exp10--;
+        }
+    }
+    if (!found)
+        return false;
+
+    if (pos < end && (*pos == 'e' || *pos == 'E'))
+    {
+        pos++;
+        bool expNeg = false;
+        if (pos < end && (*pos == '-' || *pos == '+'))
+            expNeg = (*pos++ == '-');
+        if (pos == end || !isDigit(*pos))
+            return false;
+        int exp = 0;
+        for (; pos < end && isDigit(*pos); pos++)
+            if (exp < 10000)
+                exp = exp * 10 + (*pos - '0');
+        exp10 += expNeg ? -exp : exp;
+    }
+
+    while (pos < end && isSpace(*pos))
+        pos++;
+    if (pos != end)
+        return false;
+
+    if (mant == 0)
+    {
+        d = neg ? -0.0 : 0.0;
+        return true;
+    }
+
+    // With an exact mantissa and an exact power of ten, a single
+    // multiplication or division gives the correctly rounded result.
+    if (mant > (1ULL << 53) || exp10 < -22 || exp10 > 22)
+        return false;
+    d = static_cast<double>(mant);
+    if (exp10 < 0)
+        d /= s_pow10[-exp10];
+    else
+        d *= s_pow10[exp10];
+    if (neg)
+        d = -d;
+    return true;
+}
+
+
+void appendFixed(double d, size_t precision, std::string& out)
+{
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    int biased = static_cast<int>((bits >> 52) & 0x7FF);
+    uint64_t mant = bits & ((1ULL << 52) - 1);
+    bool neg = (bits >> 63) != 0;
+
+    uint64_t ipart, fpart;
+    if (biased != 0x7FF && precision <= MaxDigits)
+    {
+        int exp;
+        if (biased == 0)
+            exp = -1074;
+        else
+        {
+            mant |= 1ULL << 52;
+            exp = biased - 1075;
+        }
+
+        if (fixedParts(mant, exp, precision, ipart, fpart))
+        {
+            char buf[48];
+            char *end = buf + sizeof(buf);
+            char *pos = end;
+            if (precision)
+            {
+                for (size_t i = 0; i < precision; ++i)
+                {
+                    *--pos = '0' + (fpart % 10);
+                    fpart /= 10;
+                }
+                *--pos = '.';
+            }
+            do
+            {
+                *--pos = '0' + (ipart % 10);
+                ipart /= 10;
+            } while (ipart);
+            if (neg)
+                *--pos = '-';
+            out.append(pos, end - pos);
+            return;
+        }
+    }
+
+    // Infinity, NaN, very large values and very high precision.
+    char buf[64];
+    int prec = static_cast<int>(precision);
+    int cnt = snprintf(buf, sizeof(buf), "%.*f", prec, d);
+    if (cnt < 0)
+        return;
+    if (static_cast<size_t>(cnt) < sizeof(buf))
+        out.append(buf, cnt);
+    else
+    {
+        size_t start = out.size();
+        out.resize(start + cnt + 1);
+        snprintf(&out[start], cnt + 1, "%.*f", prec, d);
+        out.resize(start + cnt);
+    }
+}
+
+} // namespace textnum
+} // namespace pdal
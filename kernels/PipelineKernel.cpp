@@ -71,7 +71,15 @@ void PipelineKernel::validateSwitches(ProgramArgs& args)
 
     if (m_stream && m_noStream)
         throw pdal_error("Can't execute with 'stream' and 'nostream' options");
-    if (m_stream)
+    if (m_pipelined && m_noStream)
+        throw pdal_error("Can't execute with 'pipelined' and 'nostream' "
+            "options");
+    if (m_pipelined && m_stream)
+        throw pdal_error("Can't execute with 'pipelined' and 'stream' "
+            "options");
+    if (m_pipelined)
+        m_mode = ExecMode::PipelinedStream;
+    else if (m_stream)
         m_mode = ExecMode::Stream;
     else if (m_noStream)
         m_mode = ExecMode::Standard;
@@ -105,6 +113,10 @@ void PipelineKernel::addSwitches(ProgramArgs& args)
     args.add("stream", "Run in stream mode.  Error if not streamable.",
         m_stream);
     args.add("nostream", "Run in standard mode.", m_noStream);
+    args.add("pipelined", "Run in stream mode with each stage on its own "
+        "thread.  Error if not streamable.", m_pipelined);
+    args.add("threads", "Maximum number of threads used to run stages in "
+        "standard mode.", m_threads, 1U);
     args.add("metadata", "Metadata filename", m_metadataFile);
 }
 
@@ -144,6 +156,7 @@ int PipelineKernel::execute()
     }
 
     m_manager.readPipeline(m_inputFile);
+    m_manager.setThreads(m_threads);
     if (m_manager.execute(m_mode).m_mode == ExecMode::None)
         throw pdal_error("Couldn't run pipeline in requested execution mode.");
 
@@ -64,6 +64,8 @@ private:
     bool m_usestdin;
     bool m_stream;
     bool m_noStream;
+    bool m_pipelined;
+    uint32_t m_threads;
     ExecMode m_mode;
 };
 
@@ -34,10 +34,15 @@
 
 #include "TileKernel.hpp"
 
+#include <chrono>
+
 #include <pdal/StageFactory.hpp>
 #include <pdal/StageWrapper.hpp>
 #include <pdal/Writer.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/private/ThreadBudget.hpp>
+
+#include "private/tile/SpillFiles.hpp"
 
 namespace pdal
 {
@@ -51,6 +56,28 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_KERNEL(TileKernel, s_info)
 
+namespace
+{
+
+// Size of the point records that a reading thread holds before appending
+// them to the spill files.
+const size_t SpillBufferSize = 32 * 1024 * 1024;
+
+// Removes the spill directory however bucketed processing ends.
+class SpillDirectory
+{
+public:
+    SpillDirectory(const std::string& dir) : m_dir(dir)
+    {}
+    ~SpillDirectory()
+        { FileUtils::deleteDirectory(m_dir); }
+
+private:
+    std::string m_dir;
+};
+
+} // unnamed namespace
+
 TileKernel::TileKernel() : m_table(10000), m_repro(nullptr)
 {}
 
@@ -75,6 +102,15 @@ void TileKernel::addSwitches(ProgramArgs& args)
         m_buffer);
     args.add("out_srs", "Output SRS to which points will be reprojected",
         m_outSrs);
+    args.add("bucketed", "Write tiles in two passes through temporary "
+        "spill files", m_bucketed);
+    args.add("spill_dir", "Directory for spill files in bucketed mode",
+        m_spillDir);
+    args.add("max_open", "Maximum number of open spill files in bucketed "
+        "mode", m_maxOpen, (size_t)256);
+    args.add("threads", "Number of threads used to read input and write "
+        "tiles in bucketed mode. 0 takes threads from the thread budget",
+        m_threads);
 }
 
 
@@ -98,8 +134,27 @@ int TileKernel::execute()
     for (auto&& file : files)
         readers[file] = prepareReader(file);
     checkReaders(readers);
+
+    // In bucketed mode the input files are read in parallel, so each needs
+    // its own reprojection filter.
+    Readers repros;
     if (m_repro)
-        m_repro->prepare(m_table);
+    {
+        if (m_bucketed)
+        {
+            Options opts;
+            opts.add("out_srs", m_outSrs);
+            for (auto& rp : readers)
+            {
+                Streamable *repro = dynamic_cast<Streamable *>(
+                    &m_manager.makeFilter("filters.reprojection", opts));
+                repro->prepare(m_table);
+                repros[rp.first] = repro;
+            }
+        }
+        else
+            m_repro->prepare(m_table);
+    }
     Options opts;
     opts.add("length", m_length);
     opts.add("buffer", m_buffer);
@@ -107,6 +162,11 @@ int TileKernel::execute()
     m_splitter.prepare(m_table);
 
     m_table.finalize();
+    if (m_bucketed)
+    {
+        processBucketed(readers, repros);
+        return 0;
+    }
     process(readers);
     StageWrapper::done(m_splitter, m_table);
     for (auto&& wp : m_writers)
@@ -292,10 +352,7 @@ void TileKernel::adder(PointRef& point, int xpos, int ypos)
     auto wi = m_writers.find(loc);
     if (wi == m_writers.end())
     {
-        std::string filename(m_outputFile);
-        std::string xname(std::to_string(xpos));
-        std::string yname(std::to_string(ypos));
-        filename.replace(m_hashPos, 1, (xname + "_" + yname));
+        std::string filename(tileFilename(loc));
 
         w = &m_manager.makeWriter(filename, "");
         if (!w)
@@ -316,4 +373,229 @@ void TileKernel::adder(PointRef& point, int xpos, int ypos)
     StreamableWrapper::processOne(*sw, point);
 }
 
+
+std::string TileKernel::tileFilename(const Coord& tile) const
+{
+    std::string filename(m_outputFile);
+    std::string xname(std::to_string(tile.first));
+    std::string yname(std::to_string(tile.second));
+    filename.replace(m_hashPos, 1, (xname + "_" + yname));
+    return filename;
+}
+
+
+// Bucketed mode makes two passes.  The first reads the input files in
+// parallel and appends the points of each tile to spill files of fixed-size
+// records, one for each input file.  The second converts the spill files of
+// each tile to the output format in parallel, reading them in the order of
+// the input files so that the points are in the same order as when not
+// bucketed.  Only the spill files that are being written are open, so the
+// number of tiles isn't limited by the number of files that can be open.
+void TileKernel::processBucketed(const Readers& readers,
+    const Readers& repros)
+{
+    if (std::isnan(m_xOrigin) || std::isnan(m_yOrigin))
+        findOrigin(readers);
+    m_splitter.setOrigin(m_xOrigin, m_yOrigin);
+    StageWrapper::ready(m_splitter, m_table);
+
+    // Points are written with the output SRS if there is one, or the SRS
+    // of the input, which in that case is the same for all the files.
+    SpatialReference srs(m_outSrs);
+    for (auto it = readers.begin(); srs.empty() && it != readers.end(); ++it)
+        srs = it->second->getSpatialReference();
+
+    std::string dir(m_spillDir.size() ? m_spillDir :
+        FileUtils::getDirectory(m_outputFile));
+    if (dir.size() && dir.back() != '/' && dir.back() != '\\')
+        dir += '/';
+    dir += "pdal_tile_" + std::to_string(
+        std::chrono::system_clock::now().time_since_epoch().count());
+    if (!FileUtils::createDirectories(dir))
+        throw pdal_error("Unable to create spill directory '" + dir + "'.");
+    SpillDirectory spillDir(dir);
+
+    // Threads come from the thread budget unless the user asked for a
+    // number of them.  Once a task throws, no more are started and the
+    // error is rethrown when the running tasks are done.
+    ThreadGroup group(m_threads ? m_threads : ThreadGroup::Unlimited,
+        m_threads == 0);
+
+    SpillFiles spill(dir, m_maxOpen);
+    {
+        std::vector<std::pair<Streamable *, Streamable *>> sources;
+        for (auto& rp : readers)
+        {
+            auto ri = repros.find(rp.first);
+            sources.emplace_back(rp.second,
+                ri == repros.end() ? nullptr : ri->second);
+        }
+        group.run(sources.size(), [this, &sources, &spill](size_t source)
+        {
+            scatter(*sources[source].first, sources[source].second, source,
+                spill);
+        });
+    }
+    spill.close();
+
+    {
+        std::vector<std::pair<Coord, StringList>> tiles;
+        for (auto& t : spill.tiles())
+        {
+            StringList filenames;
+            for (size_t source : t.second)
+                filenames.push_back(spill.filename(t.first, source));
+            tiles.emplace_back(t.first, filenames);
+        }
+        group.run(tiles.size(), [this, &tiles, &srs](size_t i)
+        {
+            writeTile(tiles[i].first, tiles[i].second, srs);
+        });
+    }
+    StageWrapper::done(m_splitter, m_table);
+}
+
+
+// Use the first point read as the origin, as is done when not in bucketed
+// mode.  The point is read with a separate reader so that the input
+// readers can all be run in parallel.
+void TileKernel::findOrigin(const Readers& readers)
+{
+    for (auto& rp : readers)
+    {
+        FixedPointTable table(1);
+        Stage& r = m_manager.makeReader(rp.first, "");
+        Streamable *sr = dynamic_cast<Streamable *>(&r);
+        sr->prepare(table);
+        table.finalize();
+        StreamableWrapper::ready(*sr, table);
+
+        PointRef point(table, 0);
+        bool found = StreamableWrapper::processOne(*sr, point);
+        if (found)
+        {
+            if (std::isnan(m_xOrigin))
+                m_xOrigin = point.getFieldAs<double>(Dimension::Id::X);
+            if (std::isnan(m_yOrigin))
+                m_yOrigin = point.getFieldAs<double>(Dimension::Id::Y);
+        }
+        StreamableWrapper::done(*sr, table);
+        if (found)
+            return;
+    }
+}
+
+
+// Read an input file and append its points to the spill files of the
+// tiles that contain them.  Records are collected for each tile and appended
+// in large blocks.
+void TileKernel::scatter(Streamable& reader, Streamable *repro,
+    size_t source, SpillFiles& spill)
+{
+    SpillTable table(*m_table.layout(), m_table.capacity());
+    const size_t pointSize = m_table.layout()->pointSize();
+    std::map<Coord, std::vector<char>> buckets;
+    size_t bytes = 0;
+
+    auto adder = [&table, &buckets, &bytes, pointSize]
+        (PointRef& point, int xpos, int ypos)
+    {
+        std::vector<char>& bucket = buckets[Coord(xpos, ypos)];
+        const char *row = table.row(point.pointId());
+        bucket.insert(bucket.end(), row, row + pointSize);
+        bytes += pointSize;
+    };
+
+    auto flush = [&buckets, &bytes, &spill, source]()
+    {
+        for (auto& b : buckets)
+            spill.append(b.first, source, b.second.data(), b.second.size());
+        buckets.clear();
+        bytes = 0;
+    };
+
+    StreamableWrapper::ready(reader, table);
+    if (repro)
+        StreamableWrapper::spatialReferenceChanged(*repro,
+            reader.getSpatialReference());
+
+    PointRef point(table, 0);
+    bool finished = false;
+    while (!finished)
+    {
+        point_count_t count = 0;
+        while (count < table.capacity())
+        {
+            point.setPointId(count);
+            if (!StreamableWrapper::processOne(reader, point))
+            {
+                finished = true;
+                break;
+            }
+            count++;
+        }
+
+        for (PointId idx = 0; idx < count; ++idx)
+        {
+            point.setPointId(idx);
+            if (repro && !StreamableWrapper::processOne(*repro, point))
+                continue;
+            m_splitter.processPoint(point, adder);
+        }
+        if (bytes > SpillBufferSize)
+            flush();
+    }
+    flush();
+    StreamableWrapper::done(reader, table);
+    if (repro)
+        StreamableWrapper::done(*repro, table);
+}
+
+
+// Write the points in the spill files of a tile to an output tile.  Each tile has its
+// own pipeline manager so that the writer is destroyed once it's done.
+void TileKernel::writeTile(const Coord& tile, const StringList& spillFiles,
+    const SpatialReference& srs)
+{
+    std::string filename(tileFilename(tile));
+
+    PipelineManager mgr;
+    mgr.setLog(m_log);
+    mgr.commonOptions() = m_manager.commonOptions();
+    mgr.stageOptions() = m_manager.stageOptions();
+
+    Stage& w = mgr.makeWriter(filename, "");
+    Streamable *sw = dynamic_cast<Streamable *>(&w);
+    if (!sw)
+        throw pdal_error("Driver '" + w.getName() + "' for output file '" +
+            m_outputFile + "' is not streamable.");
+
+    SpillTable table(*m_table.layout(), m_table.capacity());
+    if (!srs.empty())
+        table.setSpatialReference(srs);
+    sw->prepare(table);
+    StreamableWrapper::spatialReferenceChanged(*sw, srs);
+    StreamableWrapper::ready(*sw, table);
+
+    const size_t pointSize = m_table.layout()->pointSize();
+    PointRef point(table, 0);
+    for (const std::string& spillFile : spillFiles)
+    {
+        std::ifstream in(spillFile, std::ios::in | std::ios::binary);
+        while (in)
+        {
+            in.read(table.data(), table.capacity() * pointSize);
+            point_count_t count = (point_count_t)(in.gcount() / pointSize);
+            for (PointId idx = 0; idx < count; ++idx)
+            {
+                point.setPointId(idx);
+                StreamableWrapper::processOne(*sw, point);
+            }
+        }
+    }
+    StreamableWrapper::done(*sw, table);
+    for (const std::string& spillFile : spillFiles)
+        FileUtils::deleteFile(spillFile);
+}
+
 } // namespace pdal
@@ -42,6 +42,9 @@
 namespace pdal
 {
 
+class SpillFiles;
+class SpillTable;
+
 class PDAL_DLL TileKernel : public Kernel
 {
     using Coord = std::pair<int, int>;
@@ -59,6 +62,13 @@ private:
     void process(const Readers& readers);
     void checkReaders(const Readers& readers);
     void adder(PointRef& point, int xpos, int ypos);
+    void processBucketed(const Readers& readers, const Readers& repros);
+    void findOrigin(const Readers& readers);
+    void scatter(Streamable& reader, Streamable *repro, size_t source,
+        SpillFiles& spill);
+    void writeTile(const Coord& tile, const StringList& spillFiles,
+        const SpatialReference& srs);
+    std::string tileFilename(const Coord& tile) const;
 
     std::string m_inputFile;
     std::string m_outputFile;
@@ -72,6 +82,10 @@ private:
     Streamable *m_repro;
     SpatialReference m_outSrs;
     std::string::size_type m_hashPos;
+    bool m_bucketed;
+    std::string m_spillDir;
+    size_t m_maxOpen;
+    size_t m_threads;
 };
 
 } // namespace pdal
@@ -89,6 +89,10 @@ void TranslateKernel::addSwitches(ProgramArgs& args)
     args.add("writer,w", "Writer type", m_writerType);
     args.add("nostream", "Run in standard mode", m_noStream);
     args.add("stream", "Run in stream mode.  Error if not possible.", m_stream);
+    args.add("pipelined", "Run in stream mode with each stage on its own "
+        "thread.  Error if not possible.", m_pipelined);
+    args.add("threads", "Maximum number of threads used to run stages in "
+        "standard mode.", m_threads, 1U);
 }
 
 
@@ -96,8 +100,16 @@ void TranslateKernel::validateSwitches(ProgramArgs&)
 {
     if (m_stream && m_noStream)
         throw pdal_error("Can't specify both 'stream' and 'nostream' options.");
-
-    if (m_stream)
+    if (m_pipelined && m_noStream)
+        throw pdal_error("Can't specify both 'pipelined' and 'nostream' "
+            "options.");
+    if (m_pipelined && m_stream)
+        throw pdal_error("Can't specify both 'pipelined' and 'stream' "
+            "options.");
+
+    if (m_pipelined)
+        m_mode = ExecMode::PipelinedStream;
+    else if (m_stream)
         m_mode = ExecMode::Stream;
     else if (m_noStream)
         m_mode = ExecMode::Standard;
@@ -223,6 +235,7 @@ int TranslateKernel::execute()
         return 0;
     }
 
+    m_manager.setThreads(m_threads);
     if (m_manager.execute(m_mode).m_mode == ExecMode::None)
         throw pdal_error("Couldn't run translation pipeline in requested "
             "execution mode.");
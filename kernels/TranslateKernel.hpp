@@ -68,6 +68,8 @@ private:
     std::string m_metadataFile;
     bool m_noStream;
     bool m_stream;
+    bool m_pipelined;
+    uint32_t m_threads;
     ExecMode m_mode;
 };
 
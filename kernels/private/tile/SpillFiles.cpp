@@ -0,0 +1,109 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+
+#include "SpillFiles.hpp"
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+SpillFiles::SpillFiles(const std::string& dir, size_t maxOpen) :
+    m_dir(dir), m_maxOpen((std::max)(maxOpen, (size_t)1))
+{
+    if (m_dir.size() && m_dir.back() != '/' && m_dir.back() != '\\')
+        m_dir += '/';
+}
+
+
+std::string SpillFiles::filename(const Coord& tile, size_t source) const
+{
+    return m_dir + std::to_string(tile.first) + "_" +
+        std::to_string(tile.second) + "_" + std::to_string(source) + ".bin";
+}
+
+
+void SpillFiles::append(const Coord& tile, size_t source, const char *data,
+    size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::ofstream& out = open(Segment(tile, source));
+    out.write(data, size);
+    if (!out)
+        throw pdal_error("Unable to write spill file '" +
+            filename(tile, source) + "'.");
+}
+
+
+std::ofstream& SpillFiles::open(const Segment& segment)
+{
+    auto it = m_index.find(segment);
+    if (it != m_index.end())
+    {
+        m_open.splice(m_open.begin(), m_open, it->second);
+        return *m_open.front().second;
+    }
+
+    if (m_open.size() >= m_maxOpen)
+    {
+        m_index.erase(m_open.back().first);
+        m_open.pop_back();
+    }
+
+    // Files are opened for append since they may have been closed to
+    // make room for others.
+    const std::string name(filename(segment.first, segment.second));
+    std::unique_ptr<std::ofstream> out(new std::ofstream(name,
+        std::ios::out | std::ios::binary | std::ios::app));
+    if (!*out)
+        throw pdal_error("Unable to open spill file '" + name + "'.");
+    m_open.emplace_front(segment, std::move(out));
+    m_index[segment] = m_open.begin();
+    m_tiles[segment.first].insert(segment.second);
+    return *m_open.front().second;
+}
+
+
+void SpillFiles::close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_index.clear();
+    m_open.clear();
+}
+
+} // namespace pdal
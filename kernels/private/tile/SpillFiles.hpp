@@ -0,0 +1,112 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <pdal/PointTable.hpp>
+
+namespace pdal
+{
+
+// Stream table with its own point storage that shares a layout with other
+// tables, so that several threads can stream points of the same layout.
+class SpillTable : public StreamPointTable
+{
+public:
+    SpillTable(PointLayout& layout, point_count_t capacity) :
+        StreamPointTable(layout, capacity),
+        m_buf(layout.pointSize() * capacity)
+    {}
+
+    // Storage for the points, stored row by row.
+    char *data()
+        { return m_buf.data(); }
+    const char *row(PointId idx)
+        { return getPoint(idx); }
+
+protected:
+    virtual char *getPoint(PointId idx) override
+        { return m_buf.data() + pointsToBytes(idx); }
+
+private:
+    std::vector<char> m_buf;
+};
+
+// Files of fixed-size point records.  Each tile has a file for every
+// input source with points in the tile, so that the records of a tile can
+// be read back in source order no matter how the threads that append them
+// were scheduled.  Records may be appended to the files by several threads
+// at once, but those of a source must be appended by one thread.  Only a
+// limited number of the files are kept open; when the limit is reached,
+// the least recently written file is closed.
+class SpillFiles
+{
+public:
+    using Coord = std::pair<int, int>;
+    // Tiles and the sources with points in each.
+    using TileSources = std::map<Coord, std::set<size_t>>;
+
+    SpillFiles(const std::string& dir, size_t maxOpen);
+
+    void append(const Coord& tile, size_t source, const char *data,
+        size_t size);
+    void close();
+    std::string filename(const Coord& tile, size_t source) const;
+    const TileSources& tiles() const
+        { return m_tiles; }
+
+private:
+    using Segment = std::pair<Coord, size_t>;
+    using File = std::pair<Segment, std::unique_ptr<std::ofstream>>;
+
+    std::string m_dir;
+    size_t m_maxOpen;
+    std::list<File> m_open;     // Most recently written first.
+    std::map<Segment, std::list<File>::iterator> m_index;
+    TileSources m_tiles;
+    std::mutex m_mutex;
+
+    std::ofstream& open(const Segment& segment);
+};
+
+} // namespace pdal
@@ -40,8 +40,8 @@ namespace pdal
 ColumnPointTable::~ColumnPointTable()
 {
     for (DimBlockList& l : m_blocks)
-        for (auto ptr : l)
-            delete [] ptr;
+        for (std::size_t i = 0; i < l.size(); ++i)
+            delete [] l[i];
 }
 
 
@@ -54,6 +54,7 @@ void ColumnPointTable::finalize()
 
 PointId ColumnPointTable::addPoint()
 {
+    std::lock_guard<std::mutex> lock(m_addMutex);
     if (m_numPts % m_blockPtCnt == 0)
     {
         for (Dimension::Id id : m_layoutRef.dims())
@@ -0,0 +1,144 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/Dimension.hpp>
+
+namespace pdal
+{
+
+class PointView;
+
+/**
+  Maps a C++ type to the dimension type with the same representation.
+*/
+template<typename T>
+struct FieldTraits
+{
+    static const Dimension::Type type = Dimension::Type::None;
+};
+
+template<>
+struct FieldTraits<int8_t>
+    { static const Dimension::Type type = Dimension::Type::Signed8; };
+template<>
+struct FieldTraits<int16_t>
+    { static const Dimension::Type type = Dimension::Type::Signed16; };
+template<>
+struct FieldTraits<int32_t>
+    { static const Dimension::Type type = Dimension::Type::Signed32; };
+template<>
+struct FieldTraits<int64_t>
+    { static const Dimension::Type type = Dimension::Type::Signed64; };
+template<>
+struct FieldTraits<uint8_t>
+    { static const Dimension::Type type = Dimension::Type::Unsigned8; };
+template<>
+struct FieldTraits<uint16_t>
+    { static const Dimension::Type type = Dimension::Type::Unsigned16; };
+template<>
+struct FieldTraits<uint32_t>
+    { static const Dimension::Type type = Dimension::Type::Unsigned32; };
+template<>
+struct FieldTraits<uint64_t>
+    { static const Dimension::Type type = Dimension::Type::Unsigned64; };
+template<>
+struct FieldTraits<float>
+    { static const Dimension::Type type = Dimension::Type::Float; };
+template<>
+struct FieldTraits<double>
+    { static const Dimension::Type type = Dimension::Type::Double; };
+
+/**
+  A contiguous array of the values of a dimension for a run of points,
+  returned by PointView::getFieldSpan().  A span either refers directly to
+  the storage of a point table, in which case changes to values are made
+  in place, or holds a copy of the values.  Changes to a copy are stored
+  with PointView::setFieldSpan().
+*/
+template<typename T>
+class FieldSpan
+{
+    friend class PointView;
+
+public:
+    FieldSpan() : m_data(nullptr), m_size(0), m_direct(false)
+    {}
+    FieldSpan(FieldSpan&& other) = default;
+    FieldSpan& operator=(FieldSpan&& other) = default;
+    FieldSpan(const FieldSpan&) = delete;
+    FieldSpan& operator=(const FieldSpan&) = delete;
+
+    T *data()
+        { return m_data; }
+    const T *data() const
+        { return m_data; }
+    point_count_t size() const
+        { return m_size; }
+    bool empty() const
+        { return m_size == 0; }
+    T *begin()
+        { return m_data; }
+    T *end()
+        { return m_data + m_size; }
+    const T *begin() const
+        { return m_data; }
+    const T *end() const
+        { return m_data + m_size; }
+    T& operator[](size_t i)
+        { return m_data[i]; }
+    const T& operator[](size_t i) const
+        { return m_data[i]; }
+
+    /**
+      Determine if the span refers directly to point table storage.
+
+      \return  Whether changes to the span's values change the points.
+    */
+    bool direct() const
+        { return m_direct; }
+
+private:
+    T *m_data;
+    point_count_t m_size;
+    bool m_direct;
+    std::vector<T> m_buf;
+};
+
+} // namespace pdal
@@ -86,16 +86,33 @@ void Filter::l_prepared(PointTableRef table)
         throwError("Can't set 'where_merge' options without also setting 'where' option.");
 }
 
+// Points that don't match a 'where' expression pass through the filter
+// untouched, so the filter's predicate only holds when there is none.
+ReadPredicatePtr Filter::l_predicate() const
+{
+    if (m_args->m_whereArg->set())
+        return ReadPredicatePtr();
+    return Stage::l_predicate();
+}
+
 void Filter::splitView(const PointViewPtr& view, PointViewPtr& keep, PointViewPtr& skip)
 {
     if (m_args->m_whereArg->set())
     {
+        // Evaluate the expression for a block of points at a time.
+        const point_count_t blockSize = 4096;
         PointView *k = keep.get();
         PointView *s = skip.get();
-        for (PointRef p : *view)
+        std::vector<double> results;
+        for (PointId idx = 0; idx < view->size(); idx += blockSize)
         {
-            PointView *active = m_args->m_where.eval(p) ? k : s;
-            active->appendPoint(*view, p.pointId());
+            point_count_t count = (std::min)(blockSize, view->size() - idx);
+            m_args->m_where.eval(*view, idx, count, results);
+            for (point_count_t i = 0; i < count; ++i)
+            {
+                PointView *active = results[i] ? k : s;
+                active->appendPoint(*view, idx + i);
+            }
         }
     }
     else
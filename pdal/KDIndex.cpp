@@ -32,12 +32,133 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <functional>
+
 #include "KDIndex.hpp"
 #include "private/KDImpl.hpp"
+#include "private/ThreadBudget.hpp"
 
 namespace pdal
 {
 
+namespace
+{
+
+const point_count_t BlockSize = 1024;
+
+point_count_t numBlocks(point_count_t count)
+{
+    return (count + BlockSize - 1) / BlockSize;
+}
+
+// Run 'fn' on the blocks of the range [0, count).  A nonzero 'threads'
+// is the number of threads to use.  Zero takes threads from the current
+// thread budget.  'fn' is passed the block number and the range of point
+// positions in the block.  The first exception thrown is rethrown here.
+void parallelBlocks(point_count_t count, unsigned threads,
+    const std::function<void(point_count_t, PointId, PointId)>& fn)
+{
+    const point_count_t blocks = numBlocks(count);
+    ThreadGroup group(threads ? threads : blocks, threads == 0);
+    group.run(blocks, [&](size_t b)
+    {
+        fn(b, b * BlockSize, (std::min)(count, (b + 1) * BlockSize));
+    });
+}
+
+template<size_t DIMS>
+void getPosition(const PointView& view, PointId idx, double *pt)
+{
+    static const Dimension::Id dims[] =
+        { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z };
+
+    for (size_t d = 0; d < DIMS; ++d)
+        pt[d] = view.getFieldAs<double>(dims[d], idx);
+}
+
+template<size_t DIMS, typename IMPL>
+void findKnn(const IMPL& impl, point_count_t indexSize, const PointView& query,
+    point_count_t k, PointId begin, point_count_t count, unsigned threads,
+    std::vector<point_count_t>& offsets, PointIdList& ids,
+    std::vector<double>& sqrDists)
+{
+    if (begin >= query.size())
+        count = 0;
+    count = (std::min)(count, query.size() - begin);
+    k = (std::min)(k, indexSize);
+
+    // Every query point has the same number of neighbors.
+    offsets.resize(count + 1);
+    for (point_count_t i = 0; i <= count; ++i)
+        offsets[i] = i * k;
+    ids.resize(count * k);
+    sqrDists.resize(count * k);
+    if (k == 0)
+        return;
+
+    parallelBlocks(count, threads,
+        [&](point_count_t, PointId first, PointId last)
+        {
+            double pt[DIMS];
+            for (PointId i = first; i < last; ++i)
+            {
+                getPosition<DIMS>(query, begin + i, pt);
+                impl.knnSearch(pt, k, ids.data() + i * k,
+                    sqrDists.data() + i * k);
+            }
+        });
+}
+
+template<size_t DIMS, typename IMPL>
+void findRadius(const IMPL& impl, const PointView& query, double r,
+    PointId begin, point_count_t count, unsigned threads,
+    std::vector<point_count_t>& offsets, PointIdList& ids,
+    std::vector<double>& sqrDists)
+{
+    if (begin >= query.size())
+        count = 0;
+    count = (std::min)(count, query.size() - begin);
+
+    // Each block collects its own neighbors, which are concatenated after
+    // all blocks are done.
+    std::vector<PointIdList> blockIds(numBlocks(count));
+    std::vector<std::vector<double>> blockDists(numBlocks(count));
+    offsets.assign(count + 1, 0);
+    parallelBlocks(count, threads,
+        [&](point_count_t block, PointId first, PointId last)
+        {
+            double pt[DIMS];
+            std::vector<std::pair<std::size_t, double>> matches;
+            for (PointId i = first; i < last; ++i)
+            {
+                getPosition<DIMS>(query, begin + i, pt);
+                matches.clear();
+                impl.radius(pt, r, matches);
+                offsets[i + 1] = matches.size();
+                for (auto& m : matches)
+                {
+                    blockIds[block].push_back(m.first);
+                    blockDists[block].push_back(m.second);
+                }
+            }
+        });
+
+    for (point_count_t i = 0; i < count; ++i)
+        offsets[i + 1] += offsets[i];
+    ids.clear();
+    ids.reserve(offsets.back());
+    sqrDists.clear();
+    sqrDists.reserve(offsets.back());
+    for (size_t b = 0; b < blockIds.size(); ++b)
+    {
+        ids.insert(ids.end(), blockIds[b].begin(), blockIds[b].end());
+        sqrDists.insert(sqrDists.end(), blockDists[b].begin(),
+            blockDists[b].end());
+    }
+}
+
+} // unnamed namespace
+
 //
 // KD2Index
 //
@@ -145,6 +266,15 @@ PointIdList KD2Index::radius(PointRef &point, double const& r) const
     return radius(x, y, r);
 }
 
+KDNeighbors KD2Index::knnSearchAll(const PointView& query, point_count_t k,
+    PointId begin, point_count_t count, unsigned threads) const
+{
+    KDNeighbors n;
+    findKnn<2>(*m_impl, m_buf.size(), query, k, begin, count, threads,
+        n.m_offsets, n.m_ids, n.m_sqrDists);
+    return n;
+}
+
 //
 // KD3Index
 //
@@ -261,6 +391,34 @@ PointIdList KD3Index::radius(PointRef &point, double r) const
     return radius(x, y, z, r);
 }
 
+KDNeighbors KD3Index::knnSearchAll(point_count_t k) const
+{
+    return knnSearchAll(k, 0, m_buf.size());
+}
+
+KDNeighbors KD3Index::knnSearchAll(point_count_t k, PointId begin,
+    point_count_t count, unsigned threads) const
+{
+    KDNeighbors n;
+    findKnn<3>(*m_impl, m_buf.size(), m_buf, k, begin, count, threads,
+        n.m_offsets, n.m_ids, n.m_sqrDists);
+    return n;
+}
+
+KDNeighbors KD3Index::radiusAll(double r) const
+{
+    return radiusAll(r, 0, m_buf.size());
+}
+
+KDNeighbors KD3Index::radiusAll(double r, PointId begin, point_count_t count,
+    unsigned threads) const
+{
+    KDNeighbors n;
+    findRadius<3>(*m_impl, m_buf, r, begin, count, threads,
+        n.m_offsets, n.m_ids, n.m_sqrDists);
+    return n;
+}
+
 //
 // KDFlexIndex
 //
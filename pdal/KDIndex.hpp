@@ -43,6 +43,46 @@ class KD2Impl;
 class KD3Impl;
 class KDFlexImpl;
 
+/**
+  Neighbors found for a batch of query points, stored in compressed sparse
+  row form.  The neighbors of query point 'i' (relative to the start of the
+  batch) are ids(i)[0] through ids(i)[count(i) - 1], nearest first.
+*/
+class PDAL_DLL KDNeighbors
+{
+    friend class KD2Index;
+    friend class KD3Index;
+
+public:
+    KDNeighbors() : m_offsets(1, 0)
+    {}
+
+    /// Number of query points.
+    point_count_t size() const
+        { return m_offsets.size() - 1; }
+
+    /// Number of neighbors of query point \p i.
+    point_count_t count(PointId i) const
+        { return m_offsets[i + 1] - m_offsets[i]; }
+
+    /// Neighbors of query point \p i.
+    const PointId *ids(PointId i) const
+        { return m_ids.data() + m_offsets[i]; }
+
+    /// Squared distances to the neighbors of query point \p i.
+    const double *sqrDists(PointId i) const
+        { return m_sqrDists.data() + m_offsets[i]; }
+
+    /// Copy of the neighbors of query point \p i.
+    PointIdList neighbors(PointId i) const
+        { return PointIdList(ids(i), ids(i) + count(i)); }
+
+private:
+    std::vector<point_count_t> m_offsets;
+    PointIdList m_ids;
+    std::vector<double> m_sqrDists;
+};
+
 class PDAL_DLL KD2Index
 {
 public:
@@ -67,6 +107,21 @@ public:
     PointIdList radius(PointId idx, double const& r) const;
     PointIdList radius(PointRef &point, double const& r) const;
 
+    /**
+      Find the k nearest neighbors of a range of points of another view
+      on multiple threads.
+
+      \param query  View holding the query points.
+      \param k  Number of neighbors to find.
+      \param begin  Index of the first query point.
+      \param count  Number of query points.
+      \param threads  Number of threads to use.  Zero takes threads from
+        the pipeline's thread budget.
+      \return  Neighbors of the query points.
+    */
+    KDNeighbors knnSearchAll(const PointView& query, point_count_t k,
+        PointId begin, point_count_t count, unsigned threads = 0) const;
+
 private:
     const PointView& m_buf;
     std::unique_ptr<KD2Impl> m_impl;
@@ -98,6 +153,52 @@ public:
     PointIdList radius(PointId idx, double r) const;
     PointIdList radius(PointRef &point, double r) const;
 
+    /**
+      Find the k nearest neighbors of every indexed point on multiple
+      threads.  Each point is its own first neighbor.
+
+      \param k  Number of neighbors to find.
+      \return  Neighbors of the points.
+    */
+    KDNeighbors knnSearchAll(point_count_t k) const;
+
+    /**
+      Find the k nearest neighbors of a range of indexed points on multiple
+      threads.  Use this to bound memory use for large views.
+
+      \param k  Number of neighbors to find.
+      \param begin  Index of the first query point.
+      \param count  Number of query points.
+      \param threads  Number of threads to use.  Zero takes threads from
+        the pipeline's thread budget.
+      \return  Neighbors of the query points.
+    */
+    KDNeighbors knnSearchAll(point_count_t k, PointId begin,
+        point_count_t count, unsigned threads = 0) const;
+
+    /**
+      Find the neighbors within a radius of every indexed point on multiple
+      threads.
+
+      \param r  Search radius.
+      \return  Neighbors of the points.
+    */
+    KDNeighbors radiusAll(double r) const;
+
+    /**
+      Find the neighbors within a radius of a range of indexed points on
+      multiple threads.
+
+      \param r  Search radius.
+      \param begin  Index of the first query point.
+      \param count  Number of query points.
+      \param threads  Number of threads to use.  Zero takes threads from
+        the pipeline's thread budget.
+      \return  Neighbors of the query points.
+    */
+    KDNeighbors radiusAll(double r, PointId begin, point_count_t count,
+        unsigned threads = 0) const;
+
 private:
     const PointView& m_buf;
     std::unique_ptr<KD3Impl> m_impl;
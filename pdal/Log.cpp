@@ -45,6 +45,7 @@ Log::Log(std::string const& leaderString, std::string const& outputName,
         bool timing)
     : m_level(LogLevel::Warning)
     , m_deleteStreamOnCleanup(false)
+    , m_owner(std::this_thread::get_id())
     , m_timing(timing)
 {
     if (Utils::iequals(outputName, "stdlog"))
@@ -69,6 +70,7 @@ Log::Log(std::string const& leaderString, std::string const& outputName,
 Log::Log(std::string const& leaderString, std::ostream* v, bool timing)
     : m_level(LogLevel::Error)
     , m_deleteStreamOnCleanup(false)
+    , m_owner(std::this_thread::get_id())
     , m_timing(timing)
 {
     m_log = v;
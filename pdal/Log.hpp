@@ -35,9 +35,12 @@
 #pragma once
 
 #include <cassert>
+#include <map>
 #include <memory> // shared_ptr
+#include <mutex>
 #include <stack>
 #include <chrono>
+#include <thread>
 
 #include <pdal/pdal_internal.hpp>
 #include <pdal/util/NullOStream.hpp>
@@ -104,21 +107,37 @@ public:
     void setLeader(const std::string& leader)
         { pushLeader(leader); }
 
-    /// Push the leader string onto the stack.
+    /// Push the leader string onto the stack of the calling thread.  Threads
+    /// other than the one that created the log have their own stacks, so
+    /// that stages running on different threads log with their own leaders.
     /// \param  leader  Leader string
     void pushLeader(const std::string& leader)
-        { m_leaders.push(leader); }
+    {
+        std::lock_guard<std::mutex> lock(m_leaderMutex);
+        leaders().push(leader);
+    }
 
-    /// Get the leader string.
+    /// Get the leader string.  A thread that hasn't pushed a leader uses
+    /// the leader of the thread that created the log.
     /// \return  The current leader string.
     std::string leader() const
-        { return m_leaders.empty() ? std::string() : m_leaders.top(); }
+    {
+        std::lock_guard<std::mutex> lock(m_leaderMutex);
+        auto ti = m_threadLeaders.find(std::this_thread::get_id());
+        if (ti != m_threadLeaders.end())
+            return ti->second.top();
+        return m_leaders.empty() ? std::string() : m_leaders.top();
+    }
 
-    /// Pop the current leader string.
+    /// Pop the current leader string of the calling thread.
     void popLeader()
     {
-        if (!m_leaders.empty())
-            m_leaders.pop();
+        std::lock_guard<std::mutex> lock(m_leaderMutex);
+        std::stack<std::string>& l = leaders();
+        if (!l.empty())
+            l.pop();
+        if (l.empty() && &l != &m_leaders)
+            m_threadLeaders.erase(std::this_thread::get_id());
     }
 
     /// @return A string representing the LogLevel
@@ -153,9 +172,19 @@ private:
     Log& operator =(const Log&) = delete;
     std::string now() const;
 
+    // Leader stack of the calling thread.  The leader mutex must be held.
+    std::stack<std::string>& leaders()
+    {
+        std::thread::id id = std::this_thread::get_id();
+        return id == m_owner ? m_leaders : m_threadLeaders[id];
+    }
+
     LogLevel m_level;
     bool m_deleteStreamOnCleanup;
+    std::thread::id m_owner;
     std::stack<std::string> m_leaders;
+    std::map<std::thread::id, std::stack<std::string>> m_threadLeaders;
+    mutable std::mutex m_leaderMutex;
     NullOStream m_nullStream;
     bool m_timing;
     std::chrono::steady_clock m_clock;
@@ -419,6 +419,15 @@ public:
         return node;
     }
 
+    /**
+      Replace the contents of the node with those of another node.  Other
+      references to the node see the new contents.
+
+      \param node  Node whose contents are copied.
+    */
+    void assign(const MetadataNode& node)
+        { *m_impl = *node.m_impl; }
+
     MetadataNode add(MetadataNode node)
         { return MetadataNode(m_impl->add(node.m_impl)); }
 
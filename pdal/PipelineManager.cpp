@@ -49,7 +49,7 @@ PipelineManager::PipelineManager(point_count_t streamLimit) :
     m_tablePtr(new ColumnPointTable()), m_table(*m_tablePtr),
     m_streamTablePtr(new FixedPointTable(streamLimit)),
     m_streamTable(*m_streamTablePtr),
-    m_progressFd(-1), m_input(nullptr)
+    m_progressFd(-1), m_threads(1), m_input(nullptr)
 {}
 
 
@@ -254,10 +254,19 @@ PipelineManager::ExecResult PipelineManager::execute(ExecMode mode)
             result.m_mode = ExecMode::Stream;
         }
     }
+    else if (mode == ExecMode::PipelinedStream)
+    {
+        if (s->pipelineStreamable())
+        {
+            s->prepare(m_streamTable);
+            s->executePipelined(m_streamTable);
+            result.m_mode = ExecMode::PipelinedStream;
+        }
+    }
     else if (mode == ExecMode::Standard)
     {
         s->prepare(m_table);
-        m_viewSet = s->execute(m_table);
+        m_viewSet = s->execute(m_table, m_threads);
         point_count_t cnt = 0;
         for (auto pi = m_viewSet.begin(); pi != m_viewSet.end(); ++pi)
         {
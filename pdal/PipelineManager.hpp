@@ -80,6 +80,11 @@ public:
     void setProgressFd(int fd)
         { m_progressFd = fd; }
 
+    // Set the maximum number of threads used to run stages when
+    // executing in standard mode.
+    void setThreads(std::size_t threads)
+        { m_threads = threads; }
+
     void readPipeline(std::istream& input);
     void readPipeline(const std::string& filename);
 
@@ -165,6 +170,7 @@ private:
     PointViewSet m_viewSet;
     std::vector<Stage*> m_stages; // stage observer, never owner
     int m_progressFd;
+    std::size_t m_threads;
     std::istream *m_input;
     LogPtr m_log;
 
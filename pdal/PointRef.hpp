@@ -220,6 +220,11 @@ public:
             m_container->setFieldInternal(dim, m_idx, &e);
     }
 
+    // Set a field from a value that already has the dimension's type in
+    // the layout.  No conversion or range checking is done.
+    void setRawField(Dimension::Id dim, const void *val)
+        { m_container->setFieldInternal(dim, m_idx, val); }
+
     /**
       Set the ID of a PointRef.
 
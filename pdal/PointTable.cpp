@@ -99,14 +99,27 @@ void SimplePointTable::getFieldInternal(Dimension::Id id, PointId idx,
 }
 
 
+void BlockList::push_back(char *block)
+{
+    std::size_t segment = m_size / SegmentSize;
+    if (segment >= MaxSegments)
+        throw pdal_error("Point table can't hold any more points.");
+    if (!m_segments[segment])
+        m_segments[segment].reset(new char *[SegmentSize]);
+    m_segments[segment][m_size % SegmentSize] = block;
+    m_size++;
+}
+
+
 RowPointTable::~RowPointTable()
 {
-    for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
-        delete [] *vi;
+    for (std::size_t i = 0; i < m_blocks.size(); ++i)
+        delete [] m_blocks[i];
 }
 
 PointId RowPointTable::addPoint()
 {
+    std::lock_guard<std::mutex> lock(m_addMutex);
     if (m_numPts % m_blockPtCnt == 0)
     {
         size_t size = pointsToBytes(m_blockPtCnt);
@@ -35,7 +35,10 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "pdal/SpatialReference.hpp"
@@ -100,6 +103,13 @@ private:
     virtual PointId addPoint() = 0;
     virtual char *getDimension(const Dimension::Detail *d, PointId idx) = 0;
 
+    // Return the number of points, at most 'count', starting at 'idx' whose
+    // values for each dimension are stored contiguously.  Tables that don't
+    // store dimensions as columns return 0.
+    virtual point_count_t columnRun(PointId /*idx*/,
+            point_count_t /*count*/) const
+        { return 0; }
+
 protected:
     virtual char *getPoint(PointId idx) = 0;
 
@@ -139,14 +149,45 @@ private:
     }
 };
 
+// List of pointers to blocks of point data.  The pointers are stored in
+// fixed-size segments so that adding a block never moves existing entries.
+// This allows points to be added to a table by one thread while other
+// threads access points already in the table.
+class PDAL_DLL BlockList
+{
+public:
+    BlockList() : m_segments(new std::unique_ptr<char *[]>[MaxSegments]),
+        m_size(0)
+    {}
+    BlockList(BlockList&& other) : m_segments(std::move(other.m_segments)),
+        m_size(other.m_size.load())
+    {}
+
+    void push_back(char *block);
+    char *operator[](std::size_t i) const
+        { return m_segments[i / SegmentSize][i % SegmentSize]; }
+    std::size_t size() const
+        { return m_size; }
+
+private:
+    static const std::size_t SegmentSize = 2048;
+    static const std::size_t MaxSegments = 2048;
+
+    std::unique_ptr<std::unique_ptr<char *[]>[]> m_segments;
+    // Blocks are added under the table's lock, but the size may be read
+    // by any thread.
+    std::atomic<std::size_t> m_size;
+};
+
 // This provides a context for processing a set of points and allows the library
 // to be used to process multiple point sets simultaneously.
 class PDAL_DLL RowPointTable : public SimplePointTable
 {
 private:
     // Point storage.
-    std::vector<char *> m_blocks;
+    BlockList m_blocks;
     point_count_t m_numPts;
+    std::mutex m_addMutex;
 
     // Make sure this is power-of-2 to facilitate fast div and mod ops.
     static const point_count_t m_blockPtCnt = 65536;
@@ -175,12 +216,13 @@ class PDAL_DLL ColumnPointTable : public SimplePointTable
 {
 private:
     // Point storage.
-    using DimBlockList = std::vector<char *>;
+    using DimBlockList = BlockList;
     using MemBlocks = std::vector<DimBlockList>;
 
     // List of dimension memory block lists.
     MemBlocks m_blocks;
     point_count_t m_numPts;
+    std::mutex m_addMutex;
 
     // Make sure this is power-of-2 to facilitate fast div and mod ops.
     static const point_count_t m_blockPtCnt = 16384;
@@ -202,6 +244,8 @@ private:
         void *value) const;
 
     virtual PointId addPoint();
+    virtual point_count_t columnRun(PointId idx, point_count_t count) const
+        { return (std::min)(count, m_blockPtCnt - (idx % m_blockPtCnt)); }
 
     // Hide base class calls for now.
     const char *getDimension(const Dimension::Detail *d, PointId idx) const;
@@ -281,9 +325,17 @@ public:
         : StreamPointTable(m_layout, capacity)
     {}
 
+    /// Create a table that shares the finalized layout of another table.
+    /// \param layout  Finalized point layout.
+    /// \param capacity  Number of points the table can hold.
+    FixedPointTable(PointLayout& layout, point_count_t capacity)
+        : StreamPointTable(layout, capacity),
+        m_buf(pointsToBytes(capacity + 1))
+    {}
+
     virtual void finalize()
     {
-        if (!m_layout.finalized())
+        if (!layout()->finalized())
         {
             BasePointTable::finalize();
             m_buf.resize(pointsToBytes(capacity() + 1));
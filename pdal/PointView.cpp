@@ -43,7 +43,7 @@
 namespace pdal
 {
 
-int PointView::m_lastId = 0;
+std::atomic<int> PointView::m_lastId(0);
 
 PointView::PointView(PointTableRef pointTable) : m_pointTable(pointTable),
     m_layout(pointTable.layout()), m_size(0), m_id(0)
@@ -74,6 +74,16 @@ PointViewIter PointView::end()
 }
 
 
+// Return the number of points, at most 'count', starting at view index
+// 'begin' that are stored in order in a single column block, or 0 if the
+// points can't be accessed directly.
+point_count_t PointView::directRun(PointId begin, point_count_t count) const
+{
+    count = m_pointTable.columnRun(m_index[begin], count);
+    return m_index.contiguous(begin, count) ? count : 0;
+}
+
+
 PointId PointView::tableId(PointId idx)
 {
     if (idx > size())
@@ -81,7 +91,7 @@ PointId PointView::tableId(PointId idx)
     if (idx == size())
     {
         PointId rawId = m_pointTable.addPoint();
-        m_index.push_back(rawId);
+        m_index.add(rawId);
         m_size++;
         assert(m_temps.empty());
         return rawId;
@@ -97,7 +107,7 @@ void PointView::setFieldInternal(Dimension::Id dim, PointId idx,
     if (idx == size())
     {
         rawId = m_pointTable.addPoint();
-        m_index.push_back(rawId);
+        m_index.add(rawId);
         m_size++;
         assert(m_temps.empty());
     }
@@ -206,6 +216,27 @@ Rasterd *PointView::raster(const std::string& name)
 }
 
 
+void PointView::reorder(const PointIdList& order)
+{
+    if (order.size() != size())
+        throw pdal_error("Point order doesn't match the size of the view.");
+
+    std::vector<bool> seen(size());
+    ViewIndex index;
+    for (PointId id : order)
+    {
+        if (id >= seen.size() || seen[id])
+            throw pdal_error("Point order isn't a permutation of the view's "
+                "point IDs.");
+        seen[id] = true;
+        index.add(m_index[id]);
+    }
+    m_index = std::move(index);
+    clearTemps();
+    invalidateProducts();
+}
+
+
 void PointView::invalidateProducts()
 {
     m_index2.reset();
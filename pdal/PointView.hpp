@@ -36,12 +36,15 @@
 
 #include <pdal/DimDetail.hpp>
 #include <pdal/DimType.hpp>
+#include <pdal/FieldSpan.hpp>
 #include <pdal/Mesh.hpp>
 #include <pdal/PointContainer.hpp>
+#include <pdal/ViewIndex.hpp>
 #include <pdal/PointLayout.hpp>
 #include <pdal/PointTable.hpp>
 #include <pdal/PointRef.hpp>
 
+#include <atomic>
 #include <memory>
 #include <queue>
 #include <set>
@@ -103,13 +106,22 @@ public:
         // We use size() instead of the index end because temp points
         // might have been placed at the end of the buffer.
         // We're essentially ditching temp points.
-        auto thisEnd = m_index.begin() + size();
-        auto bufEnd = buf.m_index.begin() + buf.size();
-        m_index.insert(thisEnd, buf.m_index.begin(), bufEnd);
+        m_index.truncate(size());
+        m_index.append(buf.m_index, buf.size());
         m_size += buf.size();
         clearTemps();
     }
 
+    /**
+      Rearrange the points of the view.  Only the view's index is changed;
+      no point data is copied.
+
+      \param order  Permutation of the view's point IDs.  Point \a i of
+        the view becomes the point that was at \a order[i].  Throws
+        pdal_error if \a order isn't a permutation.
+    */
+    void reorder(const PointIdList& order);
+
     /// Return a new point view with the same point table as this
     /// point buffer.
     PointViewPtr makeNew() const
@@ -132,6 +144,46 @@ public:
     inline void setField(Dimension::Id dim, Dimension::Type type,
         PointId idx, const void *val);
 
+    /**
+      Get the values of a dimension for a run of points as a contiguous
+      array.  When the points are stored in order in a columnar point table
+      and the dimension has type T, the span refers to the table storage
+      directly.  Otherwise values are copied (and converted) into the span.
+      Callers should request bounded batches (a few thousand points) and
+      loop until the returned span is empty.
+
+      The span may hold fewer than \p count points.  Spans for different
+      dimensions requested with the same \p begin and \p count always have
+      the same size.
+
+      \param dim  Dimension to fetch.
+      \param begin  Index of the first point in the run.
+      \param count  Maximum number of points in the run.
+      \return  Span of values.  The span is empty if \p begin is past the
+        end of the view.
+    */
+    template<typename T>
+    FieldSpan<T> getFieldSpan(Dimension::Id dim, PointId begin,
+        point_count_t count);
+
+    /**
+      Store the values of a span fetched with getFieldSpan().  This does
+      nothing if the span refers directly to table storage.
+
+      \param dim  Dimension of the span.
+      \param begin  Index of the first point in the span.
+      \param span  Span to store.
+    */
+    template<typename T>
+    void setFieldSpan(Dimension::Id dim, PointId begin,
+        const FieldSpan<T>& span);
+
+    // Set a field from a value that already has the dimension's type in
+    // the layout.  No conversion or range checking is done.  As with
+    // setField(), a point is added if 'idx' is the size of the view.
+    void setRawField(Dimension::Id dim, PointId idx, const void *val)
+        { setFieldInternal(dim, idx, val); }
+
     template <typename T>
     bool compare(Dimension::Id dim, PointId id1, PointId id2) const
     {
@@ -254,7 +306,7 @@ public:
     {
         if (id == size())
         {
-            m_index.push_back(m_pointTable.addPoint());
+            m_index.add(m_pointTable.addPoint());
             ++m_size;
             assert(m_temps.empty());
         }
@@ -315,7 +367,7 @@ public:
 protected:
     PointTableRef m_pointTable;
     PointLayoutPtr m_layout;
-    std::deque<PointId> m_index;
+    ViewIndex m_index;
     // The index might be larger than the size to support temporary point
     // references.
     point_count_t m_size;
@@ -328,9 +380,14 @@ protected:
     std::unique_ptr<KD2Index> m_index2;
 
 private:
-    static int m_lastId;
+    static std::atomic<int> m_lastId;
+
+    // Give the view a new ID so that it sorts after all existing views.
+    void renumber()
+        { m_id = ++m_lastId; }
 
     PointId tableId(PointId idx);
+    point_count_t directRun(PointId begin, point_count_t count) const;
 
     virtual void setFieldInternal(Dimension::Id dim, PointId idx,
         const void *buf);
@@ -340,12 +397,12 @@ private:
     virtual void swapItems(PointId id1, PointId id2)
     {
         PointId temp = m_index[id2];
-        m_index[id2] = m_index[id1];
-        m_index[id1] = temp;
+        m_index.set(id2, m_index[id1]);
+        m_index.set(id1, temp);
     }
     virtual void setItem(PointId dst, PointId src)
     {
-        m_index[dst] = m_index[src];
+        m_index.set(dst, m_index[src]);
     }
 
     template<class T>
@@ -596,11 +653,63 @@ void PointView::setField(Dimension::Id dim, PointId idx, T val)
     }
 }
 
+template<typename T>
+FieldSpan<T> PointView::getFieldSpan(Dimension::Id dim, PointId begin,
+    point_count_t count)
+{
+    FieldSpan<T> span;
+    if (begin >= size())
+        return span;
+    count = (std::min)(count, size() - begin);
+
+    const Dimension::Detail *dd = layout()->dimDetail(dim);
+    point_count_t run = directRun(begin, count);
+    if (run)
+    {
+        count = run;
+        if (dd->type() == FieldTraits<T>::type)
+        {
+            span.m_data = reinterpret_cast<T *>(
+                m_pointTable.getDimension(dd, m_index[begin]));
+            span.m_size = count;
+            span.m_direct = true;
+            return span;
+        }
+    }
+
+    span.m_buf.resize(count);
+    span.m_data = span.m_buf.data();
+    span.m_size = count;
+    if (dd->type() == FieldTraits<T>::type)
+        for (point_count_t i = 0; i < count; ++i)
+            getFieldInternal(dim, begin + i, span.m_data + i);
+    else
+        for (point_count_t i = 0; i < count; ++i)
+            span.m_data[i] = getFieldAs<T>(dim, begin + i);
+    return span;
+}
+
+template<typename T>
+void PointView::setFieldSpan(Dimension::Id dim, PointId begin,
+    const FieldSpan<T>& span)
+{
+    if (span.direct())
+        return;
+
+    const Dimension::Detail *dd = layout()->dimDetail(dim);
+    if (dd->type() == FieldTraits<T>::type)
+        for (point_count_t i = 0; i < span.size(); ++i)
+            setFieldInternal(dim, begin + i, span.data() + i);
+    else
+        for (point_count_t i = 0; i < span.size(); ++i)
+            setField(dim, begin + i, span[i]);
+}
+
 inline void PointView::appendPoint(const PointView& buffer, PointId id)
 {
     // Invalid 'id' is a programmer error.
     PointId rawId = buffer.m_index[id];
-    m_index.push_back(rawId);
+    m_index.add(rawId);
     m_size++;
     assert(m_temps.empty());
 }
@@ -614,12 +723,12 @@ inline PointId PointView::getTemp(PointId id)
     {
         newid = m_temps.front();
         m_temps.pop();
-        m_index[newid] = m_index[id];
+        m_index.set(newid, m_index[id]);
     }
     else
     {
         newid = (PointId)m_index.size();
-        m_index.push_back(m_index[id]);
+        m_index.add(m_index[id]);
     }
     return newid;
 }
@@ -36,6 +36,7 @@
 #include <ogr_geometry.h>
 
 #include <pdal/Polygon.hpp>
+#include <pdal/private/BoxTree.hpp>
 #include <pdal/private/gdal/GDALUtils.hpp>
 
 #include "../filters/private/pnp/GridPnp.hpp"
@@ -46,6 +47,8 @@ namespace pdal
 struct Polygon::PrivateData
 {
     std::vector<GridPnp> m_grids;
+    BoxTree m_index;
+    std::vector<size_t> m_candidates;
 };
 
 
@@ -145,6 +148,7 @@ Polygon& Polygon::operator=(const Polygon& src)
 void Polygon::modified()
 {
     m_pd->m_grids.clear();
+    m_pd->m_index.clear();
 }
 
 
@@ -293,11 +297,21 @@ bool Polygon::intersects(const Polygon& p) const
 /// \return  Whether the polygon contains the point or not.
 bool Polygon::contains(double x, double y) const
 {
+    // Only the parts of a multipolygon whose bounds contain the point
+    // need to be tested.
     if (m_pd->m_grids.empty())
+    {
+        std::vector<BOX2D> bounds;
         for (const Polygon& p : polygons())
+        {
             m_pd->m_grids.emplace_back(p.exteriorRing(), p.interiorRings());
-    for (auto& g : m_pd->m_grids)
-        if (g.inside(x, y))
+            bounds.push_back(p.bounds().to2d());
+        }
+        m_pd->m_index.build(bounds);
+    }
+    m_pd->m_index.candidates(x, y, m_pd->m_candidates);
+    for (size_t id : m_pd->m_candidates)
+        if (m_pd->m_grids[id].inside(x, y))
             return true;
     return false;
 }
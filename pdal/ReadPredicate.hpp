@@ -0,0 +1,93 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <memory>
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+class PointRef;
+
+/**
+  A test of the points that a stage can make use of, passed upstream so
+  that a reader can discard points before it decodes them.  Tests must be
+  conservative: they may accept points that the stage will eventually
+  reject, but must never reject a point that the stage would accept.
+  The default implementation accepts every point.
+*/
+class PDAL_DLL ReadPredicate
+{
+public:
+    virtual ~ReadPredicate()
+    {}
+
+    /**
+      Determine if any point inside a box could pass the predicate.
+
+      \param box  Box containing points.
+      \return  \c false if no point in the box can pass.
+    */
+    virtual bool boxPasses(const BOX3D& /*box*/) const
+        { return true; }
+
+    /**
+      Determine if a point at a position could pass the predicate.
+
+      \param x  X coordinate of the point.
+      \param y  Y coordinate of the point.
+      \param z  Z coordinate of the point.
+      \return  \c false if the point can't pass.
+    */
+    virtual bool positionPasses(double /*x*/, double /*y*/,
+            double /*z*/) const
+        { return true; }
+
+    /**
+      Determine if a decoded point could pass the predicate.
+
+      \param point  Point to test.
+      \return  \c false if the point can't pass.
+    */
+    virtual bool pointPasses(PointRef& /*point*/) const
+        { return true; }
+};
+typedef std::shared_ptr<ReadPredicate> ReadPredicatePtr;
+
+} // namespace pdal
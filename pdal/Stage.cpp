@@ -38,12 +38,16 @@
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/private/gdal/ErrorHandler.hpp>
 
 #include "private/StageRunner.hpp"
 
+#include <condition_variable>
+#include <exception>
 #include <iterator>
 #include <memory>
+#include <mutex>
 
 namespace pdal
 {
@@ -153,11 +157,37 @@ void Stage::prepare(PointTableRef table)
     addDimensions(table.layout());
     l_prepared(table);
     prepared(table);
+
+    ReadPredicatePtr pred = l_predicate();
+    for (Stage *prev : m_inputs)
+        prev->m_consumers[this] = std::make_pair(&table, pred);
     stopLogging();
 }
 
 
+// Consumers registered when the stage was part of a pipeline prepared with
+// a different table are ignored.
+ReadPredicatePtr Stage::pushedPredicate(PointTableRef table) const
+{
+    ReadPredicatePtr pred;
+    size_t count = 0;
+    for (auto& c : m_consumers)
+        if (c.second.first == &table)
+        {
+            pred = c.second.second;
+            count++;
+        }
+    return count == 1 ? pred : ReadPredicatePtr();
+}
+
+
 PointViewSet Stage::execute(PointTableRef table)
+{
+    return execute(table, 1);
+}
+
+
+PointViewSet Stage::execute(PointTableRef table, std::size_t threads)
 {
     table.finalize();
 
@@ -203,35 +233,194 @@ PointViewSet Stage::execute(PointTableRef table)
         }
     }
 
-    // Go through the stages in order, executing
     PointViewSet outViews;
-    std::map<StageInstance, PointViewSet> sets;
-    while (stages.size())
+    if (threads <= 1)
+    {
+        // Go through the stages in order, executing
+        std::map<StageInstance, PointViewSet> sets;
+        while (stages.size())
+        {
+            StageInstance si = stages.top();
+            stages.pop();
+            PointViewSet& inViews = sets[si];
+            if (inViews.empty())
+                inViews.insert(PointViewPtr(new PointView(table)));
+            outViews = si.m_stage->execute(table, inViews);
+
+            StageInstance child = children[si];
+
+            // If a stage has no child it is the terminal stage.  We're done.
+            if (child.m_stage)
+                sets[child].insert(outViews.begin(), outViews.end());
+            // Allow previous point views to be freed.
+            sets.erase(si);
+        }
+        return outViews;
+    }
+
+    m_log->get(LogLevel::Debug) << "Running stages on up to " << threads <<
+        " threads." << std::endl;
+
+    // Number the stage instances in the order in which they would be
+    // executed serially.  When more than one instance is ready to run,
+    // the one that comes first in this order is started first.
+    struct Node
+    {
+        Node() : m_parents(0)
+        {}
+
+        StageInstance m_instance;
+        size_t m_child;
+        size_t m_parents;
+        // Output views of each parent, keyed by the parent's position.
+        std::map<size_t, PointViewSet> m_inputs;
+    };
+
+    std::vector<Node> nodes(stages.size());
+    std::map<StageInstance, size_t> position;
+    for (size_t pos = 0; stages.size(); ++pos)
     {
-        StageInstance si = stages.top();
+        nodes[pos].m_instance = stages.top();
+        position[stages.top()] = pos;
         stages.pop();
-        PointViewSet& inViews = sets[si];
-        if (inViews.empty())
-            inViews.insert(PointViewPtr(new PointView(table)));
-        outViews = si.m_stage->execute(table, inViews);
-
-        StageInstance child = children[si];
-
-        // If a stage has no child it is the terminal stage.  We're done.
-        if (child.m_stage)
-            sets[child].insert(outViews.begin(), outViews.end());
-        // Allow previous point views to be freed.
-        sets.erase(si);
     }
+    for (Node& node : nodes)
+    {
+        auto ci = children.find(node.m_instance);
+        if (ci == children.end())
+            node.m_child = nodes.size();
+        else
+        {
+            node.m_child = position[ci->second];
+            nodes[node.m_child].m_parents++;
+        }
+    }
+
+    ParallelContext ctx(threads);
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::set<size_t> ready;
+    std::set<Stage *> busy;
+    size_t running = 0;
+    size_t remaining = nodes.size();
+    std::exception_ptr error;
+
+    for (size_t pos = 0; pos < nodes.size(); ++pos)
+        if (nodes[pos].m_parents == 0)
+            ready.insert(pos);
+
+    auto runNode = [&](size_t pos)
+    {
+        Node& node = nodes[pos];
+        Stage *stage = node.m_instance.m_stage;
+        PointViewSet views;
+        std::exception_ptr err;
+
+        try
+        {
+            // Parents may have finished in any order.  Renumber their
+            // views in parent order so that the views sort as they would
+            // have had the parents been run serially.
+            PointViewSet inViews;
+            for (auto& input : node.m_inputs)
+            {
+                std::vector<PointViewPtr> parentViews(input.second.begin(),
+                    input.second.end());
+                for (PointViewPtr& v : parentViews)
+                {
+                    v->renumber();
+                    inViews.insert(v);
+                }
+            }
+            node.m_inputs.clear();
+            if (inViews.empty())
+                inViews.insert(PointViewPtr(new PointView(table)));
+            views = stage->execute(table, inViews, &ctx);
+        }
+        catch (...)
+        {
+            err = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ctx.m_budget.release(1);
+        busy.erase(stage);
+        running--;
+        remaining--;
+        if (err)
+        {
+            if (!error)
+                error = err;
+        }
+        else if (node.m_child < nodes.size())
+        {
+            Node& child = nodes[node.m_child];
+            child.m_inputs[pos] = views;
+            if (--child.m_parents == 0)
+                ready.insert(node.m_child);
+        }
+        else
+            outViews = views;
+        cv.notify_all();
+    };
+
+    // Start stage instances as their inputs complete and threads are
+    // available.  After an error, wait for running stages to finish.
+    ThreadPool pool(threads);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (remaining && !(error && running == 0))
+    {
+        for (auto it = ready.begin(); !error && it != ready.end();)
+        {
+            Stage *stage = nodes[*it].m_instance.m_stage;
+            if (busy.count(stage))
+            {
+                it++;
+                continue;
+            }
+            if (!ctx.m_budget.acquire(1))
+                break;
+            busy.insert(stage);
+            running++;
+            size_t pos = *it;
+            it = ready.erase(it);
+            pool.add([&runNode, pos](){ runNode(pos); });
+        }
+        cv.wait(lock);
+    }
+    lock.unlock();
+    pool.join();
+
+    if (error)
+        std::rethrow_exception(error);
     return outViews;
 }
 
+
 PointViewSet Stage::execute(PointTableRef table, PointViewSet& views)
 {
+    return execute(table, views, nullptr);
+}
+
 
+PointViewSet Stage::execute(PointTableRef table, PointViewSet& views,
+    ParallelContext *ctx)
+{
     PointViewSet outViews;
     std::vector<StageRunnerPtr> runners;
 
+    // When stages run concurrently, only one at a time may use the
+    // table's spatial references or be readied.
+    std::unique_lock<std::mutex> tableLock;
+    if (ctx)
+        tableLock = std::unique_lock<std::mutex>(ctx->m_tableMutex);
+
+    // Work the stage splits among threads takes them from the pipeline's
+    // budget.  Without one, it takes them from the caller's budget, which
+    // is normally the process budget.
+    ThreadBudget *budget = ctx ? &ctx->m_budget : ThreadBudget::current();
+    ThreadBudget::Scope budgetScope(budget);
+
     startLogging();
 
     // Put the spatial references from the views onto the table.
@@ -267,24 +456,101 @@ PointViewSet Stage::execute(PointTableRef table, PointViewSet& views)
         keeps.insert(r->keeps());
     prerun(keeps);
 
-    for (StageRunnerPtr r : runners)
-        r->run();
+    // Stages running concurrently may read the whole metadata tree while
+    // the table is locked, so a running stage writes to a copy of its
+    // metadata node that's put back in the tree once the table is locked
+    // again.
+    MetadataNode sharedMetadata;
+    if (ctx)
+    {
+        sharedMetadata = m_metadata;
+        m_metadata = sharedMetadata.clone(sharedMetadata.name());
+        tableLock.unlock();
+    }
 
-    // As the stages complete (synchronously at this time), propagate the
-    // spatial reference and merge the output views.
-    srs = getSpatialReference();
-    for (StageRunnerPtr r : runners)
+    try
     {
-        PointViewSet temp = r->wait();
-
-        // If our stage has a spatial reference, the view takes it on once
-        // the stage has been run.
-        if (!srs.empty())
-            for (PointViewPtr v : temp)
-                v->setSpatialReference(srs);
-        outViews.insert(temp.begin(), temp.end());
+        // Borrow threads to run the views in parallel if the stage allows
+        // it.  The thread that holds this stage's place in the budget runs
+        // views along with the borrowed threads.
+        size_t extra = 0;
+        if (ctx && runners.size() > 1 && viewParallelSafe())
+            extra = ctx->m_budget.acquire(runners.size() - 1);
+        if (extra)
+        {
+            std::vector<std::exception_ptr> errors(runners.size());
+            ThreadPool pool(extra + 1);
+            for (size_t i = 0; i < runners.size(); ++i)
+            {
+                StageRunnerPtr r = runners[i];
+                std::exception_ptr& err = errors[i];
+                pool.add([r, &err, budget]()
+                {
+                    ThreadBudget::Scope scope(budget);
+                    try
+                    {
+                        r->run();
+                    }
+                    catch (...)
+                    {
+                        err = std::current_exception();
+                    }
+                });
+            }
+            pool.join();
+            ctx->m_budget.release(extra);
+            for (std::exception_ptr& err : errors)
+                if (err)
+                    std::rethrow_exception(err);
+        }
+        else
+        {
+            for (StageRunnerPtr r : runners)
+                r->run();
+        }
+
+        // As the stages complete, propagate the spatial reference and merge
+        // the output views.
+        srs = getSpatialReference();
+        for (StageRunnerPtr r : runners)
+        {
+            PointViewSet temp = r->wait();
+
+            // If our stage has a spatial reference, the view takes it on
+            // once the stage has been run.
+            if (!srs.empty())
+                for (PointViewPtr v : temp)
+                    v->setSpatialReference(srs);
+
+            // Views created by runners on different threads are renumbered
+            // so that they sort in runner order.
+            if (extra)
+            {
+                std::vector<PointViewPtr> runnerViews(temp.begin(),
+                    temp.end());
+                for (PointViewPtr& v : runnerViews)
+                    v->renumber();
+            }
+            outViews.insert(temp.begin(), temp.end());
+        }
+    }
+    catch (...)
+    {
+        if (ctx)
+        {
+            tableLock.lock();
+            sharedMetadata.assign(m_metadata);
+            m_metadata = sharedMetadata;
+        }
+        throw;
     }
 
+    if (ctx)
+    {
+        tableLock.lock();
+        sharedMetadata.assign(m_metadata);
+        m_metadata = sharedMetadata;
+    }
     done(table);
     stopLogging();
     m_pointCount = 0;
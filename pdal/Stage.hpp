@@ -35,6 +35,7 @@
 #pragma once
 
 #include <list>
+#include <map>
 
 #include <pdal/Dimension.hpp>
 #include <pdal/DimType.hpp>
@@ -47,6 +48,7 @@
 #include <pdal/PointRef.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/QuickInfo.hpp>
+#include <pdal/ReadPredicate.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
@@ -54,6 +56,7 @@ namespace pdal
 {
 
 class ProgramArgs;
+struct ParallelContext;
 class StageRunner;
 class StageWrapper;
 class Streamable;
@@ -124,12 +127,42 @@ public:
     */
     PointViewSet execute(PointTableRef table);
 
+    /**
+      Execute a prepared pipeline (linked set of stages) using up to
+      \ref threads threads.
+
+      Stages whose inputs have completed are run concurrently, though a
+      stage is never run on more than one set of views at a time.  Stages
+      that are view-parallel safe may run each of their input point views
+      on a different thread.  Point views are passed to each stage in the
+      same order as with serial execution.
+
+      \param table  Point table being used for stage pipeline.  This must be
+        the same \ref table used in the \ref prepare function.
+      \param threads  Maximum number of threads used to run stages.
+    */
+    PointViewSet execute(PointTableRef table, std::size_t threads);
+
     virtual void execute(StreamPointTable& table)
     {
         throw pdal_error("Attempting to use stream mode with a non-streamable "
             "stage.");
     }
 
+    /**
+      Execute a prepared pipeline in pipelined stream mode.  Each stage of
+      the pipeline runs on its own thread and works on a different chunk
+      of points.
+
+      \param table  Streaming point table used for stage pipeline.  This
+        must be the same \ref table used in the \ref prepare function.
+    */
+    virtual void executePipelined(StreamPointTable& table)
+    {
+        throw pdal_error("Attempting to use stream mode with a non-streamable "
+            "stage.");
+    }
+
     /**
       Determine if a pipeline with this stage as a sink is streamable.
 
@@ -285,6 +318,8 @@ public:
     **/
     std::vector<Stage*>& getInputs()
         { return m_inputs; }
+    const std::vector<Stage*>& getInputs() const
+        { return m_inputs; }
 
     /**
       Get the stage's metadata node.
@@ -348,6 +383,16 @@ protected:
     */
     point_count_t faceCount() const
         { return m_faceCount; }
+    /**
+      Return the predicate that the stage consuming this stage's points
+      has pushed upstream.  A predicate is only returned if this stage
+      has a single consumer, since points that one consumer rejects may
+      be needed by another.  Valid once the pipeline has been prepared.
+
+      \param table  Table with which the pipeline was prepared.
+      \return  Pushed-down predicate, or null if all points are needed.
+    */
+    ReadPredicatePtr pushedPredicate(PointTableRef table) const;
 
 private:
     uint32_t m_verbose;
@@ -367,6 +412,10 @@ private:
     // This is never used, but we want something to bind to the argument
     // we stick in ProgramArgs so that it shows up in help and an options list.
     std::string m_optionFile;
+    // Predicates pushed by the stages that consume this stage's points,
+    // along with the table with which each consumer was prepared.
+    std::map<const Stage *,
+        std::pair<const BasePointTable *, ReadPredicatePtr>> m_consumers;
 
     Stage& operator=(const Stage&) = delete;
     Stage(const Stage&) = delete;
@@ -378,6 +427,8 @@ private:
     virtual void l_addArgs(ProgramArgs& args);
     virtual void l_initialize(PointTableRef table);
     virtual void l_prepared(PointTableRef table);
+    virtual ReadPredicatePtr l_predicate() const
+        { return predicate(); }
 
     /**
       Get basic metadata (avoids reading points).  Implement in subclass.
@@ -437,6 +488,8 @@ private:
       \return  Output PointViewSet
     */
     PointViewSet execute(PointTableRef table, PointViewSet& pvSet);
+    PointViewSet execute(PointTableRef table, PointViewSet& pvSet,
+        ParallelContext *ctx);
 
     /**
       Functions called after dimensions have been added.  Implement in
@@ -447,6 +500,17 @@ private:
     virtual void prepared(PointTableRef /*table*/)
         {}
 
+    /**
+      Return a conservative test of the points this stage can make use of.
+      The test is pushed to the stage's inputs once the stage has been
+      prepared so that points which can't pass may be dropped as they're
+      read.  Implement in subclass.
+
+      \return  Predicate, or null if the stage needs every point.
+    */
+    virtual ReadPredicatePtr predicate() const
+        { return ReadPredicatePtr(); }
+
     /**
       First part of the execute step.  Called after all stages have been
       prepared.  Implement in subclass.
@@ -476,6 +540,16 @@ private:
         return PointViewSet();
     }
 
+    /**
+      Determine if \ref run can be called for different point views
+      at the same time from different threads.  Implement in subclass.
+      Only return true if \ref run modifies no member data of the stage.
+
+      \return  Whether \ref run is safe to call concurrently.
+    */
+    virtual bool viewParallelSafe() const
+        { return false; }
+
     /**
       Called after all point views have been processed.  Implement in subclass.
 
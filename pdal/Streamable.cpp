@@ -32,7 +32,14 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <condition_variable>
+#include <exception>
 #include <iterator>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <typeinfo>
 
 #include <pdal/Streamable.hpp>
 #include <pdal/Filter.hpp>
@@ -41,6 +48,65 @@
 namespace pdal
 {
 
+namespace
+{
+
+struct StreamChunk
+{
+    StreamChunk(PointLayout& layout, point_count_t capacity) :
+        m_table(layout, capacity), m_count(0)
+    {}
+
+    FixedPointTable m_table;
+    point_count_t m_count;
+    SpatialReference m_srs;
+};
+
+// Queue of chunks waiting to be processed by a stage.  A null chunk
+// marks the end of the stream.
+class ChunkQueue
+{
+public:
+    ChunkQueue() : m_aborted(false)
+    {}
+
+    void push(StreamChunk *chunk)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_chunks.push(chunk);
+        lock.unlock();
+        m_cv.notify_one();
+    }
+
+    // Wait for a chunk.  Returns false if the pipeline has been aborted.
+    bool pop(StreamChunk *& chunk)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this](){ return m_aborted || m_chunks.size(); });
+        if (m_aborted)
+            return false;
+        chunk = m_chunks.front();
+        m_chunks.pop();
+        return true;
+    }
+
+    void abort()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_aborted = true;
+        lock.unlock();
+        m_cv.notify_all();
+    }
+
+private:
+    std::queue<StreamChunk *> m_chunks;
+    bool m_aborted;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+} // unnamed namespace
+
 Streamable::Streamable()
 {}
 
@@ -73,6 +139,30 @@ void Streamable::execute(StreamPointTable& table)
 {
     m_log->get(LogLevel::Debug) << "Executing pipeline in stream mode." <<
         std::endl;
+    execute(table, false);
+}
+
+
+// Streamed execution with each stage running on its own thread.
+void Streamable::executePipelined(StreamPointTable& table)
+{
+    // Points are stored in tables owned by the pipeline, so a table that
+    // does its work in reset() would never see them.
+    if (typeid(table) != typeid(FixedPointTable))
+    {
+        m_log->get(LogLevel::Debug) << "Point table may consume points "
+            "in reset().  Executing pipeline in stream mode." << std::endl;
+        execute(table, false);
+        return;
+    }
+    m_log->get(LogLevel::Debug) << "Executing pipeline in pipelined "
+        "stream mode." << std::endl;
+    execute(table, true);
+}
+
+
+void Streamable::execute(StreamPointTable& table, bool pipelined)
+{
     struct StreamableList : public std::list<Streamable *>
     {
         StreamableList operator - (const StreamableList& other) const
@@ -152,7 +242,10 @@ void Streamable::execute(StreamPointTable& table)
             (lastRunStages - stages).done(table);
             // Call ready on all the stages we didn't run last time.
             (stages - lastRunStages).ready(table);
-            execute(table, stages, srsMap);
+            if (pipelined)
+                executePipelined(table, stages, srsMap);
+            else
+                execute(table, stages, srsMap);
             lastRunStages = stages;
         }
         else
@@ -176,6 +269,21 @@ void Streamable::execute(StreamPointTable& table)
 }
 
 
+void Streamable::processChunk(StreamPointTable& table, point_count_t count)
+{
+    Filter *f = dynamic_cast<Filter *>(this);
+    PointRef point(table, 0);
+    for (PointId idx = 0; idx < count; idx++)
+    {
+        point.setPointId(idx);
+        if (table.skip(idx) || (f && !f->eval(point)))
+            continue;
+        if (!processOne(point))
+            table.setSkip(idx);
+    }
+}
+
+
 void Streamable::execute(StreamPointTable& table,
     std::list<Streamable *>& stages, SrsMap& srsMap)
 {
@@ -241,27 +349,193 @@ void Streamable::execute(StreamPointTable& table,
                 srsMap[s] = srs;
             }
             s->startLogging();
+            s->processChunk(table, pointLimit);
+            const SpatialReference& tempSrs = s->getSpatialReference();
+            if (!tempSrs.empty())
+            {
+                srs = tempSrs;
+                table.setSpatialReference(srs);
+            }
+            s->stopLogging();
+        }
+
+        table.clear(pointLimit);
+    }
+}
+
+
+void Streamable::executePipelined(StreamPointTable& table,
+    std::list<Streamable *>& stages, SrsMap& srsMap)
+{
+    struct StageState
+    {
+        Streamable *m_stage;
+        bool m_srsSet;
+        SpatialReference m_srs;
+    };
 
-            Filter *f = dynamic_cast<Filter *>(s);
+    // Copy the SRS state out of the map so that the stage threads
+    // don't share it.
+    std::vector<StageState> states;
+    for (Streamable *s : stages)
+    {
+        auto si = srsMap.find(s);
+        if (si == srsMap.end())
+            states.push_back({ s, false, SpatialReference() });
+        else
+            states.push_back({ s, true, si->second });
+    }
+    const size_t numStages = states.size();
+
+    // We may be limited in the number of points requested.
+    point_count_t count = (std::numeric_limits<point_count_t>::max)();
+    if (Reader *r = dynamic_cast<Reader *>(states.front().m_stage))
+        count = r->count();
+
+    // The queue for the first stage holds free chunks.  Queue N holds
+    // chunks waiting for stage N.  Two chunks per stage allows each stage
+    // to have a chunk waiting when it finishes the one it's working on.
+    std::vector<ChunkQueue> queues(numStages);
+    std::vector<std::unique_ptr<StreamChunk>> chunks;
+    for (size_t i = 0; i < 2 * numStages; ++i)
+    {
+        chunks.emplace_back(new StreamChunk(*table.layout(),
+            table.capacity()));
+        queues[0].push(chunks.back().get());
+    }
+
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    SpatialReference finalSrs;
+
+    // Pass a chunk to the next stage.  After the last stage, clear the
+    // chunk and return it to the free queue.
+    auto pass = [&](size_t stageNum, StreamChunk *chunk)
+    {
+        size_t next = (stageNum + 1) % numStages;
+        if (next == 0)
+        {
+            finalSrs = chunk->m_srs;
+            chunk->m_table.clear(chunk->m_count);
+        }
+        queues[next].push(chunk);
+    };
+
+    auto readerWork = [&]()
+    {
+        Streamable *reader = states.front().m_stage;
+        bool finished = false;
+        while (!finished)
+        {
+            StreamChunk *chunk;
+            if (!queues[0].pop(chunk))
+                return;
+
+            StreamPointTable& t = chunk->m_table;
+            t.clearSpatialReferences();
+            PointRef point(t, 0);
+            point_count_t pointLimit = (std::min)(count, t.capacity());
+
+            if (!pointLimit)
+                finished = true;
             for (PointId idx = 0; idx < pointLimit; idx++)
             {
                 point.setPointId(idx);
-                if (table.skip(idx) || (f && !f->eval(point)))
-                    continue;
-                if (!s->processOne(point))
-                    table.setSkip(idx);
+                finished = !reader->processOne(point);
+                if (finished)
+                    pointLimit = idx;
+            }
+            count -= pointLimit;
+            chunk->m_count = pointLimit;
+
+            chunk->m_srs = reader->getSpatialReference();
+            if (!chunk->m_srs.empty())
+                t.setSpatialReference(chunk->m_srs);
+            pass(0, chunk);
+        }
+        if (numStages > 1)
+            queues[1].push(nullptr);
+    };
+
+    auto filterWork = [&](size_t stageNum)
+    {
+        StageState& state = states[stageNum];
+        Streamable *s = state.m_stage;
+        while (true)
+        {
+            StreamChunk *chunk;
+            if (!queues[stageNum].pop(chunk))
+                return;
+            if (!chunk)
+            {
+                if (stageNum + 1 < numStages)
+                    queues[stageNum + 1].push(nullptr);
+                return;
+            }
+
+            StreamPointTable& t = chunk->m_table;
+            if (!state.m_srsSet || state.m_srs != chunk->m_srs)
+            {
+                s->spatialReferenceChanged(chunk->m_srs);
+                state.m_srs = chunk->m_srs;
+                state.m_srsSet = true;
             }
+
+            // As in execute(), a point rejected by a filter is marked
+            // as skipped so that later stages ignore it.
+            s->processChunk(t, chunk->m_count);
             const SpatialReference& tempSrs = s->getSpatialReference();
             if (!tempSrs.empty())
             {
-                srs = tempSrs;
-                table.setSpatialReference(srs);
+                chunk->m_srs = tempSrs;
+                t.setSpatialReference(tempSrs);
             }
+            pass(stageNum, chunk);
+        }
+    };
+
+    // Stop all stages when any of them throws.  The first exception is
+    // rethrown once the threads have been joined.
+    // Each stage logs from its own thread.
+    auto work = [&](size_t stageNum)
+    {
+        Streamable *s = states[stageNum].m_stage;
+        try
+        {
+            s->startLogging();
+            if (stageNum == 0)
+                readerWork();
+            else
+                filterWork(stageNum);
+            s->stopLogging();
+        }
+        catch (...)
+        {
             s->stopLogging();
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = std::current_exception();
+            for (ChunkQueue& q : queues)
+                q.abort();
         }
+    };
 
-        table.clear(pointLimit);
-    }
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numStages; ++i)
+        threads.emplace_back(work, i);
+    for (std::thread& t : threads)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    for (const StageState& state : states)
+        if (state.m_srsSet)
+            srsMap[state.m_stage] = state.m_srs;
+
+    table.clearSpatialReferences();
+    if (!finalSrs.empty())
+        table.setSpatialReference(finalSrs);
 }
 
 } // namespace pdal
@@ -67,6 +67,29 @@ public:
     virtual void execute(StreamPointTable& table);
     using Stage::execute;
 
+    /**
+      Execute a prepared pipeline (linked set of stages) in pipelined
+      streaming mode.
+
+      Each stage on a path from a reader to this stage runs on its own
+      thread.  Points are passed between the stages in chunks, each the
+      size of the capacity of the provided StreamPointTable.  A fixed
+      number of chunks is allocated up front, so a slow stage causes the
+      stages before it to wait rather than using additional memory.
+      Points are processed by every stage in the same order as in
+      \ref execute.
+
+      The provided table supplies the point layout and chunk size.  Point
+      data is stored in tables owned by the pipeline, so only a
+      FixedPointTable is executed in this mode.  Other tables may consume
+      points in their reset() function and are executed as with
+      \ref execute.
+
+      \param table  Streaming point table used for stage pipeline.  This must
+        be the same \ref table used in the \ref prepare function.
+    */
+    virtual void executePipelined(StreamPointTable& table);
+
     /**
       Determine if a pipeline is streamable.
 
@@ -82,6 +105,8 @@ protected:
 
     void execute(StreamPointTable& table, std::list<Streamable *>& stages,
         SrsMap& srsMap);
+    void executePipelined(StreamPointTable& table,
+        std::list<Streamable *>& stages, SrsMap& srsMap);
 
     /**
       Process a single point (streaming mode).  Implement in subclass.
@@ -92,6 +117,19 @@ protected:
         to subsequent stages).
     */
     virtual bool processOne(PointRef& /*point*/) = 0;
+
+    /**
+      Process the points of a chunk of a StreamPointTable (streaming mode).
+      Points skipped by earlier stages and, for filters, points that don't
+      pass the 'where' expression are left alone.  Points rejected by this
+      stage are marked as skipped.  The default calls \ref processOne for
+      each point.  Stages that work more efficiently on many points at once
+      may override this.
+
+      \param table  Table holding the chunk.
+      \param count  Number of points in the chunk.
+    */
+    virtual void processChunk(StreamPointTable& table, point_count_t count);
     /**
     {
         throwStreamingError();
@@ -115,6 +153,9 @@ protected:
         a pointer to the first found stage that's not streamable.
     */
     const Stage *findNonstreamable() const;
+
+private:
+    void execute(StreamPointTable& table, bool pipelined);
 };
 
 } // namespace pdal
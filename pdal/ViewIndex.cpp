@@ -0,0 +1,121 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/ViewIndex.hpp>
+
+namespace pdal
+{
+
+void ViewIndex::append(const ViewIndex& other, point_count_t count)
+{
+    if (count == 0)
+        return;
+
+    if (m_mode == Mode::Range && other.m_mode == Mode::Range &&
+        (m_size == 0 || other.m_start == m_start + m_size))
+    {
+        if (m_size == 0)
+            m_start = other.m_start;
+        m_size += count;
+        return;
+    }
+    for (PointId idx = 0; idx < count; ++idx)
+        add(other[idx]);
+}
+
+
+void ViewIndex::truncate(point_count_t size)
+{
+    if (size >= m_size)
+        return;
+
+    m_size = size;
+    if (m_mode == Mode::Range)
+        return;
+
+    if (m_mode == Mode::Narrow)
+        trim(m_narrow, size);
+    else
+        trim(m_wide, size);
+}
+
+
+bool ViewIndex::contiguous(PointId idx, point_count_t count) const
+{
+    if (m_mode == Mode::Range || count == 0)
+        return true;
+
+    const PointId start = (*this)[idx];
+    for (point_count_t i = 1; i < count; ++i)
+        if ((*this)[idx + i] != start + i)
+            return false;
+    return true;
+}
+
+
+// Switch from range storage to chunked storage.  'id' is the next ID to be
+// stored, which determines whether 32-bit IDs are sufficient.
+void ViewIndex::expand(PointId id)
+{
+    const PointId last = m_size ? m_start + m_size - 1 : 0;
+    if ((std::max)(last, id) <= NarrowMax)
+    {
+        m_mode = Mode::Narrow;
+        for (PointId i = 0; i < m_size; ++i)
+            push(m_narrow, (uint32_t)(m_start + i));
+    }
+    else
+    {
+        m_mode = Mode::Wide;
+        for (PointId i = 0; i < m_size; ++i)
+            push(m_wide, m_start + i);
+    }
+}
+
+
+// Switch from 32-bit to 64-bit storage.
+void ViewIndex::widen()
+{
+    m_mode = Mode::Wide;
+    m_wide.reserve(m_narrow.size());
+    for (auto& chunk : m_narrow)
+    {
+        m_wide.emplace_back(chunk.begin(), chunk.end());
+        std::vector<uint32_t>().swap(chunk);
+    }
+    m_narrow.clear();
+}
+
+} // namespace pdal
@@ -0,0 +1,202 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  The list of point table IDs referenced by a PointView.
+
+  Views whose points were added to the table in order (the common case for
+  readers) are stored as a range and use no per-point storage.  Once a view
+  is reordered or refers to non-contiguous points, the IDs are stored in
+  chunks of 32-bit values, or 64-bit values if any ID doesn't fit in
+  32 bits.
+*/
+class PDAL_DLL ViewIndex
+{
+public:
+    ViewIndex() : m_mode(Mode::Range), m_start(0), m_size(0)
+    {}
+
+    point_count_t size() const
+        { return m_size; }
+    bool empty() const
+        { return m_size == 0; }
+
+    /**
+      Determine if the list is stored as a range of IDs.
+
+      \return  Whether the list is stored as a range.
+    */
+    bool isRange() const
+        { return m_mode == Mode::Range; }
+
+    PointId operator[](PointId idx) const
+    {
+        if (m_mode == Mode::Range)
+            return m_start + idx;
+        if (m_mode == Mode::Narrow)
+            return m_narrow[idx >> ChunkShift][idx & ChunkMask];
+        return m_wide[idx >> ChunkShift][idx & ChunkMask];
+    }
+
+    PointId at(PointId idx) const
+    {
+        if (idx >= m_size)
+            throw std::out_of_range("ViewIndex index out of range.");
+        return (*this)[idx];
+    }
+
+    void set(PointId idx, PointId id)
+    {
+        if (m_mode == Mode::Range)
+        {
+            if (id == m_start + idx)
+                return;
+            expand(id);
+        }
+        else if (m_mode == Mode::Narrow && id > NarrowMax)
+            widen();
+
+        if (m_mode == Mode::Narrow)
+            m_narrow[idx >> ChunkShift][idx & ChunkMask] = (uint32_t)id;
+        else
+            m_wide[idx >> ChunkShift][idx & ChunkMask] = id;
+    }
+
+    void add(PointId id)
+    {
+        if (m_mode == Mode::Range)
+        {
+            if (m_size == 0)
+                m_start = id;
+            if (id == m_start + m_size)
+            {
+                m_size++;
+                return;
+            }
+            expand(id);
+        }
+        else if (m_mode == Mode::Narrow && id > NarrowMax)
+            widen();
+
+        if (m_mode == Mode::Narrow)
+            push(m_narrow, (uint32_t)id);
+        else
+            push(m_wide, id);
+        m_size++;
+    }
+
+    /**
+      Append the first \p count IDs of another list to this one.
+
+      \param other  List to append.
+      \param count  Number of IDs to append.
+    */
+    void append(const ViewIndex& other, point_count_t count);
+
+    /**
+      Remove entries past \p size from the list.
+
+      \param size  New size of the list.
+    */
+    void truncate(point_count_t size);
+
+    /**
+      Determine if the \p count IDs starting at \p idx are consecutive.
+
+      \param idx  Position of the first ID to check.
+      \param count  Number of IDs to check.
+      \return  Whether the IDs are consecutive.
+    */
+    bool contiguous(PointId idx, point_count_t count) const;
+
+private:
+    enum class Mode
+    {
+        Range,
+        Narrow,
+        Wide
+    };
+
+    static const int ChunkShift = 16;
+    static const PointId ChunkSize = PointId(1) << ChunkShift;
+    static const PointId ChunkMask = ChunkSize - 1;
+    static const PointId NarrowMax = (std::numeric_limits<uint32_t>::max)();
+
+    template<typename T>
+    static void push(std::vector<std::vector<T>>& chunks, T id)
+    {
+        if (chunks.empty())
+            chunks.emplace_back();
+        else if (chunks.back().size() == ChunkSize)
+        {
+            // Only the first chunk grows incrementally.
+            chunks.emplace_back();
+            chunks.back().reserve(ChunkSize);
+        }
+        chunks.back().push_back(id);
+    }
+
+    template<typename T>
+    static void trim(std::vector<std::vector<T>>& chunks, point_count_t size)
+    {
+        chunks.resize((size + ChunkMask) >> ChunkShift);
+        if (chunks.size())
+            chunks.back().resize(size - ((chunks.size() - 1) << ChunkShift));
+    }
+
+    void expand(PointId id);
+    void widen();
+
+    Mode m_mode;
+    PointId m_start;
+    point_count_t m_size;
+    std::vector<std::vector<uint32_t>> m_narrow;
+    std::vector<std::vector<PointId>> m_wide;
+};
+
+} // namespace pdal
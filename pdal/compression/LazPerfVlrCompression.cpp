@@ -54,11 +54,81 @@
 #pragma pop_macro("max")
 #pragma pop_macro("min")
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
 #include "LazPerfVlrCompression.hpp"
 
 namespace pdal
 {
 
+namespace
+{
+
+// Input stream for the arithmetic decoder that reads a chunk that has been
+// loaded into memory.  Reads past the end of the buffer return zero.
+class MemoryInputStream
+{
+public:
+    MemoryInputStream(const char *buf, size_t size) :
+        m_pos(reinterpret_cast<const unsigned char *>(buf)),
+        m_end(m_pos + size)
+    {}
+
+    unsigned char getByte()
+        { return m_pos < m_end ? *m_pos++ : 0; }
+
+    void getBytes(unsigned char *buf, size_t len)
+    {
+        while (len--)
+            *buf++ = getByte();
+    }
+
+private:
+    const unsigned char *m_pos;
+    const unsigned char *m_end;
+};
+
+// Output stream for the arithmetic encoder that appends to a buffer.
+class MemoryOutputStream
+{
+public:
+    MemoryOutputStream(std::vector<char>& buf) : m_buf(buf)
+    {}
+
+    void putByte(unsigned char b)
+        { m_buf.push_back((char)b); }
+
+    void putBytes(const unsigned char *b, size_t len)
+        { m_buf.insert(m_buf.end(), b, b + len); }
+
+private:
+    std::vector<char>& m_buf;
+};
+
+// A chunk of points along with its compressed data.  Chunks are handed to
+// a thread pool for compression or decompression.
+struct LazChunk
+{
+    LazChunk() : m_count(0), m_done(false)
+    {}
+
+    std::vector<char> m_compressed;
+    std::vector<char> m_points;
+    uint64_t m_count;
+    bool m_done;
+    std::exception_ptr m_error;
+};
+typedef std::shared_ptr<LazChunk> LazChunkPtr;
+
+} // unnamed namespace
+
 // This compressor write data in chunks to a stream. At the beginning of the
 // data is an offset to the end of the data, where the chunk table is
 // stored.  The chunk table keeps a list of the offsets to the beginning of
@@ -73,20 +143,29 @@ class LazPerfVlrCompressorImpl
 {
     typedef laszip::io::__ofstream_wrapper<std::ostream> OutputStream;
     typedef laszip::encoders::arithmetic<OutputStream> Encoder;
+    typedef laszip::encoders::arithmetic<MemoryOutputStream> MemoryEncoder;
     typedef laszip::formats::dynamic_compressor Compressor;
     typedef laszip::factory::record_schema Schema;
 
 public:
     LazPerfVlrCompressorImpl(std::ostream& stream, const Schema& schema,
-            uint32_t chunksize) :
+            uint32_t chunksize, int threads) :
         m_stream(stream), m_outputStream(stream), m_schema(schema),
         m_chunksize(chunksize), m_chunkPointsWritten(0), m_chunkInfoPos(0),
-        m_chunkOffset(0)
-    {}
+        m_chunkOffset(0), m_started(false), m_window(0)
+    {
+        if (threads > 1)
+        {
+            m_window = 2 * (size_t)threads;
+            m_pool.reset(new ThreadPool(threads));
+        }
+    }
 
     ~LazPerfVlrCompressorImpl()
     {
-        if (m_encoder)
+        if (m_pool)
+            m_pool->join();
+        if (m_encoder || m_chunk || m_chunks.size())
             std::cerr << "LazPerfVlrCompressor destroyed without a call "
                "to done()";
     }
@@ -94,14 +173,16 @@ public:
 
     void compress(const char *inbuf)
     {
+        if (m_pool)
+        {
+            compressParallel(inbuf);
+            return;
+        }
+
         // First time through.
         if (!m_encoder || !m_compressor)
         {
-            // Get the position
-            m_chunkInfoPos = m_stream.tellp();
-            // Seek over the chunk info offset value
-            m_stream.seekp(sizeof(uint64_t), std::ios::cur);
-            m_chunkOffset = m_stream.tellp();
+            start();
             resetCompressor();
         }
         else if (m_chunkPointsWritten == m_chunksize)
@@ -115,11 +196,23 @@ public:
 
     void done()
     {
-        // Close and clear the point encoder.
-        m_encoder->done();
-        m_encoder.reset();
+        if (m_pool)
+        {
+            if (!m_started)
+                start();
+            if (m_chunk)
+                queueChunk();
+            while (m_chunks.size())
+                writeChunk();
+        }
+        else
+        {
+            // Close and clear the point encoder.
+            m_encoder->done();
+            m_encoder.reset();
 
-        newChunk();
+            newChunk();
+        }
 
         // Save our current position.  Go to the location where we need
         // to write the chunk table offset at the beginning of the point data.
@@ -152,6 +245,16 @@ public:
     }
 
 private:
+    void start()
+    {
+        // Get the position
+        m_chunkInfoPos = m_stream.tellp();
+        // Seek over the chunk info offset value
+        m_stream.seekp(sizeof(uint64_t), std::ios::cur);
+        m_chunkOffset = m_stream.tellp();
+        m_started = true;
+    }
+
     void resetCompressor()
     {
         if (m_encoder)
@@ -168,6 +271,85 @@ private:
         m_chunkPointsWritten = 0;
     }
 
+    void compressParallel(const char *inbuf)
+    {
+        if (!m_started)
+            start();
+        if (!m_chunk)
+        {
+            m_chunk.reset(new LazChunk);
+            m_chunk->m_points.resize((size_t)m_chunksize * pointSize());
+        }
+        std::copy(inbuf, inbuf + pointSize(),
+            m_chunk->m_points.data() + m_chunk->m_count * pointSize());
+        if (++m_chunk->m_count == m_chunksize)
+            queueChunk();
+    }
+
+    // Hand the current chunk to the thread pool.  If the maximum number
+    // of chunks are outstanding, first write the oldest one.
+    void queueChunk()
+    {
+        LazChunkPtr chunk(m_chunk);
+
+        m_chunk.reset();
+        while (m_chunks.size() >= m_window)
+            writeChunk();
+        m_chunks.push_back(chunk);
+        m_pool->add([this, chunk](){ compressChunk(*chunk); });
+    }
+
+    // Wait for the oldest chunk to be compressed and write it to the stream.
+    void writeChunk()
+    {
+        LazChunkPtr chunk(m_chunks.front());
+        m_chunks.pop_front();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&chunk](){ return chunk->m_done; });
+        lock.unlock();
+
+        if (chunk->m_error)
+            std::rethrow_exception(chunk->m_error);
+        m_stream.write(chunk->m_compressed.data(),
+            chunk->m_compressed.size());
+        m_chunkTable.push_back((uint32_t)chunk->m_compressed.size());
+    }
+
+    // Runs on a worker thread when decompressing in parallel.  Only the
+    // schema is shared between chunks.
+    void compressChunk(LazChunk& chunk)
+    {
+        try
+        {
+            MemoryOutputStream out(chunk.m_compressed);
+            MemoryEncoder encoder(out);
+            Compressor::ptr compressor =
+                laszip::factory::build_compressor(encoder, m_schema);
+
+            const char *pos = chunk.m_points.data();
+            for (uint64_t i = 0; i < chunk.m_count; ++i)
+            {
+                compressor->compress(pos);
+                pos += pointSize();
+            }
+            encoder.done();
+            std::vector<char>().swap(chunk.m_points);
+        }
+        catch (...)
+        {
+            chunk.m_error = std::current_exception();
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        chunk.m_done = true;
+        lock.unlock();
+        m_cv.notify_all();
+    }
+
+    size_t pointSize() const
+        { return (size_t)m_schema.size_in_bytes(); }
+
     std::ostream& m_stream;
     OutputStream m_outputStream;
     std::unique_ptr<Encoder> m_encoder;
@@ -178,12 +360,21 @@ private:
     std::streampos m_chunkInfoPos;
     std::streampos m_chunkOffset;
     std::vector<uint32_t> m_chunkTable;
+    bool m_started;
+
+    // Parallel compression.
+    size_t m_window;
+    std::deque<LazChunkPtr> m_chunks;
+    LazChunkPtr m_chunk;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::unique_ptr<ThreadPool> m_pool;
 };
 
 
 LazPerfVlrCompressor::LazPerfVlrCompressor(std::ostream& stream,
-        const Schema& schema, uint32_t chunksize) :
-    m_impl(new LazPerfVlrCompressorImpl(stream, schema, chunksize))
+        const Schema& schema, uint32_t chunksize, int threads) :
+    m_impl(new LazPerfVlrCompressorImpl(stream, schema, chunksize, threads))
 {}
 
 
@@ -207,21 +398,64 @@ class LazPerfVlrDecompressorImpl
 {
 public:
     LazPerfVlrDecompressorImpl(std::istream& stream, const char *vlrData,
-        std::streamoff pointOffset) :
+        std::streamoff pointOffset, uint64_t numPoints, int threads) :
         m_stream(stream), m_inputStream(stream), m_chunksize(0),
-        m_chunkPointsRead(0)
+        m_chunkPointsRead(0), m_pointOffset(pointOffset),
+        m_numPoints(numPoints), m_nextChunk(0), m_window(0)
     {
         laszip::io::laz_vlr zipvlr(vlrData);
         m_chunksize = zipvlr.chunk_size;
         m_schema = laszip::io::laz_vlr::to_schema(zipvlr);
         m_stream.seekg(pointOffset + sizeof(int64_t));
+        if (threads > 1 && m_numPoints && readChunkTable(pointOffset))
+        {
+            m_window = 2 * (size_t)threads;
+            m_pool.reset(new ThreadPool(threads));
+        }
+    }
+
+    ~LazPerfVlrDecompressorImpl()
+    {
+        if (m_pool)
+            m_pool->join();
     }
 
     size_t pointSize() const
         { return (size_t)m_schema.size_in_bytes(); }
 
+    bool parallel() const
+        { return (bool)m_pool; }
+
+    // Without worker threads, chunks are decompressed one at a time on the
+    // calling thread once the chunk table has been read.
+    bool skipChunks(const std::vector<bool>& skip)
+    {
+        if (m_decoder || m_chunk)
+            return false;
+        if (m_chunkOffsets.empty() &&
+                (!m_numPoints || !readChunkTable(m_pointOffset)))
+            return false;
+        if (skip.size() + 1 != m_chunkOffsets.size())
+            return false;
+        if (!m_pool)
+            m_window = 1;
+        m_skip = skip;
+        return true;
+    }
+
     void decompress(char *outbuf)
     {
+        if (m_window)
+        {
+            if (!m_chunk || m_chunkPointsRead == m_chunk->m_count)
+                nextChunk();
+            const char *pos = m_chunk->m_points.data() +
+                m_chunkPointsRead * pointSize();
+            std::copy(pos, pos + pointSize(), outbuf);
+            m_chunkPointsRead++;
+            return;
+        }
+
         if (m_chunkPointsRead == m_chunksize || !m_decoder || !m_decompressor)
         {
             resetDecompressor();
@@ -232,6 +466,12 @@ public:
     }
 
 private:
+    typedef laszip::io::__ifstream_wrapper<std::istream> InputStream;
+    typedef laszip::decoders::arithmetic<InputStream> Decoder;
+    typedef laszip::decoders::arithmetic<MemoryInputStream> MemoryDecoder;
+    typedef laszip::formats::dynamic_decompressor Decompressor;
+    typedef laszip::factory::record_schema Schema;
+
     void resetDecompressor()
     {
         m_decoder.reset(new Decoder(m_inputStream));
@@ -239,10 +479,160 @@ private:
             laszip::factory::build_decompressor(*m_decoder, m_schema);
     }
 
-    typedef laszip::io::__ifstream_wrapper<std::istream> InputStream;
-    typedef laszip::decoders::arithmetic<InputStream> Decoder;
-    typedef laszip::formats::dynamic_decompressor Decompressor;
-    typedef laszip::factory::record_schema Schema;
+    // Read the chunk table and convert the chunk sizes to the file offsets
+    // of the start of each chunk.  The offset following the last chunk is
+    // stored as well, so that chunk 'n' occupies the bytes from
+    // m_chunkOffsets[n] to m_chunkOffsets[n + 1].  Returns false if the
+    // table can't be read or doesn't match the point count.
+    bool readChunkTable(std::streamoff pointOffset)
+    {
+        if (m_chunksize == 0 ||
+            m_chunksize == (std::numeric_limits<uint32_t>::max)())
+            return false;
+
+        std::streampos pos = m_stream.tellg();
+        std::streamoff dataStart = pointOffset + sizeof(int64_t);
+        uint64_t numChunks = (m_numPoints + m_chunksize - 1) / m_chunksize;
+        bool ok = false;
+        try
+        {
+            ILeStream in(&m_stream);
+            int64_t tablePos;
+
+            in.seek(pointOffset);
+            in >> tablePos;
+            // LASzip stores the chunk table offset at the end of the
+            // file when it couldn't seek back to the start of the data.
+            if (tablePos == -1)
+            {
+                in.seek(-(std::streamoff)sizeof(int64_t), std::ios::end);
+                in >> tablePos;
+            }
+
+            uint32_t version = 0;
+            uint32_t count = 0;
+            if (m_stream && tablePos > dataStart)
+            {
+                in.seek(tablePos);
+                in >> version >> count;
+            }
+            if (m_stream && tablePos > dataStart && version == 0 &&
+                count == numChunks)
+            {
+                InputStream inputStream(m_stream);
+                Decoder decoder(inputStream);
+                laszip::decompressors::integer decomp(32, 2);
+
+                decoder.readInitBytes();
+                decomp.init();
+
+                std::streamoff offset = dataStart;
+                uint32_t predictor = 0;
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    m_chunkOffsets.push_back(offset);
+                    predictor = (uint32_t)decomp.decompress(decoder,
+                        predictor, 1);
+                    offset += predictor;
+                }
+                m_chunkOffsets.push_back(offset);
+                ok = (offset <= tablePos);
+            }
+        }
+        catch (...)
+        {
+            ok = false;
+        }
+        if (!ok)
+            m_chunkOffsets.clear();
+        m_stream.clear();
+        m_stream.seekg(pos);
+        return ok;
+    }
+
+    // Read the compressed data for chunks following those already queued
+    // and hand them to the thread pool for decompression.  Compressed data
+    // is read sequentially from the stream on the calling thread.
+    void fillWindow()
+    {
+        while (m_chunks.size() < m_window)
+        {
+            while (m_nextChunk < m_skip.size() && m_skip[m_nextChunk])
+                m_nextChunk++;
+            if (m_nextChunk + 1 >= m_chunkOffsets.size())
+                break;
+
+            LazChunkPtr chunk(new LazChunk);
+
+            std::streamoff start = m_chunkOffsets[m_nextChunk];
+            std::streamoff end = m_chunkOffsets[m_nextChunk + 1];
+            chunk->m_count = (std::min)((uint64_t)m_chunksize,
+                m_numPoints - m_nextChunk * m_chunksize);
+            chunk->m_compressed.resize((size_t)(end - start));
+            m_stream.seekg(start);
+            m_stream.read(chunk->m_compressed.data(),
+                chunk->m_compressed.size());
+            if (!m_stream)
+                throw pdal_error("Unable to read compressed data for "
+                    "LAZ chunk " + std::to_string(m_nextChunk) + ".");
+            m_nextChunk++;
+            m_chunks.push_back(chunk);
+            if (m_pool)
+                m_pool->add([this, chunk](){ decompressChunk(*chunk); });
+            else
+                decompressChunk(*chunk);
+        }
+    }
+
+    void nextChunk()
+    {
+        fillWindow();
+        if (m_chunks.empty())
+            throw pdal_error("Attempt to read past the end of LAZ data.");
+        m_chunk = m_chunks.front();
+        m_chunks.pop_front();
+        if (m_pool)
+            fillWindow();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this](){ return m_chunk->m_done; });
+        lock.unlock();
+
+        if (m_chunk->m_error)
+            std::rethrow_exception(m_chunk->m_error);
+        m_chunkPointsRead = 0;
+    }
+
+    // Runs on a worker thread.  Only the schema is shared between chunks.
+    void decompressChunk(LazChunk& chunk)
+    {
+        try
+        {
+            MemoryInputStream in(chunk.m_compressed.data(),
+                chunk.m_compressed.size());
+            MemoryDecoder decoder(in);
+            Decompressor::ptr decompressor =
+                laszip::factory::build_decompressor(decoder, m_schema);
+
+            chunk.m_points.resize((size_t)chunk.m_count * pointSize());
+            char *pos = chunk.m_points.data();
+            for (uint64_t i = 0; i < chunk.m_count; ++i)
+            {
+                decompressor->decompress(pos);
+                pos += pointSize();
+            }
+            std::vector<char>().swap(chunk.m_compressed);
+        }
+        catch (...)
+        {
+            chunk.m_error = std::current_exception();
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        chunk.m_done = true;
+        lock.unlock();
+        m_cv.notify_all();
+    }
 
     std::istream& m_stream;
     InputStream m_inputStream;
@@ -250,12 +640,27 @@ private:
     Decompressor::ptr m_decompressor;
     Schema m_schema;
     uint32_t m_chunksize;
-    uint32_t m_chunkPointsRead;
+    uint64_t m_chunkPointsRead;
+    std::streamoff m_pointOffset;
+
+    // Chunk-at-a-time decompression.
+    uint64_t m_numPoints;
+    std::vector<std::streamoff> m_chunkOffsets;
+    std::vector<bool> m_skip;
+    size_t m_nextChunk;
+    size_t m_window;
+    std::deque<LazChunkPtr> m_chunks;
+    LazChunkPtr m_chunk;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::unique_ptr<ThreadPool> m_pool;
 };
 
 LazPerfVlrDecompressor::LazPerfVlrDecompressor(std::istream& stream,
-        const char *vlrData, std::streamoff pointOffset) :
-    m_impl(new LazPerfVlrDecompressorImpl(stream, vlrData, pointOffset))
+        const char *vlrData, std::streamoff pointOffset, uint64_t numPoints,
+        int threads) :
+    m_impl(new LazPerfVlrDecompressorImpl(stream, vlrData, pointOffset,
+        numPoints, threads))
 {}
 
 
@@ -274,5 +679,17 @@ void LazPerfVlrDecompressor::decompress(char *outbuf)
     m_impl->decompress(outbuf);
 }
 
+
+bool LazPerfVlrDecompressor::parallel() const
+{
+    return m_impl->parallel();
+}
+
+
+bool LazPerfVlrDecompressor::skipChunks(const std::vector<bool>& skip)
+{
+    return m_impl->skipChunks(skip);
+}
+
 } // namespace pdal
 
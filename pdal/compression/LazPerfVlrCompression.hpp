@@ -34,6 +34,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <pdal/util/OStream.hpp>
 
 namespace laszip
@@ -58,13 +59,17 @@ namespace pdal
 // The compressor uses the schema of the point data in order to compress
 // the point stream.  The schema is also stored in a VLR that isn't
 // handled as part of the compression process itself.
+// When more than one thread is requested, points are collected into
+// chunks that are compressed on worker threads.  Since the compressor is
+// reset at each chunk, the compressed chunks are identical to those
+// produced by a single thread and are written to the stream in order.
 class LazPerfVlrCompressor
 {
     typedef laszip::factory::record_schema Schema;
 
 public:
     PDAL_DLL LazPerfVlrCompressor(std::ostream& stream, const Schema& schema,
-        uint32_t chunksize);
+        uint32_t chunksize, int threads = 1);
     PDAL_DLL ~LazPerfVlrCompressor();
 
     PDAL_DLL void compress(const char *inbuf);
@@ -77,15 +82,29 @@ private:
 
 class LazPerfVlrDecompressorImpl;
 
+// The decompressor reads points written by LazPerfVlrCompressor (or LASzip
+// using fixed-size chunks).  When more than one thread is requested and the
+// chunk table can be read, the compressed data for upcoming chunks is read
+// from the stream and decompressed on worker threads ahead of the requests
+// for points.  Points are always returned in file order.  If the chunk
+// table is missing or doesn't match the number of points, decompression
+// falls back to a single thread.  Whole chunks can be skipped, in which
+// case the points of the next chunk that isn't skipped are returned.
 class LazPerfVlrDecompressor
 {
 public:
     PDAL_DLL LazPerfVlrDecompressor(std::istream& stream, const char *vlrData,
-        std::streamoff pointOffset);
+        std::streamoff pointOffset, uint64_t numPoints = 0,
+        int threads = 1);
     PDAL_DLL ~LazPerfVlrDecompressor();
 
     PDAL_DLL size_t pointSize() const;
     PDAL_DLL void decompress(char *outbuf);
+    PDAL_DLL bool parallel() const;
+    // Set the chunks whose points shouldn't be returned.  Must be called
+    // before any points are decompressed.  Returns false, and skips
+    // nothing, if the chunk table can't be read.
+    PDAL_DLL bool skipChunks(const std::vector<bool>& skip);
 
 private:
     std::unique_ptr<LazPerfVlrDecompressorImpl> m_impl;
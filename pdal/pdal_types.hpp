@@ -260,6 +260,7 @@ enum class ExecMode
     Standard,
     Stream,
     PreferStream,
+    PipelinedStream,
     None
 };
 
@@ -0,0 +1,166 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "BoxTree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Maximum number of children of a node.
+const size_t NodeSize = 16;
+
+// Sort items so that each run of NodeSize items is spatially compact:
+// sort by the X center, cut into vertical slices and sort each slice by
+// the Y center.
+template<typename T, typename BOX>
+void strSort(std::vector<T>& items, BOX box)
+{
+    auto xLess = [&box](const T& a, const T& b)
+    {
+        const BOX2D& ba = box(a);
+        const BOX2D& bb = box(b);
+        return ba.minx + ba.maxx < bb.minx + bb.maxx;
+    };
+    auto yLess = [&box](const T& a, const T& b)
+    {
+        const BOX2D& ba = box(a);
+        const BOX2D& bb = box(b);
+        return ba.miny + ba.maxy < bb.miny + bb.maxy;
+    };
+
+    const size_t nodes = (items.size() + NodeSize - 1) / NodeSize;
+    const size_t slices = (size_t)std::ceil(std::sqrt((double)nodes));
+    const size_t sliceSize = slices * NodeSize;
+
+    std::stable_sort(items.begin(), items.end(), xLess);
+    for (size_t i = 0; i < items.size(); i += sliceSize)
+    {
+        auto end = items.begin() + (std::min)(i + sliceSize, items.size());
+        std::stable_sort(items.begin() + i, end, yLess);
+    }
+}
+
+} // unnamed namespace
+
+
+void BoxTree::clear()
+{
+    m_boxes.clear();
+    m_ids.clear();
+    m_nodes.clear();
+}
+
+
+void BoxTree::build(const std::vector<BOX2D>& boxes)
+{
+    clear();
+    if (boxes.empty())
+        return;
+
+    m_ids.resize(boxes.size());
+    std::iota(m_ids.begin(), m_ids.end(), 0);
+    strSort(m_ids, [&boxes](size_t id) -> const BOX2D&
+        { return boxes[id]; });
+    for (size_t id : m_ids)
+        m_boxes.push_back(boxes[id]);
+
+    // Pack the entries into leaves, then pack each level of nodes into
+    // the level above until there's a single root, which is the last
+    // node.
+    auto pack = [this](size_t begin, size_t end, bool leaf)
+    {
+        for (size_t i = begin; i < end; i += NodeSize)
+        {
+            Node n;
+            n.m_first = (uint32_t)i;
+            n.m_count = (uint32_t)((std::min)(i + NodeSize, end) - i);
+            n.m_leaf = leaf;
+            for (size_t j = i; j < i + n.m_count; ++j)
+                n.m_bounds.grow(leaf ? m_boxes[j] : m_nodes[j].m_bounds);
+            m_nodes.push_back(n);
+        }
+    };
+
+    pack(0, m_boxes.size(), true);
+    size_t begin = 0;
+    size_t end = m_nodes.size();
+    while (end - begin > 1)
+    {
+        std::vector<Node> level(m_nodes.begin() + begin,
+            m_nodes.begin() + end);
+        strSort(level, [](const Node& n) -> const BOX2D&
+            { return n.m_bounds; });
+        std::copy(level.begin(), level.end(), m_nodes.begin() + begin);
+        pack(begin, end, false);
+        begin = end;
+        end = m_nodes.size();
+    }
+}
+
+
+void BoxTree::candidates(double x, double y, std::vector<size_t>& ids) const
+{
+    ids.clear();
+    search([x, y](const BOX2D& b){ return b.contains(x, y); },
+        [this, &ids](uint32_t i){ ids.push_back(m_ids[i]); return false; });
+    std::sort(ids.begin(), ids.end());
+}
+
+
+void BoxTree::candidates(const BOX2D& box, std::vector<size_t>& ids) const
+{
+    ids.clear();
+    search([&box](const BOX2D& b){ return b.overlaps(box); },
+        [this, &ids](uint32_t i){ ids.push_back(m_ids[i]); return false; });
+    std::sort(ids.begin(), ids.end());
+}
+
+
+bool BoxTree::overlaps(const BOX2D& box) const
+{
+    bool found = false;
+    search([&box](const BOX2D& b){ return b.overlaps(box); },
+        [&found](uint32_t){ found = true; return true; });
+    return found;
+}
+
+} // namespace pdal
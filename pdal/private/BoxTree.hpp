@@ -0,0 +1,177 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/util/Bounds.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace pdal
+{
+
+/**
+  R-tree of 2D boxes, bulk loaded with the sort-tile-recursive (STR)
+  algorithm.  The tree is built once from a list of boxes and then
+  queried for the boxes that contain a point or overlap a box.  Boxes are
+  identified by their position in the list used to build the tree.
+*/
+class PDAL_DLL BoxTree
+{
+public:
+    BoxTree()
+    {}
+
+    BoxTree(const std::vector<BOX2D>& boxes)
+        { build(boxes); }
+
+    /**
+      Replace the contents of the tree.
+
+      \param boxes  Boxes to index.
+    */
+    void build(const std::vector<BOX2D>& boxes);
+
+    /**
+      Remove all boxes from the tree.
+    */
+    void clear();
+
+    /**
+      Number of boxes in the tree.
+    */
+    size_t size() const
+        { return m_ids.size(); }
+
+    /**
+      Determine if the tree is empty.
+    */
+    bool empty() const
+        { return m_ids.empty(); }
+
+    /**
+      Find the boxes that contain a point.
+
+      \param x  X coordinate of the point.
+      \param y  Y coordinate of the point.
+      \param ids  Set to the IDs of the boxes that contain the point, in
+        ascending order.
+    */
+    void candidates(double x, double y, std::vector<size_t>& ids) const;
+
+    /**
+      Find the boxes that overlap a box.
+
+      \param box  Box to test.
+      \param ids  Set to the IDs of the boxes that overlap \a box, in
+        ascending order.
+    */
+    void candidates(const BOX2D& box, std::vector<size_t>& ids) const;
+
+    /**
+      Determine if any box overlaps a box.
+
+      \param box  Box to test.
+      \return  Whether any box in the tree overlaps \a box.
+    */
+    bool overlaps(const BOX2D& box) const;
+
+    /**
+      Call a function with the ID of each box that contains a point, in no
+      particular order, until the function returns true.
+
+      \param x  X coordinate of the point.
+      \param y  Y coordinate of the point.
+      \param f  Function to call.
+      \return  Whether the function returned true.
+    */
+    template<typename F>
+    bool find(double x, double y, F f) const
+    {
+        bool found = false;
+        search([x, y](const BOX2D& b){ return b.contains(x, y); },
+            [this, &f, &found](uint32_t i)
+            { return (found = f(m_ids[i])); });
+        return found;
+    }
+
+private:
+    struct Node
+    {
+        BOX2D m_bounds;
+        uint32_t m_first;   // First child node or entry.
+        uint32_t m_count;   // Number of children.
+        bool m_leaf;        // Whether the children are entries.
+    };
+
+    template<typename TEST, typename FOUND>
+    void search(TEST test, FOUND found) const;
+
+    std::vector<BOX2D> m_boxes;
+    std::vector<size_t> m_ids;
+    std::vector<Node> m_nodes;
+};
+
+
+// Walk the nodes whose bounds pass 'test', calling 'found' with the
+// position of each entry whose box passes until it returns true.
+template<typename TEST, typename FOUND>
+void BoxTree::search(TEST test, FOUND found) const
+{
+    if (m_nodes.empty() || !test(m_nodes.back().m_bounds))
+        return;
+
+    // Each level adds fewer than 16 entries to the stack and a tree
+    // can't have more than 16 levels with 32-bit positions.
+    uint32_t stack[256];
+    size_t top = 0;
+    stack[top++] = (uint32_t)(m_nodes.size() - 1);
+    while (top)
+    {
+        const Node& n = m_nodes[stack[--top]];
+        for (uint32_t i = n.m_first; i < n.m_first + n.m_count; ++i)
+            if (n.m_leaf)
+            {
+                if (test(m_boxes[i]) && found(i))
+                    return;
+            }
+            else if (test(m_nodes[i].m_bounds))
+                stack[top++] = i;
+    }
+}
+
+} // namespace pdal
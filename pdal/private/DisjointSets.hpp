@@ -0,0 +1,125 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace pdal
+{
+
+/**
+  Disjoint sets of the integers [0, size), also known as union-find.  Sets
+  can be joined and searched by several threads at once without locking.
+  The root of each set is its smallest member, so the result doesn't
+  depend on the order in which sets are joined.
+*/
+class DisjointSets
+{
+public:
+    /**
+      Create sets each holding a single integer.
+
+      \param size  Number of sets.
+    */
+    DisjointSets(size_t size) : m_parent(size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            m_parent[i].store(i, std::memory_order_relaxed);
+    }
+
+    /**
+      Number of integers in the sets.
+    */
+    size_t size() const
+        { return m_parent.size(); }
+
+    /**
+      Find the root of the set containing an integer.
+
+      \param i  Integer to find.
+      \return  Smallest member of the set containing \a i, once all joins
+        are complete.
+    */
+    size_t find(size_t i)
+    {
+        // Parents only ever move closer to the root, so each step can
+        // point a node at its grandparent (path halving).
+        while (true)
+        {
+            size_t p = m_parent[i].load();
+            if (p == i)
+                return i;
+            size_t g = m_parent[p].load();
+            if (g != p)
+                m_parent[i].compare_exchange_weak(p, g);
+            i = g;
+        }
+    }
+
+    /**
+      Join the sets containing two integers.
+
+      \param a  First integer.
+      \param b  Second integer.
+      \return  Whether the integers were in different sets.
+    */
+    bool unite(size_t a, size_t b)
+    {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return false;
+            if (a < b)
+                std::swap(a, b);
+
+            // Attach the larger root to the smaller.  This fails if
+            // another thread has attached 'a' in the meantime.
+            size_t expected = a;
+            if (m_parent[a].compare_exchange_strong(expected, b))
+                return true;
+        }
+    }
+
+private:
+    std::vector<std::atomic<size_t>> m_parent;
+};
+
+} // namespace pdal
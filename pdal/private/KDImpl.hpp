@@ -36,6 +36,8 @@
 
 #include <nanoflann/nanoflann.hpp>
 
+#include "ThreadBudget.hpp"
+
 namespace pdal
 {
 
@@ -84,7 +86,8 @@ public:
 
     void build()
     {
-        m_index.buildIndex();
+        ThreadGroup group;
+        m_index.buildIndex((unsigned)group.size());
     }
 
     PointIdList neighbors(double x, double y, point_count_t k) const
@@ -132,6 +135,30 @@ public:
         return output;
     }
 
+    // Find the 'k' nearest neighbors of 'pt'.  'indices' and 'sqr_dists'
+    // must have room for 'k' entries, which should be no more than the
+    // number of indexed points.
+    void knnSearch(const double *pt, point_count_t k, PointId *indices,
+        double *sqr_dists) const
+    {
+        nanoflann::KNNResultSet<double, PointId, point_count_t> resultSet(k);
+
+        resultSet.init(indices, sqr_dists);
+        m_index.findNeighbors(resultSet, pt, nanoflann::SearchParams(10));
+    }
+
+    // Find the neighbors of 'pt' within radius 'r', nearest first.
+    void radius(const double *pt, double r,
+        std::vector<std::pair<std::size_t, double>>& matches) const
+    {
+        nanoflann::SearchParams params;
+        params.sorted = true;
+
+        // Our distance metric is square distance, so we use the square of
+        // the radius.
+        m_index.radiusSearch(pt, r * r, matches, params);
+    }
+
 private:
     const PointView& m_buf;
 
@@ -194,7 +221,8 @@ public:
 
     void build()
     {
-        m_index.buildIndex();
+        ThreadGroup group;
+        m_index.buildIndex((unsigned)group.size());
     }
 
     PointIdList neighbors(double x, double y, double z, point_count_t k,
@@ -263,6 +291,30 @@ public:
         return output;
     }
 
+    // Find the 'k' nearest neighbors of 'pt'.  'indices' and 'sqr_dists'
+    // must have room for 'k' entries, which should be no more than the
+    // number of indexed points.
+    void knnSearch(const double *pt, point_count_t k, PointId *indices,
+        double *sqr_dists) const
+    {
+        nanoflann::KNNResultSet<double, PointId, point_count_t> resultSet(k);
+
+        resultSet.init(indices, sqr_dists);
+        m_index.findNeighbors(resultSet, pt, nanoflann::SearchParams(10));
+    }
+
+    // Find the neighbors of 'pt' within radius 'r', nearest first.
+    void radius(const double *pt, double r,
+        std::vector<std::pair<std::size_t, double>>& matches) const
+    {
+        nanoflann::SearchParams params;
+        params.sorted = true;
+
+        // Our distance metric is square distance, so we use the square of
+        // the radius.
+        m_index.radiusSearch(pt, r * r, matches, params);
+    }
+
 private:
     const PointView& m_buf;
 
@@ -288,7 +340,8 @@ public:
 
     void build()
     {
-        m_index.buildIndex();
+        ThreadGroup group;
+        m_index.buildIndex((unsigned)group.size());
     }
 
     PointIdList neighbors(PointRef &point, point_count_t k, size_t stride) const
@@ -34,6 +34,7 @@
 
 #include <array>
 #include <cfloat>
+#include <functional>
 #include <numeric>
 #include <vector>
 
@@ -44,6 +45,7 @@
 #include <pdal/private/gdal/Raster.hpp>
 
 #include "MathUtils.hpp"
+#include "ThreadBudget.hpp"
 
 namespace pdal
 {
@@ -210,8 +212,10 @@ Eigen::MatrixXd extendedLocalMinimum(const PointView& view, int rows, int cols,
     using namespace Dimension;
     using namespace Eigen;
 
-    // Index elevation values by row and column.
-    std::map<uint32_t, std::vector<double>> hash;
+    // Pair elevation values with their cell and sort, which groups each
+    // cell's values in increasing order.
+    std::vector<std::pair<uint32_t, double>> cells;
+    cells.reserve(view.size());
     for (PointId i = 0; i < view.size(); ++i)
     {
         double x = view.getFieldAs<double>(Id::X, i);
@@ -221,113 +225,242 @@ Eigen::MatrixXd extendedLocalMinimum(const PointView& view, int rows, int cols,
         int c = Utils::clamp(static_cast<int>(floor(x-bounds.minx)/cell_size), 0, cols-1);
         int r = Utils::clamp(static_cast<int>(floor(y-bounds.miny)/cell_size), 0, rows-1);
 
-        hash[r*cols+c].push_back(z);
+        cells.emplace_back(r*cols+c, z);
     }
+    std::sort(cells.begin(), cells.end());
 
-    // For each grid cell, sort elevations and detect local minimum, rejecting
-    // low outliers.
+    // For each grid cell, detect local minimum, rejecting low outliers.
     MatrixXd ZImin(rows, cols);
     ZImin.setConstant(std::numeric_limits<double>::quiet_NaN());
-    for (int c = 0; c < cols; ++c)
+    for (size_t first = 0; first < cells.size();)
     {
-        for (int r = 0; r < rows; ++r)
+        const uint32_t cell = cells[first].first;
+        size_t last = first + 1;
+        while (last < cells.size() && cells[last].first == cell)
+            last++;
+
+        const int r = cell / cols;
+        const int c = cell % cols;
+        if (last - first == 1)
+            ZImin(r, c) = cells[first].second;
+        for (size_t i = first; i < last - 1; ++i)
         {
-            std::vector<double> cp(hash[r*cols+c]);
-            if (cp.empty())
-                continue;
-            std::sort(cp.begin(), cp.end());
-            if (cp.size() == 1)
+            if (std::fabs(cells[i].second - cells[i+1].second) < 1.0)
             {
-                ZImin(r, c) = cp[0];
-                continue;
-            }
-            for (size_t i = 0; i < cp.size()-1; ++i)
-            {
-                if (std::fabs(cp[i] - cp[i+1]) < 1.0)
-                {
-                    ZImin(r, c) = cp[i];
-                    break;
-                }
+                ZImin(r, c) = cells[i].second;
+                break;
             }
         }
+        first = last;
     }
 
     return ZImin;
 }
 
-void dilateDiamond(std::vector<double>& data, size_t rows, size_t cols, int iterations)
+namespace
 {
-    std::vector<double> out(data.size(), std::numeric_limits<double>::lowest());
-    std::array<size_t, 5> idx;
 
-    for (int iter = 0; iter < iterations; ++iter)
+struct MinOp
+{
+    static double neutral()
+        { return (std::numeric_limits<double>::max)(); }
+    static double apply(double a, double b)
+        { return (std::min)(a, b); }
+};
+
+struct MaxOp
+{
+    static double neutral()
+        { return std::numeric_limits<double>::lowest(); }
+    static double apply(double a, double b)
+        { return (std::max)(a, b); }
+};
+
+// Run fn(i) for i in [0, count) on threads from the thread budget.
+void parallelFor(size_t count, size_t work,
+    const std::function<void(size_t)>& fn)
+{
+    // Don't bother with threads for small rasters.
+    ThreadGroup group((work < (1 << 18)) ? 1 : count);
+    group.run(count, fn);
+}
+
+struct VanHerkScratch
+{
+    std::vector<double> f;
+    std::vector<double> g;
+    std::vector<double> h;
+};
+
+// Apply a 1D filter with a window of 2 * n + 1 values using the van Herk/
+// Gil-Werman algorithm, which needs three comparisons per value regardless
+// of window size.  The filter is applied to 'width' lines at once.  Value
+// 'k' of line position 'i' is at data[i * istride + k * kstride].  Positions
+// outside the line are treated as neutral values.
+template<typename OP>
+void vanHerk(double *data, size_t len, size_t istride, size_t width,
+    size_t kstride, size_t n, VanHerkScratch& scratch)
+{
+    const size_t w = 2 * n + 1;
+    const size_t padded = ((len + 2 * n + w - 1) / w) * w;
+    std::vector<double>& f = scratch.f;
+    std::vector<double>& g = scratch.g;
+    std::vector<double>& h = scratch.h;
+
+    f.assign(padded * width, OP::neutral());
+    g.resize(padded * width);
+    h.resize(padded * width);
+    for (size_t i = 0; i < len; ++i)
+    {
+        const double *in = data + i * istride;
+        double *fi = f.data() + (i + n) * width;
+        for (size_t k = 0; k < width; ++k)
+            fi[k] = in[k * kstride];
+    }
+
+    // Running values from the start of each block (g) and from the end of
+    // each block (h).  The inner loops are across lines so that they
+    // can be vectorized.
+    for (size_t start = 0; start < padded; start += w)
     {
-        for (size_t col = 0; col < cols; ++col)
+        std::copy(f.data() + start * width, f.data() + (start + 1) * width,
+            g.data() + start * width);
+        for (size_t i = start + 1; i < start + w; ++i)
         {
-            size_t index = col*rows;
-            for (size_t row = 0; row < rows; ++row)
-            {
-                // Find the index into the vector of the current cell.  Then
-                // find the index of the cells to the right/left/above/below
-                // if they exist.
-                size_t j = 0;
-                idx[j++] = index+row;
-                if (row > 0)
-                    idx[j++] = idx[0]-1;
-                if (row < rows-1)
-                    idx[j++] = idx[0]+1;
-                if (col > 0)
-                    idx[j++] = idx[0]-rows;
-                if (col < cols-1)
-                    idx[j++] = idx[0]+rows;
-                // If the data at the test cell pos is greater than that
-                // from the last iteration, set the value to the maximum of
-                // the value of those cells.
-                for (size_t i = 0; i < j; ++i)
-                {
-                    if (data[idx[i]] > out[index+row])
-                        out[index+row] = data[idx[i]];
-                }
-            }
+            const double *fi = f.data() + i * width;
+            const double *gprev = g.data() + (i - 1) * width;
+            double *gi = g.data() + i * width;
+            for (size_t k = 0; k < width; ++k)
+                gi[k] = OP::apply(gprev[k], fi[k]);
         }
-        data.swap(out);
+
+        const size_t last = start + w - 1;
+        std::copy(f.data() + last * width, f.data() + (last + 1) * width,
+            h.data() + last * width);
+        for (size_t i = last; i-- > start;)
+        {
+            const double *fi = f.data() + i * width;
+            const double *hnext = h.data() + (i + 1) * width;
+            double *hi = h.data() + i * width;
+            for (size_t k = 0; k < width; ++k)
+                hi[k] = OP::apply(hnext[k], fi[k]);
+        }
+    }
+
+    // The window for position 'i' spans padded positions [i, i + 2n].
+    for (size_t i = 0; i < len; ++i)
+    {
+        const double *hi = h.data() + i * width;
+        const double *gi = g.data() + (i + 2 * n) * width;
+        double *out = data + i * istride;
+        for (size_t k = 0; k < width; ++k)
+            out[k * kstride] = OP::apply(hi[k], gi[k]);
     }
 }
 
-void erodeDiamond(std::vector<double>& data, size_t rows, size_t cols,
+// Apply 'iterations' passes with a 5-cell diamond structuring element.
+// Used for small structuring elements.
+template<typename OP>
+void diamondIterate(std::vector<double>& data, size_t rows, size_t cols,
     int iterations)
 {
-    std::vector<double> out(data.size(), (std::numeric_limits<double>::max)());
-    std::array<size_t, 5> idx;
-
+    std::vector<double> out(data.size());
     for (int iter = 0; iter < iterations; ++iter)
     {
-        for (size_t col = 0; col < cols; ++col)
+        parallelFor(cols, rows * cols, [&](size_t col)
         {
-            size_t index = col*rows;
+            const size_t index = col * rows;
             for (size_t row = 0; row < rows; ++row)
             {
-                size_t j = 0;
-                idx[j++] = index+row;
-                if (row > 0)
-                    idx[j++] = idx[0]-1;
-                if (row < rows-1)
-                    idx[j++] = idx[0]+1;
-                if (col > 0)
-                    idx[j++] = idx[0]-rows;
-                if (col < cols-1)
-                    idx[j++] = idx[0]+rows;
-                for (size_t i = 0; i < j; ++i)
-                {
-                    if (data[idx[i]] < out[index+row])
-                        out[index+row] = data[idx[i]];
-                }
+                const size_t i = index + row;
+                double v = OP::neutral();
+                if (!std::isnan(data[i]))
+                    v = data[i];
+                if (row > 0 && !std::isnan(data[i - 1]))
+                    v = OP::apply(v, data[i - 1]);
+                if (row < rows - 1 && !std::isnan(data[i + 1]))
+                    v = OP::apply(v, data[i + 1]);
+                if (col > 0 && !std::isnan(data[i - rows]))
+                    v = OP::apply(v, data[i - rows]);
+                if (col < cols - 1 && !std::isnan(data[i + rows]))
+                    v = OP::apply(v, data[i + rows]);
+                out[i] = v;
             }
-        }
+        });
         data.swap(out);
     }
 }
 
+// Filter with a diamond of radius 'iterations', which is the same as
+// iterating the 5-cell diamond.  The raster is rotated 45 degrees, where
+// the diamond becomes a square and the filter separates into two 1D passes
+// whose cost doesn't depend on the radius.  Cells of the rotated grid
+// that don't correspond to cells of the raster hold neutral values.
+template<typename OP>
+void diamond(std::vector<double>& data, size_t rows, size_t cols,
+    int iterations)
+{
+    if (iterations <= 0 || rows == 0 || cols == 0)
+        return;
+
+    // Rotated coordinates: u = row + col, v = row - col + (cols - 1).
+    const size_t N = rows + cols - 1;
+
+    // Iterating is cheaper for small elements.
+    if ((size_t)iterations * rows * cols < 6 * N * N)
+    {
+        diamondIterate<OP>(data, rows, cols, iterations);
+        return;
+    }
+
+    const size_t n = (std::min)((size_t)iterations, N - 1);
+    std::vector<double> rot(N * N, OP::neutral());
+    for (size_t col = 0; col < cols; ++col)
+        for (size_t row = 0; row < rows; ++row)
+        {
+            double v = data[col * rows + row];
+            if (!std::isnan(v))
+                rot[(row + col) * N + (row + cols - 1 - col)] = v;
+        }
+
+    // Filter along u and then along v, a slab of lines at a time.
+    const size_t slab = 64;
+    const size_t slabs = (N + slab - 1) / slab;
+    parallelFor(slabs, N * N, [&](size_t s)
+    {
+        VanHerkScratch scratch;
+        const size_t first = s * slab;
+        const size_t width = (std::min)(slab, N - first);
+        vanHerk<OP>(rot.data() + first, N, N, width, 1, n, scratch);
+    });
+    parallelFor(slabs, N * N, [&](size_t s)
+    {
+        VanHerkScratch scratch;
+        const size_t first = s * slab;
+        const size_t width = (std::min)(slab, N - first);
+        vanHerk<OP>(rot.data() + first * N, N, 1, width, N, n, scratch);
+    });
+
+    for (size_t col = 0; col < cols; ++col)
+        for (size_t row = 0; row < rows; ++row)
+            data[col * rows + row] =
+                rot[(row + col) * N + (row + cols - 1 - col)];
+}
+
+} // unnamed namespace
+
+void dilateDiamond(std::vector<double>& data, size_t rows, size_t cols,
+    int iterations)
+{
+    diamond<MaxOp>(data, rows, cols, iterations);
+}
+
+void erodeDiamond(std::vector<double>& data, size_t rows, size_t cols,
+    int iterations)
+{
+    diamond<MinOp>(data, rows, cols, iterations);
+}
+
 Eigen::MatrixXd pointViewToEigen(const PointView& view)
 {
     Eigen::MatrixXd matrix(view.size(), 3);
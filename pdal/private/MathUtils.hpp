@@ -189,15 +189,17 @@ Eigen::MatrixXd extendedLocalMinimum(const PointView& view, int rows,
   Perform a morphological dilation of the input raster.
 
   Performs a morphological dilation of the input raster using a diamond
-  structuring element. Larger structuring elements are approximated by applying
-  multiple iterations of the opening operation. The input and output rasters are
-  stored in column major order.
+  structuring element of radius \a iterations, which is the same as applying
+  a five-cell diamond \a iterations times. The cost per cell doesn't depend on
+  the radius, and large rasters are processed in parallel. NaN cells are
+  ignored, and a cell with only NaN cells within the radius is set to the
+  lowest double. The input and output rasters are stored in column major
+  order.
 
   \param data the input raster.
   \param rows the number of rows.
   \param cols the number of cols.
-  \param iterations the number of iterations used to approximate a larger
-         structuring element.
+  \param iterations the radius of the structuring element.
   \return the morphological dilation of the input raster.
 */
 void dilateDiamond(std::vector<double>& data, size_t rows, size_t cols, int iterations);
@@ -206,15 +208,17 @@ void dilateDiamond(std::vector<double>& data, size_t rows, size_t cols, int iter
   Perform a morphological erosion of the input raster.
 
   Performs a morphological erosion of the input raster using a diamond
-  structuring element. Larger structuring elements are approximated by applying
-  multiple iterations of the opening operation. The input and output rasters are
-  stored in column major order.
+  structuring element of radius \a iterations, which is the same as applying
+  a five-cell diamond \a iterations times. The cost per cell doesn't depend on
+  the radius, and large rasters are processed in parallel. NaN cells are
+  ignored, and a cell with only NaN cells within the radius is set to the
+  largest double. The input and output rasters are stored in column major
+  order.
 
   \param data the input raster.
   \param rows the number of rows.
   \param cols the number of cols.
-  \param iterations the number of iterations used to approximate a larger
-         structuring element.
+  \param iterations the radius of the structuring element.
   \return the morphological erosion of the input raster.
 */
 void erodeDiamond(std::vector<double>& data, size_t rows, size_t cols, int iterations);
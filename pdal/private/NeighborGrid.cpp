@@ -0,0 +1,188 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "NeighborGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <pdal/PointView.hpp>
+
+#include "ThreadBudget.hpp"
+
+namespace pdal
+{
+
+NeighborGrid::NeighborGrid(PointView& view, const Dimension::IdList& dims,
+        double radius) :
+    m_view(view), m_dims(dims), m_radius(radius), m_radius2(radius * radius)
+{}
+
+
+void NeighborGrid::build()
+{
+    if (!(m_radius > 0))
+        throw pdal_error("Neighbor search radius must be greater than 0.");
+
+    const point_count_t count = m_view.size();
+    const size_t numDims = m_dims.size();
+    const size_t gridDims = (std::min)(numDims, size_t(3));
+
+    m_cells.clear();
+    m_index.clear();
+    m_start.clear();
+    m_ids.clear();
+    m_pos.clear();
+    if (count == 0)
+        return;
+
+    // Positions in point order.
+    std::vector<double> pos(count * numDims);
+    for (size_t d = 0; d < numDims; ++d)
+    {
+        PointId id = 0;
+        while (id < count)
+        {
+            FieldSpan<double> span =
+                m_view.getFieldSpan<double>(m_dims[d], id, count - id);
+            for (size_t i = 0; i < span.size(); ++i)
+                pos[(id + i) * numDims + d] = span[i];
+            id += span.size();
+        }
+    }
+
+    double origin[3] {};
+    for (size_t d = 0; d < gridDims; ++d)
+    {
+        origin[d] = (std::numeric_limits<double>::max)();
+        for (PointId id = 0; id < count; ++id)
+            origin[d] = (std::min)(origin[d], pos[id * numDims + d]);
+    }
+
+    // Assign points to cells, counting the points in each.
+    std::vector<uint32_t> cellOf(count);
+    std::vector<size_t> cellCount;
+    for (PointId id = 0; id < count; ++id)
+    {
+        int32_t idx[3] {};
+        for (size_t d = 0; d < gridDims; ++d)
+        {
+            double c = std::floor((pos[id * numDims + d] - origin[d]) /
+                m_radius);
+            if (!(c >= 0 && c <= (std::numeric_limits<int32_t>::max)()))
+                throw pdal_error("Neighbor grid index out of range.  "
+                    "Increase the search radius.");
+            idx[d] = (int32_t)c;
+        }
+        std::pair<uint32_t, bool> res =
+            m_cells.insert(idx[0], idx[1], idx[2]);
+        if (res.second)
+        {
+            m_index.insert(m_index.end(), idx, idx + 3);
+            cellCount.push_back(0);
+        }
+        cellOf[id] = res.first;
+        cellCount[res.first]++;
+    }
+
+    // Order the points by cell.
+    m_start.resize(cellCount.size() + 1);
+    for (size_t c = 0; c < cellCount.size(); ++c)
+        m_start[c + 1] = m_start[c] + cellCount[c];
+    std::vector<size_t> next(m_start.begin(), m_start.end() - 1);
+    m_ids.resize(count);
+    m_pos.resize(count * numDims);
+    for (PointId id = 0; id < count; ++id)
+    {
+        const size_t slot = next[cellOf[id]]++;
+        m_ids[slot] = id;
+        std::copy_n(pos.begin() + id * numDims, numDims,
+            m_pos.begin() + slot * numDims);
+    }
+}
+
+
+void NeighborGrid::adjacent(size_t cell, std::vector<uint32_t>& cells) const
+{
+    const int64_t MaxIndex = (std::numeric_limits<int32_t>::max)();
+    const size_t gridDims = (std::min)(m_dims.size(), size_t(3));
+
+    int64_t lo[3] {};
+    int64_t hi[3] {};
+    for (size_t d = 0; d < gridDims; ++d)
+    {
+        lo[d] = (std::max)((int64_t)m_index[3 * cell + d] - 1, (int64_t)0);
+        hi[d] = (std::min)((int64_t)m_index[3 * cell + d] + 1, MaxIndex);
+    }
+
+    cells.clear();
+    for (int64_t i = lo[0]; i <= hi[0]; ++i)
+        for (int64_t j = lo[1]; j <= hi[1]; ++j)
+            for (int64_t k = lo[2]; k <= hi[2]; ++k)
+            {
+                std::pair<uint32_t, bool> res =
+                    m_cells.find((int32_t)i, (int32_t)j, (int32_t)k);
+                if (res.second)
+                    cells.push_back(res.first);
+            }
+}
+
+
+void NeighborGrid::forEachCell(const std::function<void(size_t,
+    const std::vector<uint32_t>&)>& fn, unsigned threads) const
+{
+    // Threads don't pay for themselves on small grids.
+    const point_count_t MinPerThread = 1 << 14;
+    const size_t CellBatch = 64;
+
+    const point_count_t maxThreads = threads ? (point_count_t)threads :
+        (std::max)(size() / MinPerThread, (point_count_t)1);
+    ThreadGroup group(maxThreads, threads != 0);
+    const size_t batches = (cellCount() + CellBatch - 1) / CellBatch;
+    group.run(batches, [&](size_t batch)
+    {
+        std::vector<uint32_t> cells;
+        size_t begin = batch * CellBatch;
+        size_t end = (std::min)(begin + CellBatch, cellCount());
+        for (size_t cell = begin; cell < end; ++cell)
+        {
+            adjacent(cell, cells);
+            fn(cell, cells);
+        }
+    });
+}
+
+} // namespace pdal
@@ -0,0 +1,183 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/Dimension.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "VoxelGrid.hpp"
+
+namespace pdal
+{
+
+class PointView;
+
+/**
+  Grid for fixed-radius neighbor searches.  Points are binned into cells
+  whose edges are the search radius, so the neighbors of a point are in
+  its own cell or an adjacent one.  Cells are formed from the first three
+  (or fewer) dimensions, and distances are computed from all of them.
+
+  The points are copied into the grid ordered by cell.  A point is
+  referred to by its position in that order, its "slot".  Nothing is
+  stored per pair of neighbors, so memory use is linear in the number of
+  points, and the grid can be searched by several threads at once.
+*/
+class PDAL_DLL NeighborGrid
+{
+public:
+    /**
+      \param view  View containing the points.
+      \param dims  Dimensions used to compute distances.
+      \param radius  Search radius.  Points are neighbors when the
+        distance between them is less than the radius.
+    */
+    NeighborGrid(PointView& view, const Dimension::IdList& dims,
+        double radius);
+
+    /**
+      Bin the points of the view.  Throws pdal_error if the radius isn't
+      positive or there are too many cells.
+    */
+    void build();
+
+    /**
+      Number of points in the grid.
+    */
+    point_count_t size() const
+        { return m_ids.size(); }
+
+    /**
+      Number of populated cells.
+    */
+    size_t cellCount() const
+        { return m_start.empty() ? 0 : m_start.size() - 1; }
+
+    /**
+      First slot of a cell.
+    */
+    size_t begin(size_t cell) const
+        { return m_start[cell]; }
+
+    /**
+      Slot past the last of a cell.
+    */
+    size_t end(size_t cell) const
+        { return m_start[cell + 1]; }
+
+    /**
+      ID of the point in a slot.
+    */
+    PointId id(size_t slot) const
+        { return m_ids[slot]; }
+
+    /**
+      Find the cells that can contain neighbors of the points in a cell.
+
+      \param cell  Cell whose neighborhood should be found.
+      \param cells  Set to the populated cells adjacent to \a cell,
+        including \a cell itself.
+    */
+    void adjacent(size_t cell, std::vector<uint32_t>& cells) const;
+
+    /**
+      Call a function for each cell, spreading the cells among threads.
+      Cells are handed out in small batches, since the work per cell can
+      vary a great deal.
+
+      \param fn  Function to call with each cell and the cells adjacent to
+        it, as found by adjacent().
+      \param threads  Number of threads to use.  0 takes threads from the
+        pipeline's thread budget for grids that are large enough to
+        benefit.
+    */
+    void forEachCell(const std::function<void(size_t,
+        const std::vector<uint32_t>&)>& fn, unsigned threads = 0) const;
+
+    /**
+      Call a function with the slot of each neighbor of a point, including
+      the point itself, until the function returns true.
+
+      \param slot  Slot of the point whose neighbors should be found.
+      \param cells  Cells adjacent to the point's cell, from adjacent().
+      \param f  Function to call.
+      \return  Whether the function returned true.
+    */
+    template<typename F>
+    bool findNeighbors(size_t slot, const std::vector<uint32_t>& cells,
+        F f) const
+    {
+        const size_t numDims = m_dims.size();
+        const double *p = m_pos.data() + slot * numDims;
+        for (uint32_t cell : cells)
+        {
+            const double *q = m_pos.data() + m_start[cell] * numDims;
+            for (size_t s = m_start[cell]; s < m_start[cell + 1]; ++s)
+            {
+                // Same arithmetic as the KD index, so the same points are
+                // found.
+                double dist = 0;
+                for (size_t d = 0; d < numDims; ++d)
+                {
+                    const double diff = p[d] - q[d];
+                    dist += diff * diff;
+                }
+                q += numDims;
+                if (dist < m_radius2 && f(s))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    PointView& m_view;
+    Dimension::IdList m_dims;
+    double m_radius;
+    double m_radius2;
+
+    VoxelHash m_cells;
+    std::vector<int32_t> m_index;   // Indices of each cell.
+    std::vector<size_t> m_start;    // First slot of each cell.
+    std::vector<PointId> m_ids;     // Point ID of each slot.
+    std::vector<double> m_pos;      // Position of each slot.
+};
+
+} // namespace pdal
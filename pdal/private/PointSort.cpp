@@ -0,0 +1,402 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "PointSort.hpp"
+
+#include <array>
+#include <cstring>
+#include <functional>
+#include <memory>
+
+#include <pdal/PointView.hpp>
+
+#include "ThreadBudget.hpp"
+
+namespace pdal
+{
+namespace sorting
+{
+
+namespace
+{
+
+struct SortItem
+{
+    uint64_t key;
+    PointId id;
+};
+
+// Number of points fetched from a view at once.
+const point_count_t Batch = 4096;
+
+// Make a group of threads for sorting 'count' items.  A nonzero 'threads'
+// is the number of threads to use.  Zero takes threads from the thread
+// budget.
+std::unique_ptr<ThreadGroup> threadGroup(size_t count, unsigned threads)
+{
+    // Threads don't pay for themselves on small inputs.
+    const size_t MinPerThread = 1 << 15;
+
+    size_t maxThreads = (std::max)(count / MinPerThread, size_t(1));
+    if (threads)
+        maxThreads = (std::min)(size_t(threads), maxThreads);
+    return std::unique_ptr<ThreadGroup>(
+        new ThreadGroup(maxThreads, threads == 0));
+}
+
+// Split [0, count) into a contiguous chunk for each thread of the group
+// and call fn(chunk, begin, end) for each.  The split depends only on
+// count and the size of the group, so repeated calls see the same chunks.
+void parallelChunks(size_t count, ThreadGroup& group,
+    const std::function<void(size_t, size_t, size_t)>& fn)
+{
+    const size_t chunks = group.size();
+    const size_t chunk = (count + chunks - 1) / chunks;
+    group.run(chunks, [&](size_t t)
+    {
+        fn(t, (std::min)(count, t * chunk),
+            (std::min)(count, (t + 1) * chunk));
+    });
+}
+
+// Stable LSD radix sort on the keys, one byte per pass.  Each thread
+// counts the digits of its chunk and then scatters the chunk to the
+// positions reserved for it, which keeps the sort stable.
+void radixSort(std::vector<SortItem>& items, ThreadGroup& group)
+{
+    const size_t count = items.size();
+    if (count < 2)
+        return;
+
+    // Bytes in which all keys agree needn't be sorted.
+    uint64_t differ = 0;
+    for (const SortItem& item : items)
+        differ |= item.key ^ items[0].key;
+    if (differ == 0)
+        return;
+
+    std::vector<SortItem> tmp(count);
+    SortItem *src = items.data();
+    SortItem *dst = tmp.data();
+    std::vector<std::array<size_t, 256>> offsets(group.size());
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        if (((differ >> shift) & 0xFF) == 0)
+            continue;
+
+        parallelChunks(count, group,
+            [&](size_t t, size_t begin, size_t end)
+            {
+                std::array<size_t, 256>& counts = offsets[t];
+                counts.fill(0);
+                for (size_t i = begin; i < end; ++i)
+                    counts[(src[i].key >> shift) & 0xFF]++;
+            });
+
+        size_t pos = 0;
+        for (size_t digit = 0; digit < 256; ++digit)
+            for (size_t t = 0; t < offsets.size(); ++t)
+            {
+                size_t c = offsets[t][digit];
+                offsets[t][digit] = pos;
+                pos += c;
+            }
+
+        parallelChunks(count, group,
+            [&](size_t t, size_t begin, size_t end)
+            {
+                std::array<size_t, 256>& next = offsets[t];
+                for (size_t i = begin; i < end; ++i)
+                    dst[next[(src[i].key >> shift) & 0xFF]++] = src[i];
+            });
+        std::swap(src, dst);
+    }
+    if (src != items.data())
+        items.swap(tmp);
+}
+
+// Map values to unsigned keys that sort in the same order.
+uint64_t orderedKey(uint64_t v)
+{
+    return v;
+}
+
+uint64_t orderedKey(int64_t v)
+{
+    return (uint64_t)v ^ (uint64_t(1) << 63);
+}
+
+uint64_t orderedKey(double v)
+{
+    const uint64_t sign = uint64_t(1) << 63;
+
+    // Negative zero compares equal to zero.
+    if (v == 0)
+        v = 0;
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return (bits & sign) ? ~bits : (bits | sign);
+}
+
+template<typename T>
+void fieldKeys(PointView& view, Dimension::Id dim, bool descending,
+    ThreadGroup& group, std::vector<uint64_t>& keys)
+{
+    const uint64_t flip = descending ? ~uint64_t(0) : 0;
+
+    keys.resize(view.size());
+    parallelChunks(view.size(), group,
+        [&](size_t, size_t begin, size_t end)
+        {
+            // Spans may be shorter than asked for.
+            for (PointId i = begin; i < end;)
+            {
+                FieldSpan<T> span = view.getFieldSpan<T>(dim, i,
+                    (std::min)(Batch, (point_count_t)(end - i)));
+                for (size_t j = 0; j < span.size(); ++j)
+                    keys[i + j] = orderedKey(span[j]) ^ flip;
+                i += span.size();
+            }
+        });
+}
+
+void dimensionKeys(PointView& view, Dimension::Id dim, bool descending,
+    ThreadGroup& group, std::vector<uint64_t>& keys)
+{
+    switch (Dimension::base(view.dimType(dim)))
+    {
+    case Dimension::BaseType::Signed:
+        fieldKeys<int64_t>(view, dim, descending, group, keys);
+        break;
+    case Dimension::BaseType::Unsigned:
+        fieldKeys<uint64_t>(view, dim, descending, group, keys);
+        break;
+    default:
+        fieldKeys<double>(view, dim, descending, group, keys);
+        break;
+    }
+}
+
+// Insert a zero bit between each of the bits of v.
+uint64_t spread2(uint32_t v)
+{
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+}
+
+// Insert two zero bits between each of the low 21 bits of v.
+uint64_t spread3(uint32_t v)
+{
+    uint64_t x = v & 0x1FFFFF;
+    x = (x | (x << 32)) & 0x001F00000000FFFFull;
+    x = (x | (x << 16)) & 0x001F0000FF0000FFull;
+    x = (x | (x << 8)) & 0x100F00F00F00F00Full;
+    x = (x | (x << 4)) & 0x10C30C30C30C30C3ull;
+    x = (x | (x << 2)) & 0x1249249249249249ull;
+    return x;
+}
+
+// Convert coordinates to the transposed Hilbert index (J. Skilling,
+// "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004).
+template<int N>
+void hilbertTranspose(uint32_t (&X)[N], int bits)
+{
+    const uint32_t M = uint32_t(1) << (bits - 1);
+
+    // Inverse undo.
+    for (uint32_t Q = M; Q > 1; Q >>= 1)
+    {
+        const uint32_t P = Q - 1;
+        for (int i = 0; i < N; ++i)
+        {
+            if (X[i] & Q)
+                X[0] ^= P;
+            else
+            {
+                uint32_t t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+
+    // Gray encode.
+    for (int i = 1; i < N; ++i)
+        X[i] ^= X[i - 1];
+    uint32_t t = 0;
+    for (uint32_t Q = M; Q > 1; Q >>= 1)
+        if (X[N - 1] & Q)
+            t ^= Q - 1;
+    for (int i = 0; i < N; ++i)
+        X[i] ^= t;
+}
+
+PointIdList itemOrder(const std::vector<SortItem>& items)
+{
+    PointIdList order(items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+        order[i] = items[i].id;
+    return order;
+}
+
+} // unnamed namespace
+
+uint64_t mortonKey(uint32_t x, uint32_t y)
+{
+    return (spread2(x) << 1) | spread2(y);
+}
+
+
+uint64_t mortonKey(uint32_t x, uint32_t y, uint32_t z)
+{
+    return (spread3(x) << 2) | (spread3(y) << 1) | spread3(z);
+}
+
+
+uint64_t hilbertKey(uint32_t x, uint32_t y)
+{
+    uint32_t X[2] = { x, y };
+    hilbertTranspose(X, 32);
+    return mortonKey(X[0], X[1]);
+}
+
+
+uint64_t hilbertKey(uint32_t x, uint32_t y, uint32_t z)
+{
+    uint32_t X[3] = { x & 0x1FFFFF, y & 0x1FFFFF, z & 0x1FFFFF };
+    hilbertTranspose(X, 21);
+    return mortonKey(X[0], X[1], X[2]);
+}
+
+
+PointIdList keyOrder(const std::vector<uint64_t>& keys, unsigned threads)
+{
+    std::vector<SortItem> items(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+        items[i] = { keys[i], i };
+    std::unique_ptr<ThreadGroup> group(threadGroup(items.size(), threads));
+    radixSort(items, *group);
+    return itemOrder(items);
+}
+
+
+PointIdList dimensionOrder(PointView& view, const Dimension::IdList& dims,
+    bool descending, unsigned threads)
+{
+    std::unique_ptr<ThreadGroup> group(threadGroup(view.size(), threads));
+
+    std::vector<SortItem> items(view.size());
+    for (PointId i = 0; i < view.size(); ++i)
+        items[i].id = i;
+
+    // Sort by the last dimension first and let the stability of the sort
+    // preserve that order among points equal in earlier dimensions.
+    std::vector<uint64_t> keys;
+    for (auto di = dims.rbegin(); di != dims.rend(); ++di)
+    {
+        dimensionKeys(view, *di, descending, *group, keys);
+        for (SortItem& item : items)
+            item.key = keys[item.id];
+        radixSort(items, *group);
+    }
+    return itemOrder(items);
+}
+
+
+PointIdList curveOrder(PointView& view, Curve curve, bool threeD,
+    unsigned threads)
+{
+    using namespace Dimension;
+
+    std::unique_ptr<ThreadGroup> group(threadGroup(view.size(), threads));
+
+    BOX3D bounds;
+    view.calculateBounds(bounds);
+    const double maxCell = threeD ? (double)0x1FFFFF :
+        (double)(std::numeric_limits<uint32_t>::max)();
+    auto scale = [maxCell](double min, double max)
+        { return (max > min) ? maxCell / (max - min) : 0.0; };
+    const double xscale = scale(bounds.minx, bounds.maxx);
+    const double yscale = scale(bounds.miny, bounds.maxy);
+    const double zscale = scale(bounds.minz, bounds.maxz);
+
+    std::vector<SortItem> items(view.size());
+    parallelChunks(view.size(), *group,
+        [&](size_t, size_t begin, size_t end)
+        {
+            // Spans for the same range all have the same size, which may
+            // be less than asked for.
+            for (PointId i = begin; i < end;)
+            {
+                point_count_t count =
+                    (std::min)(Batch, (point_count_t)(end - i));
+                FieldSpan<double> xs = view.getFieldSpan<double>(Id::X, i,
+                    count);
+                FieldSpan<double> ys = view.getFieldSpan<double>(Id::Y, i,
+                    count);
+                FieldSpan<double> zs;
+                if (threeD)
+                    zs = view.getFieldSpan<double>(Id::Z, i, count);
+                for (size_t j = 0; j < xs.size(); ++j)
+                {
+                    uint32_t x = (uint32_t)((xs[j] - bounds.minx) * xscale);
+                    uint32_t y = (uint32_t)((ys[j] - bounds.miny) * yscale);
+                    uint64_t key;
+                    if (threeD)
+                    {
+                        uint32_t z =
+                            (uint32_t)((zs[j] - bounds.minz) * zscale);
+                        key = (curve == Curve::Hilbert) ?
+                            hilbertKey(x, y, z) : mortonKey(x, y, z);
+                    }
+                    else
+                        key = (curve == Curve::Hilbert) ?
+                            hilbertKey(x, y) : mortonKey(x, y);
+                    items[i + j] = { key, i + j };
+                }
+                i += xs.size();
+            }
+        });
+    radixSort(items, *group);
+    return itemOrder(items);
+}
+
+} // namespace sorting
+} // namespace pdal
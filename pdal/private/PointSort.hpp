@@ -0,0 +1,146 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <pdal/DimType.hpp>
+#include <pdal/pdal_internal.hpp>
+
+#include <vector>
+
+namespace pdal
+{
+
+class PointView;
+
+namespace sorting
+{
+
+/**
+  Space-filling curves available for spatial ordering.
+*/
+enum class Curve
+{
+    Morton,
+    Hilbert
+};
+
+/**
+  Interleave the bits of two coordinates into a Morton (Z-order) key.
+  Bits of \a x are placed above the bits of \a y at each level.
+
+  \param x  X coordinate.
+  \param y  Y coordinate.
+  \return  Morton key.
+*/
+PDAL_DLL uint64_t mortonKey(uint32_t x, uint32_t y);
+
+/**
+  Interleave the low 21 bits of three coordinates into a Morton key.
+
+  \param x  X coordinate.
+  \param y  Y coordinate.
+  \param z  Z coordinate.
+  \return  Morton key.
+*/
+PDAL_DLL uint64_t mortonKey(uint32_t x, uint32_t y, uint32_t z);
+
+/**
+  Compute the distance of a cell along a Hilbert curve that covers the
+  full 32-bit by 32-bit grid and starts at the origin.
+
+  \param x  X coordinate.
+  \param y  Y coordinate.
+  \return  Hilbert key.
+*/
+PDAL_DLL uint64_t hilbertKey(uint32_t x, uint32_t y);
+
+/**
+  Compute the distance of a cell along a Hilbert curve that covers the
+  full 21-bit cube and starts at the origin.  Only the low 21 bits of each
+  coordinate are used.
+
+  \param x  X coordinate.
+  \param y  Y coordinate.
+  \param z  Z coordinate.
+  \return  Hilbert key.
+*/
+PDAL_DLL uint64_t hilbertKey(uint32_t x, uint32_t y, uint32_t z);
+
+/**
+  Compute the stable order of a set of keys with a parallel LSD radix sort.
+  Byte positions where all keys agree are skipped.
+
+  \param keys  Keys to sort.
+  \param threads  Number of threads to use.  0 takes threads from the
+    pipeline's thread budget.
+  \return  Positions of the keys in sorted order.  Equal keys retain
+    their relative order.
+*/
+PDAL_DLL PointIdList keyOrder(const std::vector<uint64_t>& keys,
+    unsigned threads = 0);
+
+/**
+  Compute the order of the points of a view sorted by the values of one or
+  more dimensions.  Later dimensions break ties in earlier ones, and points
+  that compare equal retain their relative order.
+
+  \param view  View whose points should be ordered.
+  \param dims  Dimensions on which to sort.
+  \param descending  Whether to sort in decreasing order.
+  \param threads  Number of threads to use.  0 takes threads from the
+    pipeline's thread budget.
+  \return  Point IDs in sorted order, suitable for PointView::reorder().
+*/
+PDAL_DLL PointIdList dimensionOrder(PointView& view,
+    const Dimension::IdList& dims, bool descending, unsigned threads = 0);
+
+/**
+  Compute the order of the points of a view along a space-filling curve
+  over the view's bounds.  Coordinates are quantized to 32 bits per axis
+  in 2D and 21 bits per axis in 3D.
+
+  \param view  View whose points should be ordered.
+  \param curve  Curve to follow.
+  \param threeD  Whether to include Z when computing keys.
+  \param threads  Number of threads to use.  0 takes threads from the
+    pipeline's thread budget.
+  \return  Point IDs in curve order, suitable for PointView::reorder().
+*/
+PDAL_DLL PointIdList curveOrder(PointView& view, Curve curve, bool threeD,
+    unsigned threads = 0);
+
+} // namespace sorting
+} // namespace pdal
@@ -33,6 +33,9 @@
 
 #include <ogr_spatialref.h>
 
+#include <algorithm>
+#include <limits>
+
 namespace pdal
 {
 
@@ -102,11 +105,54 @@ bool SrsTransform::transform(double& x, double& y, double& z) const
 bool SrsTransform::transform(std::vector<double>& x, std::vector<double>& y,
     std::vector<double>& z) const
 {
-    if (x.size() != y.size() && y.size() != z.size())
+    if (x.size() != y.size() || y.size() != z.size())
         throw pdal_error("SrsTransform::called with vectors of different "
             "sizes.");
-    int err = m_transform->Transform(x.size(), x.data(), y.data(), z.data());
-    return (err == OGRERR_NONE);
+    return transform(x.size(), x.data(), y.data(), z.data());
+}
+
+
+bool SrsTransform::transform(size_t count, double *x, double *y, double *z,
+    int *success) const
+{
+    if (!m_transform)
+    {
+        if (success)
+            std::fill(success, success + count, FALSE);
+        return false;
+    }
+
+    // Failed points may be overwritten by GDAL/PROJ, so keep the originals.
+    std::vector<double> orig(x, x + count);
+    orig.insert(orig.end(), y, y + count);
+    orig.insert(orig.end(), z, z + count);
+
+    std::vector<int> ok;
+    if (!success)
+    {
+        ok.resize(count);
+        success = ok.data();
+    }
+
+    // GDAL takes an int count.
+    const size_t MaxCount = (std::numeric_limits<int>::max)();
+    for (size_t pos = 0; pos < count; pos += MaxCount)
+    {
+        int n = (int)(std::min)(count - pos, MaxCount);
+        std::fill(success + pos, success + pos + n, FALSE);
+        m_transform->Transform(n, x + pos, y + pos, z + pos, success + pos);
+    }
+
+    bool all = true;
+    for (size_t i = 0; i < count; ++i)
+        if (!success[i])
+        {
+            all = false;
+            x[i] = orig[i];
+            y[i] = orig[count + i];
+            z[i] = orig[2 * count + i];
+        }
+    return all;
 }
 
 } // namespace pdal
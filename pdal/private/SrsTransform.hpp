@@ -69,6 +69,17 @@ public:
     bool transform(std::vector<double>& x, std::vector<double>& y,
         std::vector<double>& z) const;
 
+    /// Transform a set of points in place.
+    /// \param count  Number of points
+    /// \param x  X coordinates
+    /// \param y  Y coordinates
+    /// \param z  Z coordinates
+    /// \param success  If not null, set to whether each point was
+    ///   transformed successfully.  Points that fail aren't modified.
+    /// \return  True if all points were transformed successfully
+    bool transform(size_t count, double *x, double *y, double *z,
+        int *success = nullptr) const;
+
 private:
     std::unique_ptr<OGRCoordinateTransformation> m_transform;
 };
@@ -57,7 +57,8 @@ PointViewPtr StageRunner::keeps()
     return m_keeps;
 }
 
-// For now this is all synchronous
+// Runners for the views of a stage may be run on different threads if
+// the stage is view-parallel safe.
 void StageRunner::run()
 {
     point_count_t keepSize = m_keeps->size();
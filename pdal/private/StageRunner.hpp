@@ -34,13 +34,29 @@
 
 #pragma once
 
+#include <mutex>
+
 #include <pdal/PointView.hpp>
 
+#include "ThreadBudget.hpp"
+
 namespace pdal
 {
 
 class Stage;
 
+// State shared by stages run concurrently in standard mode.
+struct ParallelContext
+{
+    ParallelContext(std::size_t threads) : m_budget(threads)
+    {}
+
+    ThreadBudget m_budget;
+    // Held while a stage sets the spatial references of the point table
+    // and while it calls ready(), prerun() and done().
+    std::mutex m_tableMutex;
+};
+
 class StageRunner
 {
 public:
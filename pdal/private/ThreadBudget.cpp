@@ -0,0 +1,160 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <atomic>
+#include <exception>
+#include <thread>
+
+#include <pdal/util/ThreadPool.hpp>
+
+#include "ThreadBudget.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+thread_local ThreadBudget *s_current = nullptr;
+
+} // unnamed namespace
+
+const std::size_t ThreadGroup::Unlimited;
+
+ThreadBudget *ThreadBudget::current()
+{
+    // The calling thread counts against the CPUs, so it isn't in the
+    // process budget.
+    static ThreadBudget processBudget(
+        (std::max)(std::thread::hardware_concurrency(), 1U) - 1);
+
+    return s_current ? s_current : &processBudget;
+}
+
+
+ThreadBudget::Scope::Scope(ThreadBudget *budget) : m_prev(s_current)
+{
+    s_current = budget;
+}
+
+
+ThreadBudget::Scope::~Scope()
+{
+    s_current = m_prev;
+}
+
+
+ThreadGroup::ThreadGroup(std::size_t max, bool budgeted) :
+    m_budget(ThreadBudget::current()), m_extra(0), m_budgeted(budgeted)
+{
+    if (max <= 1)
+        return;
+    if (!m_budgeted)
+        m_extra = max - 1;
+    else
+        m_extra = m_budget->acquire(max - 1);
+}
+
+
+ThreadGroup::~ThreadGroup()
+{
+    m_pool.reset();
+    if (m_budgeted)
+        m_budget->release(m_extra);
+}
+
+
+void ThreadGroup::run(std::size_t count,
+    const std::function<void(std::size_t)>& fn)
+{
+    const std::size_t workers = (std::min)(m_extra, count ? count - 1 : 0);
+    if (workers == 0)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error;
+    std::mutex mutex;
+    ThreadBudget *budget = m_budget;
+    auto work = [&]()
+    {
+        // Work on the group's threads can start groups of its own.
+        ThreadBudget::Scope scope(budget);
+        try
+        {
+            for (std::size_t i = next++; i < count; i = next++)
+                fn(i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            next = count;
+        }
+    };
+
+    // The pool is started here so that a group used only to count
+    // threads doesn't start any.
+    if (!m_pool)
+        m_pool.reset(new ThreadPool(m_extra, -1, false));
+    for (std::size_t i = 0; i < workers; ++i)
+        m_pool->add(work);
+    work();
+    m_pool->await();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+
+std::size_t ThreadGroup::ranges(std::size_t count, std::size_t minSize,
+    const std::function<void(std::size_t, std::size_t, std::size_t)>& fn)
+{
+    const std::size_t parts = (std::min)(size(),
+        (std::max)(count / (std::max)(minSize, (std::size_t)1),
+            (std::size_t)1));
+    const std::size_t chunk = (count + parts - 1) / parts;
+    run(parts, [&](std::size_t part)
+    {
+        std::size_t begin = (std::min)(count, part * chunk);
+        fn(part, begin, (std::min)(count, begin + chunk));
+    });
+    return parts;
+}
+
+} // namespace pdal
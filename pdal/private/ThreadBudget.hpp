@@ -0,0 +1,145 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+class ThreadPool;
+
+// Limit on the number of threads used to execute a pipeline in standard
+// mode.  Each running stage holds one thread.  A stage that can run its
+// point views in parallel, or that splits the work for a view among
+// threads, takes extra threads if any are available.
+class PDAL_DLL ThreadBudget
+{
+public:
+    ThreadBudget(std::size_t threads) : m_available(threads)
+    {}
+
+    // Take up to 'count' threads without waiting.  Returns the number
+    // of threads taken.
+    std::size_t acquire(std::size_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        count = (std::min)(count, m_available);
+        m_available -= count;
+        return count;
+    }
+
+    void release(std::size_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_available += count;
+    }
+
+    // The budget for parallel work started on the calling thread.  Outside
+    // of a pipeline run with several threads, this is a budget shared by
+    // the process that holds a thread for each CPU beyond the caller's.
+    static ThreadBudget *current();
+
+    // Makes a budget current for the calling thread while the scope
+    // exists.  A null budget makes the process budget current.
+    class PDAL_DLL Scope
+    {
+    public:
+        Scope(ThreadBudget *budget);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ThreadBudget *m_prev;
+    };
+
+private:
+    std::size_t m_available;
+    std::mutex m_mutex;
+};
+
+// A set of threads for splitting work among.  The calling thread is
+// always part of the group.  Other threads are borrowed from the current
+// thread budget and returned when the group is destroyed.
+class PDAL_DLL ThreadGroup
+{
+public:
+    static const std::size_t Unlimited =
+        (std::numeric_limits<std::size_t>::max)();
+
+    // Use up to 'max' threads.  If 'budgeted' is false, exactly 'max'
+    // threads are used regardless of the budget.  This is for stages
+    // with an option that sets their number of threads.
+    explicit ThreadGroup(std::size_t max = Unlimited, bool budgeted = true);
+    ~ThreadGroup();
+
+    ThreadGroup(const ThreadGroup&) = delete;
+    ThreadGroup& operator=(const ThreadGroup&) = delete;
+
+    // Number of threads in the group, including the calling thread.
+    std::size_t size() const
+        { return m_extra + 1; }
+
+    // Call fn(i) for each i in [0, count), spreading the calls over the
+    // threads of the group.  Once a call throws, no more calls are
+    // started and the first exception is rethrown when the running
+    // calls are done.
+    void run(std::size_t count, const std::function<void(std::size_t)>& fn);
+
+    // Split [0, count) into a range for each thread, each holding at
+    // least 'minSize' items where possible, and call fn(part, begin, end)
+    // for each range.  Returns the number of ranges, which is no more
+    // than size().
+    std::size_t ranges(std::size_t count, std::size_t minSize,
+        const std::function<void(std::size_t, std::size_t, std::size_t)>&
+            fn);
+
+private:
+    ThreadBudget *m_budget;
+    std::size_t m_extra;
+    bool m_budgeted;
+    std::unique_ptr<ThreadPool> m_pool;
+};
+
+} // namespace pdal
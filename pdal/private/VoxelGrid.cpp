@@ -0,0 +1,323 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "VoxelGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <pdal/PointView.hpp>
+
+#include "ThreadBudget.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+// Number of points fetched from a view at once.
+const point_count_t Batch = 4096;
+
+// Call fn(id, pos) for each point of a view in [begin, end) that belongs
+// to a shard.  An empty shard list means all points belong.
+template<typename FN>
+void forEachPoint(PointView& view, PointId begin, PointId end,
+    const std::vector<uint8_t>& shardOf, unsigned shard, FN fn)
+{
+    using namespace Dimension;
+
+    // Spans for the same range all have the same size, which may be less
+    // than asked for.
+    for (PointId b = begin; b < end;)
+    {
+        const point_count_t n = (std::min)(Batch, (point_count_t)(end - b));
+        if (shardOf.size() &&
+            std::find(shardOf.begin() + b, shardOf.begin() + b + n,
+                (uint8_t)shard) == shardOf.begin() + b + n)
+        {
+            b += n;
+            continue;
+        }
+
+        FieldSpan<double> xs = view.getFieldSpan<double>(Id::X, b, n);
+        FieldSpan<double> ys = view.getFieldSpan<double>(Id::Y, b, n);
+        FieldSpan<double> zs = view.getFieldSpan<double>(Id::Z, b, n);
+        for (point_count_t i = 0; i < xs.size(); ++i)
+        {
+            if (shardOf.size() && shardOf[b + i] != shard)
+                continue;
+            const double pos[3] { xs[i], ys[i], zs[i] };
+            fn(b + i, pos);
+        }
+        b += xs.size();
+    }
+}
+
+double sqrDist(const double *a, const double *b)
+{
+    return (a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) +
+        (a[2] - b[2]) * (a[2] - b[2]);
+}
+
+} // unnamed namespace
+
+
+void VoxelHash::grow()
+{
+    std::vector<Entry> old(
+        (std::max)(m_entries.size() * 2, size_t(1024)),
+        Entry { 0, 0, 0, Empty });
+    old.swap(m_entries);
+
+    const size_t mask = m_entries.size() - 1;
+    for (const Entry& e : old)
+    {
+        if (e.voxel == Empty)
+            continue;
+        size_t pos = hash(e.i, e.j, e.k) & mask;
+        while (m_entries[pos].voxel != Empty)
+            pos = (pos + 1) & mask;
+        m_entries[pos] = e;
+    }
+}
+
+
+// Voxels and reductions of the points assigned to one thread.
+struct VoxelGrid::Shard
+{
+    VoxelHash hash;
+    std::vector<int32_t> index;
+    std::vector<PointId> first;
+    std::vector<point_count_t> count;
+    std::vector<PointId> nearestCenter;
+    std::vector<double> centerDist;
+    std::vector<double> centroid;
+    std::vector<PointId> nearestCentroid;
+    std::vector<double> centroidDist;
+};
+
+
+VoxelGrid::VoxelGrid(double cell, double originX, double originY,
+        double originZ, int reductions) :
+    m_cell(cell), m_origin { originX, originY, originZ },
+    m_reductions(reductions)
+{}
+
+
+void VoxelGrid::cellIndex(const double *pos, int32_t *idx) const
+{
+    for (size_t d = 0; d < 3; ++d)
+    {
+        double c = std::floor((pos[d] - m_origin[d]) / m_cell);
+        if (!(c >= (std::numeric_limits<int32_t>::lowest)() &&
+            c <= (std::numeric_limits<int32_t>::max)()))
+            throw pdal_error("Voxel index out of range.  Increase the "
+                "cell size.");
+        idx[d] = (int32_t)c;
+    }
+}
+
+
+void VoxelGrid::center(size_t voxel, double& x, double& y, double& z) const
+{
+    x = (m_index[3 * voxel] + 0.5) * m_cell + m_origin[0];
+    y = (m_index[3 * voxel + 1] + 0.5) * m_cell + m_origin[1];
+    z = (m_index[3 * voxel + 2] + 0.5) * m_cell + m_origin[2];
+}
+
+
+void VoxelGrid::build(PointView& view, unsigned threads)
+{
+    // Threads don't pay for themselves on small views.
+    const point_count_t MinPerThread = 1 << 16;
+
+    point_count_t maxThreads = (std::min)(view.size() / MinPerThread,
+        (point_count_t)255);
+    if (threads)
+        maxThreads = (std::min)((point_count_t)threads, maxThreads);
+    ThreadGroup group((std::max)(maxThreads, (point_count_t)1),
+        threads == 0);
+    threads = (unsigned)group.size();
+
+    // Each thread owns the voxels whose hash falls in its shard, so the
+    // voxel tables can be built without locking.
+    std::vector<uint8_t> shardOf;
+    if (threads > 1)
+    {
+        shardOf.resize(view.size());
+        const point_count_t chunk = (view.size() + threads - 1) / threads;
+        group.run(threads, [&](size_t t)
+        {
+            PointId begin = (std::min)(view.size(), t * chunk);
+            PointId end = (std::min)(view.size(), (t + 1) * chunk);
+            forEachPoint(view, begin, end, {}, 0,
+                [&](PointId id, const double *pos)
+                {
+                    int32_t idx[3];
+                    cellIndex(pos, idx);
+                    shardOf[id] = (uint8_t)((VoxelHash::hash(idx[0], idx[1],
+                        idx[2]) >> 56) % threads);
+                });
+        });
+    }
+
+    std::vector<Shard> shards(threads);
+    group.run(threads, [&](size_t t)
+    {
+        assign(view, shards[t], (unsigned)t, shardOf);
+    });
+    merge(shards);
+}
+
+
+void VoxelGrid::assign(PointView& view, Shard& shard, unsigned shardId,
+    const std::vector<uint8_t>& shardOf)
+{
+    const double Inf = (std::numeric_limits<double>::max)();
+    const bool doCenter = m_reductions & Center;
+    const bool doCentroid = m_reductions & Centroid;
+
+    forEachPoint(view, 0, view.size(), shardOf, shardId,
+        [&](PointId id, const double *pos)
+        {
+            int32_t idx[3];
+            cellIndex(pos, idx);
+            std::pair<uint32_t, bool> res =
+                shard.hash.insert(idx[0], idx[1], idx[2]);
+            const uint32_t v = res.first;
+            if (res.second)
+            {
+                shard.index.insert(shard.index.end(), idx, idx + 3);
+                shard.first.push_back(id);
+                shard.count.push_back(0);
+                if (doCenter)
+                {
+                    shard.nearestCenter.push_back(id);
+                    shard.centerDist.push_back(Inf);
+                }
+                if (doCentroid)
+                    shard.centroid.insert(shard.centroid.end(), 3, 0.0);
+            }
+            shard.count[v]++;
+            if (doCenter)
+            {
+                double c[3];
+                for (size_t d = 0; d < 3; ++d)
+                    c[d] = (idx[d] + 0.5) * m_cell + m_origin[d];
+                double dist = sqrDist(pos, c);
+                if (dist < shard.centerDist[v])
+                {
+                    shard.centerDist[v] = dist;
+                    shard.nearestCenter[v] = id;
+                }
+            }
+            if (doCentroid)
+                for (size_t d = 0; d < 3; ++d)
+                    shard.centroid[3 * v + d] += pos[d];
+        });
+
+    if (!doCentroid)
+        return;
+
+    // Finding the point nearest the centroid takes a second pass.
+    for (size_t v = 0; v < shard.count.size(); ++v)
+        for (size_t d = 0; d < 3; ++d)
+            shard.centroid[3 * v + d] /= shard.count[v];
+    shard.nearestCentroid.resize(shard.count.size());
+    shard.centroidDist.resize(shard.count.size(), Inf);
+    forEachPoint(view, 0, view.size(), shardOf, shardId,
+        [&](PointId id, const double *pos)
+        {
+            int32_t idx[3];
+            cellIndex(pos, idx);
+            const uint32_t v = shard.hash.insert(idx[0], idx[1], idx[2]).first;
+            double dist = sqrDist(pos, shard.centroid.data() + 3 * v);
+            if (dist < shard.centroidDist[v])
+            {
+                shard.centroidDist[v] = dist;
+                shard.nearestCentroid[v] = id;
+            }
+        });
+}
+
+
+void VoxelGrid::merge(std::vector<Shard>& shards)
+{
+    struct Ref
+    {
+        PointId first;
+        uint32_t shard;
+        uint32_t voxel;
+    };
+
+    // Number voxels by their first point so that the result doesn't depend
+    // on the number of threads.  A single shard is already in that order.
+    std::vector<Ref> refs;
+    for (uint32_t s = 0; s < shards.size(); ++s)
+        for (uint32_t v = 0; v < shards[s].first.size(); ++v)
+            refs.push_back({ shards[s].first[v], s, v });
+    if (shards.size() > 1)
+        std::sort(refs.begin(), refs.end(),
+            [](const Ref& a, const Ref& b){ return a.first < b.first; });
+
+    const size_t count = refs.size();
+    const bool doCenter = m_reductions & Center;
+    const bool doCentroid = m_reductions & Centroid;
+    m_index.resize(3 * count);
+    m_first.resize(count);
+    m_count.resize(count);
+    m_nearestCenter.resize(doCenter ? count : 0);
+    m_centroid.resize(doCentroid ? 3 * count : 0);
+    m_nearestCentroid.resize(doCentroid ? count : 0);
+    for (size_t v = 0; v < count; ++v)
+    {
+        const Shard& s = shards[refs[v].shard];
+        const uint32_t sv = refs[v].voxel;
+        std::copy_n(s.index.begin() + 3 * sv, 3, m_index.begin() + 3 * v);
+        m_first[v] = s.first[sv];
+        m_count[v] = s.count[sv];
+        if (doCenter)
+            m_nearestCenter[v] = s.nearestCenter[sv];
+        if (doCentroid)
+        {
+            std::copy_n(s.centroid.begin() + 3 * sv, 3,
+                m_centroid.begin() + 3 * v);
+            m_nearestCentroid[v] = s.nearestCentroid[sv];
+        }
+    }
+}
+
+} // namespace pdal
@@ -0,0 +1,289 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace pdal
+{
+
+class PointView;
+
+/**
+  Open-addressing hash table of voxels.  Voxels are identified by their
+  integer indices along each axis and are numbered densely in the order
+  they're added.  Entries are stored inline, so there's no allocation per
+  voxel.
+*/
+class PDAL_DLL VoxelHash
+{
+public:
+    VoxelHash() : m_size(0)
+    {}
+
+    /**
+      Find a voxel, adding it if it isn't present.
+
+      \param i  Index of the voxel along the X axis.
+      \param j  Index of the voxel along the Y axis.
+      \param k  Index of the voxel along the Z axis.
+      \return  The voxel's number and whether the voxel was added.
+    */
+    std::pair<uint32_t, bool> insert(int32_t i, int32_t j, int32_t k)
+    {
+        // Keep the load factor at or below 3/4.
+        if ((m_size + 1) * 4 > m_entries.size() * 3)
+            grow();
+
+        const size_t mask = m_entries.size() - 1;
+        for (size_t pos = hash(i, j, k) & mask;; pos = (pos + 1) & mask)
+        {
+            Entry& e = m_entries[pos];
+            if (e.voxel == Empty)
+            {
+                if (m_size == Empty)
+                    throw pdal_error("Too many voxels.  Increase the "
+                        "cell size.");
+                e = { i, j, k, (uint32_t)m_size };
+                return { (uint32_t)m_size++, true };
+            }
+            if (e.i == i && e.j == j && e.k == k)
+                return { e.voxel, false };
+        }
+    }
+
+    /**
+      Find a voxel.
+
+      \param i  Index of the voxel along the X axis.
+      \param j  Index of the voxel along the Y axis.
+      \param k  Index of the voxel along the Z axis.
+      \return  The voxel's number and whether the voxel was found.
+    */
+    std::pair<uint32_t, bool> find(int32_t i, int32_t j, int32_t k) const
+    {
+        if (m_entries.empty())
+            return { Empty, false };
+
+        const size_t mask = m_entries.size() - 1;
+        for (size_t pos = hash(i, j, k) & mask;; pos = (pos + 1) & mask)
+        {
+            const Entry& e = m_entries[pos];
+            if (e.voxel == Empty)
+                return { Empty, false };
+            if (e.i == i && e.j == j && e.k == k)
+                return { e.voxel, true };
+        }
+    }
+
+    /**
+      Number of voxels in the table.
+    */
+    size_t size() const
+        { return m_size; }
+
+    /**
+      Determine if the table is empty.
+    */
+    bool empty() const
+        { return m_size == 0; }
+
+    /**
+      Remove all voxels and release the table's memory.
+    */
+    void clear()
+    {
+        std::vector<Entry>().swap(m_entries);
+        m_size = 0;
+    }
+
+    /**
+      Hash of a voxel.  The indices are packed into a 64-bit code, which
+      is then mixed so that both high and low bits are well distributed.
+    */
+    static uint64_t hash(int32_t i, int32_t j, int32_t k)
+    {
+        uint64_t h = ((uint64_t)(uint32_t)i << 42) ^
+            ((uint64_t)(uint32_t)j << 21) ^ (uint64_t)(uint32_t)k;
+
+        // MurmurHash3 finalizer.
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+private:
+    struct Entry
+    {
+        int32_t i;
+        int32_t j;
+        int32_t k;
+        uint32_t voxel;
+    };
+    static const uint32_t Empty = (std::numeric_limits<uint32_t>::max)();
+
+    std::vector<Entry> m_entries;
+    size_t m_size;
+
+    void grow();
+};
+
+/**
+  Assignment of the points of a view to voxels, with per-voxel reductions
+  computed while the points are assigned.  Voxels are numbered in the order
+  of the first point that falls in each.
+*/
+class PDAL_DLL VoxelGrid
+{
+public:
+    /**
+      Reductions to compute in addition to the first point of each voxel.
+    */
+    enum Reduction
+    {
+        First = 0,
+        // Point nearest the center of each voxel.
+        Center = 1,
+        // Centroid of each voxel and the point nearest it.
+        Centroid = 2
+    };
+
+    /**
+      \param cell  Edge length of a voxel.
+      \param originX  X coordinate of the corner of voxel (0, 0, 0).
+      \param originY  Y coordinate of the corner of voxel (0, 0, 0).
+      \param originZ  Z coordinate of the corner of voxel (0, 0, 0).
+      \param reductions  Bitwise OR of the reductions to compute.
+    */
+    VoxelGrid(double cell, double originX, double originY, double originZ,
+        int reductions = First);
+
+    /**
+      Assign the points of a view to voxels.  Large views are split among
+      threads by voxel.  Throws pdal_error if a voxel index doesn't fit in
+      32 bits.
+
+      \param view  View whose points should be assigned.
+      \param threads  Number of threads to use.  0 takes threads from the
+        pipeline's thread budget.
+    */
+    void build(PointView& view, unsigned threads = 0);
+
+    /**
+      Number of populated voxels.
+    */
+    size_t size() const
+        { return m_first.size(); }
+
+    /**
+      Get the indices of a voxel along each axis.
+    */
+    void index(size_t voxel, int32_t& i, int32_t& j, int32_t& k) const
+    {
+        i = m_index[3 * voxel];
+        j = m_index[3 * voxel + 1];
+        k = m_index[3 * voxel + 2];
+    }
+
+    /**
+      Get the coordinates of the center of a voxel.
+    */
+    void center(size_t voxel, double& x, double& y, double& z) const;
+
+    /**
+      Number of points in a voxel.
+    */
+    point_count_t count(size_t voxel) const
+        { return m_count[voxel]; }
+
+    /**
+      First point in a voxel.
+    */
+    PointId first(size_t voxel) const
+        { return m_first[voxel]; }
+
+    /**
+      Point nearest the center of a voxel.  Requires the Center reduction.
+    */
+    PointId nearestCenter(size_t voxel) const
+        { return m_nearestCenter[voxel]; }
+
+    /**
+      Get the centroid of a voxel.  Requires the Centroid reduction.
+    */
+    void centroid(size_t voxel, double& x, double& y, double& z) const
+    {
+        x = m_centroid[3 * voxel];
+        y = m_centroid[3 * voxel + 1];
+        z = m_centroid[3 * voxel + 2];
+    }
+
+    /**
+      Point nearest the centroid of a voxel.  Requires the Centroid
+      reduction.
+    */
+    PointId nearestCentroid(size_t voxel) const
+        { return m_nearestCentroid[voxel]; }
+
+private:
+    struct Shard;
+
+    double m_cell;
+    double m_origin[3];
+    int m_reductions;
+
+    std::vector<int32_t> m_index;
+    std::vector<PointId> m_first;
+    std::vector<point_count_t> m_count;
+    std::vector<PointId> m_nearestCenter;
+    std::vector<double> m_centroid;
+    std::vector<PointId> m_nearestCentroid;
+
+    void cellIndex(const double *pos, int32_t *idx) const;
+    void assign(PointView& view, Shard& shard, unsigned shardId,
+        const std::vector<uint8_t>& shardOf);
+    void merge(std::vector<Shard>& shards);
+};
+
+} // namespace pdal
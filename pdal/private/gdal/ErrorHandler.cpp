@@ -58,9 +58,21 @@ ErrorHandler& ErrorHandler::getGlobalErrorHandler()
 
 namespace
 {
-}
 
-namespace {
+// Log and debug state of a thread that has set them.
+struct ThreadState
+{
+    ThreadState() : m_set(false), m_debug(false), m_errorNum(0)
+    {}
+
+    bool m_set;
+    LogPtr m_log;
+    bool m_debug;
+    int m_errorNum;
+};
+
+thread_local ThreadState t_state;
+
 
 //ABELL - No idea why this is __stdcall
 #ifdef _WIN32
@@ -77,7 +89,7 @@ void trampoline(::CPLErr code, int num, char const* msg)
 /**
   Constructor for a GDAL error handler.
 */
-ErrorHandler::ErrorHandler() : m_errorNum(0)
+ErrorHandler::ErrorHandler()
 {
     std::string value;
 
@@ -120,6 +132,10 @@ void ErrorHandler::setLog(LogPtr log)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
     m_log = log;
+    if (!t_state.m_set)
+        t_state.m_debug = m_debug;
+    t_state.m_log = log;
+    t_state.m_set = true;
 }
 
 /**
@@ -130,6 +146,10 @@ void ErrorHandler::setDebug(bool debug)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
     m_debug = debug;
+    if (!t_state.m_set)
+        t_state.m_log = m_log;
+    t_state.m_debug = debug;
+    t_state.m_set = true;
 
     if (debug)
         CPLSetThreadLocalConfigOption("CPL_DEBUG", "ON");
@@ -144,8 +164,7 @@ void ErrorHandler::setDebug(bool debug)
 */
 int ErrorHandler::errorNum()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_errorNum;
+    return t_state.m_errorNum;
 }
 
 /**
@@ -159,18 +178,21 @@ void ErrorHandler::handle(int level, int num, char const* msg)
     std::lock_guard<std::mutex> lock(m_mutex);
     std::ostringstream oss;
 
-    m_errorNum = num;
+    // GDAL calls the handler on the thread that raised the error.
+    t_state.m_errorNum = num;
+    LogPtr log = t_state.m_set ? t_state.m_log : m_log;
+    bool debug = t_state.m_set ? t_state.m_debug : m_debug;
     if (level == CE_Failure || level == CE_Fatal)
     {
         oss << "GDAL failure (" << num << ") " << msg;
-        if (m_log)
-            m_log->get(LogLevel::Error) << oss.str() << std::endl;
+        if (log)
+            log->get(LogLevel::Error) << oss.str() << std::endl;
     }
-    else if (m_debug && level == CE_Debug)
+    else if (debug && level == CE_Debug)
     {
         oss << "GDAL debug: " << msg;
-        if (m_log)
-            m_log->get(LogLevel::Debug) << oss.str() << std::endl;
+        if (log)
+            log->get(LogLevel::Debug) << oss.str() << std::endl;
     }
 }
 
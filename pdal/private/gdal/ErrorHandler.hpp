@@ -39,11 +39,12 @@ namespace pdal
 namespace gdal
 {
 
-// This is a little confusing because we have a singleton error handler with
-// a single log pointer, but we set the log pointer/debug state as if we
-// were taking advantage of GDAL's thread-specific error handing.
+// There is a singleton error handler, but the log and debug state are
+// kept for each thread that sets them, so that stages running on different
+// threads write GDAL messages to their own logs.  Threads that haven't set
+// a log use the one most recently set by any thread.
 //
-// We lock the log/debug so that it doesn't
+// We lock the shared log/debug so that it doesn't
 // get changed while another thread is using or setting.
 class PDAL_DLL ErrorHandler
 {
@@ -84,7 +85,7 @@ public:
     void setDebug(bool doDebug);
 
     /**
-      Get the last error and clear the error last error value.
+      Get the number of the last error raised on the calling thread.
 
       \return  The last error number.
     */
@@ -99,7 +100,6 @@ private:
     std::mutex m_mutex;
     bool m_debug;
     pdal::LogPtr m_log;
-    mutable int m_errorNum;
     bool m_cplSet;
 };
 
@@ -548,6 +548,95 @@ GDALError Raster::read(double x, double y, std::vector<double>& data)
 }
 
 
+/**
+  Get the block size of the first band of the raster.
+  \param[out] x  Block width.
+  \param[out] y  Block height.
+  \return  Error code or GDALError::None.
+*/
+GDALError Raster::blockSize(int& x, int& y) const
+{
+    if (!m_ds)
+    {
+        m_errorMsg = "Raster not open.";
+        return GDALError::NotOpen;
+    }
+
+    GDALRasterBand *band = m_ds->GetRasterBand(1);
+    if (!band)
+    {
+        m_errorMsg = "Unable to get band 1 from raster '" + m_filename + "'.";
+        return GDALError::InvalidBand;
+    }
+    band->GetBlockSize(&x, &y);
+    if (x <= 0 || y <= 0)
+    {
+        m_errorMsg = "Unable to read band/block information from "
+            "raster '" + m_filename + "'.";
+        return GDALError::BadBand;
+    }
+    return GDALError::None;
+}
+
+
+/**
+  Read a window of a band, converting the data to doubles.
+  \param nBand  Band number (1-indexed).
+  \param column  First column of the window.
+  \param row  First row of the window.
+  \param width  Window width.
+  \param height  Window height.
+  \param[out] data  Buffer for the window's data, stored row by row.
+  \return  Error code or GDALError::None.
+*/
+GDALError Raster::readWindow(int nBand, int column, int row, int width,
+    int height, double *data)
+{
+    if (!m_ds)
+    {
+        m_errorMsg = "Raster not open.";
+        return GDALError::NotOpen;
+    }
+
+    GDALRasterBand *band = m_ds->GetRasterBand(nBand);
+    if (!band)
+    {
+        m_errorMsg = "Unable to get band " + std::to_string(nBand) +
+            " from raster '" + m_filename + "'.";
+        return GDALError::InvalidBand;
+    }
+    if (band->RasterIO(GF_Read, column, row, width, height, data,
+        width, height, GDT_Float64, 0, 0) != CE_None)
+    {
+        m_errorMsg = "Unable to read block for for raster '" +
+            m_filename + "'.";
+        return GDALError::CantReadBlock;
+    }
+    return GDALError::None;
+}
+
+
+/**
+  Get the no-data value of a band.
+  \param nBand  Band number (1-indexed).
+  \param[out] value  No-data value.
+  \return  Whether the band has a no-data value.
+*/
+bool Raster::noData(int nBand, double& value) const
+{
+    if (!m_ds)
+        return false;
+
+    GDALRasterBand *band = m_ds->GetRasterBand(nBand);
+    if (!band)
+        return false;
+
+    int hasNoData(0);
+    value = band->GetNoDataValue(&hasNoData);
+    return hasNoData;
+}
+
+
 /**
   Get the spatial reference associated with a raster.
   \return  Associated spatial reference.
@@ -469,6 +469,57 @@ public:
     */
     GDALError read(double x, double y, std::vector<double>& data);
 
+    /**
+      Get the size of the blocks in which the first band of the raster is
+      stored.  Reading whole blocks avoids decoding data more than once.
+
+      \param[out] x  Width of a block (X direction).
+      \param[out] y  Height of a block (Y direction).
+      \return  Error code or GDALError::None.
+    */
+    GDALError blockSize(int& x, int& y) const;
+
+    /**
+      Read a rectangular window of a band as doubles, row by row.
+
+      \param nBand  Band number to read.  Band numbers start at 1.
+      \param column  First column of the window.
+      \param row  First row of the window.
+      \param width  Width of the window.
+      \param height  Height of the window.
+      \param[out] data  Array of at least \a width * \a height values.
+      \return  Error code or GDALError::None.
+    */
+    GDALError readWindow(int nBand, int column, int row, int width,
+        int height, double *data);
+
+    /**
+      Get the no-data value of a band.
+
+      \param nBand  Band number.  Band numbers start at 1.
+      \param[out] value  No-data value of the band, if it has one.
+      \return  Whether the band has a no-data value.
+    */
+    bool noData(int nBand, double& value) const;
+
+    /**
+      Convert a geo-located position into a fractional raster position
+      using the inverse of the raster's transformation matrix.  The center
+      of the cell at column 0, row 0 is at (.5, .5).
+
+      \param x  X position.
+      \param y  Y position.
+      \param[out] column  Fractional raster column.
+      \param[out] row  Fractional raster row.
+    */
+    void coordToPixel(double x, double y, double& column, double& row) const
+    {
+        column = m_inverseTransform[0] + (m_inverseTransform[1] * x) +
+            (m_inverseTransform[2] * y);
+        row = m_inverseTransform[3] + (m_inverseTransform[4] * x) +
+            (m_inverseTransform[5] * y);
+    }
+
     /**
       Get a vector of dimensions that map to the bands of a raster.
     */
@@ -0,0 +1,265 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Raster.hpp"
+#include "RasterSampler.hpp"
+
+namespace pdal
+{
+namespace gdal
+{
+
+const size_t RasterSampler::DefaultCacheSize;
+
+RasterSampler::RasterSampler(const std::string& filename, Method method,
+        size_t cacheSize) :
+    m_raster(new Raster(filename)), m_method(method), m_maxBlocks(1),
+    m_cacheSize(cacheSize), m_blockWidth(0), m_blockHeight(0)
+{}
+
+
+RasterSampler::~RasterSampler()
+{}
+
+
+GDALError RasterSampler::open()
+{
+    GDALError error = m_raster->open();
+    if (error == GDALError::CantOpen || error == GDALError::InvalidBand)
+    {
+        m_errorMsg = m_raster->errorMsg();
+        return error;
+    }
+    // A raster without a usable transform can still be sampled, though
+    // the result probably isn't what's wanted.
+    if (error != GDALError::None)
+        m_errorMsg = m_raster->errorMsg();
+
+    GDALError blockError = m_raster->blockSize(m_blockWidth, m_blockHeight);
+    if (blockError != GDALError::None)
+    {
+        m_errorMsg = m_raster->errorMsg();
+        return blockError;
+    }
+    size_t blockBytes = (size_t)m_blockWidth * m_blockHeight * sizeof(double);
+    m_maxBlocks = (std::max)(m_cacheSize / blockBytes, (size_t)1);
+
+    const int numBands = m_raster->bandCount();
+    m_hasNoData.resize(numBands);
+    m_noData.resize(numBands);
+    for (int i = 0; i < numBands; ++i)
+        m_hasNoData[i] = m_raster->noData(i + 1, m_noData[i]);
+
+    m_blocks.clear();
+    m_index.clear();
+    return error;
+}
+
+
+int RasterSampler::bandCount() const
+{
+    return m_raster->bandCount();
+}
+
+
+// Get the data for a block of a band, reading it if it isn't in the
+// cache.  The block returned is always at the front of the cache list.
+const double *RasterSampler::block(int band, int bx, int by)
+{
+    const uint64_t key = ((uint64_t)band << 48) | ((uint64_t)by << 24) |
+        (uint64_t)bx;
+
+    if (m_blocks.size() && m_blocks.front().m_key == key)
+        return m_blocks.front().m_data.data();
+
+    auto it = m_index.find(key);
+    if (it != m_index.end())
+    {
+        m_blocks.splice(m_blocks.begin(), m_blocks, it->second);
+        return m_blocks.front().m_data.data();
+    }
+
+    // Reuse the least recently used block's buffer if the cache is full.
+    if (m_blocks.size() >= m_maxBlocks)
+    {
+        m_index.erase(m_blocks.back().m_key);
+        m_blocks.splice(m_blocks.begin(), m_blocks, std::prev(m_blocks.end()));
+    }
+    else
+        m_blocks.emplace_front();
+
+    Block& b = m_blocks.front();
+    b.m_key = key;
+    m_index[key] = m_blocks.begin();
+
+    // Blocks at the right and bottom edges may be partial.
+    const int column = bx * m_blockWidth;
+    const int row = by * m_blockHeight;
+    const int width = (std::min)(m_blockWidth, m_raster->width() - column);
+    const int height = (std::min)(m_blockHeight, m_raster->height() - row);
+    b.m_data.resize((size_t)m_blockWidth * m_blockHeight);
+    if (m_raster->readWindow(band, column, row, width, height,
+        b.m_data.data()) != GDALError::None)
+    {
+        m_index.erase(key);
+        m_blocks.pop_front();
+        throw CantReadBlock();
+    }
+
+    // Spread partial blocks out so that every block has the same stride.
+    if (width < m_blockWidth)
+        for (int r = height - 1; r > 0; --r)
+            std::copy_backward(b.m_data.begin() + r * width,
+                b.m_data.begin() + (r + 1) * width,
+                b.m_data.begin() + r * m_blockWidth + width);
+    return b.m_data.data();
+}
+
+
+double RasterSampler::cell(int band, int column, int row)
+{
+    const int bx = column / m_blockWidth;
+    const int by = row / m_blockHeight;
+    const double *data = block(band, bx, by);
+    return data[(row - by * m_blockHeight) * m_blockWidth +
+        (column - bx * m_blockWidth)];
+}
+
+
+bool RasterSampler::isNoData(int band, double value) const
+{
+    return std::isnan(value) ||
+        (m_hasNoData[band - 1] && value == m_noData[band - 1]);
+}
+
+
+GDALError RasterSampler::sample(point_count_t count, const double *x,
+    const double *y, const std::vector<int>& bands, double *values,
+    char *found)
+{
+    if (m_blockWidth == 0)
+    {
+        m_errorMsg = "Raster not open.";
+        return GDALError::NotOpen;
+    }
+    for (int band : bands)
+        if (band <= 0 || band > bandCount())
+        {
+            m_errorMsg = "Unable to get band " + std::to_string(band) +
+                " from raster '" + m_raster->filename() + "'.";
+            return GDALError::InvalidBand;
+        }
+
+    const int width = m_raster->width();
+    const int height = m_raster->height();
+    const uint64_t outside = (std::numeric_limits<uint64_t>::max)();
+
+    // Visit the positions ordered by the block holding their cell so that
+    // each block is looked up once per run of positions.
+    m_order.resize(count);
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        double c, r;
+        m_raster->coordToPixel(x[i], y[i], c, r);
+        c = std::floor(c);
+        r = std::floor(r);
+        found[i] = (c >= 0 && c < width && r >= 0 && r < height);
+        uint64_t key = outside;
+        if (found[i])
+            key = ((uint64_t)((int)r / m_blockHeight) << 32) |
+                (uint64_t)((int)c / m_blockWidth);
+        m_order[i] = { key, i };
+    }
+    std::sort(m_order.begin(), m_order.end());
+
+    const size_t numBands = bands.size();
+    try
+    {
+        for (size_t b = 0; b < numBands; ++b)
+        {
+            const int band = bands[b];
+            for (auto& o : m_order)
+            {
+                if (o.first == outside)
+                    break;
+
+                const point_count_t i = o.second;
+                double c, r;
+                m_raster->coordToPixel(x[i], y[i], c, r);
+                const int column = (int)std::floor(c);
+                const int row = (int)std::floor(r);
+                double v = cell(band, column, row);
+                if (m_method == Method::Bilinear)
+                {
+                    // Interpolate between the centers of the four cells
+                    // around the position.  Cells past the edge of the
+                    // raster are replaced by the edge cells.
+                    const double fc = c - .5;
+                    const double fr = r - .5;
+                    const int c0 = (int)std::floor(fc);
+                    const int r0 = (int)std::floor(fr);
+                    const double dx = fc - c0;
+                    const double dy = fr - r0;
+                    const int cl = (std::max)(c0, 0);
+                    const int ch = (std::min)(c0 + 1, width - 1);
+                    const int rl = (std::max)(r0, 0);
+                    const int rh = (std::min)(r0 + 1, height - 1);
+
+                    const double v00 = cell(band, cl, rl);
+                    const double v10 = cell(band, ch, rl);
+                    const double v01 = cell(band, cl, rh);
+                    const double v11 = cell(band, ch, rh);
+                    if (!isNoData(band, v00) && !isNoData(band, v10) &&
+                        !isNoData(band, v01) && !isNoData(band, v11))
+                        v = (v00 * (1 - dx) + v10 * dx) * (1 - dy) +
+                            (v01 * (1 - dx) + v11 * dx) * dy;
+                }
+                values[i * numBands + b] = v;
+            }
+        }
+    }
+    catch (CantReadBlock)
+    {
+        m_errorMsg = m_raster->errorMsg();
+        return GDALError::CantReadBlock;
+    }
+    return GDALError::None;
+}
+
+} // namespace gdal
+} // namespace pdal
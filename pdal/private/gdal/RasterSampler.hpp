@@ -0,0 +1,155 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+
+#include "GDALError.hpp"
+
+namespace pdal
+{
+namespace gdal
+{
+
+class Raster;
+
+/*
+  Samples the bands of a raster at many positions.  Data is read from
+  GDAL a block at a time into a cache of recently used blocks, so points
+  that fall in the same block cost a single read.
+
+  A sampler holds its own dataset handle and cache and may only be used
+  by one thread at a time.  Threads that sample the same raster should
+  each create a sampler.
+*/
+class PDAL_DLL RasterSampler
+{
+public:
+    enum class Method
+    {
+        Nearest,
+        Bilinear
+    };
+
+    static const size_t DefaultCacheSize = 64 * 1024 * 1024;
+
+    /**
+      Constructor.
+
+      \param filename  Filename of raster file.
+      \param method  Method to use to compute a value from the cells near
+        a position.
+      \param cacheSize  Maximum size of the block cache in bytes.
+    */
+    RasterSampler(const std::string& filename,
+        Method method = Method::Nearest, size_t cacheSize = DefaultCacheSize);
+    ~RasterSampler();
+
+    /**
+      Open the raster for reading.  Errors that don't prevent sampling,
+      like a missing transform, are returned but leave the sampler usable.
+
+      \return  Error code or GDALError::None.
+    */
+    GDALError open();
+
+    /**
+      Sample bands of the raster at a set of positions.  Positions outside
+      of the raster aren't sampled.  With bilinear interpolation, the
+      nearest cell's value is used where a neighboring cell holds no data.
+
+      \param count  Number of positions.
+      \param x  X coordinates of the positions.
+      \param y  Y coordinates of the positions.
+      \param bands  Band numbers to sample.  Band numbers start at 1.
+      \param[out] values  Array of at least \a count * \a bands.size()
+        values.  The values for a position are adjacent, in the order
+        of \a bands.
+      \param[out] found  Array of \a count flags set to whether the
+        position was in the raster.
+      \return  Error code or GDALError::None.
+    */
+    GDALError sample(point_count_t count, const double *x, const double *y,
+        const std::vector<int>& bands, double *values, char *found);
+
+    /**
+      Get the most recent error message.
+    */
+    std::string errorMsg() const
+        { return m_errorMsg; }
+
+    /**
+      Get the number of bands in the raster.
+    */
+    int bandCount() const;
+
+private:
+    struct Block
+    {
+        uint64_t m_key;
+        std::vector<double> m_data;
+    };
+    using BlockList = std::list<Block>;
+
+    const double *block(int band, int bx, int by);
+    double cell(int band, int column, int row);
+    bool isNoData(int band, double value) const;
+
+    std::unique_ptr<Raster> m_raster;
+    Method m_method;
+    size_t m_maxBlocks;
+    size_t m_cacheSize;
+    int m_blockWidth;
+    int m_blockHeight;
+    std::vector<char> m_hasNoData;
+    std::vector<double> m_noData;
+    std::string m_errorMsg;
+
+    // Blocks in order of use, the most recent first.
+    BlockList m_blocks;
+    std::unordered_map<uint64_t, BlockList::iterator> m_index;
+    // Scratch space for ordering positions by block.
+    std::vector<std::pair<uint64_t, point_count_t>> m_order;
+};
+
+} // namespace gdal
+} // namespace pdal
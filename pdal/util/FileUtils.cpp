@@ -463,7 +463,8 @@ MapContext mapFile(const std::string& filename, bool readOnly,
 #ifndef WIN32
     ctx.m_fd = ::open(filename.c_str(), readOnly ? O_RDONLY : O_RDWR);
 #else
-    ctx.m_fd = ::_open(filename.c_str(), readOnly ? O_RDONLY : O_RDWR);
+    ctx.m_fd = ::_wopen(toNative(filename).c_str(),
+        readOnly ? O_RDONLY : O_RDWR);
 #endif
 
     if (ctx.m_fd == -1)
@@ -521,6 +522,23 @@ MapContext unmapFile(MapContext ctx)
     return ctx;
 }
 
+
+bool adviseSequential(const MapContext& ctx)
+{
+    if (!ctx.m_addr)
+        return false;
+#ifndef _WIN32
+    bool ok = (::madvise(ctx.m_addr, ctx.m_size, MADV_SEQUENTIAL) == 0);
+#ifdef MADV_HUGEPAGE
+    // Only honored for some filesystems.  Failure isn't an error.
+    (void)::madvise(ctx.m_addr, ctx.m_size, MADV_HUGEPAGE);
+#endif
+    return ok;
+#else
+    return false;
+#endif
+}
+
 } // namespace FileUtils
 } // namespace pdal
 
@@ -312,5 +312,15 @@ namespace FileUtils
     */
     PDAL_DLL MapContext unmapFile(MapContext ctx);
 
+    /**
+      Advise the system that a mapped file will be read sequentially so
+      that pages are read ahead aggressively and can be dropped once read.
+      Transparent huge pages are requested where the system supports them
+      for file mappings.  Has no effect on systems without madvise().
+      \param ctx  Previously returned MapContext
+      \return  \c true if the advice was accepted, \c false otherwise
+    */
+    PDAL_DLL bool adviseSequential(const MapContext& ctx);
+
 } // namespace FileUtils
 } // namespace pdal
@@ -0,0 +1,117 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "Charbuf.hpp"
+#include "FileUtils.hpp"
+#include "IStream.hpp"
+
+namespace pdal
+{
+
+// A read-only mapping of a file along with a stream that reads from it.
+// If the file can't be mapped, it's opened with FileUtils::openFile()
+// instead.
+class MappedFile
+{
+public:
+    MappedFile(const std::string& filename) : m_in(nullptr), m_stream(&m_buf)
+    {
+        if (!FileUtils::fileExists(filename))
+            return;
+        size_t size = (size_t)FileUtils::fileSize(filename);
+        if (size)
+            m_ctx = FileUtils::mapFile(filename, true, 0, size);
+        if (m_ctx.addr())
+        {
+            FileUtils::adviseSequential(m_ctx);
+            m_buf.initialize(static_cast<char *>(m_ctx.addr()), size);
+        }
+        else
+            m_in = FileUtils::openFile(filename);
+    }
+
+    ~MappedFile()
+    {
+        if (m_ctx.m_fd != -1)
+            FileUtils::unmapFile(m_ctx);
+        FileUtils::closeFile(m_in);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool valid() const
+        { return m_ctx.addr() != nullptr; }
+    const char *data() const
+        { return static_cast<const char *>(m_ctx.addr()); }
+    size_t size() const
+        { return valid() ? m_ctx.m_size : 0; }
+    std::istream *stream()
+        { return valid() ? &m_stream : m_in; }
+
+private:
+    FileUtils::MapContext m_ctx;
+    std::istream *m_in;
+    Charbuf m_buf;
+    std::istream m_stream;
+};
+
+
+int IStream::openMapped(const std::string& filename)
+{
+    if (m_stream)
+        return -1;
+
+    std::shared_ptr<MappedFile> map(new MappedFile(filename));
+    if (!map->stream())
+        return -1;
+    m_map = map;
+    m_stream = m_map->stream();
+    return 0;
+}
+
+
+const char *IStream::data() const
+{
+    return m_map ? m_map->data() : nullptr;
+}
+
+
+size_t IStream::size() const
+{
+    return m_map ? m_map->size() : 0;
+}
+
+} // namespace pdal
@@ -51,6 +51,7 @@ namespace pdal
 {
 
 class IStreamMarker;
+class MappedFile;
 
 /**
   Stream wrapper for input of binary data.
@@ -103,6 +104,33 @@ public:
         return 0;
     }
 
+    /**
+      Open a file to extract, mapping it into memory.  Data is extracted
+      directly from the mapped pages rather than through a file stream and
+      the mapped data can be accessed without copying using data().  If
+      the file can't be mapped, it's opened with FileUtils::openFile().
+
+      \param filename  Filename.
+      \return  -1 if a stream is already assigned or the file can't be
+        opened, 0 otherwise.
+    */
+    PDAL_DLL int openMapped(const std::string& filename);
+
+    /**
+      Return a pointer to the data of a file opened with openMapped().
+
+      \return  Pointer to the start of the mapped file, or nullptr if
+        no file is mapped.
+    */
+    PDAL_DLL const char *data() const;
+
+    /**
+      Return the size of a file opened with openMapped().
+
+      \return  Number of bytes mapped, or 0 if no file is mapped.
+    */
+    PDAL_DLL size_t size() const;
+
     /**
       Close the underlying stream.
     */
@@ -111,6 +139,7 @@ public:
         delete m_fstream;
         m_fstream = NULL;
         m_stream = NULL;
+        m_map.reset();
     }
 
     /**
@@ -260,6 +289,7 @@ public:
 protected:
     std::istream *m_stream;
     std::ifstream *m_fstream; // Dup of above to facilitate cleanup.
+    std::shared_ptr<MappedFile> m_map;
 
 private:
     std::stack<std::istream *> m_streams;
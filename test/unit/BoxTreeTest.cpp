@@ -0,0 +1,129 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+#include <random>
+
+#include <pdal/private/BoxTree.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+std::vector<BOX2D> randomBoxes(size_t count, std::mt19937& gen)
+{
+    std::uniform_real_distribution<double> pos(0, 1000);
+    std::uniform_real_distribution<double> len(0, 50);
+
+    std::vector<BOX2D> boxes;
+    for (size_t i = 0; i < count; ++i)
+    {
+        double x = pos(gen);
+        double y = pos(gen);
+        boxes.emplace_back(x, y, x + len(gen), y + len(gen));
+    }
+    return boxes;
+}
+
+} // unnamed namespace
+
+TEST(BoxTreeTest, empty)
+{
+    BoxTree tree;
+    std::vector<size_t> ids { 1, 2 };
+
+    EXPECT_TRUE(tree.empty());
+    tree.candidates(1, 1, ids);
+    EXPECT_TRUE(ids.empty());
+    EXPECT_FALSE(tree.overlaps(BOX2D(0, 0, 10, 10)));
+
+    tree.build(std::vector<BOX2D>(1, BOX2D(0, 0, 1, 1)));
+    EXPECT_EQ(tree.size(), 1U);
+    tree.candidates(0.5, 0.5, ids);
+    ASSERT_EQ(ids.size(), 1U);
+    EXPECT_EQ(ids[0], 0U);
+
+    tree.clear();
+    EXPECT_TRUE(tree.empty());
+    tree.candidates(0.5, 0.5, ids);
+    EXPECT_TRUE(ids.empty());
+}
+
+// Check queries against a linear search of the boxes.
+TEST(BoxTreeTest, queries)
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<double> pos(-50, 1050);
+
+    for (size_t count : { 5, 16, 17, 300, 5000 })
+    {
+        std::vector<BOX2D> boxes = randomBoxes(count, gen);
+        BoxTree tree(boxes);
+        EXPECT_EQ(tree.size(), count);
+
+        std::vector<size_t> ids;
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < 500; ++i)
+        {
+            double x = pos(gen);
+            double y = pos(gen);
+
+            expected.clear();
+            for (size_t j = 0; j < boxes.size(); ++j)
+                if (boxes[j].contains(x, y))
+                    expected.push_back(j);
+            tree.candidates(x, y, ids);
+            EXPECT_EQ(ids, expected);
+
+            size_t calls = 0;
+            bool found = tree.find(x, y,
+                [&calls](size_t){ return ++calls == 2; });
+            EXPECT_EQ(found, expected.size() >= 2);
+            EXPECT_EQ(calls, (std::min)(expected.size(), (size_t)2));
+
+            BOX2D box(x, y, x + 20, y + 5);
+            expected.clear();
+            for (size_t j = 0; j < boxes.size(); ++j)
+                if (boxes[j].overlaps(box))
+                    expected.push_back(j);
+            tree.candidates(box, ids);
+            EXPECT_EQ(ids, expected);
+            EXPECT_EQ(tree.overlaps(box), !expected.empty());
+        }
+    }
+}
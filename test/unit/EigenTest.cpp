@@ -39,6 +39,9 @@
 
 #include <Eigen/Dense>
 
+#include <array>
+#include <cmath>
+#include <functional>
 #include <limits>
 #include <numeric>
 
@@ -166,6 +169,160 @@ TEST(EigenTest, Morphological)
     EXPECT_EQ(0, Fv2[12]);
 }
 
+TEST(EigenTest, LargeDiamond)
+{
+    // Large structuring elements must match repeated small ones.
+    const size_t rows(60);
+    const size_t cols(50);
+    std::vector<double> src(rows * cols);
+    for (size_t i = 0; i < src.size(); ++i)
+        src[i] = (i % 7 == 3) ? std::numeric_limits<double>::quiet_NaN() :
+            double((i * 7919) % 1013);
+
+    for (int radius : { 15, 40, 200 })
+    {
+        std::vector<double> dilate(src);
+        std::vector<double> erode(src);
+        math::dilateDiamond(dilate, rows, cols, radius);
+        math::erodeDiamond(erode, rows, cols, radius);
+
+        std::vector<double> dilateIter(src);
+        std::vector<double> erodeIter(src);
+        for (int i = 0; i < radius; ++i)
+        {
+            math::dilateDiamond(dilateIter, rows, cols, 1);
+            math::erodeDiamond(erodeIter, rows, cols, 1);
+        }
+        EXPECT_EQ(dilateIter, dilate);
+        EXPECT_EQ(erodeIter, erode);
+    }
+}
+
+namespace
+{
+
+// The five-cell diamond filter as it was before dilateDiamond() and
+// erodeDiamond() were rewritten, for comparison.  'Better' is std::greater
+// to dilate and std::less to erode.
+template<typename Better>
+void baselineDiamond(std::vector<double>& data, size_t rows, size_t cols,
+    int iterations, double init)
+{
+    Better better;
+    std::vector<double> out(data.size(), init);
+    std::array<size_t, 5> idx;
+
+    for (int iter = 0; iter < iterations; ++iter)
+    {
+        for (size_t col = 0; col < cols; ++col)
+        {
+            size_t index = col*rows;
+            for (size_t row = 0; row < rows; ++row)
+            {
+                size_t j = 0;
+                idx[j++] = index+row;
+                if (row > 0)
+                    idx[j++] = idx[0]-1;
+                if (row < rows-1)
+                    idx[j++] = idx[0]+1;
+                if (col > 0)
+                    idx[j++] = idx[0]-rows;
+                if (col < cols-1)
+                    idx[j++] = idx[0]+rows;
+                for (size_t i = 0; i < j; ++i)
+                {
+                    if (better(data[idx[i]], out[index+row]))
+                        out[index+row] = data[idx[i]];
+                }
+            }
+        }
+        data.swap(out);
+    }
+}
+
+// The best non-NaN value within 'radius' cells (Manhattan distance) of
+// each cell, or 'init' if there is none.
+template<typename Better>
+std::vector<double> bruteDiamond(const std::vector<double>& data,
+    size_t rows, size_t cols, int radius, double init)
+{
+    Better better;
+    std::vector<double> out(data.size(), init);
+    for (int col = 0; col < (int)cols; ++col)
+        for (int row = 0; row < (int)rows; ++row)
+            for (int c = col - radius; c <= col + radius; ++c)
+                for (int r = row - radius; r <= row + radius; ++r)
+                {
+                    if (c < 0 || c >= (int)cols || r < 0 || r >= (int)rows ||
+                            std::abs(c - col) + std::abs(r - row) > radius)
+                        continue;
+                    double v = data[c * rows + r];
+                    double& o = out[col * rows + row];
+                    if (!std::isnan(v) && better(v, o))
+                        o = v;
+                }
+    return out;
+}
+
+} // unnamed namespace
+
+TEST(EigenTest, BaselineDiamond)
+{
+    const double lowest = std::numeric_limits<double>::lowest();
+    const double max = (std::numeric_limits<double>::max)();
+    const size_t rows(37);
+    const size_t cols(45);
+    std::vector<double> src(rows * cols);
+    for (size_t i = 0; i < src.size(); ++i)
+        src[i] = double((i * 7919) % 1013);
+
+    // Rasters without holes match the old filter exactly, for radii that
+    // iterate and radii that use the rotated raster.
+    for (int radius : { 1, 2, 3, 8, 20, 50 })
+    {
+        std::vector<double> dilate(src);
+        std::vector<double> erode(src);
+        math::dilateDiamond(dilate, rows, cols, radius);
+        math::erodeDiamond(erode, rows, cols, radius);
+
+        std::vector<double> dilateOld(src);
+        std::vector<double> erodeOld(src);
+        baselineDiamond<std::greater<double>>(dilateOld, rows, cols, radius,
+            lowest);
+        baselineDiamond<std::less<double>>(erodeOld, rows, cols, radius, max);
+        EXPECT_EQ(dilateOld, dilate);
+        EXPECT_EQ(erodeOld, erode);
+    }
+
+    // NaN holes are skipped in every pass, so each cell takes the best
+    // value that isn't a hole within the radius.  Cells with only holes
+    // around them get the lowest/highest double.  The old filter agreed
+    // for one pass.  For more it reused the previous pass's output as a
+    // starting value, which brought holes back on even passes.
+    std::vector<double> holes(src);
+    for (size_t i = 0; i < holes.size(); ++i)
+        if (i % 5 == 2 || (i / rows > 10 && i / rows < 20))
+            holes[i] = std::numeric_limits<double>::quiet_NaN();
+
+    for (int radius : { 1, 2, 3, 8, 20, 50 })
+    {
+        std::vector<double> dilate(holes);
+        std::vector<double> erode(holes);
+        math::dilateDiamond(dilate, rows, cols, radius);
+        math::erodeDiamond(erode, rows, cols, radius);
+        EXPECT_EQ(bruteDiamond<std::greater<double>>(holes, rows, cols,
+            radius, lowest), dilate);
+        EXPECT_EQ(bruteDiamond<std::less<double>>(holes, rows, cols,
+            radius, max), erode);
+    }
+
+    std::vector<double> dilate(holes);
+    std::vector<double> dilateOld(holes);
+    math::dilateDiamond(dilate, rows, cols, 1);
+    baselineDiamond<std::greater<double>>(dilateOld, rows, cols, 1, lowest);
+    EXPECT_EQ(dilateOld, dilate);
+}
+
 TEST(EigenTest, RoundtripString)
 {
     Eigen::MatrixXd identity = Eigen::MatrixXd::Identity(4, 4);
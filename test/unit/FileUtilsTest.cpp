@@ -35,6 +35,8 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/OStream.hpp>
 #include <pdal/util/Utils.hpp>
 
 #include "Support.hpp"
@@ -258,6 +260,59 @@ TEST(FileUtilsTest, glob)
     FileUtils::deleteFile("temp.glob");
 }
 
+TEST(FileUtilsTest, mapped_stream)
+{
+    std::string tmp(Support::temppath("mapped.tmp"));
+    FileUtils::deleteFile(tmp);
+
+    std::ostream *ostr = FileUtils::createFile(tmp);
+    {
+        OLeStream out(ostr);
+        out << (uint32_t)1234 << (double)5.5 << (uint16_t)99;
+    }
+    FileUtils::closeFile(ostr);
+
+    ILeStream in;
+    EXPECT_EQ(in.openMapped(tmp), 0);
+    EXPECT_EQ(in.size(), 14U);
+    ASSERT_NE(in.data(), nullptr);
+
+    uint32_t i;
+    double d;
+    uint16_t s;
+    in >> i >> d >> s;
+    EXPECT_EQ(i, 1234U);
+    EXPECT_EQ(d, 5.5);
+    EXPECT_EQ(s, 99U);
+    EXPECT_EQ(in.data()[0], (char)(1234 & 0xFF));
+
+    in.seek(4);
+    in >> d;
+    EXPECT_EQ(d, 5.5);
+    in.close();
+    EXPECT_EQ(in.data(), nullptr);
+
+    // Files that can't be mapped, like empty ones, are still read
+    // through a stream.
+    std::string empty(Support::temppath("mapped-empty.tmp"));
+    FileUtils::closeFile(FileUtils::createFile(empty));
+    ILeStream unmapped;
+    EXPECT_EQ(unmapped.openMapped(empty), 0);
+    EXPECT_EQ(unmapped.data(), nullptr);
+    EXPECT_EQ(unmapped.size(), 0U);
+    ASSERT_NE(unmapped.stream(), nullptr);
+    EXPECT_TRUE(unmapped.good());
+    unmapped.close();
+
+    // Files that can't be opened aren't.
+    ILeStream missing;
+    EXPECT_EQ(missing.openMapped(Support::temppath("nonexistent.tmp")), -1);
+    EXPECT_EQ(missing.stream(), nullptr);
+
+    FileUtils::deleteFile(tmp);
+    FileUtils::deleteFile(empty);
+}
+
 TEST(FileUtilsTest, test_file_ops_with_unicode_paths)
 {
     // 1. Read Unicode encoded word, ie. Japanese, from .txt file.
@@ -378,3 +378,72 @@ TEST(KDIndex, radius3D)
     EXPECT_EQ(ids[2], 2u);
 }
 
+
+TEST(KDIndex, batch)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Y);
+    layout->registerDim(Id::Z);
+
+    // A jittered 50x50x20 grid, big enough to be split across threads.
+    PointView view(table);
+    PointId idx = 0;
+    for (int i = 0; i < 50; ++i)
+        for (int j = 0; j < 50; ++j)
+            for (int k = 0; k < 20; ++k)
+            {
+                view.setField(Id::X, idx, i + (idx % 7) * .01);
+                view.setField(Id::Y, idx, j + (idx % 5) * .01);
+                view.setField(Id::Z, idx, k + (idx % 3) * .01);
+                idx++;
+            }
+
+    KD3Index index(view);
+    index.build();
+
+    KDNeighbors all = index.knnSearchAll(8);
+    EXPECT_EQ(all.size(), view.size());
+    KDNeighbors part = index.knnSearchAll(8, 1000, 3000, 3);
+    EXPECT_EQ(part.size(), 3000u);
+    for (PointId i = 0; i < view.size(); i += 97)
+    {
+        PointIdList ids(8);
+        std::vector<double> dists(8);
+        index.knnSearch(i, 8, &ids, &dists);
+        ASSERT_EQ(all.count(i), 8u);
+        EXPECT_EQ(all.ids(i)[0], i);
+        for (size_t j = 0; j < 8; ++j)
+            EXPECT_DOUBLE_EQ(all.sqrDists(i)[j], dists[j]);
+        if (i >= 1000 && i < 4000)
+            EXPECT_EQ(part.neighbors(i - 1000), all.neighbors(i));
+    }
+
+    KDNeighbors radius = index.radiusAll(1.5, 0, view.size(), 4);
+    EXPECT_EQ(radius.size(), view.size());
+    for (PointId i = 0; i < view.size(); i += 97)
+        EXPECT_EQ(radius.neighbors(i), index.radius(i, 1.5));
+
+    // More neighbors than points.
+    PointView small(table);
+    small.appendPoint(view, 0);
+    small.appendPoint(view, 1);
+    KD3Index smallIndex(small);
+    smallIndex.build();
+    KDNeighbors two = smallIndex.knnSearchAll(5);
+    EXPECT_EQ(two.size(), 2u);
+    EXPECT_EQ(two.count(0), 2u);
+    EXPECT_EQ(two.ids(1)[0], 1u);
+
+    // 2D neighbors of the points of another view.
+    KD2Index index2(small);
+    index2.build();
+    KDNeighbors nearest = index2.knnSearchAll(view, 1, 0, 100);
+    EXPECT_EQ(nearest.size(), 100u);
+    EXPECT_EQ(nearest.ids(0)[0], 0u);
+    EXPECT_EQ(nearest.ids(1)[0], 1u);
+    EXPECT_EQ(nearest.ids(99)[0], 1u);
+}
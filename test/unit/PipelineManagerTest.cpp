@@ -238,3 +238,129 @@ TEST(PipelineManagerTest, replace)
     EXPECT_EQ(w2->getInputs().size(), 1U);
     EXPECT_EQ(w2->getInputs().front(), f2);
 }
+
+namespace
+{
+
+void makeParallelPipeline(PipelineManager& mgr)
+{
+    Stage& merge = mgr.makeFilter("filters.merge");
+    for (int i = 0; i < 4; ++i)
+    {
+        Options ro;
+        ro.add("mode", "ramp");
+        ro.add("count", 1000);
+        ro.add("bounds", BOX3D(i * 1000, 0, 0, i * 1000 + 999, 999, 999));
+        Stage& r = mgr.addReader("readers.faux");
+        r.setOptions(ro);
+        merge.setInput(r);
+    }
+
+    Options so;
+    so.add("length", 250);
+    Stage& splitter = mgr.makeFilter("filters.splitter", merge, so);
+
+    Options fo;
+    fo.add("limits", "Y[100:899]");
+    mgr.makeFilter("filters.range", splitter, fo);
+}
+
+} // unnamed namespace
+
+// Make sure that a pipeline run on several threads produces the same views
+// as a pipeline run serially.
+TEST(PipelineManagerTest, threads)
+{
+    PipelineManager serial;
+    makeParallelPipeline(serial);
+    point_count_t serialCount = serial.execute();
+    const PointViewSet& serialViews = serial.views();
+
+    PipelineManager parallel;
+    makeParallelPipeline(parallel);
+    parallel.setThreads(4);
+    point_count_t parallelCount = parallel.execute();
+    const PointViewSet& parallelViews = parallel.views();
+
+    EXPECT_EQ(serialCount, parallelCount);
+    ASSERT_EQ(serialViews.size(), parallelViews.size());
+    auto si = serialViews.begin();
+    auto pi = parallelViews.begin();
+    for (; si != serialViews.end(); ++si, ++pi)
+    {
+        PointViewPtr s = *si;
+        PointViewPtr p = *pi;
+        ASSERT_EQ(s->size(), p->size());
+        for (PointId i = 0; i < s->size(); ++i)
+        {
+            EXPECT_EQ(s->getFieldAs<double>(Dimension::Id::X, i),
+                p->getFieldAs<double>(Dimension::Id::X, i));
+            EXPECT_EQ(s->getFieldAs<double>(Dimension::Id::Y, i),
+                p->getFieldAs<double>(Dimension::Id::Y, i));
+        }
+    }
+}
+
+namespace
+{
+
+// Branches that use GDAL to reproject and write metadata as they run.
+void makeGdalPipeline(PipelineManager& mgr, std::vector<Stage *>& stats)
+{
+    Stage& merge = mgr.makeFilter("filters.merge");
+    for (int i = 0; i < 2; ++i)
+    {
+        Options ro;
+        ro.add("mode", "ramp");
+        ro.add("count", 20000);
+        ro.add("bounds", BOX3D(400000 + i * 10000, 4500000, 0,
+            409999 + i * 10000, 4509999, 100));
+        ro.add("override_srs", "EPSG:26915");
+        Stage& r = mgr.addReader("readers.faux");
+        r.setOptions(ro);
+
+        Options po;
+        po.add("out_srs", "EPSG:4326");
+        Stage& repro = mgr.makeFilter("filters.reprojection", r, po);
+        Stage& s = mgr.makeFilter("filters.stats", repro);
+        stats.push_back(&s);
+        merge.setInput(s);
+    }
+}
+
+} // unnamed namespace
+
+// Run two branches that use GDAL at the same time.  The results and the
+// metadata written by the branches are the same as when run serially.
+// This is meant to be run under a thread sanitizer as well.
+TEST(PipelineManagerTest, threadsGdal)
+{
+    std::vector<Stage *> serialStats;
+    PipelineManager serial;
+    makeGdalPipeline(serial, serialStats);
+    serial.execute();
+    PointViewPtr s = *serial.views().begin();
+
+    std::vector<Stage *> parallelStats;
+    PipelineManager parallel;
+    makeGdalPipeline(parallel, parallelStats);
+    parallel.setThreads(4);
+    parallel.execute();
+    PointViewPtr p = *parallel.views().begin();
+
+    ASSERT_EQ(s->size(), 40000u);
+    ASSERT_EQ(s->size(), p->size());
+    for (PointId i = 0; i < s->size(); i += 7)
+    {
+        EXPECT_EQ(s->getFieldAs<double>(Dimension::Id::X, i),
+            p->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_EQ(s->getFieldAs<double>(Dimension::Id::Y, i),
+            p->getFieldAs<double>(Dimension::Id::Y, i));
+    }
+
+    for (size_t i = 0; i < serialStats.size(); ++i)
+        EXPECT_EQ(Utils::toJSON(serialStats[i]->getMetadata()),
+            Utils::toJSON(parallelStats[i]->getMetadata()));
+    EXPECT_EQ(Utils::toJSON(serial.getMetadata()),
+        Utils::toJSON(parallel.getMetadata()));
+}
@@ -290,6 +290,192 @@ TEST(PointViewTest, getFloatNan)
     EXPECT_NO_THROW(view->getFieldAs<float>(Dimension::Id::ScanAngleRank, 0));
 }
 
+TEST(PointViewTest, fieldSpan)
+{
+    using namespace Dimension;
+
+    auto fill = [](PointTableRef table, point_count_t cnt)
+    {
+        PointLayoutPtr layout(table.layout());
+        layout->registerDim(Id::X, Type::Double);
+        layout->registerDim(Id::Intensity, Type::Unsigned16);
+        table.finalize();
+        PointViewPtr view(new PointView(table));
+        for (PointId i = 0; i < cnt; ++i)
+        {
+            view->setField(Id::X, i, (double)i);
+            view->setField(Id::Intensity, i, (uint16_t)(i % 1000));
+        }
+        return view;
+    };
+
+    // Columnar table - spans are direct and stop at block boundaries.
+    {
+        ColumnPointTable table;
+        PointViewPtr view = fill(table, 20000);
+
+        FieldSpan<double> xs = view->getFieldSpan<double>(Id::X, 0, 4096);
+        EXPECT_TRUE(xs.direct());
+        EXPECT_EQ(xs.size(), 4096u);
+        for (point_count_t i = 0; i < xs.size(); ++i)
+            xs[i] += 1;
+        view->setFieldSpan(Id::X, 0, xs);
+        EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Id::X, 100), 101.0);
+
+        xs = view->getFieldSpan<double>(Id::X, 16000, 4096);
+        EXPECT_TRUE(xs.direct());
+        EXPECT_EQ(xs.size(), 16384u - 16000u);
+
+        // Type conversion requires a copy, but the size matches.
+        FieldSpan<double> is =
+            view->getFieldSpan<double>(Id::Intensity, 16000, 4096);
+        EXPECT_FALSE(is.direct());
+        EXPECT_EQ(is.size(), xs.size());
+        EXPECT_DOUBLE_EQ(is[5], 5.0);
+
+        xs = view->getFieldSpan<double>(Id::X, 19990, 4096);
+        EXPECT_EQ(xs.size(), 10u);
+        xs = view->getFieldSpan<double>(Id::X, 20000, 4096);
+        EXPECT_TRUE(xs.empty());
+
+        // A reordered view falls back to a copy.
+        PointViewPtr reordered = view->makeNew();
+        reordered->appendPoint(*view, 1);
+        reordered->appendPoint(*view, 0);
+        for (PointId i = 2; i < 100; ++i)
+            reordered->appendPoint(*view, i);
+        xs = reordered->getFieldSpan<double>(Id::X, 0, 4096);
+        EXPECT_FALSE(xs.direct());
+        EXPECT_EQ(xs.size(), 100u);
+        EXPECT_DOUBLE_EQ(xs[0], 2.0);
+        EXPECT_DOUBLE_EQ(xs[1], 1.0);
+    }
+
+    // Row table - values are copied and must be stored.
+    {
+        PointTable table;
+        PointViewPtr view = fill(table, 1000);
+
+        FieldSpan<uint16_t> is =
+            view->getFieldSpan<uint16_t>(Id::Intensity, 10, 4096);
+        EXPECT_FALSE(is.direct());
+        EXPECT_EQ(is.size(), 990u);
+        for (uint16_t& i : is)
+            i *= 2;
+        EXPECT_EQ(view->getFieldAs<uint16_t>(Id::Intensity, 20), 20);
+        view->setFieldSpan(Id::Intensity, 10, is);
+        EXPECT_EQ(view->getFieldAs<uint16_t>(Id::Intensity, 20), 40);
+
+        FieldSpan<double> xs = view->getFieldSpan<double>(Id::X, 0, 10);
+        xs[0] = 70000;
+        view->setFieldSpan(Id::X, 0, xs);
+        EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Id::X, 0), 70000.0);
+
+        FieldSpan<double> big =
+            view->getFieldSpan<double>(Id::Intensity, 0, 1);
+        big[0] = 70000;
+        EXPECT_THROW(view->setFieldSpan(Id::Intensity, 0, big), pdal_error);
+    }
+}
+
+TEST(PointViewTest, viewIndex)
+{
+    ViewIndex index;
+
+    // Consecutive IDs are stored as a range.
+    for (PointId id = 10; id < 100010; ++id)
+        index.add(id);
+    EXPECT_TRUE(index.isRange());
+    EXPECT_EQ(index.size(), 100000u);
+    EXPECT_EQ(index[70000], 70010u);
+    EXPECT_TRUE(index.contiguous(5, 1000));
+    index.set(5, 15);
+    EXPECT_TRUE(index.isRange());
+
+    // Reordering switches to chunked storage.
+    index.set(5, 16);
+    index.set(6, 15);
+    EXPECT_FALSE(index.isRange());
+    EXPECT_EQ(index[5], 16u);
+    EXPECT_EQ(index[6], 15u);
+    EXPECT_EQ(index[99999], 100009u);
+    EXPECT_FALSE(index.contiguous(0, 10));
+    EXPECT_TRUE(index.contiguous(7, 1000));
+
+    // IDs that don't fit in 32 bits.
+    const PointId big = PointId(1) << 33;
+    index.add(big);
+    EXPECT_EQ(index.size(), 100001u);
+    EXPECT_EQ(index[100000], big);
+    EXPECT_EQ(index[6], 15u);
+    EXPECT_EQ(index[65536], 65546u);
+
+    index.truncate(65536);
+    EXPECT_EQ(index.size(), 65536u);
+    index.add(7);
+    EXPECT_EQ(index[65536], 7u);
+
+    ViewIndex other;
+    other.add(3);
+    other.add(4);
+    other.append(index, 10);
+    EXPECT_EQ(other.size(), 12u);
+    EXPECT_EQ(other[1], 4u);
+    EXPECT_EQ(other[2], 10u);
+    EXPECT_EQ(other[7], 16u);
+
+    ViewIndex range;
+    range.add(0);
+    range.add(1);
+    ViewIndex tail;
+    tail.add(2);
+    tail.add(3);
+    tail.add(100);
+    range.append(tail, 2);
+    EXPECT_TRUE(range.isRange());
+    EXPECT_EQ(range.size(), 4u);
+    EXPECT_EQ(range.at(3), 3u);
+    EXPECT_THROW(range.at(4), std::out_of_range);
+}
+
+TEST(PointViewTest, appendAfterSort)
+{
+    PointTable table;
+    PointViewPtr view = makeTestView(table, 100);
+    PointViewPtr sorted = view->makeNew();
+    sorted->append(*view);
+    EXPECT_EQ(sorted->size(), 100u);
+
+    // Reverse the order of the points.
+    auto cmp = [](const PointRef& p1, const PointRef& p2)
+        { return p2.compare(Dimension::Id::Y, p1); };
+    std::sort(sorted->begin(), sorted->end(), cmp);
+    sorted->append(*view);
+    EXPECT_EQ(sorted->size(), 200u);
+    for (PointId i = 0; i < 100; ++i)
+        EXPECT_EQ(sorted->getFieldAs<uint8_t>(Dimension::Id::Classification,
+            i + 100), view->getFieldAs<uint8_t>(
+            Dimension::Id::Classification, i));
+    for (PointId i = 1; i < 100; ++i)
+        EXPECT_GT(sorted->getFieldAs<double>(Dimension::Id::Y, i - 1),
+            sorted->getFieldAs<double>(Dimension::Id::Y, i));
+}
+
+TEST(PointViewTest, reorder)
+{
+    PointTable table;
+    PointViewPtr view = makeTestView(table, 5);
+
+    view->reorder({ 4, 3, 2, 1, 0 });
+    for (PointId i = 0; i < 5; ++i)
+        EXPECT_EQ(view->getFieldAs<uint8_t>(Dimension::Id::Classification, i),
+            5 - i);
+
+    EXPECT_THROW(view->reorder({ 0, 1, 2, 3 }), pdal_error);
+    EXPECT_THROW(view->reorder({ 0, 1, 2, 3, 5 }), pdal_error);
+    EXPECT_THROW(view->reorder({ 0, 1, 2, 3, 3 }), pdal_error);
+}
+
 // Per discussions with @abellgithub (https://github.com/gadomski/PDAL/commit/c1d54e56e2de841d37f2a1b1c218ed723053f6a9#commitcomment-14415138)
 // we only do bounds checking on `PointView`s when in debug mode.
 #ifndef NDEBUG
@@ -40,6 +40,8 @@
 
 #include <filters/private/Segmentation.hpp>
 
+#include <algorithm>
+#include <random>
 #include <vector>
 
 using namespace pdal;
@@ -155,6 +157,47 @@ TEST(SegmentationTest, Clustering2D)
     EXPECT_EQ(1u, clusters[0].size());
 }
 
+// The union-find clustering should match the clustering done with
+// a KD index.
+TEST(SegmentationTest, ParallelClustering)
+{
+    using namespace Segmentation;
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDims({ Id::X, Id::Y, Id::Z });
+    PointViewPtr src(new PointView(table));
+
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<double> uniform(0, 50);
+    for (PointId i = 0; i < 40000; ++i)
+    {
+        src->setField(Id::X, i, uniform(gen));
+        src->setField(Id::Y, i, uniform(gen));
+        src->setField(Id::Z, i, uniform(gen) / 5);
+    }
+
+    auto check = [](std::deque<PointIdList> expected,
+        const std::deque<PointIdList>& clusters)
+    {
+        ASSERT_EQ(expected.size(), clusters.size());
+        for (size_t i = 0; i < clusters.size(); ++i)
+        {
+            std::sort(expected[i].begin(), expected[i].end());
+            EXPECT_EQ(expected[i], clusters[i]);
+        }
+    };
+
+    check(extractClusters<KD3Index>(*src, 1, 100, 0.2),
+        extractClusters(*src, { Id::X, Id::Y, Id::Z }, 1, 100, 0.2));
+    check(extractClusters<KD3Index>(*src, 3, 1000000, 0.25),
+        extractClusters(*src, { Id::X, Id::Y, Id::Z }, 3, 1000000, 0.25));
+    check(extractClusters<KD2Index>(*src, 2, 50, 0.1),
+        extractClusters(*src, { Id::X, Id::Y }, 2, 50, 0.1));
+    check(extractClusters<KD2Index>(*src, 1, 1000000, 0.3),
+        extractClusters(*src, { Id::X, Id::Y }, 1, 1000000, 0.3));
+}
+
 TEST(SegmentationTest, SegmentReturns)
 {
     using namespace Segmentation;
@@ -528,3 +528,132 @@ R"(
         EXPECT_NE(output.find("DBDCA"), std::string::npos);
     }
 }
+
+// Make sure pipelined execution keeps point order and honors skips.
+TEST(Streaming, pipelined)
+{
+    class OddFilter : public Filter, public Streamable
+    {
+    public:
+        std::string getName() const { return "filters.odd"; }
+
+    private:
+        virtual bool processOne(PointRef& point)
+            { return point.getFieldAs<int>(Dimension::Id::X) % 2; }
+    };
+
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("mode", "ramp");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    OddFilter odd;
+    odd.setInput(r);
+
+    StreamCallbackFilter f;
+    int cnt = 0;
+    int x = 1;
+    auto cb = [&cnt, &x](PointRef& point)
+    {
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X), x);
+        x += 2;
+        cnt++;
+        return true;
+    };
+    f.setCallback(cb);
+    f.setInput(odd);
+
+    FixedPointTable t(15);
+    f.prepare(t);
+    f.executePipelined(t);
+    EXPECT_EQ(cnt, 500);
+}
+
+// Make sure an exception thrown by a stage stops a pipelined execution
+// and is passed to the caller.
+TEST(Streaming, pipelined_error)
+{
+    Options ro;
+    ro.add("mode", "constant");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    StreamCallbackFilter f;
+    int cnt = 0;
+    auto cb = [&cnt](PointRef&)
+    {
+        if (++cnt == 100)
+            throw pdal_error("Callback failed.");
+        return true;
+    };
+    f.setCallback(cb);
+    f.setInput(r);
+
+    FixedPointTable t(10);
+    f.prepare(t);
+    EXPECT_THROW(f.executePipelined(t), pdal_error);
+    EXPECT_EQ(cnt, 100);
+}
+
+// A table that consumes points in reset() can't be pipelined, since point
+// data lives in tables owned by the pipeline.  Make sure it still sees
+// every point.
+TEST(Streaming, pipelined_reset)
+{
+    class SumPointTable : public StreamPointTable
+    {
+    public:
+        SumPointTable(point_count_t capacity) :
+            StreamPointTable(m_layout, capacity), m_count(0), m_sum(0)
+        {}
+
+        virtual void finalize()
+        {
+            if (!m_layout.finalized())
+            {
+                BasePointTable::finalize();
+                m_buf.resize(pointsToBytes(capacity() + 1));
+            }
+        }
+
+        point_count_t m_count;
+        int m_sum;
+
+    protected:
+        virtual void reset()
+        {
+            for (PointId idx = 0; idx < numPoints(); ++idx)
+            {
+                PointRef point(*this, idx);
+                m_sum += point.getFieldAs<int>(Dimension::Id::X);
+            }
+            m_count += numPoints();
+        }
+
+        virtual char *getPoint(PointId idx)
+            { return m_buf.data() + pointsToBytes(idx); }
+
+    private:
+        std::vector<char> m_buf;
+        PointLayout m_layout;
+    };
+
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("mode", "ramp");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    StreamCallbackFilter f;
+    f.setInput(r);
+
+    SumPointTable t(15);
+    f.prepare(t);
+    f.executePipelined(t);
+    EXPECT_EQ(t.m_count, 1000u);
+    EXPECT_EQ(t.m_sum, 999 * 1000 / 2);
+}
@@ -0,0 +1,203 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <pdal/Filter.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/private/ThreadBudget.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Count the threads that run work on a group.  Each call waits for
+// another so that one thread can't make all of them.
+size_t countThreads(ThreadGroup& group)
+{
+    std::mutex mutex;
+    std::set<std::thread::id> ids;
+    std::atomic<size_t> arrived(0);
+    group.run(group.size(), [&](size_t)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ids.insert(std::this_thread::get_id());
+        }
+        arrived++;
+        auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (arrived < 2 && std::chrono::steady_clock::now() < end)
+            std::this_thread::yield();
+    });
+    return ids.size();
+}
+
+} // unnamed namespace
+
+// Without a pipeline budget, threads come from the process budget, which
+// has a thread for each CPU.
+TEST(ThreadBudgetTest, processBudget)
+{
+    const size_t cpus = (std::max)(std::thread::hardware_concurrency(), 1U);
+    ASSERT_NE(ThreadBudget::current(), nullptr);
+
+    {
+        ThreadGroup group;
+        EXPECT_EQ(group.size(), cpus);
+        ThreadGroup other;
+        EXPECT_EQ(other.size(), 1u);
+    }
+    ThreadGroup group;
+    EXPECT_EQ(group.size(), cpus);
+
+    ThreadGroup fixed(3, false);
+    EXPECT_EQ(fixed.size(), 3u);
+}
+
+// A stage run with the default settings splits its work among threads.
+TEST(ThreadBudgetTest, defaultPipeline)
+{
+    if (std::thread::hardware_concurrency() < 2)
+        return;
+
+    class TestFilter : public Filter
+    {
+    public:
+        TestFilter() : m_threads(0)
+        {}
+
+        std::string getName() const { return "filters.test"; }
+
+        size_t m_threads;
+
+    private:
+        virtual void filter(PointView&)
+        {
+            ThreadGroup group;
+            m_threads = countThreads(group);
+        }
+    };
+
+    StageFactory factory;
+    Stage& r = *(factory.createStage("readers.faux"));
+    Options ro;
+    ro.add("count", 10);
+    ro.add("mode", "constant");
+    r.setOptions(ro);
+
+    TestFilter f;
+    f.setInput(r);
+
+    PointTable table;
+    f.prepare(table);
+    f.execute(table);
+    EXPECT_GT(f.m_threads, 1u);
+}
+
+TEST(ThreadBudgetTest, acquire)
+{
+    ThreadBudget *process = ThreadBudget::current();
+    ThreadBudget budget(4);
+    {
+        ThreadBudget::Scope scope(&budget);
+        EXPECT_EQ(ThreadBudget::current(), &budget);
+
+        ThreadGroup g1(3);
+        EXPECT_EQ(g1.size(), 3u);
+        ThreadGroup g2;
+        EXPECT_EQ(g2.size(), 3u);
+        ThreadGroup g3;
+        EXPECT_EQ(g3.size(), 1u);
+
+        // Unbudgeted groups don't take from the budget.
+        ThreadGroup g4(5, false);
+        EXPECT_EQ(g4.size(), 5u);
+    }
+    EXPECT_EQ(ThreadBudget::current(), process);
+
+    // Everything was returned.
+    EXPECT_EQ(budget.acquire(10), 4u);
+}
+
+TEST(ThreadBudgetTest, run)
+{
+    ThreadBudget budget(4);
+    ThreadBudget::Scope scope(&budget);
+    ThreadGroup group;
+    ASSERT_EQ(group.size(), 5u);
+    EXPECT_GT(countThreads(group), 1u);
+
+    std::vector<int> hits(100000);
+    group.run(hits.size(), [&hits](size_t i){ hits[i]++; });
+    for (int h : hits)
+        EXPECT_EQ(h, 1);
+
+    // Work on the group's threads sees the budget, which is used up.
+    std::atomic<size_t> nested(0);
+    group.run(100, [&nested](size_t)
+    {
+        ThreadGroup inner;
+        nested += inner.size();
+    });
+    EXPECT_EQ(nested, 100u);
+
+    // Ranges cover [0, count) in order without overlap.
+    std::vector<size_t> begins(group.size());
+    std::vector<size_t> ends(group.size());
+    size_t parts = group.ranges(1000, 300,
+        [&](size_t part, size_t begin, size_t end)
+        {
+            begins[part] = begin;
+            ends[part] = end;
+        });
+    EXPECT_EQ(parts, 3u);
+    EXPECT_EQ(begins[0], 0u);
+    for (size_t p = 1; p < parts; ++p)
+        EXPECT_EQ(begins[p], ends[p - 1]);
+    EXPECT_EQ(ends[parts - 1], 1000u);
+
+    EXPECT_THROW(group.run(1000, [](size_t i)
+        {
+            if (i == 500)
+                throw std::runtime_error("failed");
+        }), std::runtime_error);
+}
@@ -34,9 +34,15 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <cmath>
+#include <thread>
+
 #include <pdal/Filter.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/Bounds.hpp>
+#include <filters/private/expr/ConditionalExpression.hpp>
+#include <filters/private/expr/MathExpression.hpp>
+#include <filters/private/expr/MathParser.hpp>
 
 namespace pdal
 {
@@ -192,4 +198,125 @@ TEST(WhereTest, t1)
     exec3("X<50 && Y < 2.5", 25, 3, Filter::WhereMergeMode::False);
 }
 
+// Check that compiled expressions fold constants, share repeated
+// subexpressions and give the same results for a block as for each point.
+TEST(WhereTest, compiled)
+{
+    PointTable t;
+    t.layout()->registerDims({Dimension::Id::X, Dimension::Id::Y,
+        Dimension::Id::Intensity});
+    PointView v(t);
+    for (PointId i = 0; i < 3000; ++i)
+    {
+        v.setField(Dimension::Id::X, i, i * .5);
+        v.setField(Dimension::Id::Y, i, (double)(i % 7));
+        v.setField(Dimension::Id::Intensity, i, i % 300);
+    }
+
+    auto check = [&v](const std::string& s)
+    {
+        expr::ConditionalExpression e;
+        auto status = Utils::fromString(s, e);
+        EXPECT_TRUE(status) << s;
+        status = e.prepare(v.table().layout());
+        EXPECT_TRUE(status) << s;
+
+        std::vector<double> results;
+        e.eval(v, 10, 2500, results);
+        EXPECT_EQ(results.size(), 2500U);
+        for (PointId i = 0; i < 2500; ++i)
+        {
+            PointRef p(v, i + 10);
+            EXPECT_EQ(results[i] != 0, e.eval(p)) << s << " at " << i;
+        }
+    };
+
+    check("X < 50");
+    check("X * 2 > Y + Intensity && !(Y == 3)");
+    check("(X + Y) / Y >= 2 || X + Y < 100");
+    check("X / 0 == X / 0 || -(-Y) != Y - 1");
+
+    auto size = [&v](const std::string& s)
+    {
+        expr::MathExpression e;
+        expr::Lexer lexer(s);
+        expr::MathParser parser(lexer);
+        EXPECT_TRUE(parser.expression(e) && parser.checkEnd()) << s;
+        EXPECT_TRUE(e.prepare(v.table().layout())) << s;
+
+        std::vector<double> results;
+        e.eval(v, 0, 3000, results);
+        for (PointId i = 0; i < 3000; i += 97)
+        {
+            PointRef p(v, i);
+            double d = e.eval(p);
+            EXPECT_TRUE(d == results[i] || (std::isnan(d) &&
+                std::isnan(results[i])));
+        }
+        expr::Program prog;
+        prog.compile(*e.topNode());
+        return prog.size();
+    };
+
+    // Loads of X and Y, and two instructions for (X + Y) * (X + Y).
+    EXPECT_EQ(size("(X + Y) * (Y + X)"), 4U);
+    // The multiply by one and the negations go away.
+    EXPECT_EQ(size("-(-X) * (2 - 1) + Y"), 3U);
+    EXPECT_EQ(size("Intensity / 2 - Intensity / 2"), 3U);
+}
+
+// Check that a compiled expression can be evaluated point by point by
+// several threads at once, including one too long for the stack.
+TEST(WhereTest, threads)
+{
+    PointTable t;
+    t.layout()->registerDims({Dimension::Id::X, Dimension::Id::Y});
+    PointView v(t);
+    for (PointId i = 0; i < 20000; ++i)
+    {
+        v.setField(Dimension::Id::X, i, i * .25);
+        v.setField(Dimension::Id::Y, i, (double)(i % 11));
+    }
+
+    // Each term is a multiply and an add.
+    std::string longExpr("X");
+    for (int i = 0; i < 50; ++i)
+        longExpr += " + X * " + std::to_string(i + 2) + ".5 / (Y + " +
+            std::to_string(i) + ")";
+
+    for (const std::string& s : { std::string("X * 2 + Y / 3 - X * Y"),
+        longExpr })
+    {
+        expr::MathExpression e;
+        expr::Lexer lexer(s);
+        expr::MathParser parser(lexer);
+        ASSERT_TRUE(parser.expression(e) && parser.checkEnd()) << s;
+        ASSERT_TRUE(e.prepare(v.table().layout())) << s;
+
+        std::vector<double> results;
+        e.eval(v, 0, v.size(), results);
+
+        const size_t NumThreads = 4;
+        std::vector<size_t> mismatches(NumThreads);
+        std::vector<std::thread> threads;
+        for (size_t n = 0; n < NumThreads; ++n)
+            threads.emplace_back([&, n]()
+            {
+                // Every thread visits every point so that they overlap.
+                for (PointId i = 0; i < v.size(); ++i)
+                {
+                    PointRef p(v, i);
+                    double d = e.eval(p);
+                    if (!(d == results[i] || (std::isnan(d) &&
+                            std::isnan(results[i]))))
+                        mismatches[n]++;
+                }
+            });
+        for (std::thread& th : threads)
+            th.join();
+        for (size_t n = 0; n < NumThreads; ++n)
+            EXPECT_EQ(mismatches[n], 0U) << s;
+    }
+}
+
 } // namespace pdal
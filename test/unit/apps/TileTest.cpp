@@ -89,6 +89,68 @@ TEST(Tile, test1)
 }
 
 
+TEST(Tile, bucketed)
+{
+    std::string inSpec(Support::datapath("text/file*.txt"));
+    std::string outSpec(Support::temppath("tile/out#.txt"));
+
+    std::string baseCmd = Support::binpath("pdal") + " tile \"" +
+        inSpec + "\" \"" + outSpec + "\" ";
+
+    FileUtils::deleteDirectory(Support::temppath("tile"));
+    FileUtils::createDirectory(Support::temppath("tile"));
+
+    std::string output;
+    std::string cmd = baseCmd + " --origin_x=0 --origin_y=0 --length=10 "
+        "--bucketed --max_open=2 --threads=2";
+    Utils::run_shell_command(cmd, output);
+
+    // The spill directory is removed when the tiles have been written.
+    EXPECT_EQ(FileUtils::directoryList(Support::temppath("tile")).size(), 9U);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            checkFile(i, j, 3);
+
+    // Points are in the same order as when not bucketed.
+    FileUtils::deleteDirectory(Support::temppath("tile-ref"));
+    FileUtils::createDirectory(Support::temppath("tile-ref"));
+    cmd = Support::binpath("pdal") + " tile \"" + inSpec + "\" \"" +
+        Support::temppath("tile-ref/out#.txt") +
+        "\" --origin_x=0 --origin_y=0 --length=10";
+    Utils::run_shell_command(cmd, output);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+        {
+            std::string name("out" + std::to_string(i) + "_" +
+                std::to_string(j) + ".txt");
+            std::string bucketed(FileUtils::readFileIntoString(
+                Support::temppath("tile/" + name)));
+            std::string ref(FileUtils::readFileIntoString(
+                Support::temppath("tile-ref/" + name)));
+            EXPECT_EQ(bucketed, ref) << name;
+        }
+    FileUtils::deleteDirectory(Support::temppath("tile-ref"));
+}
+
+// The spill directory is removed when writing the tiles fails.
+TEST(Tile, bucketedError)
+{
+    std::string spillDir(Support::temppath("tile-spill"));
+    FileUtils::deleteDirectory(spillDir);
+    FileUtils::createDirectory(spillDir);
+    FileUtils::deleteDirectory(Support::temppath("tile-missing"));
+
+    std::string output;
+    std::string cmd = Support::binpath("pdal") + " tile \"" +
+        Support::datapath("text/file*.txt") + "\" \"" +
+        Support::temppath("tile-missing/out#.txt") +
+        "\" --origin_x=0 --origin_y=0 --length=10 --bucketed "
+        "--spill_dir=\"" + spillDir + "\"";
+    EXPECT_NE(Utils::run_shell_command(cmd, output), 0);
+    EXPECT_EQ(FileUtils::directoryList(spillDir).size(), 0U);
+    FileUtils::deleteDirectory(spillDir);
+}
+
 TEST(Tile, test2)
 {
     std::string output;
@@ -36,6 +36,9 @@
 
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/private/ThreadBudget.hpp>
+#include <io/FauxReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 
 #include "Support.hpp"
 
@@ -191,3 +194,108 @@ TEST(AssignFilterTest, test_condition)
     EXPECT_EQ(v->size(), 10u);
     EXPECT_EQ(ielse, 7);
 }
+
+// Assigning to whole stream chunks must match assigning in standard mode.
+TEST(AssignFilterTest, stream)
+{
+    StageFactory factory;
+
+    Options ro;
+    ro.add("filename", Support::datapath("las/utm17.las"));
+
+    Options fo;
+    fo.add("assignment", "Classification[:]=2");
+    fo.add("value", "PointSourceId = 6 where intensity == 260");
+    fo.add("value", "UserData = Intensity / 20");
+    fo.add("condition", "Intensity[250:300]");
+
+    Stage& r1 = *factory.createStage("readers.las");
+    r1.setOptions(ro);
+    Stage& f1 = *factory.createStage("filters.assign");
+    f1.setInput(r1);
+    f1.setOptions(fo);
+
+    PointTable t1;
+    f1.prepare(t1);
+    PointViewPtr v = *f1.execute(t1).begin();
+
+    Stage& r2 = *factory.createStage("readers.las");
+    r2.setOptions(ro);
+    Stage& f2 = *factory.createStage("filters.assign");
+    f2.setInput(r2);
+    f2.setOptions(fo);
+    StreamCallbackFilter c;
+    c.setInput(f2);
+
+    using namespace Dimension;
+
+    PointId i = 0;
+    int i6 = 0;
+    c.setCallback([&v, &i, &i6](PointRef& point)
+    {
+        for (Id id : { Id::Classification, Id::PointSourceId, Id::UserData })
+            EXPECT_EQ(point.getFieldAs<int>(id), v->getFieldAs<int>(id, i));
+        if (point.getFieldAs<int>(Id::PointSourceId) == 6)
+            i6++;
+        i++;
+        return true;
+    });
+
+    FixedPointTable t2(4);
+    c.prepare(t2);
+    c.execute(t2);
+    EXPECT_EQ(i, 10u);
+    EXPECT_EQ(i6, 3);
+}
+
+// Large chunks are split among threads.
+TEST(AssignFilterTest, streamThreads)
+{
+    using namespace Dimension;
+
+    ThreadBudget budget(3);
+    ThreadBudget::Scope scope(&budget);
+
+    const point_count_t count(50000);
+    Options ro;
+    ro.add("mode", "ramp");
+    ro.add("count", count);
+    ro.add("bounds", BOX3D(0, 0, 0, count - 1, count - 1, count - 1));
+
+    Options fo;
+    fo.add("assignment", "OffsetTime[:]=2");
+    fo.add("value", "Y = 7 where X >= 25000");
+    fo.add("value", "Z = X / 10");
+    fo.add("condition", "X[0:40000]");
+
+    FauxReader r;
+    r.setOptions(ro);
+    StageFactory factory;
+    Stage& f = *factory.createStage("filters.assign");
+    f.setInput(r);
+    f.setOptions(fo);
+    StreamCallbackFilter c;
+    c.setInput(f);
+
+    // The ramp sets X, Y, Z and OffsetTime to the point's index.
+    PointId i = 0;
+    c.setCallback([&i](PointRef& point)
+    {
+        bool selected = (i <= 40000);
+        EXPECT_EQ(point.getFieldAs<PointId>(Id::OffsetTime),
+            selected ? 2 : i);
+        EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::X), i);
+        EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::Y),
+            selected && i >= 25000 ? 7 : i);
+        EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::Z),
+            selected ? i / 10.0 : i);
+        i++;
+        return true;
+    });
+
+    FixedPointTable t(20000);
+    c.prepare(t);
+    c.execute(t);
+    EXPECT_EQ(i, count);
+    EXPECT_EQ(budget.acquire(10), 3u);
+}
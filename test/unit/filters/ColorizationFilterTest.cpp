@@ -35,6 +35,9 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/private/gdal/Raster.hpp>
+#include <pdal/private/gdal/RasterSampler.hpp>
 #include <io/LasReader.hpp>
 #include <filters/ColorizationFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
@@ -187,4 +190,151 @@ TEST(ColorizationFilterTest, test4)
     EXPECT_THROW(testFile(options, dims, 210, 205, 47175), pdal_error);
 }
 
+// Sampling blocks of positions from cached raster blocks must match
+// reading the raster one position at a time.
+TEST(ColorizationFilterTest, sampler)
+{
+    using namespace gdal;
+
+    const std::string filename(Support::datapath("autzen/autzen.jpg"));
+    gdal::Raster raster(filename);
+    raster.open();
+
+    // A small cache forces blocks to be evicted and read again.
+    RasterSampler nearest(filename, RasterSampler::Method::Nearest, 1);
+    nearest.open();
+    RasterSampler bilinear(filename, RasterSampler::Method::Bilinear);
+    bilinear.open();
+
+    // Positions in a grid that extends past the raster on every side.
+    BOX2D b = raster.bounds();
+    std::vector<double> x;
+    std::vector<double> y;
+    for (int i = -5; i < 105; ++i)
+        for (int j = -5; j < 105; ++j)
+        {
+            x.push_back(b.minx + (b.maxx - b.minx) * i / 100.0);
+            y.push_back(b.miny + (b.maxy - b.miny) * j / 100.0);
+        }
+
+    const std::vector<int> bands { 3, 1 };
+    std::vector<double> values(x.size() * bands.size());
+    std::vector<double> smooth(x.size() * bands.size());
+    std::vector<char> found(x.size());
+    std::vector<char> smoothFound(x.size());
+    EXPECT_EQ(nearest.sample(x.size(), x.data(), y.data(), bands,
+        values.data(), found.data()), GDALError::None);
+    EXPECT_EQ(bilinear.sample(x.size(), x.data(), y.data(), bands,
+        smooth.data(), smoothFound.data()), GDALError::None);
+
+    size_t count = 0;
+    std::vector<double> data;
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        bool inside = (raster.read(x[i], y[i], data) == GDALError::None);
+        EXPECT_EQ((bool)found[i], inside);
+        EXPECT_EQ(found[i], smoothFound[i]);
+        if (!inside)
+            continue;
+        count++;
+        EXPECT_EQ(values[i * 2], data[2]);
+        EXPECT_EQ(values[i * 2 + 1], data[0]);
+        EXPECT_GE(smooth[i * 2], 0);
+        EXPECT_LE(smooth[i * 2], 255);
+    }
+    EXPECT_GT(count, 0u);
+
+    std::vector<int> badBand { 4 };
+    EXPECT_EQ(nearest.sample(x.size(), x.data(), y.data(), badBand,
+        values.data(), found.data()), GDALError::InvalidBand);
+}
+
+// Check sampled values against a small raster with known cell values.
+TEST(ColorizationFilterTest, samplerValues)
+{
+    using namespace gdal;
+
+    const std::string filename(Support::temppath("sampler.tif"));
+    FileUtils::deleteFile(filename);
+
+    // Four columns, three rows of unit cells with the top-left corner at
+    // (0, 3).  Cell (column, row) holds 10 * column + row, except that
+    // cell (2, 1) holds no data.
+    const double noData = -9999;
+    std::vector<double> data;
+    for (int row = 0; row < 3; ++row)
+        for (int col = 0; col < 4; ++col)
+            data.push_back(10 * col + row);
+    data[1 * 4 + 2] = noData;
+    {
+        std::array<double, 6> pixelToPos { 0, 1, 0, 3, 0, -1 };
+        gdal::Raster raster(filename, "GTiff", SpatialReference(), pixelToPos);
+        EXPECT_EQ(raster.open(4, 3, 1, Dimension::Type::Double, noData),
+            GDALError::None);
+        EXPECT_EQ(raster.writeBand(data.data(), noData, 1), GDALError::None);
+    }
+
+    RasterSampler nearest(filename, RasterSampler::Method::Nearest);
+    nearest.open();
+    RasterSampler bilinear(filename, RasterSampler::Method::Bilinear);
+    bilinear.open();
+
+    // Between the centers of cells (0, 0) and (1, 1), near the left edge
+    // and next to the no-data cell.
+    std::vector<double> x { 1.25, .2, 1.75 };
+    std::vector<double> y { 1.75, 2.2, 1.75 };
+    const std::vector<int> bands { 1 };
+    std::vector<double> values(x.size());
+    std::vector<double> smooth(x.size());
+    std::vector<char> found(x.size());
+    EXPECT_EQ(nearest.sample(x.size(), x.data(), y.data(), bands,
+        values.data(), found.data()), GDALError::None);
+    EXPECT_EQ(bilinear.sample(x.size(), x.data(), y.data(), bands,
+        smooth.data(), found.data()), GDALError::None);
+    for (char f : found)
+        EXPECT_TRUE(f);
+
+    EXPECT_EQ(values[0], 11);
+    EXPECT_EQ(values[1], 0);
+    EXPECT_EQ(values[2], 11);
+
+    // Inside the raster the cells are a plane, so interpolation is exact.
+    EXPECT_DOUBLE_EQ(smooth[0], 8.25);
+    // Columns past the left edge are replaced by the edge column.
+    EXPECT_NEAR(smooth[1], .3, 1e-12);
+    // A neighbor holds no data, so the nearest cell is used.
+    EXPECT_EQ(smooth[2], 11);
+
+    FileUtils::deleteFile(filename);
+}
+
+// Options that control sampling.
+TEST(ColorizationFilterTest, interpolation)
+{
+    Options readerOps;
+    readerOps.add("filename",
+        Support::datapath("autzen/autzen-point-format-3.las"));
 
+    Options options;
+    options.add("raster", Support::datapath("autzen/autzen.jpg"));
+    options.add("interpolation", "bilinear");
+    options.add("cache_size", 1);
+
+    LasReader reader;
+    reader.setOptions(readerOps);
+    ColorizationFilter filter;
+    filter.setOptions(options);
+    filter.setInput(reader);
+
+    PointTable table;
+    filter.prepare(table);
+    PointViewPtr view = *filter.execute(table).begin();
+    for (PointId i = 0; i < view->size(); ++i)
+        EXPECT_LE(view->getFieldAs<int>(Dimension::Id::Red, i), 255);
+
+    Options bad;
+    bad.add("raster", Support::datapath("autzen/autzen.jpg"));
+    bad.add("interpolation", "cubic");
+    StringList dims { "Red", "Green", "Blue" };
+    EXPECT_THROW(testFile(bad, dims, 210, 205, 185), pdal_error);
+}
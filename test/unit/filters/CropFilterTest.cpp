@@ -667,3 +667,88 @@ TEST(CropFilterTest, issue_3114)
     tst("([-122.530, -122.347], [37.695, 37.816])", 2);
     tst("([-122.530, -122.347], [37.695, 37.816], [0,500])", 1);
 }
+
+// Crop a grid of points with many polygons, which uses the polygon
+// index and tests blocks of points that are entirely inside or outside
+// of a polygon at once.
+TEST(CropFilterTest, manyPolygons)
+{
+    // 200 x 200 points with integer coordinates.
+    Options readerOpts;
+    readerOpts.add("bounds", BOX3D(0.0, 0.0, 0.0, 200.0, 200.0, 0.0));
+    readerOpts.add("mode", "grid");
+
+    // 100 squares, each containing 100 points.
+    Options cropOpts;
+    for (int i = 0; i < 10; ++i)
+        for (int j = 0; j < 10; ++j)
+        {
+            double x = i * 20 + 2.5;
+            double y = j * 20 + 2.5;
+            BOX2D b(x, y, x + 10, y + 10);
+            cropOpts.add("polygon", Polygon(b).wkt());
+        }
+
+    auto run = [&readerOpts](const Options& cropOpts, PointTable& table)
+    {
+        FauxReader reader;
+        reader.setOptions(readerOpts);
+        CropFilter crop;
+        crop.setOptions(cropOpts);
+        crop.setInput(reader);
+
+        crop.prepare(table);
+        return crop.execute(table);
+    };
+
+    PointTable t1;
+    PointViewSet s = run(cropOpts, t1);
+    EXPECT_EQ(s.size(), 100U);
+    for (const PointViewPtr& v : s)
+    {
+        ASSERT_EQ(v->size(), 100U);
+        double x = v->getFieldAs<double>(Dimension::Id::X, 0);
+        double y = v->getFieldAs<double>(Dimension::Id::Y, 0);
+        EXPECT_EQ((int)x % 20, 3);
+        EXPECT_EQ((int)y % 20, 3);
+    }
+
+    // A polygon that covers all the points.
+    Options allOpts;
+    allOpts.add("polygon", Polygon(BOX2D(-.5, -.5, 199.5, 199.5)).wkt());
+    PointTable t2;
+    s = run(allOpts, t2);
+    ASSERT_EQ(s.size(), 1U);
+    EXPECT_EQ((*s.begin())->size(), 40000U);
+
+    allOpts.add("outside", true);
+    PointTable t3;
+    s = run(allOpts, t3);
+    ASSERT_EQ(s.size(), 1U);
+    EXPECT_EQ((*s.begin())->size(), 0U);
+
+    // A single square, keeping the points outside it.
+    Options outsideOpts;
+    outsideOpts.add("polygon", Polygon(BOX2D(2.5, 2.5, 12.5, 12.5)).wkt());
+    outsideOpts.add("outside", true);
+    PointTable t4;
+    s = run(outsideOpts, t4);
+    ASSERT_EQ(s.size(), 1U);
+    EXPECT_EQ((*s.begin())->size(), 39900U);
+
+    // Streaming keeps each point that is in any of the polygons.
+    point_count_t count = 0;
+    FauxReader reader;
+    reader.setOptions(readerOpts);
+    CropFilter crop;
+    crop.setOptions(cropOpts);
+    crop.setInput(reader);
+    StreamCallbackFilter f;
+    f.setCallback([&count](PointRef&){ count++; return true; });
+    f.setInput(crop);
+
+    FixedPointTable streamTable(1000);
+    f.prepare(streamTable);
+    f.execute(streamTable);
+    EXPECT_EQ(count, 10000U);
+}
@@ -0,0 +1,178 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <random>
+
+#include <pdal/KDIndex.hpp>
+#include <pdal/StageFactory.hpp>
+#include <io/BufferReader.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Straightforward DBSCAN that expands one cluster at a time.
+std::vector<int64_t> reference(PointView& view, const Dimension::IdList& dims,
+    double eps, uint64_t minPoints)
+{
+    KDFlexIndex index(view, dims);
+    index.build();
+
+    std::vector<int64_t> labels(view.size(), -2);
+    int64_t label = 0;
+    for (PointId idx = 0; idx < view.size(); ++idx)
+    {
+        if (labels[idx] != -2)
+            continue;
+        PointIdList neighbors = index.radius(idx, eps);
+        if (neighbors.size() < minPoints)
+        {
+            labels[idx] = -1;
+            continue;
+        }
+
+        std::vector<PointId> next(neighbors.begin(), neighbors.end());
+        labels[idx] = label;
+        while (next.size())
+        {
+            PointId p = next.back();
+            next.pop_back();
+            if (labels[p] == -1)
+                labels[p] = label;
+            if (labels[p] != -2)
+                continue;
+            labels[p] = label;
+            neighbors = index.radius(p, eps);
+            if (neighbors.size() >= minPoints)
+                next.insert(next.end(), neighbors.begin(), neighbors.end());
+        }
+        label++;
+    }
+    return labels;
+}
+
+} // unnamed namespace
+
+// Compare labels with a simple implementation for clumps of points of
+// varying density, in two and three dimensions.
+TEST(DBSCANFilterTest, reference)
+{
+    using namespace Dimension;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> uniform(0, 100);
+    std::vector<double> pos;
+    for (int clump = 0; clump < 40; ++clump)
+    {
+        std::normal_distribution<double> spread(0, 0.5 + clump % 4);
+        double cx = uniform(gen);
+        double cy = uniform(gen);
+        double cz = uniform(gen) / 10;
+        for (int i = 0; i < 1000; ++i)
+        {
+            pos.push_back(cx + spread(gen));
+            pos.push_back(cy + spread(gen));
+            pos.push_back(cz + spread(gen));
+        }
+    }
+    for (int i = 0; i < 10000; ++i)
+    {
+        pos.push_back(uniform(gen));
+        pos.push_back(uniform(gen));
+        pos.push_back(uniform(gen) / 10);
+    }
+
+    auto test = [&pos](const std::string& dims, double eps,
+        uint64_t minPoints)
+    {
+        PointTable table;
+        table.layout()->registerDims({ Id::X, Id::Y, Id::Z, Id::ClusterID });
+        PointViewPtr input(new PointView(table));
+        for (PointId i = 0; i < pos.size() / 3; ++i)
+        {
+            input->setField(Id::X, i, pos[3 * i]);
+            input->setField(Id::Y, i, pos[3 * i + 1]);
+            input->setField(Id::Z, i, pos[3 * i + 2]);
+        }
+
+        BufferReader reader;
+        reader.addView(input);
+
+        StageFactory factory;
+        Stage *filter = factory.createStage("filters.dbscan");
+        Options opts;
+        opts.add("dimensions", dims);
+        opts.add("eps", eps);
+        opts.add("min_points", minPoints);
+        filter->setOptions(opts);
+        filter->setInput(reader);
+        filter->prepare(table);
+        PointViewSet s = filter->execute(table);
+        ASSERT_EQ(s.size(), 1U);
+        PointViewPtr v = *s.begin();
+
+        Dimension::IdList ids;
+        for (const std::string& name : Utils::split(dims, ','))
+            ids.push_back(table.layout()->findDim(name));
+        std::vector<int64_t> expected = reference(*v, ids, eps, minPoints);
+
+        size_t mismatches = 0;
+        for (PointId i = 0; i < v->size(); ++i)
+            if (v->getFieldAs<int64_t>(Id::ClusterID, i) != expected[i])
+                mismatches++;
+        EXPECT_EQ(mismatches, 0U) << dims << " " << eps << " " << minPoints;
+    };
+
+    test("X,Y,Z", 1.0, 6);
+    test("X,Y,Z", 0.3, 4);
+    test("X,Y", 0.5, 10);
+    test("X", 0.01, 3);
+    test("X,Y,Z", 2.0, 1);
+}
+
+TEST(DBSCANFilterTest, badEps)
+{
+    StageFactory factory;
+    Stage *filter = factory.createStage("filters.dbscan");
+    Options opts;
+    opts.add("eps", 0);
+    filter->setOptions(opts);
+
+    PointTable table;
+    EXPECT_THROW(filter->prepare(table), pdal_error);
+}
@@ -0,0 +1,158 @@
+/******************************************************************************
+* Copyright (c) 2020, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/StageFactory.hpp>
+#include <pdal/private/gdal/Raster.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+
+#include "Support.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+// Write a DEM of four columns and three rows of unit cells with the
+// top-left corner at (0, 3).  Cell (column, row) holds 10 * column + row.
+void writeDem(const std::string& filename)
+{
+    std::vector<double> data;
+    for (int row = 0; row < 3; ++row)
+        for (int col = 0; col < 4; ++col)
+            data.push_back(10 * col + row);
+
+    std::array<double, 6> pixelToPos { 0, 1, 0, 3, 0, -1 };
+    gdal::Raster raster(filename, "GTiff", SpatialReference(), pixelToPos);
+    EXPECT_EQ(raster.open(4, 3, 1, Dimension::Type::Double, -9999),
+        gdal::GDALError::None);
+    EXPECT_EQ(raster.writeBand(data.data(), -9999.0, 1),
+        gdal::GDALError::None);
+}
+
+} // unnamed namespace
+
+// Stream mode samples the raster a chunk at a time and must keep the
+// same points as standard mode.
+TEST(DEMFilterTest, stream)
+{
+    using namespace Dimension;
+
+    const std::string filename(Support::temppath("dem.tif"));
+    FileUtils::deleteFile(filename);
+    writeDem(filename);
+
+    // Points outside of the DEM are dropped.
+    Options ro;
+    ro.add("mode", "uniform");
+    ro.add("seed", 1);
+    ro.add("count", 1000);
+    ro.add("bounds", "([-1, 5], [-1, 4], [0, 40])");
+
+    Options fo;
+    fo.add("raster", filename);
+    fo.add("limits", "Z[5:10]");
+
+    auto passes = [](PointRef& point)
+    {
+        double x = point.getFieldAs<double>(Id::X);
+        double y = point.getFieldAs<double>(Id::Y);
+        if (x < 0 || x >= 4 || y <= 0 || y > 3)
+            return false;
+        double v = 10 * std::floor(x) + std::floor(3 - y);
+        double z = point.getFieldAs<double>(Id::Z);
+        return z >= v - 5 && z <= v + 10;
+    };
+
+    StageFactory factory;
+    size_t expected = 0;
+    {
+        Stage& r = *(factory.createStage("readers.faux"));
+        r.setOptions(ro);
+
+        PointTable t;
+        r.prepare(t);
+        PointViewPtr v = *r.execute(t).begin();
+        for (PointRef point : *v)
+            if (passes(point))
+                expected++;
+    }
+    EXPECT_GT(expected, 0u);
+    EXPECT_LT(expected, 1000u);
+
+    {
+        Stage& r = *(factory.createStage("readers.faux"));
+        r.setOptions(ro);
+        Stage& f = *(factory.createStage("filters.dem"));
+        f.setInput(r);
+        f.setOptions(fo);
+
+        PointTable t;
+        f.prepare(t);
+        PointViewPtr v = *f.execute(t).begin();
+        EXPECT_EQ(v->size(), expected);
+        for (PointRef point : *v)
+            EXPECT_TRUE(passes(point));
+    }
+
+    {
+        Stage& r = *(factory.createStage("readers.faux"));
+        r.setOptions(ro);
+        Stage& f = *(factory.createStage("filters.dem"));
+        f.setInput(r);
+        f.setOptions(fo);
+
+        size_t count = 0;
+        StreamCallbackFilter s;
+        s.setCallback([&count, &passes](PointRef& point)
+        {
+            EXPECT_TRUE(passes(point));
+            count++;
+            return true;
+        });
+        s.setInput(f);
+
+        FixedPointTable t(100);
+        s.prepare(t);
+        s.execute(t);
+        EXPECT_EQ(count, expected);
+    }
+
+    FileUtils::deleteFile(filename);
+}
+
+} // namespace pdal
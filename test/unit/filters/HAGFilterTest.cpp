@@ -35,6 +35,9 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/StageFactory.hpp>
+#include <pdal/private/gdal/Raster.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 
 #include "Support.hpp"
 
@@ -190,6 +193,100 @@ TEST(HAGFilterTest, closest)
             check(4, 4, 20, 16);
     }
 }
+namespace
+{
+
+// Write a DEM of four columns and three rows of unit cells with the
+// top-left corner at (0, 3).  Cell (column, row) holds 10 * column + row.
+void writeDem(const std::string& filename)
+{
+    std::vector<double> data;
+    for (int row = 0; row < 3; ++row)
+        for (int col = 0; col < 4; ++col)
+            data.push_back(10 * col + row);
+
+    std::array<double, 6> pixelToPos { 0, 1, 0, 3, 0, -1 };
+    gdal::Raster raster(filename, "GTiff", SpatialReference(), pixelToPos);
+    EXPECT_EQ(raster.open(4, 3, 1, Dimension::Type::Double, -9999),
+        gdal::GDALError::None);
+    EXPECT_EQ(raster.writeBand(data.data(), -9999.0, 1),
+        gdal::GDALError::None);
+}
+
+} // unnamed namespace
+
+// Stream mode samples the raster a chunk at a time and must match
+// standard mode.
+TEST(HAGFilterTest, dem)
+{
+    using namespace Dimension;
+
+    const std::string filename(Support::temppath("hag_dem.tif"));
+    FileUtils::deleteFile(filename);
+    writeDem(filename);
+
+    // Some points fall outside of the DEM.  Their HAG isn't set.
+    Options ro;
+    ro.add("mode", "uniform");
+    ro.add("seed", 1);
+    ro.add("count", 1000);
+    ro.add("bounds", "([-1, 5], [-1, 4], [0, 100])");
+
+    Options fo;
+    fo.add("raster", filename);
+    fo.add("zero_ground", false);
+
+    size_t count = 0;
+    auto check = [&count](PointRef& point)
+    {
+        double x = point.getFieldAs<double>(Id::X);
+        double y = point.getFieldAs<double>(Id::Y);
+        if (x < 0 || x >= 4 || y <= 0 || y > 3)
+            return true;
+        double v = 10 * std::floor(x) + std::floor(3 - y);
+        EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::HeightAboveGround),
+            point.getFieldAs<double>(Id::Z) - v);
+        count++;
+        return true;
+    };
+
+    StageFactory factory;
+    {
+        Stage& r = *(factory.createStage("readers.faux"));
+        r.setOptions(ro);
+        Stage& f = *(factory.createStage("filters.hag_dem"));
+        f.setInput(r);
+        f.setOptions(fo);
+
+        PointTable t;
+        f.prepare(t);
+        PointViewPtr v = *f.execute(t).begin();
+        EXPECT_EQ(v->size(), 1000u);
+        for (PointRef point : *v)
+            check(point);
+    }
+    size_t inside = count;
+    EXPECT_GT(inside, 0u);
+
+    count = 0;
+    {
+        Stage& r = *(factory.createStage("readers.faux"));
+        r.setOptions(ro);
+        Stage& f = *(factory.createStage("filters.hag_dem"));
+        f.setInput(r);
+        f.setOptions(fo);
+        StreamCallbackFilter s;
+        s.setCallback(check);
+        s.setInput(f);
+
+        FixedPointTable t(100);
+        s.prepare(t);
+        s.execute(t);
+    }
+    EXPECT_EQ(count, inside);
+
+    FileUtils::deleteFile(filename);
+}
 
 // Should add tests for exact match in neighbors case and for
 // max_distance in neighbors case.
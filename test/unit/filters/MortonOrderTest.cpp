@@ -36,6 +36,7 @@
 
 #include <io/BufferReader.hpp>
 #include <filters/MortonOrderFilter.hpp>
+#include <pdal/private/PointSort.hpp>
 
 #include "Support.hpp"
 
@@ -113,3 +114,97 @@ TEST(MortonOrderTest, test_code)
     EXPECT_EQ(outView->getFieldAs<double>(Dimension::Id::X, 5), 3);
     EXPECT_EQ(outView->getFieldAs<double>(Dimension::Id::Y, 5), 2);
 }
+
+TEST(MortonOrderTest, keys)
+{
+    using namespace sorting;
+
+    EXPECT_EQ(mortonKey(1, 0), 2u);
+    EXPECT_EQ(mortonKey(0, 1), 1u);
+    EXPECT_EQ(mortonKey(3, 3), 15u);
+    EXPECT_EQ(mortonKey(1, 0, 0), 4u);
+    EXPECT_EQ(mortonKey(0, 0, 1), 1u);
+
+    // The first 4^n cells of the Hilbert curve fill the 2^n square at the
+    // origin, and consecutive cells are neighbors.
+    std::vector<std::pair<uint64_t, std::pair<int, int>>> cells;
+    for (int x = 0; x < 16; ++x)
+        for (int y = 0; y < 16; ++y)
+            cells.push_back({ hilbertKey(x, y), { x, y } });
+    std::sort(cells.begin(), cells.end());
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        EXPECT_EQ(cells[i].first, i);
+        if (i == 0)
+            continue;
+        int dx = cells[i].second.first - cells[i - 1].second.first;
+        int dy = cells[i].second.second - cells[i - 1].second.second;
+        EXPECT_EQ(std::abs(dx) + std::abs(dy), 1);
+    }
+
+    std::vector<std::pair<uint64_t, std::array<int, 3>>> cubes;
+    for (int x = 0; x < 8; ++x)
+        for (int y = 0; y < 8; ++y)
+            for (int z = 0; z < 8; ++z)
+                cubes.push_back({ hilbertKey(x, y, z), {{ x, y, z }} });
+    std::sort(cubes.begin(), cubes.end());
+    for (size_t i = 0; i < cubes.size(); ++i)
+    {
+        EXPECT_EQ(cubes[i].first, i);
+        if (i == 0)
+            continue;
+        int dist = 0;
+        for (int k = 0; k < 3; ++k)
+            dist += std::abs(cubes[i].second[k] - cubes[i - 1].second[k]);
+        EXPECT_EQ(dist, 1);
+    }
+
+    // Key order is stable.
+    std::vector<uint64_t> keys { 5, 1, 5, 0, 1, 5 };
+    PointIdList order = keyOrder(keys);
+    EXPECT_EQ(order, PointIdList({ 3, 1, 4, 0, 2, 5 }));
+}
+
+TEST(MortonOrderTest, hilbert)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+
+    PointViewPtr view(new PointView(table));
+
+    // A 2x2 grid is visited in the order of the first Hilbert cells.
+    view->setField(Dimension::Id::X, 0, 1);
+    view->setField(Dimension::Id::Y, 0, 0);
+    view->setField(Dimension::Id::X, 1, 1);
+    view->setField(Dimension::Id::Y, 1, 1);
+    view->setField(Dimension::Id::X, 2, 0);
+    view->setField(Dimension::Id::Y, 2, 1);
+    view->setField(Dimension::Id::X, 3, 0);
+    view->setField(Dimension::Id::Y, 3, 0);
+
+    BufferReader r;
+    r.addView(view);
+
+    MortonOrderFilter filter;
+    Options o;
+    o.add("curve", "hilbert");
+    filter.setInput(r);
+    filter.setOptions(o);
+
+    filter.prepare(table);
+    PointViewSet s = filter.execute(table);
+    PointViewPtr outView = *s.begin();
+
+    ASSERT_EQ(outView->size(), 4u);
+    EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::X, 0), 0);
+    EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::Y, 0), 0);
+    for (PointId i = 1; i < outView->size(); ++i)
+    {
+        int dx = outView->getFieldAs<int>(Dimension::Id::X, i) -
+            outView->getFieldAs<int>(Dimension::Id::X, i - 1);
+        int dy = outView->getFieldAs<int>(Dimension::Id::Y, i) -
+            outView->getFieldAs<int>(Dimension::Id::Y, i - 1);
+        EXPECT_EQ(std::abs(dx) + std::abs(dy), 1);
+    }
+}
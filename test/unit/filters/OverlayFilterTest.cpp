@@ -34,8 +34,13 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <fstream>
+#include <random>
+
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <io/FauxReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 
 #include "Support.hpp"
 
@@ -162,3 +167,108 @@ TEST(OverlayFilterTest, stream)
 {
     testOverlay(10, true);
 }
+
+// With many overlapping polygons, each point gets the value of the first
+// polygon in datasource order that contains it, as when every polygon was
+// tested in turn.
+TEST(OverlayFilterTest, overlapping)
+{
+    struct Square
+    {
+        double x, y, size;
+    };
+
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> corner(-10, 75);
+    std::uniform_int_distribution<int> size(2, 30);
+    std::vector<Square> squares;
+    for (int i = 0; i < 300; ++i)
+        squares.push_back({ corner(gen) + .5, corner(gen) + .5,
+            (double)size(gen) });
+
+    std::string filename(Support::temppath("overlapping.geojson"));
+    {
+        std::ofstream out(filename);
+        out << "{ \"type\": \"FeatureCollection\", \"features\": [";
+        for (size_t i = 0; i < squares.size(); ++i)
+        {
+            const Square& sq = squares[i];
+            double x1 = sq.x + sq.size;
+            double y1 = sq.y + sq.size;
+            out << (i ? "," : "") << "{ \"type\": \"Feature\", "
+                "\"properties\": { \"cls\": " << (i + 1) << " }, "
+                "\"geometry\": { \"type\": \"Polygon\", "
+                "\"coordinates\": [[[" << sq.x << "," << sq.y << "],[" <<
+                x1 << "," << sq.y << "],[" << x1 << "," << y1 << "],[" <<
+                sq.x << "," << y1 << "],[" << sq.x << "," << sq.y <<
+                "]]] } }";
+        }
+        out << "] }";
+    }
+
+    // Points are at integer coordinates and polygon edges at halves, so
+    // no point is on an edge.
+    auto expected = [&squares](double x, double y)
+    {
+        for (size_t i = 0; i < squares.size(); ++i)
+        {
+            const Square& sq = squares[i];
+            if (x > sq.x && x < sq.x + sq.size &&
+                    y > sq.y && y < sq.y + sq.size)
+                return (int)(i + 1);
+        }
+        return 0;
+    };
+
+    Options ro;
+    ro.add("mode", "grid");
+    ro.add("bounds", BOX3D(0, 0, 0, 80, 80, 0));
+
+    Options fo;
+    fo.add("dimension", "Z");
+    fo.add("column", "cls");
+    fo.add("datasource", filename);
+
+    StageFactory factory;
+    for (bool stream : { false, true })
+    {
+        FauxReader r;
+        r.setOptions(ro);
+        Stage& f = *factory.createStage("filters.overlay");
+        f.setInput(r);
+        f.setOptions(fo);
+
+        StreamCallbackFilter c;
+        c.setInput(f);
+        point_count_t count = 0;
+        int assigned = 0;
+        c.setCallback([&](PointRef& point)
+        {
+            double x = point.getFieldAs<double>(Dimension::Id::X);
+            double y = point.getFieldAs<double>(Dimension::Id::Y);
+            int z = point.getFieldAs<int>(Dimension::Id::Z);
+            EXPECT_EQ(z, expected(x, y)) << x << ", " << y;
+            if (z)
+                assigned++;
+            count++;
+            return true;
+        });
+
+        if (stream)
+        {
+            FixedPointTable t(1000);
+            c.prepare(t);
+            c.execute(t);
+        }
+        else
+        {
+            PointTable t;
+            c.prepare(t);
+            c.execute(t);
+        }
+        EXPECT_EQ(count, 6400u);
+        // Most points are covered by more than one polygon.
+        EXPECT_GT(assigned, 5000);
+    }
+    FileUtils::deleteFile(filename);
+}
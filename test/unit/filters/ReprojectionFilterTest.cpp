@@ -36,6 +36,10 @@
 
 #include <pdal/SpatialReference.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/private/SrsTransform.hpp>
+#include <pdal/private/ThreadBudget.hpp>
+#include <io/BufferReader.hpp>
+#include <io/FauxReader.hpp>
 #include <io/LasReader.hpp>
 #include <filters/ReprojectionFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
@@ -227,3 +231,137 @@ TEST(ReprojectionFilterTest, stream_test_2)
     f.prepare(table3);
     f.execute(table3);
 }
+
+namespace
+{
+
+// Reprojecting in batches across threads must match reprojecting one point
+// at a time.
+void checkBatch(PointTableRef table)
+{
+    using namespace Dimension;
+
+    const SpatialReference inSrs("EPSG:26915");
+    const SpatialReference outSrs("EPSG:4326");
+
+    table.layout()->registerDims({ Id::X, Id::Y, Id::Z });
+    table.finalize();
+    PointViewPtr view(new PointView(table, inSrs));
+    const point_count_t count(100000);
+    for (PointId i = 0; i < count; ++i)
+    {
+        view->setField(Id::X, i, 400000 + (i % 1000) * 50.0);
+        view->setField(Id::Y, i, 4500000 + (i / 1000) * 500.0);
+        view->setField(Id::Z, i, (double)(i % 100));
+    }
+
+    BufferReader reader;
+    reader.addView(view);
+
+    Options options;
+    options.add("out_srs", outSrs.getWKT());
+    ReprojectionFilter filter;
+    filter.setOptions(options);
+    filter.setInput(reader);
+
+    filter.prepare(table);
+    PointViewSet viewSet = filter.execute(table);
+    ASSERT_EQ(viewSet.size(), 1u);
+    PointViewPtr out = *viewSet.begin();
+    ASSERT_EQ(out->size(), count);
+
+    SrsTransform xform(inSrs, outSrs);
+    for (PointId i = 0; i < count; ++i)
+    {
+        double x = 400000 + (i % 1000) * 50.0;
+        double y = 4500000 + (i / 1000) * 500.0;
+        double z = (double)(i % 100);
+        ASSERT_TRUE(xform.transform(x, y, z));
+        ASSERT_DOUBLE_EQ(out->getFieldAs<double>(Id::X, i), x);
+        ASSERT_DOUBLE_EQ(out->getFieldAs<double>(Id::Y, i), y);
+        ASSERT_DOUBLE_EQ(out->getFieldAs<double>(Id::Z, i), z);
+    }
+}
+
+// Reprojecting stream chunks must match reprojecting one point at a time.
+void checkStream()
+{
+    using namespace Dimension;
+
+    Options ro;
+    ro.add("mode", "ramp");
+    ro.add("count", 50000);
+    ro.add("bounds", "([400000, 450000], [4500000, 4550000], [0, 100])");
+
+    Options fo;
+    fo.add("in_srs", "EPSG:26915");
+    fo.add("out_srs", "EPSG:4326");
+
+    FauxReader source;
+    source.setOptions(ro);
+    PointTable sourceTable;
+    source.prepare(sourceTable);
+    PointViewPtr in = *source.execute(sourceTable).begin();
+
+    FauxReader reader;
+    reader.setOptions(ro);
+    ReprojectionFilter filter;
+    filter.setOptions(fo);
+    filter.setInput(reader);
+
+    SrsTransform xform(SpatialReference("EPSG:26915"),
+        SpatialReference("EPSG:4326"));
+    PointId i = 0;
+    StreamCallbackFilter f;
+    f.setInput(filter);
+    f.setCallback([&](PointRef& point)
+    {
+        double x = in->getFieldAs<double>(Id::X, i);
+        double y = in->getFieldAs<double>(Id::Y, i);
+        double z = in->getFieldAs<double>(Id::Z, i);
+        EXPECT_TRUE(xform.transform(x, y, z));
+        EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::X), x);
+        EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::Y), y);
+        EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::Z), z);
+        i++;
+        return true;
+    });
+
+    FixedPointTable table(20000);
+    f.prepare(table);
+    f.execute(table);
+    EXPECT_EQ(i, 50000u);
+}
+
+} // unnamed namespace
+
+TEST(ReprojectionFilterTest, batch)
+{
+    PointTable table;
+    checkBatch(table);
+}
+
+// Column tables hand out spans that stop at block boundaries, well short
+// of the filter's batch size.
+TEST(ReprojectionFilterTest, batchColumn)
+{
+    ColumnPointTable table;
+    checkBatch(table);
+}
+
+// With threads to spare, batches are split among several workers, each
+// with its own transformation, in standard and stream mode.
+TEST(ReprojectionFilterTest, batchThreads)
+{
+    ThreadBudget budget(3);
+    ThreadBudget::Scope scope(&budget);
+
+    {
+        PointTable table;
+        checkBatch(table);
+    }
+    checkStream();
+
+    // The threads were returned.
+    EXPECT_EQ(budget.acquire(10), 3u);
+}
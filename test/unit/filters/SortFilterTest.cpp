@@ -38,6 +38,7 @@
 
 #include <pdal/PipelineManager.hpp>
 #include <pdal/StageWrapper.hpp>
+#include <pdal/private/PointSort.hpp>
 #include <io/LasReader.hpp>
 #include <io/LasWriter.hpp>
 #include <filters/SortFilter.hpp>
@@ -169,3 +170,104 @@ TEST(SortFilterTest, issue1121_simpleSortOrderDesc)
     }
 }
 
+
+TEST(SortFilterTest, multipleDimensions)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDim(Id::Classification);
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Intensity);
+    PointViewPtr view(new PointView(table));
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> cls(0, 3);
+    std::uniform_int_distribution<int> x(-5, 5);
+    const point_count_t count(10000);
+    for (PointId i = 0; i < count; ++i)
+    {
+        view->setField(Id::Classification, i, cls(generator));
+        view->setField(Id::X, i, x(generator));
+        view->setField(Id::Intensity, i, i);
+    }
+
+    Options opts;
+    opts.add("dimension", "Classification, X");
+    opts.add("order", "DESC");
+
+    SortFilter filter;
+    filter.setOptions(opts);
+    filter.prepare(table);
+    FilterWrapper::ready(filter, table);
+    FilterWrapper::filter(filter, *view.get());
+    FilterWrapper::done(filter, table);
+
+    EXPECT_EQ(count, view->size());
+    for (PointId i = 1; i < count; ++i)
+    {
+        int c1 = view->getFieldAs<int>(Id::Classification, i - 1);
+        int c2 = view->getFieldAs<int>(Id::Classification, i);
+        double x1 = view->getFieldAs<double>(Id::X, i - 1);
+        double x2 = view->getFieldAs<double>(Id::X, i);
+        EXPECT_GE(c1, c2);
+        if (c1 != c2)
+            continue;
+        EXPECT_GE(x1, x2);
+        // Equal points keep their original order.
+        if (x1 == x2)
+            EXPECT_LT(view->getFieldAs<int>(Id::Intensity, i - 1),
+                view->getFieldAs<int>(Id::Intensity, i));
+    }
+}
+
+// Column tables hand out spans that stop at block boundaries.  Splitting
+// the work among threads makes chunks that don't start on a boundary.
+TEST(SortFilterTest, columnTable)
+{
+    using namespace Dimension;
+
+    ColumnPointTable table;
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Y);
+    table.layout()->registerDim(Id::Z);
+    table.finalize();
+    PointViewPtr view(new PointView(table));
+
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> dist(0.0, 1000.0);
+    const point_count_t count(100000);
+    for (PointId i = 0; i < count; ++i)
+    {
+        view->setField(Id::X, i, dist(generator));
+        view->setField(Id::Y, i, dist(generator));
+        view->setField(Id::Z, i, dist(generator));
+    }
+
+    PointIdList order = sorting::dimensionOrder(*view, { Id::X }, false, 3);
+    ASSERT_EQ(order.size(), count);
+    for (PointId i = 1; i < count; ++i)
+        EXPECT_LE(view->getFieldAs<double>(Id::X, order[i - 1]),
+            view->getFieldAs<double>(Id::X, order[i]));
+    EXPECT_EQ(order, sorting::dimensionOrder(*view, { Id::X }, false, 1));
+
+    order = sorting::curveOrder(*view, sorting::Curve::Morton, true, 3);
+    EXPECT_EQ(order,
+        sorting::curveOrder(*view, sorting::Curve::Morton, true, 1));
+
+    view->reorder(order);
+    EXPECT_EQ(view->size(), count);
+}
+
+TEST(SortFilterTest, badDimension)
+{
+    Options opts;
+    opts.add("dimension", "X,Foo");
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+
+    SortFilter filter;
+    filter.setOptions(opts);
+    EXPECT_THROW(filter.prepare(table), pdal_error);
+}
@@ -262,6 +262,56 @@ TEST(Stats, stream)
 }
 
 
+// Stream chunks are summarized a dimension per thread.  The results must
+// match inserting the values one at a time.
+TEST(Stats, streamChunks)
+{
+    using namespace Dimension;
+
+    Options ops;
+    ops.add("bounds", BOX3D(0, 0, 0, 1000, 1000, 1000));
+    ops.add("count", 50000);
+    ops.add("mode", "uniform");
+    ops.add("seed", 3);
+
+    std::map<Id, stats::Summary> expected;
+    for (Id id : { Id::X, Id::Y, Id::Z })
+        expected.emplace(id, stats::Summary("", stats::Summary::NoEnum));
+    {
+        FauxReader reader;
+        reader.setOptions(ops);
+        PointTable table;
+        reader.prepare(table);
+        PointViewPtr view = *reader.execute(table).begin();
+        for (PointId idx = 0; idx < view->size(); ++idx)
+            for (auto& p : expected)
+                p.second.insert(view->getFieldAs<double>(p.first, idx));
+    }
+
+    FauxReader reader;
+    reader.setOptions(ops);
+    StatsFilter filter;
+    Options fo;
+    fo.add("advanced", true);
+    filter.setOptions(fo);
+    filter.setInput(reader);
+
+    FixedPointTable table(10000);
+    filter.prepare(table);
+    filter.execute(table);
+
+    for (auto& p : expected)
+    {
+        const stats::Summary& s = filter.getStats(p.first);
+        EXPECT_EQ(s.count(), 50000u);
+        EXPECT_EQ(s.minimum(), p.second.minimum());
+        EXPECT_EQ(s.maximum(), p.second.maximum());
+        EXPECT_EQ(s.average(), p.second.average());
+        EXPECT_EQ(s.sampleVariance(), p.second.sampleVariance());
+        EXPECT_EQ(s.sampleSkewness(), p.second.sampleSkewness());
+    }
+}
+
 TEST(Stats, dimset)
 {
     BOX3D bounds(1.0, 2.0, 3.0, 101.0, 102.0, 103.0);
@@ -435,3 +485,116 @@ TEST(Stats, global)
 	EXPECT_DOUBLE_EQ(statsZ.maximum(), 1000.0);
 
 }
+
+TEST(Stats, merge)
+{
+    using namespace stats;
+
+    Summary whole("X", Summary::Count, true);
+    Summary first("X", Summary::Count, true);
+    Summary second("X", Summary::Count, true);
+    for (int i = 0; i < 1000; ++i)
+    {
+        double d = std::sin(i) * 100 + (i % 10) * (i % 10);
+        whole.insert(d);
+        if (i < 300)
+            first.insert(d);
+        else
+            second.insert(d);
+    }
+    first.merge(second);
+
+    EXPECT_EQ(first.count(), whole.count());
+    EXPECT_DOUBLE_EQ(first.minimum(), whole.minimum());
+    EXPECT_DOUBLE_EQ(first.maximum(), whole.maximum());
+    EXPECT_NEAR(first.average(), whole.average(), 1e-9);
+    EXPECT_NEAR(first.sampleVariance(), whole.sampleVariance(), 1e-6);
+    EXPECT_NEAR(first.sampleSkewness(), whole.sampleSkewness(), 1e-9);
+    EXPECT_NEAR(first.sampleExcessKurtosis(), whole.sampleExcessKurtosis(),
+        1e-9);
+    EXPECT_EQ(first.values(), whole.values());
+}
+
+TEST(Stats, sketch)
+{
+    using namespace stats;
+
+    // Insert 0 - 99999 in a scrambled order, split between two sketches.
+    QuantileSketch q1;
+    QuantileSketch q2;
+    DistinctSketch d1;
+    DistinctSketch d2;
+    const int count = 100000;
+    for (int i = 0; i < count; ++i)
+    {
+        double v = (double)((i * 7919) % count);
+        if (i % 3)
+        {
+            q1.insert(v);
+            d1.insert(v);
+        }
+        else
+        {
+            q2.insert(v);
+            d2.insert(v);
+            d2.insert(v);
+        }
+    }
+    q1.merge(q2);
+    d1.merge(d2);
+
+    EXPECT_EQ(q1.count(), (point_count_t)count);
+    EXPECT_LT(q1.size(), 1000U);
+    EXPECT_NEAR(q1.quantile(.5), count / 2, count * .002);
+    EXPECT_NEAR(q1.quantile(.01), count / 100, count * .0005);
+    EXPECT_NEAR(q1.quantile(.99), count * .99, count * .0005);
+    EXPECT_DOUBLE_EQ(q1.quantile(0), 0);
+    EXPECT_DOUBLE_EQ(q1.quantile(1), count - 1);
+    EXPECT_NEAR(q1.medianDeviation(q1.quantile(.5)), count / 4,
+        count * .005);
+    EXPECT_NEAR(d1.estimate(), count, count * .03);
+
+    DistinctSketch small;
+    for (int i = 0; i < 10000; ++i)
+        small.insert(i % 100);
+    EXPECT_NEAR(small.estimate(), 100, 1);
+}
+
+TEST(Stats, approximate)
+{
+    PointTable table;
+    table.layout()->registerDims({Dimension::Id::X, Dimension::Id::Y});
+    PointViewPtr v(new PointView(table));
+    const PointId count = 200000;
+    for (PointId i = 0; i < count; ++i)
+    {
+        v->setField(Dimension::Id::X, i, (double)((i * 7919) % count));
+        v->setField(Dimension::Id::Y, i, (double)(i % 1000));
+    }
+
+    BufferReader r;
+    r.addView(v);
+    StatsFilter f;
+    f.setInput(r);
+    Options opts;
+    opts.add("advanced", true);
+    opts.add("approximate", true);
+    opts.add("global", "X");
+    opts.add("distinct", "Y");
+    f.setOptions(opts);
+
+    f.prepare(table);
+    f.execute(table);
+
+    const stats::Summary& xstats = f.getStats(Dimension::Id::X);
+    EXPECT_EQ(xstats.count(), count);
+    EXPECT_DOUBLE_EQ(xstats.minimum(), 0);
+    EXPECT_DOUBLE_EQ(xstats.maximum(), count - 1);
+    EXPECT_NEAR(xstats.average(), (count - 1) / 2.0, 1e-6);
+    EXPECT_NEAR(xstats.median(), count / 2, count * .002);
+    EXPECT_NEAR(xstats.mad(), count / 4, count * .005);
+
+    const stats::Summary& ystats = f.getStats(Dimension::Id::Y);
+    EXPECT_NEAR(ystats.distinct(), 1000, 20);
+    EXPECT_NEAR(ystats.average(), 499.5, 1e-9);
+}
@@ -35,7 +35,9 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/StageFactory.hpp>
+#include <pdal/private/ThreadBudget.hpp>
 #include <io/FauxReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <filters/TransformationFilter.hpp>
 #include "Support.hpp"
 
@@ -292,4 +294,81 @@ TEST(TransformationMatrix, init_file_multiline)
 }
 
 
+// Transforming large views across threads and whole stream chunks at a
+// time must match transforming each point.
+TEST(TransformationFilterTest, Batch)
+{
+    using namespace Dimension;
+
+    // Several threads, and chunks large enough to be split among them.
+    ThreadBudget budget(3);
+    ThreadBudget::Scope scope(&budget);
+
+    const point_count_t count(200000);
+    Options readerOpts;
+    readerOpts.add("mode", "ramp");
+    readerOpts.add("count", count);
+    readerOpts.add("bounds", BOX3D(-1000, 0, 10, 1000, 5000, 20));
+
+    Options filterOpts;
+    filterOpts.add("matrix", "0 -1 0 5\n1 0 0 -3\n0 0 2 1\n0 0 0 1");
+
+    FauxReader inReader;
+    inReader.setOptions(readerOpts);
+    PointTable inTable;
+    inReader.prepare(inTable);
+    PointViewPtr in = *inReader.execute(inTable).begin();
+
+    auto verify = [&in](PointRef& point, PointId i)
+    {
+        double x = in->getFieldAs<double>(Id::X, i);
+        double y = in->getFieldAs<double>(Id::Y, i);
+        double z = in->getFieldAs<double>(Id::Z, i);
+        EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::X), -y + 5);
+        EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::Y), x - 3);
+        EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::Z), 2 * z + 1);
+    };
+
+    {
+        FauxReader reader;
+        reader.setOptions(readerOpts);
+        TransformationFilter filter;
+        filter.setOptions(filterOpts);
+        filter.setInput(reader);
+
+        PointTable table;
+        filter.prepare(table);
+        PointViewPtr view = *filter.execute(table).begin();
+        ASSERT_EQ(view->size(), count);
+        for (PointId i = 0; i < count; i += 13)
+        {
+            PointRef point(*view, i);
+            verify(point, i);
+        }
+    }
+
+    {
+        FauxReader reader;
+        reader.setOptions(readerOpts);
+        TransformationFilter filter;
+        filter.setOptions(filterOpts);
+        filter.setInput(reader);
+        StreamCallbackFilter f;
+        f.setInput(filter);
+
+        PointId i = 0;
+        f.setCallback([&verify, &i](PointRef& point)
+        {
+            verify(point, i++);
+            return true;
+        });
+
+        FixedPointTable table(20000);
+        f.prepare(table);
+        f.execute(table);
+        EXPECT_EQ(i, count);
+    }
+    EXPECT_EQ(budget.acquire(10), 3u);
+}
+
 }
@@ -35,6 +35,10 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/StageFactory.hpp>
+#include <pdal/private/VoxelGrid.hpp>
+#include <io/BufferReader.hpp>
+
+#include <random>
 
 #include "Support.hpp"
 
@@ -117,4 +121,137 @@ TEST(VoxelTest, center_value)
     }
 }
 
+// Voxels are numbered from the first point and indexed by rounding down,
+// so points just below the first point fall in their own voxel.  Voxels
+// are output in (row, column, depth) order.
+TEST(VoxelTest, centroid_value)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDims({ Id::X, Id::Y, Id::Z });
+    PointViewPtr view(new PointView(table));
+    const double pts[][3] = {
+        { 0, 0, 0 }, { -4, 1, 1 }, { 3, 1, 1 },
+        { -12, 2, 2 }, { -14, 2, 2 }, { -19, 2, 2 } };
+    for (PointId i = 0; i < 6; ++i)
+    {
+        view->setField(Id::X, i, pts[i][0]);
+        view->setField(Id::Y, i, pts[i][1]);
+        view->setField(Id::Z, i, pts[i][2]);
+    }
+    BufferReader reader;
+    reader.addView(view);
+
+    StageFactory fac;
+    Stage *filter = fac.createStage("filters.voxelcentroidnearestneighbor");
+    Options fo;
+    fo.add("cell", 10);
+    filter->setOptions(fo);
+    filter->setInput(reader);
+
+    filter->prepare(table);
+    PointViewSet set = filter->execute(table);
+    EXPECT_EQ(set.size(), 1U);
+    PointViewPtr v = *set.begin();
+    ASSERT_EQ(v->size(), 3U);
+
+    // Three points: the one nearest the centroid (-15, 2, 2).
+    EXPECT_EQ(v->getFieldAs<double>(Id::X, 0), -14);
+    // One point.
+    EXPECT_EQ(v->getFieldAs<double>(Id::X, 1), -4);
+    // Two points: the one nearest the voxel center (5, 5, 5).
+    EXPECT_EQ(v->getFieldAs<double>(Id::X, 2), 3);
+}
+
+TEST(VoxelTest, hash)
+{
+    VoxelHash hash;
+
+    EXPECT_TRUE(hash.empty());
+    for (int32_t i = -50; i < 50; ++i)
+        for (int32_t j = -50; j < 50; ++j)
+        {
+            auto res = hash.insert(i, j, i ^ j);
+            EXPECT_TRUE(res.second);
+            EXPECT_EQ(res.first, (uint32_t)((i + 50) * 100 + j + 50));
+        }
+    EXPECT_EQ(hash.size(), 10000U);
+    auto res = hash.insert(-3, 7, -3 ^ 7);
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ(res.first, 4757U);
+    hash.clear();
+    EXPECT_TRUE(hash.empty());
+    EXPECT_TRUE(hash.insert(-3, 7, -3 ^ 7).second);
+}
+
+TEST(VoxelTest, gridThreads)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDims({ Id::X, Id::Y, Id::Z });
+    PointViewPtr view(new PointView(table));
+
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> dist(-100.0, 100.0);
+    for (PointId i = 0; i < 300000; ++i)
+    {
+        view->setField(Id::X, i, dist(generator));
+        view->setField(Id::Y, i, dist(generator));
+        view->setField(Id::Z, i, dist(generator) / 10);
+    }
+
+    // A sharded build must match a single-threaded one.
+    const int reductions = VoxelGrid::Center | VoxelGrid::Centroid;
+    VoxelGrid single(5, 0, 0, 0, reductions);
+    single.build(*view, 1);
+    VoxelGrid sharded(5, 0, 0, 0, reductions);
+    sharded.build(*view, 4);
+
+    ASSERT_EQ(single.size(), sharded.size());
+    point_count_t total = 0;
+    for (size_t v = 0; v < single.size(); ++v)
+    {
+        int32_t i1, j1, k1, i2, j2, k2;
+        single.index(v, i1, j1, k1);
+        sharded.index(v, i2, j2, k2);
+        EXPECT_EQ(i1, i2);
+        EXPECT_EQ(j1, j2);
+        EXPECT_EQ(k1, k2);
+        EXPECT_EQ(single.first(v), sharded.first(v));
+        EXPECT_EQ(single.count(v), sharded.count(v));
+        EXPECT_EQ(single.nearestCenter(v), sharded.nearestCenter(v));
+        EXPECT_EQ(single.nearestCentroid(v), sharded.nearestCentroid(v));
+        if (v)
+            EXPECT_LT(single.first(v - 1), single.first(v));
+        total += single.count(v);
+
+        double x = view->getFieldAs<double>(Id::X, single.first(v));
+        EXPECT_EQ(i1, (int32_t)std::floor(x / 5));
+    }
+    EXPECT_EQ(total, view->size());
+
+    // Column tables hand out spans that stop at block boundaries, which
+    // the threads' ranges of points don't start on.
+    ColumnPointTable colTable;
+    colTable.layout()->registerDims({ Id::X, Id::Y, Id::Z });
+    colTable.finalize();
+    PointViewPtr colView(new PointView(colTable));
+    for (PointId i = 0; i < view->size(); ++i)
+        for (Id dim : { Id::X, Id::Y, Id::Z })
+            colView->setField(dim, i, view->getFieldAs<double>(dim, i));
+    VoxelGrid column(5, 0, 0, 0, reductions);
+    column.build(*colView, 4);
+
+    ASSERT_EQ(single.size(), column.size());
+    for (size_t v = 0; v < single.size(); ++v)
+    {
+        EXPECT_EQ(single.first(v), column.first(v));
+        EXPECT_EQ(single.count(v), column.count(v));
+        EXPECT_EQ(single.nearestCenter(v), column.nearestCenter(v));
+        EXPECT_EQ(single.nearestCentroid(v), column.nearestCentroid(v));
+    }
+}
+
 } // namespace
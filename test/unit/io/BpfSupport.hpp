@@ -212,6 +212,35 @@ void test_file_type(const std::string& filename)
 }
 
 
+// Check that a file is read mapped from a path that has to be converted
+// to a native path on some platforms.
+void test_file_type_mapped(const std::string& filename)
+{
+    std::string dir(Support::temppath(FileUtils::readFileIntoString(
+        Support::datapath("unicode/japanese-pr2135.txt"))));
+    EXPECT_TRUE(FileUtils::createDirectories(dir));
+    std::string copy(dir + "/" + FileUtils::getFilename(filename));
+
+    std::string contents(FileUtils::readFileIntoString(filename));
+    std::ostream *out = FileUtils::createFile(copy);
+    ASSERT_NE(out, nullptr);
+    out->write(contents.data(), contents.size());
+    FileUtils::closeFile(out);
+
+    {
+        ILeStream in;
+        EXPECT_EQ(in.openMapped(copy), 0);
+        ASSERT_NE(in.data(), nullptr);
+        EXPECT_EQ(in.size(), contents.size());
+        EXPECT_EQ(std::string(in.data(), in.size()), contents);
+    }
+    test_file_type(copy);
+
+    FileUtils::deleteFile(copy);
+    FileUtils::deleteDirectory(dir);
+}
+
+
 void test_roundtrip(Options& writerOps)
 {
     std::string infile(
@@ -57,6 +57,24 @@ TEST(BpfTestBase, test_byte_major)
         Support::datapath("bpf/autzen-utm-chipped-25-v3-segregated.bpf"));
 }
 
+TEST(BpfTestBase, mapped_point_major)
+{
+    test_file_type_mapped(
+        Support::datapath("bpf/autzen-utm-chipped-25-v3-interleaved.bpf"));
+}
+
+TEST(BpfTestBase, mapped_dim_major)
+{
+    test_file_type_mapped(
+        Support::datapath("bpf/autzen-utm-chipped-25-v3.bpf"));
+}
+
+TEST(BpfTestBase, mapped_byte_major)
+{
+    test_file_type_mapped(
+        Support::datapath("bpf/autzen-utm-chipped-25-v3-segregated.bpf"));
+}
+
 TEST(BpfTestBase, roundtrip_byte)
 {
     Options ops;
@@ -60,6 +60,12 @@ TEST(BpfTestZlib, test_byte_major_zlib)
             "autzen-utm-chipped-25-v3-deflate-segregated.bpf"));
 }
 
+TEST(BpfTestZlib, mapped_zlib)
+{
+    test_file_type_mapped(
+        Support::datapath("bpf/autzen-utm-chipped-25-v3-deflate.bpf"));
+}
+
 TEST(BpfTestZlib, roundtrip_byte_compression)
 {
     Options ops;
@@ -40,8 +40,10 @@
 
 #include <io/EptReader.hpp>
 #include <io/LasReader.hpp>
+#include <io/private/ept/TileCache.hpp>
 #include <filters/CropFilter.hpp>
 #include <filters/ReprojectionFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <pdal/SrsBounds.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/private/gdal/GDALUtils.hpp>
@@ -667,6 +669,34 @@ TEST(EptReaderTest, boundedCrop)
     EXPECT_EQ(sourceNp, 47u);
 }
 
+TEST(EptReaderTest, boundedCropStream)
+{
+    std::string wkt = FileUtils::readFileIntoString(
+        Support::datapath("autzen/autzen-selection.wkt"));
+
+    EptReader reader;
+    {
+        Options options;
+        options.add("filename", eptAutzenPath);
+        options.add("polygon", wkt + "/ EPSG:3644");
+        reader.setOptions(options);
+    }
+
+    point_count_t count(0);
+    StreamCallbackFilter f;
+    f.setCallback([&count](PointRef&)
+    {
+        count++;
+        return true;
+    });
+    f.setInput(reader);
+
+    FixedPointTable table(20);
+    f.prepare(table);
+    f.execute(table);
+    EXPECT_EQ(count, 47u);
+}
+
 TEST(EptReaderTest, boundedCropReprojection)
 {
     std::string selection = FileUtils::readFileIntoString(
@@ -781,4 +811,222 @@ TEST(EptReaderTest, ogrCrop)
 
 
 
+TEST(EptReaderTest, cache)
+{
+    const std::string cacheDir(Support::temppath("ept-cache"));
+    FileUtils::deleteDirectory(cacheDir);
+
+    auto count = [&cacheDir](const std::string& path, uint64_t cacheSize,
+        uint64_t readAhead)
+    {
+        Options options;
+        options.add("filename", "file://" + path);
+        options.add("cache_dir", cacheDir);
+        options.add("cache_size", cacheSize);
+        options.add("read_ahead", readAhead);
+
+        PointTable table;
+        EptReader reader;
+        reader.setOptions(options);
+        reader.prepare(table);
+
+        point_count_t np(0);
+        for (const PointViewPtr& view : reader.execute(table))
+            np += view->size();
+        return np;
+    };
+
+    // The first read fills the cache and the second reads from it.
+    EXPECT_EQ(count(eptLaszipPath, 1024, 512), expNumPoints);
+    EXPECT_EQ(FileUtils::directoryList(cacheDir).size(), 1u);
+    EXPECT_EQ(count(eptLaszipPath, 1024, 1), expNumPoints);
+
+    EXPECT_EQ(count(ellipsoidEptBinaryPath, 1024, 512), ellipsoidNumPoints);
+    EXPECT_EQ(FileUtils::directoryList(cacheDir).size(), 2u);
+    EXPECT_EQ(count(ellipsoidEptBinaryPath, 1024, 1), ellipsoidNumPoints);
+
+    // A cache that's too small for the data still works.
+    EXPECT_EQ(count(ellipsoidEptBinaryPath, 0, 1), ellipsoidNumPoints);
+
+    FileUtils::deleteDirectory(cacheDir);
+}
+
+namespace
+{
+
+void copyDirectory(const std::string& from, const std::string& to)
+{
+    FileUtils::createDirectories(to);
+    for (const std::string& path : FileUtils::directoryList(from))
+    {
+        const std::string dest(to + "/" + FileUtils::getFilename(path));
+        if (FileUtils::isDirectory(path))
+        {
+            copyDirectory(path, dest);
+            continue;
+        }
+        const std::string data(FileUtils::readFileIntoString(path));
+        std::ostream *out = FileUtils::createFile(dest);
+        out->write(data.data(), data.size());
+        FileUtils::closeFile(out);
+    }
+}
+
+} // unnamed namespace
+
+// Once cached, a dataset can be read without its tiles and hierarchy,
+// until its ept.json changes.
+TEST(EptReaderTest, cacheOffline)
+{
+    const std::string cacheDir(Support::temppath("ept-cache"));
+    const std::string sourceDir(Support::temppath("ept-cache-source"));
+    FileUtils::deleteDirectory(cacheDir);
+    FileUtils::deleteDirectory(sourceDir);
+    copyDirectory(Support::datapath("ept/lone-star-laszip"), sourceDir);
+
+    auto count = [&cacheDir, &sourceDir]()
+    {
+        Options options;
+        options.add("filename", "file://" + sourceDir + "/ept.json");
+        options.add("cache_dir", cacheDir);
+
+        PointTable table;
+        EptReader reader;
+        reader.setOptions(options);
+        reader.prepare(table);
+
+        point_count_t np(0);
+        for (const PointViewPtr& view : reader.execute(table))
+            np += view->size();
+        return np;
+    };
+
+    EXPECT_EQ(count(), expNumPoints);
+    FileUtils::deleteDirectory(sourceDir + "/ept-data");
+    FileUtils::deleteDirectory(sourceDir + "/ept-hierarchy");
+    EXPECT_FALSE(FileUtils::directoryExists(sourceDir + "/ept-data"));
+    EXPECT_EQ(count(), expNumPoints);
+
+    // A change to ept.json empties the cache, so the missing files are
+    // fetched again and can't be found.
+    NL::json info = NL::json::parse(
+        FileUtils::readFileIntoString(sourceDir + "/ept.json"));
+    info["cacheTest"] = 1;
+    const std::string s(info.dump());
+    std::ostream *out = FileUtils::createFile(sourceDir + "/ept.json");
+    out->write(s.data(), s.size());
+    FileUtils::closeFile(out);
+    EXPECT_ANY_THROW(count());
+
+    const StringList datasets(FileUtils::directoryList(cacheDir));
+    ASSERT_EQ(datasets.size(), 1u);
+    EXPECT_EQ(FileUtils::directoryList(datasets[0] + "/ept-data").size(), 0u);
+    EXPECT_EQ(
+        FileUtils::directoryList(datasets[0] + "/ept-hierarchy").size(), 0u);
+
+    FileUtils::deleteDirectory(cacheDir);
+    FileUtils::deleteDirectory(sourceDir);
+}
+
+// The least recently used files are removed when the cache grows past
+// its limit.
+TEST(EptReaderTest, cacheEviction)
+{
+    const std::string cacheDir(Support::temppath("ept-cache"));
+    FileUtils::deleteDirectory(cacheDir);
+
+    const std::string root("file:///ept/");
+    int fetches = 0;
+    auto get = [&root, &fetches](TileCache& cache, const std::string& name)
+    {
+        return cache.get(root + "ept-data/" + name, [&fetches]()
+        {
+            fetches++;
+            return std::vector<char>(300, 'x');
+        });
+    };
+
+    {
+        TileCache cache(cacheDir, root, "{}", 1000);
+        get(cache, "a.bin");
+        get(cache, "b.bin");
+        get(cache, "c.bin");
+        EXPECT_EQ(fetches, 3);
+        EXPECT_EQ(get(cache, "a.bin").size(), 300u);
+        EXPECT_EQ(fetches, 3);
+
+        // Adding a fourth file passes the limit and removes the least
+        // recently used one.
+        get(cache, "d.bin");
+        EXPECT_EQ(fetches, 4);
+        get(cache, "a.bin");
+        get(cache, "c.bin");
+        get(cache, "d.bin");
+        EXPECT_EQ(fetches, 4);
+        get(cache, "b.bin");
+        EXPECT_EQ(fetches, 5);
+    }
+
+    // The order of use is kept across instances.  Reading 'b' above
+    // removed 'a', the least recently used.
+    {
+        TileCache cache(cacheDir, root, "{}", 1000);
+        get(cache, "b.bin");
+        get(cache, "c.bin");
+        get(cache, "d.bin");
+        EXPECT_EQ(fetches, 5);
+        get(cache, "a.bin");
+        EXPECT_EQ(fetches, 6);
+    }
+
+    // Different dataset info empties the cache.
+    {
+        TileCache cache(cacheDir, root, "{\"changed\":true}", 1000);
+        get(cache, "a.bin");
+        EXPECT_EQ(fetches, 7);
+    }
+
+    FileUtils::deleteDirectory(cacheDir);
+}
+
+// Pins only hold in the cache that made them, so a second cache using the
+// same directory, as another process would, can remove a pinned file.  The
+// file is then fetched again.
+TEST(EptReaderTest, cacheShared)
+{
+    const std::string cacheDir(Support::temppath("ept-cache"));
+    FileUtils::deleteDirectory(cacheDir);
+
+    const std::string root("file:///ept/");
+    int fetches = 0;
+    auto fetch = [&fetches]()
+    {
+        fetches++;
+        return std::vector<char>(300, 'x');
+    };
+
+    TileCache first(cacheDir, root, "{}", 1000);
+    {
+        TileCache::Pin pin(first.pin(root + "ept-data/a.bin", fetch));
+        EXPECT_EQ(fetches, 1);
+
+        // The second cache finds 'a' when it starts and removes it as the
+        // least recently used file once it passes the limit.
+        TileCache second(cacheDir, root, "{}", 1000);
+        second.get(root + "ept-data/b.bin", fetch);
+        second.get(root + "ept-data/c.bin", fetch);
+        second.get(root + "ept-data/d.bin", fetch);
+        EXPECT_EQ(fetches, 4);
+        EXPECT_FALSE(FileUtils::fileExists(pin.localPath()));
+    }
+
+    TileCache::Pin pin(first.pin(root + "ept-data/a.bin", fetch));
+    EXPECT_EQ(fetches, 5);
+    EXPECT_EQ(FileUtils::fileSize(pin.localPath()), 300u);
+    EXPECT_EQ(first.get(root + "ept-data/a.bin", fetch).size(), 300u);
+    EXPECT_EQ(fetches, 5);
+
+    FileUtils::deleteDirectory(cacheDir);
+}
+
 } // namespace pdal
@@ -39,7 +39,11 @@
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <io/FauxReader.hpp>
 #include <io/LasReader.hpp>
+#include <io/LasWriter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
 using namespace pdal;
@@ -400,6 +404,69 @@ TEST(LasReaderTest, lazperf)
 }
 #endif
 
+#ifdef PDAL_HAVE_LAZPERF
+// Chunks are decompressed on several threads, but points must come back
+// in file order, both when reading into a view and when streaming.
+TEST(LasReaderTest, lazperf_threads)
+{
+    Options lasOps;
+    lasOps.add("filename", Support::datapath("las/autzen_trim.las"));
+
+    LasReader lasReader;
+    lasReader.setOptions(lasOps);
+
+    PointTable t1;
+    lasReader.prepare(t1);
+    PointViewSet s = lasReader.execute(t1);
+    PointViewPtr lasView = *s.begin();
+
+    Options lazOps;
+    lazOps.add("filename", Support::datapath("laz/autzen_trim.laz"));
+    lazOps.add("compression", "lazperf");
+    lazOps.add("threads", 4);
+
+    LasReader lazReader;
+    lazReader.setOptions(lazOps);
+
+    PointTable t2;
+    lazReader.prepare(t2);
+    s = lazReader.execute(t2);
+    PointViewPtr lazView = *s.begin();
+    ASSERT_EQ(lazView->size(), (point_count_t)110000);
+
+    DimTypeList dims = lasView->dimTypes();
+    size_t pointSize = lasView->pointSize();
+    EXPECT_EQ(lazView->pointSize(), pointSize);
+    std::vector<char> buf1(pointSize);
+    std::vector<char> buf2(pointSize);
+    for (PointId i = 0; i < 110000; i += 100)
+    {
+       lasView->getPackedPoint(dims, i, buf1.data());
+       lazView->getPackedPoint(dims, i, buf2.data());
+       EXPECT_EQ(memcmp(buf1.data(), buf2.data(), pointSize), 0);
+    }
+
+    LasReader streamReader;
+    streamReader.setOptions(lazOps);
+
+    PointId cnt = 0;
+    StreamCallbackFilter f;
+    f.setCallback([&](PointRef& point)
+    {
+        lasView->getPackedPoint(dims, cnt++, buf1.data());
+        point.getPackedData(dims, buf2.data());
+        EXPECT_EQ(memcmp(buf1.data(), buf2.data(), pointSize), 0);
+        return true;
+    });
+    f.setInput(streamReader);
+
+    FixedPointTable fixed(100);
+    f.prepare(fixed);
+    f.execute(fixed);
+    EXPECT_EQ(cnt, 110000u);
+}
+#endif
+
 void streamTest(const std::string src, const std::string compression)
 {
     Options ops1;
@@ -475,6 +542,275 @@ TEST(LasReaderTest, stream)
 }
 
 
+// Standard mode decodes uncompressed points a block at a time, while stream
+// mode decodes a point at a time.  Make sure they agree for a range of
+// point formats, including files with extra bytes.
+TEST(LasReaderTest, bulk_decode)
+{
+    auto check = [](const std::string& filename)
+    {
+        Options ops;
+        ops.add("filename", filename);
+
+        LasReader bulkReader;
+        bulkReader.setOptions(ops);
+
+        PointTable table;
+        bulkReader.prepare(table);
+        PointViewSet s = bulkReader.execute(table);
+        PointViewPtr view = *s.begin();
+        DimTypeList dims = view->dimTypes();
+        size_t pointSize = view->pointSize();
+        std::vector<char> buf1(pointSize);
+        std::vector<char> buf2(pointSize);
+
+        LasReader streamReader;
+        streamReader.setOptions(ops);
+
+        PointId cnt = 0;
+        StreamCallbackFilter f;
+        f.setCallback([&](PointRef& point)
+        {
+            view->getPackedPoint(dims, cnt++, buf1.data());
+            point.getPackedData(dims, buf2.data());
+            EXPECT_EQ(memcmp(buf1.data(), buf2.data(), pointSize), 0) <<
+                filename << ": point " << (cnt - 1);
+            return true;
+        });
+        f.setInput(streamReader);
+
+        FixedPointTable fixed(100);
+        f.prepare(fixed);
+        f.execute(fixed);
+        EXPECT_EQ(cnt, view->size()) << filename;
+    };
+
+    check(Support::datapath("las/simple.las"));
+    check(Support::datapath("las/autzen_trim.las"));
+    check(Support::datapath("las/autzen_trim_7.las"));
+    check(Support::datapath("las/test1_4.las"));
+    check(Support::datapath("las/extrabytes.las"));
+}
+
+
+namespace
+{
+
+// Run a file through a filter, returning the number of points that pass.
+// In standard mode, 'loaded' is set to the number of points the reader
+// loaded into the view.
+point_count_t pushdownRun(const std::string& filename,
+    const std::string& compression, const std::string& filterName,
+    const Options& filterOps, bool stream, point_count_t& loaded)
+{
+    StageFactory factory;
+
+    Options readerOps;
+    readerOps.add("filename", filename);
+    readerOps.add("compression", compression);
+    LasReader reader;
+    reader.setOptions(readerOps);
+
+    Stage *filter = factory.createStage(filterName);
+    filter->setOptions(filterOps);
+    filter->setInput(reader);
+
+    point_count_t count = 0;
+    loaded = 0;
+    if (stream)
+    {
+        StreamCallbackFilter f;
+        f.setCallback([&count](PointRef&){ count++; return true; });
+        f.setInput(*filter);
+
+        FixedPointTable table(100);
+        f.prepare(table);
+        f.execute(table);
+    }
+    else
+    {
+        reader.setReadCb([&loaded](PointView&, PointId){ loaded++; });
+
+        PointTable table;
+        filter->prepare(table);
+        for (const PointViewPtr& v : filter->execute(table))
+            count += v->size();
+    }
+    return count;
+}
+
+} // unnamed namespace
+
+TEST(LasReaderTest, pushdown)
+{
+    std::string lasFile(Support::datapath("las/autzen_trim.las"));
+    std::string lazFile(Support::datapath("laz/autzen_trim.laz"));
+
+    Options ops;
+    ops.add("filename", lasFile);
+    LasReader r;
+    r.setOptions(ops);
+    PointTable t;
+    r.prepare(t);
+    const BOX3D& b = r.header().getBounds();
+    point_count_t total = r.header().pointCount();
+
+    // Crop to the lower-left quarter of the file.
+    double midx = (b.minx + b.maxx) / 2;
+    double midy = (b.miny + b.maxy) / 2;
+    std::string bounds = "([" + std::to_string(b.minx) + "," +
+        std::to_string(midx) + "],[" + std::to_string(b.miny) + "," +
+        std::to_string(midy) + "])";
+
+    auto check = [&](const std::string& filename,
+        const std::string& compression, const std::string& filterName,
+        Options filterOps)
+    {
+        point_count_t loaded;
+
+        // A 'where' that every point matches stops the filter from
+        // pushing its predicate to the reader.
+        Options whereOps(filterOps);
+        whereOps.add("where", "X > 0 || X <= 0");
+        point_count_t expected = pushdownRun(filename, compression,
+            filterName, whereOps, false, loaded);
+        EXPECT_EQ(loaded, total);
+        EXPECT_GT(expected, 0u);
+        EXPECT_LT(expected, total);
+
+        point_count_t count = pushdownRun(filename, compression,
+            filterName, filterOps, false, loaded);
+        EXPECT_EQ(count, expected) << filename << "/" << filterName;
+        EXPECT_LT(loaded, total) << filename << "/" << filterName;
+
+        count = pushdownRun(filename, compression, filterName,
+            filterOps, true, loaded);
+        EXPECT_EQ(count, expected) << filename << "/" << filterName;
+
+        // Compressed files may skip whole chunks once they've been read.
+        count = pushdownRun(filename, compression, filterName,
+            filterOps, false, loaded);
+        EXPECT_EQ(count, expected) << filename << "/" << filterName;
+    };
+
+    Options cropOps;
+    cropOps.add("bounds", bounds);
+
+    Options polyOps;
+    polyOps.add("polygon", "POLYGON((" +
+        std::to_string(b.minx) + " " + std::to_string(b.miny) + "," +
+        std::to_string(midx) + " " + std::to_string(b.miny) + "," +
+        std::to_string(b.minx) + " " + std::to_string(midy) + "," +
+        std::to_string(b.minx) + " " + std::to_string(b.miny) + "))");
+
+    Options rangeOps;
+    rangeOps.add("limits", "X[:" + std::to_string(midx) + "]");
+    rangeOps.add("limits", "Classification[2:2]");
+
+    check(lasFile, "EITHER", "filters.crop", cropOps);
+    check(lasFile, "EITHER", "filters.crop", polyOps);
+    check(lasFile, "EITHER", "filters.range", rangeOps);
+#if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
+    std::vector<std::string> compressions { "EITHER" };
+#ifdef PDAL_HAVE_LAZPERF
+    compressions.push_back("LAZPERF");
+#endif
+    for (const std::string& compression : compressions)
+    {
+        check(lazFile, compression, "filters.crop", cropOps);
+        check(lazFile, compression, "filters.range", rangeOps);
+    }
+#endif
+
+    // A reader feeding more than one stage can't drop points for any
+    // of them.
+    point_count_t loaded;
+    point_count_t cropCount = pushdownRun(lasFile, "EITHER", "filters.crop",
+        cropOps, false, loaded);
+    point_count_t rangeCount = pushdownRun(lasFile, "EITHER",
+        "filters.range", rangeOps, false, loaded);
+
+    StageFactory factory;
+    LasReader reader;
+    reader.setOptions(ops);
+    Stage *crop = factory.createStage("filters.crop");
+    crop->setOptions(cropOps);
+    crop->setInput(reader);
+    Stage *range = factory.createStage("filters.range");
+    range->setOptions(rangeOps);
+    range->setInput(reader);
+    Stage *merge = factory.createStage("filters.merge");
+    merge->setInput(*crop);
+    merge->setInput(*range);
+
+    PointTable table;
+    merge->prepare(table);
+    PointViewSet viewSet = merge->execute(table);
+    ASSERT_EQ(viewSet.size(), 1u);
+    EXPECT_EQ((*viewSet.begin())->size(), cropCount + rangeCount);
+}
+
+
+#ifdef PDAL_HAVE_LASZIP
+// Version 1.4 LAZ files written by PDAL hold the bounds of their chunks,
+// so the first read of a file can skip chunks.
+TEST(LasReaderTest, pushdown_chunk_vlr)
+{
+    std::string filename(Support::temppath("chunk_bounds.laz"));
+    FileUtils::deleteFile(filename);
+
+    // LASzip writes chunks of 50000 points.
+    Options fauxOps;
+    fauxOps.add("bounds", BOX3D(0, 0, 0, 199999, 199999, 199999));
+    fauxOps.add("mode", "ramp");
+    fauxOps.add("count", 200000);
+    FauxReader faux;
+    faux.setOptions(fauxOps);
+
+    Options writerOps;
+    writerOps.add("filename", filename);
+    writerOps.add("compression", "laszip");
+    writerOps.add("minor_version", 4);
+    LasWriter writer;
+    writer.setOptions(writerOps);
+    writer.setInput(faux);
+
+    PointTable writeTable;
+    writer.prepare(writeTable);
+    writer.execute(writeTable);
+
+    Options readerOps;
+    readerOps.add("filename", filename);
+    readerOps.add("compression", "laszip");
+    LasReader reader;
+    reader.setOptions(readerOps);
+
+    std::ostringstream oss;
+    LogPtr log(Log::makeLog("", &oss));
+    log->setLevel(LogLevel::Debug);
+    reader.setLog(log);
+
+    Options cropOps;
+    cropOps.add("bounds", "([0,40000],[0,199999])");
+    StageFactory factory;
+    Stage *crop = factory.createStage("filters.crop");
+    crop->setOptions(cropOps);
+    crop->setInput(reader);
+
+    PointTable table;
+    crop->prepare(table);
+    PointViewSet viewSet = crop->execute(table);
+    ASSERT_EQ(viewSet.size(), 1u);
+    PointViewPtr view = *viewSet.begin();
+    ASSERT_EQ(view->size(), 40001u);
+    for (PointId idx = 0; idx < view->size(); ++idx)
+        EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::X, idx), (int)idx);
+    EXPECT_NE(oss.str().find("Skipping 3 of 4 chunks."), std::string::npos);
+    FileUtils::deleteFile(filename);
+}
+#endif
+
+
 // The header of 1.2-with-color-clipped says that it has 1065 points,
 // but it really only has 1064.
 TEST(LasReaderTest, LasHeaderIncorrectPointcount)
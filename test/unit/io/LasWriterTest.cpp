@@ -727,6 +727,57 @@ TEST(LasWriterTest, lazperf)
 }
 #endif
 
+#if defined(PDAL_HAVE_LAZPERF)
+// Chunks compressed on several threads must produce the same file as
+// a single thread.
+TEST(LasWriterTest, lazperf_threads)
+{
+    auto write = [](const std::string& filename, int threads)
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        FileUtils::deleteFile(filename);
+
+        Options writerOps;
+        writerOps.add("filename", filename);
+        writerOps.add("compression", "lazperf");
+        writerOps.add("threads", threads);
+
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+
+        PointTable t;
+        writer.prepare(t);
+        writer.execute(t);
+    };
+
+    std::string serialFile(Support::temppath("serial.laz"));
+    std::string threadedFile(Support::temppath("threaded.laz"));
+
+    write(serialFile, 1);
+    write(threadedFile, 4);
+    EXPECT_TRUE(Support::compare_files(serialFile, threadedFile));
+
+    Options ops;
+    ops.add("filename", threadedFile);
+    ops.add("compression", "lazperf");
+    ops.add("threads", 4);
+
+    LasReader r;
+    r.setOptions(ops);
+
+    PointTable t;
+    r.prepare(t);
+    PointViewSet s = r.execute(t);
+    EXPECT_EQ((*s.begin())->size(), (point_count_t)110000);
+}
+#endif
+
 #if defined(PDAL_HAVE_LASZIP)
 // LAZ files are normally written in chunks of 50,000, so a file of size
 // 110,000 ensures we read some whole chunks and a partial.
@@ -348,3 +348,61 @@ TEST(TextReaderTest, quotedHeader)
         testme(opts, "text/quoted2.txt");
     }
 }
+
+TEST(TextReaderTest, threads)
+{
+    std::string filename(Support::temppath("threads.txt"));
+
+    // Enough lines that blocks are split among threads, along with some
+    // that can't be parsed.
+    {
+        std::ofstream out(filename);
+        out << "X,Y,Z\n";
+        for (int i = 0; i < 200000; ++i)
+        {
+            if (i % 50000 == 7)
+                out << "1,2\n";
+            else if (i % 50000 == 9)
+                out << "\n";
+            out << (i * .25) << "," << -i << ", " << (i % 1000) << "e-3\r\n";
+        }
+        out << "1.5,2.5,3.5";
+    }
+
+    auto readFile = [&filename](int threads)
+    {
+        Options opts;
+        opts.add("filename", filename);
+        opts.add("threads", threads);
+
+        TextReader reader;
+        reader.setOptions(opts);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        return *s.begin();
+    };
+
+    PointViewPtr v1 = readFile(1);
+    PointViewPtr v4 = readFile(4);
+    ASSERT_EQ(v1->size(), 200001U);
+    ASSERT_EQ(v4->size(), 200001U);
+    for (PointId i = 0; i < v1->size(); ++i)
+    {
+        using namespace Dimension;
+
+        ASSERT_EQ(v1->getFieldAs<double>(Id::X, i),
+            v4->getFieldAs<double>(Id::X, i));
+        ASSERT_EQ(v1->getFieldAs<double>(Id::Y, i),
+            v4->getFieldAs<double>(Id::Y, i));
+        ASSERT_EQ(v1->getFieldAs<double>(Id::Z, i),
+            v4->getFieldAs<double>(Id::Z, i));
+    }
+    EXPECT_EQ(v4->getFieldAs<double>(Dimension::Id::X, 1001), 250.25);
+    EXPECT_EQ(v4->getFieldAs<double>(Dimension::Id::Y, 1001), -1001.0);
+    EXPECT_EQ(v4->getFieldAs<double>(Dimension::Id::Z, 1001), 0.001);
+    EXPECT_EQ(v4->getFieldAs<double>(Dimension::Id::Z, 200000), 3.5);
+
+    FileUtils::deleteFile(filename);
+}
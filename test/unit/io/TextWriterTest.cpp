@@ -41,6 +41,9 @@
 #include <io/TextReader.hpp>
 #include <io/TextWriter.hpp>
 
+#include <iomanip>
+#include <sstream>
+
 using namespace pdal;
 
 TEST(TextWriterTest, t1)
@@ -185,6 +188,64 @@ TEST(TextWriterTest, precision)
     EXPECT_NE(out.find("3,3,3,3"), std::string::npos);
 }
 
+// Values are written as std::fixed formatting would write them.
+TEST(TextWriterTest, fixedFormat)
+{
+    using namespace Dimension;
+
+    // Negative values, values that round up to a new digit, ties and
+    // large magnitudes.
+    const std::vector<double> values { 0, -0.0, -0.0004, 1.0005, 9.9995,
+        99.9996, -9.9996, -0.9999999, 0.125, 2.675, 0.5, 2.5, -1.5,
+        999999.9999999999, 123456789.987654, -987654321012.5,
+        4503599627370495.5, 1e17, 1e22, -1.7e308, 5e-324 };
+    const std::vector<int> precisions { 0, 2, 3, 9 };
+
+    PointTable table;
+    table.layout()->registerDims( { Id::X, Id::Y, Id::Z, Id::GpsTime } );
+
+    PointViewPtr view(new PointView(table));
+    std::string expected;
+    for (PointId i = 0; i < values.size(); ++i)
+    {
+        std::ostringstream oss;
+        oss << std::fixed;
+        for (size_t d = 0; d < precisions.size(); ++d)
+        {
+            if (d)
+                oss << ",";
+            oss << std::setprecision(precisions[d]) << values[i];
+        }
+        expected += oss.str() + "\n";
+
+        view->setField(Id::X, i, values[i]);
+        view->setField(Id::Y, i, values[i]);
+        view->setField(Id::Z, i, values[i]);
+        view->setField(Id::GpsTime, i, values[i]);
+    }
+
+    BufferReader r;
+    r.addView(view);
+
+    std::string outfile(Support::temppath("fixed.txt"));
+    FileUtils::deleteFile(outfile);
+
+    TextWriter w;
+    Options o;
+    o.add("order", "X:0,Y:2,Z:3,GpsTime:9");
+    o.add("keep_unspecified", false);
+    o.add("write_header", false);
+    o.add("filename", outfile);
+    w.setInput(r);
+    w.setOptions(o);
+
+    w.prepare(table);
+    w.execute(table);
+
+    EXPECT_EQ(FileUtils::readFileIntoString(outfile), expected);
+    FileUtils::deleteFile(outfile);
+}
+
 TEST(TextWriterTest, geojson)
 {
     std::string outfile(Support::temppath("utm17.geojson"));